@@ -230,6 +230,43 @@ typedef struct realm_version_id {
     uint64_t index;
 } realm_version_id_t;
 
+/* Storage metrics */
+#define RLM_LATENCY_HISTOGRAM_BUCKETS 32
+typedef struct realm_latency_histogram {
+    /* Bucket 0 counts durations below 1 us, and bucket i durations from 2^(i-1) us up to 2^i us. */
+    uint64_t buckets[RLM_LATENCY_HISTOGRAM_BUCKETS];
+    uint64_t count;
+    uint64_t total_us;
+    uint64_t max_us;
+} realm_latency_histogram_t;
+
+typedef enum realm_evacuation_stage {
+    RLM_EVACUATION_STAGE_IDLE,
+    RLM_EVACUATION_STAGE_EVACUATING,
+    RLM_EVACUATION_STAGE_WAITING,
+    RLM_EVACUATION_STAGE_BLOCKED,
+} realm_evacuation_stage_e;
+
+typedef struct realm_storage_metrics {
+    uint64_t commits;
+    uint64_t bytes_written;
+    uint64_t last_commit_bytes;
+    realm_latency_histogram_t begin_write_wait;
+    realm_latency_histogram_t commit;
+    realm_latency_histogram_t write_group;
+    realm_latency_histogram_t free_list;
+    realm_latency_histogram_t sync;
+    uint64_t read_locks;
+    uint64_t active_read_locks;
+    uint64_t live_versions;
+    uint64_t oldest_live_version;
+    uint64_t newest_version;
+    uint64_t file_size;
+    uint64_t pinned_space;
+    realm_evacuation_stage_e evacuation_stage;
+    uint64_t evacuation_limit;
+} realm_storage_metrics_t;
+
 
 /* Error types */
 typedef struct realm_async_error realm_async_error_t;
@@ -1483,6 +1520,16 @@ RLM_API bool realm_get_num_objects(const realm_t*, realm_class_key_t, size_t* ou
  */
 RLM_API bool realm_get_num_versions(const realm_t*, uint64_t* out_versions_count);
 
+/**
+ * Get the counters and latencies of the transactions on the Realm file in this
+ * process, and the versions and space of the file as of its last commit.
+ *
+ * @param out_metrics A pointer to a `realm_storage_metrics_t` that will contain
+ *                    the metrics, if successful.
+ * @return True if no exception occurred.
+ */
+RLM_API bool realm_get_storage_metrics(const realm_t*, realm_storage_metrics_t* out_metrics);
+
 /**
  * Get an object with a particular object key.
  *
@@ -101,6 +101,11 @@ public:
         return false;
     }
 
+    bool merge(const MinMaxAggregateOperator& other)
+    {
+        return other.m_result && accumulate(*other.m_result);
+    }
+
     bool is_null() const
     {
         return !m_result;
@@ -178,6 +183,27 @@ public:
         return false;
     }
 
+    // Add `count` integers summing (with wraparound) to `sum`. As the order
+    // of integer additions does not matter, this gives the same result as
+    // accumulating the values one by one.
+    void accumulate_block(ResultType sum, size_t count)
+    {
+        static_assert(std::is_integral_v<ResultType> && std::is_signed_v<ResultType>);
+        m_result = std::make_unsigned_t<ResultType>(m_result) + sum;
+        m_count += count;
+    }
+
+    void merge(const Sum& other)
+    {
+        if constexpr (std::is_integral_v<ResultType> && std::is_signed_v<ResultType>) {
+            m_result = std::make_unsigned_t<ResultType>(m_result) + other.m_result;
+        }
+        else {
+            m_result += other.m_result;
+        }
+        m_count += other.m_count;
+    }
+
     bool is_null() const
     {
         return false;
@@ -159,6 +159,9 @@ public:
 
 protected:
     constexpr static int section_shift = 26;
+    // Accesses through the translation are tracked for each of the 64 chunks
+    // of a section
+    constexpr static int access_chunk_shift = section_shift - 6;
 
     std::atomic<size_t> m_baseline; // Separation line between immutable and mutable refs.
 
@@ -173,6 +176,9 @@ protected:
         char* mapping_addr;
         uint64_t cookie = 0x1234567890;
         std::atomic<size_t> lowest_possible_xover_offset = 0;
+        // A bit for each chunk of the section translated into since the bit
+        // was last cleared by SlabAlloc::trim_mappings()
+        std::atomic<uint64_t> accessed_chunks = ~uint64_t(0);
 
         // member 'xover_mapping_addr' is used for memory synchronization of the fields
         // 'xover_mapping_base' and 'xover_encrypted_mapping'. It also imposes an ordering
@@ -202,6 +208,8 @@ protected:
 #if REALM_ENABLE_ENCRYPTION
                 encrypted_mapping = from.encrypted_mapping;
 #endif
+                accessed_chunks.store(from.accessed_chunks.load(std::memory_order_relaxed),
+                                      std::memory_order_relaxed);
                 const auto local_xover_mapping_addr = from.xover_mapping_addr.load(std::memory_order_acquire);
 
                 // This must be loaded after xover_mapping_addr to ensure it isn't stale.
@@ -249,6 +257,7 @@ protected:
     virtual char* do_translate(ref_type ref) const noexcept = 0;
     char* translate_critical(RefTranslation*, ref_type ref) const noexcept;
     char* translate_less_critical(RefTranslation*, ref_type ref) const noexcept;
+    static void note_access(RefTranslation& txl, size_t offset) noexcept;
     virtual void get_or_add_xover_mapping(RefTranslation&, size_t, size_t, size_t) = 0;
     Allocator() noexcept = default;
     size_t get_section_index(size_t pos) const noexcept;
@@ -543,6 +552,16 @@ inline bool Allocator::is_read_only(ref_type ref) const noexcept
     return ref < m_baseline.load(std::memory_order_relaxed);
 }
 
+// Only writes to the shared translation entry when a chunk is first accessed
+// after its bit was cleared, which does not happen unless the size of the
+// mappings is limited
+inline void Allocator::note_access(RefTranslation& txl, size_t offset) noexcept
+{
+    uint64_t bit = uint64_t(1) << (offset >> access_chunk_shift);
+    if (REALM_UNLIKELY((txl.accessed_chunks.load(std::memory_order_relaxed) & bit) == 0))
+        txl.accessed_chunks.fetch_or(bit, std::memory_order_relaxed);
+}
+
 // performance critical part of the translation process. Less critical code is in translate_less_critical.
 inline char* Allocator::translate_critical(RefTranslation* ref_translation_ptr, ref_type ref) const noexcept
 {
@@ -554,6 +573,7 @@ inline char* Allocator::translate_critical(RefTranslation* ref_translation_ptr,
         if (REALM_LIKELY(offset < lowest_possible_xover_offset)) {
             // the lowest possible xover offset may grow concurrently, but that will not affect this code path
             char* addr = txl.mapping_addr + offset;
+            note_access(txl, offset);
             util::encryption_read_barrier(addr, NodeHeader::header_size, txl.encrypted_mapping);
             size_t size = NodeHeader::get_byte_size_from_header(addr);
             util::encryption_read_barrier(addr, size, txl.encrypted_mapping);
@@ -35,6 +35,7 @@
 
 #include <realm/util/encrypted_file_mapping.hpp>
 #include <realm/util/errno.hpp>
+#include <realm/util/file_mapper.hpp>
 #include <realm/util/scope_exit.hpp>
 #include <realm/util/terminate.hpp>
 #include <realm/array.hpp>
@@ -82,6 +83,11 @@ util::File& SlabAlloc::get_file()
     return m_file;
 }
 
+const util::File& SlabAlloc::get_file() const
+{
+    return m_file;
+}
+
 
 inline constexpr SlabAlloc::Header SlabAlloc::empty_file_header = {
     {0, 0}, // top-refs
@@ -1188,6 +1194,7 @@ void SlabAlloc::update_reader_view(size_t file_size)
     size_t old_baseline = m_baseline.load(std::memory_order_relaxed);
     if (file_size <= old_baseline) {
         schedule_refresh_of_outdated_encrypted_pages();
+        trim_mappings();
         return;
     }
 
@@ -1304,6 +1311,122 @@ void SlabAlloc::update_reader_view(size_t file_size)
     rebuild_translations(replace_last_mapping, old_num_mappings);
 
     schedule_refresh_of_outdated_encrypted_pages();
+
+    if (is_mapping_limited()) {
+        // Faults only read in the page accessed, so that the memory used is
+        // that of the chunks accessed
+        for (size_t i = old_num_mappings > 0 ? old_num_mappings - 1 : 0; i < m_mappings.size(); ++i) {
+            auto& mapping = m_mappings[i].primary_mapping;
+            util::madvise(mapping.get_addr(), mapping.get_size(), util::MemoryAdvice::Random);
+        }
+        trim_mappings();
+    }
+}
+
+bool SlabAlloc::is_mapping_limited() const noexcept
+{
+    return m_mapping_limit != 0 && !is_in_memory() && !m_file.get_encryption();
+}
+
+void SlabAlloc::trim_mappings() noexcept
+{
+    if (!is_mapping_limited())
+        return;
+    RefTranslation* translations = m_ref_translation_ptr.load(std::memory_order_relaxed);
+    constexpr size_t chunk_size = size_t(1) << access_chunk_shift;
+    constexpr size_t chunks_per_section = size_t(1) << (section_shift - access_chunk_shift);
+    auto chunk_count = [&](size_t i) {
+        return (m_mappings[i].primary_mapping.get_size() + chunk_size - 1) / chunk_size;
+    };
+
+    // Chunks which were accessed since the last call are resident again. A
+    // released chunk which is accessed again is read in as a whole instead of
+    // page by page.
+    size_t resident = 0;
+    for (size_t i = 0; i < m_mappings.size(); ++i) {
+        MapEntry& entry = m_mappings[i];
+        uint64_t accessed = translations[i].accessed_chunks.load(std::memory_order_relaxed);
+        if (chunk_count(i) < chunks_per_section)
+            accessed &= (uint64_t(1) << chunk_count(i)) - 1;
+        if (uint64_t rewarmed = accessed & entry.released_chunks) {
+            char* addr = entry.primary_mapping.get_addr();
+            for (size_t c = 0; c < chunks_per_section; ++c) {
+                if (rewarmed & (uint64_t(1) << c)) {
+                    size_t offset = c * chunk_size;
+                    util::madvise(addr + offset, std::min(chunk_size, entry.primary_mapping.get_size() - offset),
+                                  util::MemoryAdvice::WillNeed);
+                }
+            }
+            entry.released_chunks &= ~rewarmed;
+        }
+        entry.resident_chunks |= accessed;
+        resident += size_t(fast_popcount64(int64_t(entry.resident_chunks)));
+    }
+
+    const size_t limit = std::max<size_t>(m_mapping_limit / chunk_size, 1);
+    if (resident <= limit)
+        return;
+    // Release chunks down to 7/8 of the limit, so that this isn't needed on
+    // every call once the limit is reached. A chunk accessed since the hand
+    // last passed it gets a second chance.
+    const size_t target = limit - limit / 8;
+    const size_t total = m_mappings.size() * chunks_per_section;
+    for (size_t visited = 0; resident > target && visited < 2 * total; ++visited, ++m_trim_clock) {
+        if (m_trim_clock >= total)
+            m_trim_clock = 0;
+        size_t i = m_trim_clock / chunks_per_section;
+        size_t c = m_trim_clock % chunks_per_section;
+        MapEntry& entry = m_mappings[i];
+        uint64_t bit = uint64_t(1) << c;
+        if ((entry.resident_chunks & bit) == 0)
+            continue;
+        if (translations[i].accessed_chunks.load(std::memory_order_relaxed) & bit) {
+            translations[i].accessed_chunks.fetch_and(~bit, std::memory_order_relaxed);
+            continue;
+        }
+        size_t offset = c * chunk_size;
+        util::madvise(entry.primary_mapping.get_addr() + offset,
+                      std::min(chunk_size, entry.primary_mapping.get_size() - offset), util::MemoryAdvice::DontNeed);
+        entry.resident_chunks &= ~bit;
+        entry.released_chunks |= bit;
+        --resident;
+        ++m_released_chunks;
+    }
+}
+
+void SlabAlloc::set_mapping_limit(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mapping_mutex);
+    m_mapping_limit = bytes;
+    if (!is_mapping_limited())
+        return;
+    for (auto& entry : m_mappings)
+        util::madvise(entry.primary_mapping.get_addr(), entry.primary_mapping.get_size(),
+                      util::MemoryAdvice::Random);
+    trim_mappings();
+}
+
+SlabAlloc::MappingStats SlabAlloc::get_mapping_stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mapping_mutex);
+    MappingStats stats;
+    bool limited = is_mapping_limited();
+    for (auto& entry : m_mappings) {
+        stats.mapped += entry.primary_mapping.get_size() + entry.xover_mapping.get_size();
+        if (!limited)
+            continue;
+        for (size_t offset = 0; offset < entry.primary_mapping.get_size(); offset += size_t(1) << access_chunk_shift) {
+            if (entry.resident_chunks & (uint64_t(1) << (offset >> access_chunk_shift)))
+                stats.resident += std::min(size_t(1) << access_chunk_shift, entry.primary_mapping.get_size() - offset);
+        }
+    }
+    if (!limited)
+        stats.resident = stats.mapped;
+    for (auto& old : m_old_mappings)
+        stats.mapped += old.mapping.get_size();
+    stats.limit = m_mapping_limit;
+    stats.released_chunks = m_released_chunks;
+    return stats;
 }
 
 
@@ -1316,6 +1439,27 @@ void SlabAlloc::schedule_refresh_of_outdated_encrypted_pages()
 #endif // REALM_ENABLE_ENCRYPTION
 }
 
+uint64_t SlabAlloc::note_reader_start()
+{
+#if REALM_ENABLE_ENCRYPTION
+    if (auto encryption = m_file.get_encryption()) {
+        return encryption->note_reader_start();
+    }
+#endif // REALM_ENABLE_ENCRYPTION
+    return 0;
+}
+
+void SlabAlloc::note_reader_end(uint64_t token) noexcept
+{
+#if REALM_ENABLE_ENCRYPTION
+    if (auto encryption = m_file.get_encryption()) {
+        encryption->note_reader_end(token);
+    }
+#else
+    static_cast<void>(token);
+#endif // REALM_ENABLE_ENCRYPTION
+}
+
 size_t SlabAlloc::get_allocated_size() const noexcept
 {
     size_t sz = 0;
@@ -169,6 +169,13 @@ public:
     /// Get the attached file. Only valid when called on an allocator with
     /// an attached file.
     util::File& get_file();
+    const util::File& get_file() const;
+
+    /// Track a reader of an encrypted file, so that the decrypted pages it may
+    /// still access are kept in memory until it ends. The returned token is
+    /// passed to note_reader_end(). Does nothing if the file isn't encrypted.
+    uint64_t note_reader_start();
+    void note_reader_end(uint64_t token) noexcept;
 
     /// Attach this allocator to the specified memory buffer.
     ///
@@ -326,6 +333,28 @@ public:
     void purge_old_mappings(uint64_t oldest_live_version, uint64_t youngest_live_version);
     void init_mapping_management(uint64_t currently_live_version);
 
+    /// Limit the memory used by the mappings of the file, in bytes. Zero means
+    /// no limit. When the chunks of the mappings which may be in memory exceed
+    /// the limit, the chunks which were least recently translated into are
+    /// released from the mappings, to be read back from the file when
+    /// accessed again. The address space stays reserved. Has no effect for
+    /// encrypted files, whose decrypted pages have their own limit, and on
+    /// Windows.
+    void set_mapping_limit(size_t bytes);
+
+    struct MappingStats {
+        // Size of all mappings of the file, including those kept for older
+        // versions
+        size_t mapped = 0;
+        // Size of the chunks of the current mappings which may be in memory.
+        // Without a limit, the size of the current mappings.
+        size_t resident = 0;
+        size_t limit = 0;
+        // Number of chunks released to stay within the limit
+        uint64_t released_chunks = 0;
+    };
+    MappingStats get_mapping_stats() const;
+
     /// Get an ID for the current mapping version. This ID changes whenever any part
     /// of an existing mapping is changed. Such a change requires all refs to be
     /// retranslated to new pointers. This will happen whenever the reader view
@@ -638,12 +667,20 @@ private:
         util::File::Map<char> primary_mapping;
         size_t lowest_possible_xover_offset = 0;
         util::File::Map<char> xover_mapping;
+        // The chunks which were translated into since they were last released,
+        // and those which were released and not accessed since
+        uint64_t resident_chunks = 0;
+        uint64_t released_chunks = 0;
     };
     std::vector<MapEntry> m_mappings;
     size_t m_translation_table_size = 0;
     std::atomic<uint64_t> m_mapping_version = 1;
     uint64_t m_youngest_live_version = 1;
-    std::mutex m_mapping_mutex;
+    mutable std::mutex m_mapping_mutex;
+    size_t m_mapping_limit = 0;
+    // Position of the clock hand in trim_mappings(), in chunks
+    size_t m_trim_clock = 0;
+    uint64_t m_released_chunks = 0;
     util::File m_file;
     // vectors where old mappings, are held from deletion to ensure translations are
     // kept open and ref->ptr translations work for other threads..
@@ -654,6 +691,10 @@ private:
     // true if there are changes to entries among the existing translations. Must be called
     // with m_mapping_mutex locked.
     void rebuild_translations(bool requires_new_fast_mapping, size_t old_num_sections);
+    // Release the least recently accessed chunks of the mappings while they
+    // exceed m_mapping_limit. Must be called with m_mapping_mutex locked.
+    void trim_mappings() noexcept;
+    bool is_mapping_limited() const noexcept;
     // Add a translation covering a new section in the slab area. The translation is always
     // added at the end.
     void extend_fast_mapping_with_slab(char* address);
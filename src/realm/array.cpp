@@ -17,6 +17,8 @@
  **************************************************************************/
 
 #include <realm/array_with_find.hpp>
+#include <realm/array_avx.hpp>
+#include <realm/integer_compressor.hpp>
 #include <realm/utilities.hpp>
 #include <realm/impl/destroy_guard.hpp>
 #include <realm/column_integer.hpp>
@@ -71,6 +73,7 @@
 //        0    |  number of bits      |  ceil(width * size / 8)
 //        1    |  number of bytes     |  width * size
 //        2    |  ignored             |  size
+//        3    |  width when expanded |  see NodeHeader::calc_compressed_byte_size()
 //
 //  5: 'width_ndx' (3 bits)
 //
@@ -277,11 +280,16 @@ void Array::destroy_children(size_t offset) noexcept
 }
 
 
-ref_type Array::do_write_shallow(_impl::ArrayWriterBase& out) const
+ref_type Array::do_write_shallow(_impl::ArrayWriterBase& out, bool compress) const
 {
     // Write flat array
     const char* header = get_header_from_data(m_data);
     size_t byte_size = get_byte_size();
+    std::vector<uint64_t> compressed;
+    if (compress && !m_has_refs && !m_is_compressed && IntegerCompressor::compress(*this, compressed)) {
+        header = reinterpret_cast<const char*>(compressed.data());
+        byte_size = compressed.size() * sizeof(uint64_t);
+    }
     uint32_t dummy_checksum = 0x41414141UL;                                // "AAAA" in ASCII
     ref_type new_ref = out.write_array(header, byte_size, dummy_checksum); // Throws
     REALM_ASSERT_3(new_ref % 8, ==, 0);                                    // 8-byte alignment
@@ -291,6 +299,16 @@ ref_type Array::do_write_shallow(_impl::ArrayWriterBase& out) const
 
 ref_type Array::do_write_deep(_impl::ArrayWriterBase& out, bool only_if_modified) const
 {
+    return write_deep(out, [&](size_t, ref_type subref) {
+        return write(subref, m_alloc, out, only_if_modified); // Throws
+    });
+}
+
+
+ref_type Array::write_deep(_impl::ArrayWriterBase& out, ChildWriter write_child) const
+{
+    REALM_ASSERT(m_has_refs);
+
     // Temp array for updated refs
     Array new_array(Allocator::get_default());
     Type type = m_is_inner_bptree_node ? type_InnerBptreeNode : type_HasRefs;
@@ -304,7 +322,7 @@ ref_type Array::do_write_deep(_impl::ArrayWriterBase& out, bool only_if_modified
         bool is_ref = (value != 0 && (value & 1) == 0);
         if (is_ref) {
             ref_type subref = to_ref(value);
-            ref_type new_subref = write(subref, m_alloc, out, only_if_modified); // Throws
+            ref_type new_subref = write_child(i, subref); // Throws
             value = from_ref(new_subref);
         }
         new_array.add(value); // Throws
@@ -552,6 +570,14 @@ void Array::do_ensure_minimum_width(int_fast64_t value)
 
 int64_t Array::sum(size_t start, size_t end) const
 {
+    if (REALM_UNLIKELY(m_is_compressed)) {
+        if (end == size_t(-1))
+            end = m_size;
+        int64_t s = 0;
+        for (; start < end; ++start)
+            s += get_compressed(start);
+        return s;
+    }
     REALM_TEMPEX(return sum, m_width, (start, end));
 }
 
@@ -565,6 +591,13 @@ int64_t Array::sum(size_t start, size_t end) const
     if (w == 0 || start == end)
         return 0;
 
+#ifdef REALM_COMPILER_AVX
+    if constexpr (w >= 8) {
+        if (sseavx<2>() && end - start >= 256 / w)
+            return avx::sum<w>(m_data, start, end);
+    }
+#endif
+
     int64_t s = 0;
 
     // Sum manually until 128 bit aligned
@@ -718,8 +751,70 @@ int64_t Array::sum(size_t start, size_t end) const
     return s;
 }
 
+template <bool max>
+bool Array::minmax(int64_t& result, size_t start, size_t end, size_t* return_ndx) const
+{
+    if (end == size_t(-1))
+        end = m_size;
+    REALM_ASSERT_EX(end <= m_size && start <= end, start, end, m_size);
+
+    if (start == end)
+        return false;
+
+    if (REALM_UNLIKELY(m_is_compressed)) {
+        size_t best_ndx = start;
+        result = get_compressed(start);
+        for (size_t i = start + 1; i < end; ++i) {
+            int64_t v = get_compressed(i);
+            if (max ? v > result : v < result) {
+                result = v;
+                best_ndx = i;
+            }
+        }
+        if (return_ndx)
+            *return_ndx = best_ndx;
+        return true;
+    }
+
+    REALM_TEMPEX2(result = minmax, max, m_width, (start, end));
+    if (return_ndx)
+        *return_ndx = find_first(result, start, end);
+    return true;
+}
+
+template bool Array::minmax<false>(int64_t&, size_t, size_t, size_t*) const;
+template bool Array::minmax<true>(int64_t&, size_t, size_t, size_t*) const;
+
+template <bool max, size_t w>
+int64_t Array::minmax(size_t start, size_t end) const
+{
+    if (w == 0)
+        return 0;
+
+#ifdef REALM_COMPILER_AVX
+    if constexpr (w >= 8) {
+        if (sseavx<2>() && end - start >= 256 / w)
+            return avx::minmax<max, w>(m_data, start, end);
+    }
+#endif
+
+    int64_t result = get<w>(start);
+    for (++start; start < end; ++start) {
+        int64_t v = get<w>(start);
+        if (max ? v > result : v < result)
+            result = v;
+    }
+    return result;
+}
+
 size_t Array::count(int64_t value) const noexcept
 {
+    if (REALM_UNLIKELY(m_is_compressed)) {
+        QueryStateCount state;
+        IntegerCompressor::find<Equal>(get_header(), value, 0, m_size, 0, &state);
+        return state.match_count();
+    }
+
     const uint64_t* next = reinterpret_cast<uint64_t*>(m_data);
     size_t value_count = 0;
     const size_t end = m_size;
@@ -924,6 +1019,20 @@ size_t Array::calc_aligned_byte_size(size_t size, int width)
 MemRef Array::clone(MemRef mem, Allocator& alloc, Allocator& target_alloc)
 {
     const char* header = mem.get_addr();
+    if (get_wtype_from_header(header) == wtype_Extend) {
+        // Compressed arrays are expanded, as the clone is expected to be
+        // writable
+        size_t size = get_size_from_header(header);
+        uint_least8_t width = get_width_from_header(header);
+        size_t byte_size = calc_byte_size(wtype_Bits, size, width);
+        MemRef clone_mem = target_alloc.alloc(byte_size); // Throws
+        char* clone_header = clone_mem.get_addr();
+        init_header(clone_header, false, false, get_context_flag_from_header(header), wtype_Bits, width, size,
+                    byte_size);
+        IntegerCompressor::decompress(header, clone_header);
+        return clone_mem;
+    }
+
     if (!get_hasrefs_from_header(header)) {
         // This array has no subarrays, so we can make a byte-for-byte
         // copy, which is more efficient.
@@ -1056,15 +1165,61 @@ struct Array::VTableForWidth {
 template <size_t width>
 const typename Array::VTableForWidth<width>::PopulatedVTable Array::VTableForWidth<width>::vtable;
 
+struct Array::VTableForCompressed {
+    struct PopulatedVTable : Array::VTable {
+        PopulatedVTable()
+        {
+            getter = &Array::get_compressed;
+            setter = &Array::set_compressed;
+            chunk_getter = &Array::get_chunk_compressed;
+            finder[cond_Equal] = &Array::find_compressed<Equal>;
+            finder[cond_NotEqual] = &Array::find_compressed<NotEqual>;
+            finder[cond_Greater] = &Array::find_compressed<Greater>;
+            finder[cond_Less] = &Array::find_compressed<Less>;
+        }
+    };
+    static const PopulatedVTable vtable;
+};
+
+const Array::VTableForCompressed::PopulatedVTable Array::VTableForCompressed::vtable;
+
+int64_t Array::get_compressed(size_t ndx) const noexcept
+{
+    return IntegerCompressor::get(get_header(), ndx);
+}
+
+void Array::get_chunk_compressed(size_t ndx, int64_t res[8]) const noexcept
+{
+    for (size_t i = 0; i < 8; ++i)
+        res[i] = ndx + i < m_size ? get_compressed(ndx + i) : 0;
+}
+
+void Array::set_compressed(size_t, int64_t)
+{
+    // Compressed arrays are expanded by copy_on_write() before any modification
+    REALM_UNREACHABLE();
+}
+
+template <class cond>
+bool Array::find_compressed(int64_t value, size_t start, size_t end, size_t baseindex, QueryStateBase* state) const
+{
+    return IntegerCompressor::find<cond>(get_header(), value, start, end, baseindex, state);
+}
+
 void Array::update_width_cache_from_header() noexcept
 {
-    auto width = get_width_from_header(get_header());
+    const char* header = get_header();
+    auto width = get_width_from_header(header);
     m_lbound = lbound_for_width(width);
     m_ubound = ubound_for_width(width);
 
     m_width = width;
+    m_is_compressed = get_wtype_from_header(header) == wtype_Extend;
 
-    REALM_TEMPEX(m_vtable = &VTableForWidth, width, ::vtable);
+    if (m_is_compressed)
+        m_vtable = &VTableForCompressed::vtable;
+    else
+        REALM_TEMPEX(m_vtable = &VTableForWidth, width, ::vtable);
     m_getter = m_vtable->getter;
 }
 
@@ -1263,11 +1418,41 @@ void Array::verify() const
 
 size_t Array::lower_bound_int(int64_t value) const noexcept
 {
+    if (REALM_UNLIKELY(m_is_compressed)) {
+        size_t first = 0;
+        size_t count = m_size;
+        while (count > 0) {
+            size_t step = count / 2;
+            if (get_compressed(first + step) < value) {
+                first += step + 1;
+                count -= step + 1;
+            }
+            else {
+                count = step;
+            }
+        }
+        return first;
+    }
     REALM_TEMPEX(return lower_bound, m_width, (m_data, m_size, value));
 }
 
 size_t Array::upper_bound_int(int64_t value) const noexcept
 {
+    if (REALM_UNLIKELY(m_is_compressed)) {
+        size_t first = 0;
+        size_t count = m_size;
+        while (count > 0) {
+            size_t step = count / 2;
+            if (!(value < get_compressed(first + step))) {
+                first += step + 1;
+                count -= step + 1;
+            }
+            else {
+                count = step;
+            }
+        }
+        return first;
+    }
     REALM_TEMPEX(return upper_bound, m_width, (m_data, m_size, value));
 }
 
@@ -1280,6 +1465,8 @@ size_t Array::find_first(int64_t value, size_t start, size_t end) const
 
 int_fast64_t Array::get(const char* header, size_t ndx) noexcept
 {
+    if (REALM_UNLIKELY(get_wtype_from_header(header) == wtype_Extend))
+        return IntegerCompressor::get(header, ndx);
     const char* data = get_data_from_header(header);
     uint_least8_t width = get_width_from_header(header);
     return get_direct(data, width, ndx);
@@ -1288,6 +1475,8 @@ int_fast64_t Array::get(const char* header, size_t ndx) noexcept
 
 std::pair<int64_t, int64_t> Array::get_two(const char* header, size_t ndx) noexcept
 {
+    if (REALM_UNLIKELY(get_wtype_from_header(header) == wtype_Extend))
+        return std::make_pair(IntegerCompressor::get(header, ndx), IntegerCompressor::get(header, ndx + 1));
     const char* data = get_data_from_header(header);
     uint_least8_t width = get_width_from_header(header);
     std::pair<int64_t, int64_t> p = ::get_two(data, width, ndx);
@@ -1306,6 +1495,12 @@ bool QueryStateCount::match(size_t) noexcept
     return (m_limit > m_match_count);
 }
 
+bool QueryStateCount::match_range(size_t begin, size_t end) noexcept
+{
+    m_match_count += std::min(end - begin, m_limit - m_match_count);
+    return (m_limit > m_match_count);
+}
+
 bool QueryStateFindFirst::match(size_t index, Mixed) noexcept
 {
     m_match_count++;
@@ -23,6 +23,7 @@
 #include <realm/query_state.hpp>
 #include <realm/column_fwd.hpp>
 #include <realm/array_direct.hpp>
+#include <realm/util/function_ref.hpp>
 
 namespace realm {
 
@@ -329,9 +330,30 @@ public:
         return sum(start, end);
     }
 
+    /// Find the smallest (or largest) element in the range [start, end).
+    /// Returns false if the range is empty. Otherwise \a result is set to
+    /// the value, and, if \a return_ndx is not null, \a *return_ndx is set to
+    /// the index of the first element having it.
+    bool get_min(int64_t& result, size_t start = 0, size_t end = size_t(-1), size_t* return_ndx = nullptr) const
+    {
+        return minmax<false>(result, start, end, return_ndx);
+    }
+    bool get_max(int64_t& result, size_t start = 0, size_t end = size_t(-1), size_t* return_ndx = nullptr) const
+    {
+        return minmax<true>(result, start, end, return_ndx);
+    }
+
     /// This information is guaranteed to be cached in the array accessor.
     bool is_inner_bptree_node() const noexcept;
 
+    /// True if this array uses one of the compressed integer encodings (see
+    /// IntegerCompressor). Such arrays are read-only, and are expanded when
+    /// modified.
+    bool is_compressed() const noexcept
+    {
+        return m_is_compressed;
+    }
+
     /// Returns true if type is either type_HasRefs or type_InnerColumnNode.
     ///
     /// This information is guaranteed to be cached in the array accessor.
@@ -379,11 +401,24 @@ public:
     ///
     /// \param only_if_modified Set to `false` to always write, or to `true` to
     /// only write the array if it has been modified.
-    ref_type write(_impl::ArrayWriterBase& out, bool deep, bool only_if_modified) const;
+    ///
+    /// \param compress Set to `true` to allow a leaf to be written in a
+    /// compressed encoding (see IntegerCompressor). Only meaningful for leaves
+    /// holding plain integers, and never applied to subarrays.
+    ref_type write(_impl::ArrayWriterBase& out, bool deep, bool only_if_modified, bool compress = false) const;
 
     /// Same as non-static write() with `deep` set to true. This is for the
     /// cases where you do not already have an array accessor available.
-    static ref_type write(ref_type, Allocator&, _impl::ArrayWriterBase&, bool only_if_modified);
+    static ref_type write(ref_type, Allocator&, _impl::ArrayWriterBase&, bool only_if_modified,
+                          bool compress = false);
+
+    using ChildWriter = util::FunctionRef<ref_type(size_t ndx, ref_type child_ref)>;
+
+    /// Write this array after writing each of its subarrays with \a
+    /// write_child, which returns the ref of the written copy. This is for
+    /// owners that know the type of their subarrays and want to write them in
+    /// a type specific way. The array itself is always written.
+    ref_type write_deep(_impl::ArrayWriterBase& out, ChildWriter write_child) const;
 
     size_t find_first(int64_t value, size_t begin = 0, size_t end = size_t(-1)) const;
 
@@ -475,6 +510,21 @@ protected:
     // This will have to be eventually used, exposing this here for testing.
     size_t count(int64_t value) const noexcept;
 
+    // Compressed arrays are expanded by the copy, so the cached width
+    // information must be refreshed afterwards.
+    void copy_on_write()
+    {
+        Node::copy_on_write();
+        if (REALM_UNLIKELY(m_is_compressed))
+            update_width_cache_from_header();
+    }
+    void copy_on_write(size_t min_size)
+    {
+        Node::copy_on_write(min_size);
+        if (REALM_UNLIKELY(m_is_compressed))
+            update_width_cache_from_header();
+    }
+
 private:
     void update_width_cache_from_header() noexcept;
 
@@ -485,6 +535,12 @@ private:
     template <size_t w>
     int64_t sum(size_t start, size_t end) const;
 
+    template <bool max>
+    bool minmax(int64_t& result, size_t start, size_t end, size_t* return_ndx) const;
+
+    template <bool max, size_t w>
+    int64_t minmax(size_t start, size_t end) const;
+
 protected:
     /// It is an error to specify a non-zero value unless the width
     /// type is wtype_Bits. It is also an error to specify a non-zero
@@ -514,6 +570,7 @@ protected:
     };
     template <size_t w>
     struct VTableForWidth;
+    struct VTableForCompressed;
 
     // This is the one installed into the m_vtable->finder slots.
     template <class cond, size_t bitwidth>
@@ -522,6 +579,13 @@ protected:
     template <size_t w>
     int64_t get_universal(const char* const data, const size_t ndx) const;
 
+    // Installed into the vtable of compressed arrays
+    int64_t get_compressed(size_t ndx) const noexcept;
+    void get_chunk_compressed(size_t ndx, int64_t res[8]) const noexcept;
+    void set_compressed(size_t ndx, int64_t value);
+    template <class cond>
+    bool find_compressed(int64_t value, size_t start, size_t end, size_t baseindex, QueryStateBase* state) const;
+
 protected:
     /// Takes a 64-bit value and returns the minimum number of bits needed
     /// to fit the value. For alignment this is rounded up to nearest
@@ -539,9 +603,10 @@ protected:
     bool m_is_inner_bptree_node; // This array is an inner node of B+-tree.
     bool m_has_refs;             // Elements whose first bit is zero are refs to subarrays.
     bool m_context_flag;         // Meaning depends on context.
+    bool m_is_compressed = false; // Width type is wtype_Extend
 
 private:
-    ref_type do_write_shallow(_impl::ArrayWriterBase&) const;
+    ref_type do_write_shallow(_impl::ArrayWriterBase&, bool compress = false) const;
     ref_type do_write_deep(_impl::ArrayWriterBase&, bool only_if_modified) const;
 
     void _mem_usage(size_t& mem) const noexcept;
@@ -554,6 +619,7 @@ private:
     friend class SlabAlloc;
     friend class GroupWriter;
     friend class ArrayWithFind;
+    friend class NodeTree;
 };
 
 // Implementation:
@@ -833,7 +899,7 @@ inline void Array::destroy_deep() noexcept
     m_data = nullptr;
 }
 
-inline ref_type Array::write(_impl::ArrayWriterBase& out, bool deep, bool only_if_modified) const
+inline ref_type Array::write(_impl::ArrayWriterBase& out, bool deep, bool only_if_modified, bool compress) const
 {
     REALM_ASSERT(is_attached());
 
@@ -841,12 +907,13 @@ inline ref_type Array::write(_impl::ArrayWriterBase& out, bool deep, bool only_i
         return m_ref;
 
     if (!deep || !m_has_refs)
-        return do_write_shallow(out); // Throws
+        return do_write_shallow(out, compress); // Throws
 
     return do_write_deep(out, only_if_modified); // Throws
 }
 
-inline ref_type Array::write(ref_type ref, Allocator& alloc, _impl::ArrayWriterBase& out, bool only_if_modified)
+inline ref_type Array::write(ref_type ref, Allocator& alloc, _impl::ArrayWriterBase& out, bool only_if_modified,
+                             bool compress)
 {
     if (only_if_modified && alloc.is_read_only(ref))
         return ref;
@@ -855,7 +922,7 @@ inline ref_type Array::write(ref_type ref, Allocator& alloc, _impl::ArrayWriterB
     array.init_from_ref(ref);
 
     if (!array.m_has_refs)
-        return array.do_write_shallow(out); // Throws
+        return array.do_write_shallow(out, compress); // Throws
 
     return array.do_write_deep(out, only_if_modified); // Throws
 }
@@ -942,6 +1009,8 @@ inline void Array::adjust(size_t begin, size_t end, int_fast64_t diff)
 inline size_t Array::get_byte_size() const noexcept
 {
     const char* header = get_header_from_data(m_data);
+    if (REALM_UNLIKELY(m_is_compressed))
+        return get_byte_size_from_header(header);
     WidthType wtype = Node::get_wtype_from_header(header);
     size_t num_bytes = NodeHeader::calc_byte_size(wtype, m_size, m_width);
 
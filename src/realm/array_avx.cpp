@@ -0,0 +1,506 @@
+/*************************************************************************
+ *
+ * Copyright 2024 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/array_avx.hpp>
+
+#ifdef REALM_COMPILER_AVX
+
+#include <realm/query_conditions.hpp>
+#include <realm/query_state.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+#include <immintrin.h>
+
+// The kernels are compiled for their instruction set regardless of the flags
+// used for the rest of the library. MSVC allows the intrinsics without any
+// annotation.
+#if defined(__GNUC__) || defined(__clang__)
+#define REALM_TARGET_AVX2 __attribute__((target("avx2")))
+#define REALM_TARGET_AVX512 __attribute__((target("avx2,avx512f,avx512bw")))
+#else
+#define REALM_TARGET_AVX2
+#define REALM_TARGET_AVX512
+#endif
+
+// Some versions of GCC report the placeholder `_mm*_undefined_*()` values
+// used inside their own AVX-512 intrinsics as uninitialized.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+using namespace realm;
+
+namespace {
+
+template <size_t width>
+using element_t = std::conditional_t<
+    width == 8, int8_t, std::conditional_t<width == 16, int16_t, std::conditional_t<width == 32, int32_t, int64_t>>>;
+
+template <size_t width>
+inline const element_t<width>* elements(const char* data) noexcept
+{
+    return reinterpret_cast<const element_t<width>*>(data);
+}
+
+// Scalar versions used for the elements after the last full vector
+
+template <class cond, size_t width>
+bool find_tail(const char* data, int64_t value, size_t start, size_t end, size_t baseindex, QueryStateBase* state)
+{
+    cond c;
+    for (; start < end; ++start) {
+        if (c(int64_t(elements<width>(data)[start]), value) && !state->match(start + baseindex))
+            return false;
+    }
+    return true;
+}
+
+template <size_t width>
+int64_t sum_tail(const char* data, size_t start, size_t end) noexcept
+{
+    int64_t s = 0;
+    for (; start < end; ++start)
+        s += elements<width>(data)[start];
+    return s;
+}
+
+template <bool max, size_t width>
+int64_t minmax_tail(const char* data, size_t start, size_t end, int64_t result) noexcept
+{
+    for (; start < end; ++start) {
+        int64_t v = elements<width>(data)[start];
+        result = max ? std::max(result, v) : std::min(result, v);
+    }
+    return result;
+}
+
+// AVX2
+
+template <size_t width>
+REALM_TARGET_AVX2 inline __m256i load_avx2(const char* data, size_t ndx) noexcept
+{
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + ndx * (width / 8)));
+}
+
+template <size_t width>
+REALM_TARGET_AVX2 inline __m256i set1_avx2(int64_t value) noexcept
+{
+    if constexpr (width == 8)
+        return _mm256_set1_epi8(char(value));
+    else if constexpr (width == 16)
+        return _mm256_set1_epi16(short(value));
+    else if constexpr (width == 32)
+        return _mm256_set1_epi32(int(value));
+    else
+        return _mm256_set1_epi64x(value);
+}
+
+template <size_t width>
+REALM_TARGET_AVX2 inline __m256i cmpeq_avx2(__m256i a, __m256i b) noexcept
+{
+    if constexpr (width == 8)
+        return _mm256_cmpeq_epi8(a, b);
+    else if constexpr (width == 16)
+        return _mm256_cmpeq_epi16(a, b);
+    else if constexpr (width == 32)
+        return _mm256_cmpeq_epi32(a, b);
+    else
+        return _mm256_cmpeq_epi64(a, b);
+}
+
+template <size_t width>
+REALM_TARGET_AVX2 inline __m256i cmpgt_avx2(__m256i a, __m256i b) noexcept
+{
+    if constexpr (width == 8)
+        return _mm256_cmpgt_epi8(a, b);
+    else if constexpr (width == 16)
+        return _mm256_cmpgt_epi16(a, b);
+    else if constexpr (width == 32)
+        return _mm256_cmpgt_epi32(a, b);
+    else
+        return _mm256_cmpgt_epi64(a, b);
+}
+
+// AVX2 has no mask registers, so the result has one bit per byte, and all the
+// bits of an element are equal.
+template <class cond, size_t width>
+REALM_TARGET_AVX2 inline uint32_t match_mask_avx2(__m256i v, __m256i needle) noexcept
+{
+    if constexpr (std::is_same_v<cond, Equal>)
+        return uint32_t(_mm256_movemask_epi8(cmpeq_avx2<width>(v, needle)));
+    else if constexpr (std::is_same_v<cond, NotEqual>)
+        return ~uint32_t(_mm256_movemask_epi8(cmpeq_avx2<width>(v, needle)));
+    else if constexpr (std::is_same_v<cond, Greater>)
+        return uint32_t(_mm256_movemask_epi8(cmpgt_avx2<width>(v, needle)));
+    else
+        return uint32_t(_mm256_movemask_epi8(cmpgt_avx2<width>(needle, v)));
+}
+
+template <bool max, size_t width>
+REALM_TARGET_AVX2 inline __m256i minmax_avx2(__m256i a, __m256i b) noexcept
+{
+    if constexpr (width == 8) {
+        return max ? _mm256_max_epi8(a, b) : _mm256_min_epi8(a, b);
+    }
+    else if constexpr (width == 16) {
+        return max ? _mm256_max_epi16(a, b) : _mm256_min_epi16(a, b);
+    }
+    else if constexpr (width == 32) {
+        return max ? _mm256_max_epi32(a, b) : _mm256_min_epi32(a, b);
+    }
+    else {
+        // No 64 bit min/max before AVX-512
+        __m256i gt = _mm256_cmpgt_epi64(a, b);
+        return max ? _mm256_blendv_epi8(b, a, gt) : _mm256_blendv_epi8(a, b, gt);
+    }
+}
+
+template <class cond, size_t width>
+REALM_TARGET_AVX2 bool find_avx2(const char* data, int64_t value, size_t start, size_t end, size_t baseindex,
+                                 QueryStateBase* state)
+{
+    constexpr size_t bytes = width / 8;
+    constexpr size_t per_vector = sizeof(__m256i) / bytes;
+    constexpr uint32_t element_bits = uint32_t((uint64_t(1) << bytes) - 1);
+
+    const __m256i needle = set1_avx2<width>(value);
+    for (; end - start >= per_vector; start += per_vector) {
+        uint32_t mask = match_mask_avx2<cond, width>(load_avx2<width>(data, start), needle);
+        while (mask) {
+            size_t bit = ctz(mask);
+            if (!state->match(start + bit / bytes + baseindex))
+                return false;
+            mask &= ~(element_bits << bit);
+        }
+    }
+    return find_tail<cond, width>(data, value, start, end, baseindex, state);
+}
+
+template <size_t width>
+REALM_TARGET_AVX2 int64_t sum_avx2(const char* data, size_t start, size_t end)
+{
+    constexpr size_t per_vector = sizeof(__m256i) / (width / 8);
+    int64_t s = 0;
+    __m256i total = _mm256_setzero_si256(); // 4 x 64 bit
+
+    if constexpr (width == 8) {
+        // Bias the elements into the unsigned range, so that the sum of
+        // absolute differences against zero adds up groups of 8 bytes into 64
+        // bit lanes. The bias is subtracted again at the end.
+        const __m256i bias = _mm256_set1_epi8(char(0x80));
+        const __m256i zero = _mm256_setzero_si256();
+        size_t n = 0;
+        for (; end - start >= per_vector; start += per_vector, ++n) {
+            __m256i v = _mm256_xor_si256(load_avx2<width>(data, start), bias);
+            total = _mm256_add_epi64(total, _mm256_sad_epu8(v, zero));
+        }
+        s -= int64_t(n * per_vector * 0x80);
+    }
+    else if constexpr (width == 16) {
+        // Pairwise sums into 32 bit lanes, in blocks short enough that the lanes
+        // cannot overflow.
+        const __m256i ones = _mm256_set1_epi16(1);
+        while (end - start >= per_vector) {
+            size_t n = std::min((end - start) / per_vector, size_t(1) << 14);
+            __m256i acc = _mm256_setzero_si256(); // 8 x 32 bit
+            for (size_t i = 0; i < n; ++i, start += per_vector)
+                acc = _mm256_add_epi32(acc, _mm256_madd_epi16(load_avx2<width>(data, start), ones));
+            total = _mm256_add_epi64(total, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(acc)));
+            total = _mm256_add_epi64(total, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(acc, 1)));
+        }
+    }
+    else if constexpr (width == 32) {
+        for (; end - start >= per_vector; start += per_vector) {
+            __m256i v = load_avx2<width>(data, start);
+            total = _mm256_add_epi64(total, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+            total = _mm256_add_epi64(total, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+        }
+    }
+    else {
+        for (; end - start >= per_vector; start += per_vector)
+            total = _mm256_add_epi64(total, load_avx2<width>(data, start));
+    }
+
+    alignas(32) int64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), total);
+    s += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    return s + sum_tail<width>(data, start, end);
+}
+
+template <bool max, size_t width>
+REALM_TARGET_AVX2 int64_t minmax_avx2(const char* data, size_t start, size_t end)
+{
+    constexpr size_t per_vector = sizeof(__m256i) / (width / 8);
+    int64_t result = elements<width>(data)[start];
+    if (end - start >= per_vector) {
+        __m256i acc = load_avx2<width>(data, start);
+        for (start += per_vector; end - start >= per_vector; start += per_vector)
+            acc = minmax_avx2<max, width>(acc, load_avx2<width>(data, start));
+        alignas(32) element_t<width> lanes[per_vector];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+        result = minmax_tail<max, width>(reinterpret_cast<const char*>(lanes), 0, per_vector, result);
+    }
+    return minmax_tail<max, width>(data, start, end, result);
+}
+
+template <bool max, class T>
+REALM_TARGET_AVX2 size_t minmax_float_avx2(const T* data, size_t size)
+{
+    constexpr size_t per_vector = sizeof(__m256) / sizeof(T);
+    // NaN is replaced by the value that never wins, so that the search below
+    // finds nothing if every value is NaN
+    const T neutral = max ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::infinity();
+    T result = neutral;
+    size_t i = 0;
+    if (size >= per_vector) {
+        alignas(32) T lanes[per_vector];
+        if constexpr (std::is_same_v<T, float>) {
+            __m256 acc = _mm256_set1_ps(neutral);
+            for (; size - i >= per_vector; i += per_vector) {
+                __m256 v = _mm256_loadu_ps(data + i);
+                v = _mm256_blendv_ps(acc, v, _mm256_cmp_ps(v, v, _CMP_ORD_Q));
+                acc = max ? _mm256_max_ps(acc, v) : _mm256_min_ps(acc, v);
+            }
+            _mm256_store_ps(lanes, acc);
+        }
+        else {
+            __m256d acc = _mm256_set1_pd(neutral);
+            for (; size - i >= per_vector; i += per_vector) {
+                __m256d v = _mm256_loadu_pd(data + i);
+                v = _mm256_blendv_pd(acc, v, _mm256_cmp_pd(v, v, _CMP_ORD_Q));
+                acc = max ? _mm256_max_pd(acc, v) : _mm256_min_pd(acc, v);
+            }
+            _mm256_store_pd(lanes, acc);
+        }
+        for (T lane : lanes)
+            result = max ? std::max(result, lane) : std::min(result, lane);
+    }
+    for (; i < size; ++i) {
+        if (!std::isnan(data[i]))
+            result = max ? std::max(result, data[i]) : std::min(result, data[i]);
+    }
+
+    // Report the first element comparing equal to the result, like a
+    // sequential scan would. This also resolves the sign of zero.
+    for (i = 0; i < size; ++i) {
+        if (data[i] == result)
+            return i;
+    }
+    return size_t(-1);
+}
+
+// AVX-512 (F and BW)
+
+template <size_t width>
+REALM_TARGET_AVX512 inline __m512i load_avx512(const char* data, size_t ndx) noexcept
+{
+    return _mm512_loadu_si512(data + ndx * (width / 8));
+}
+
+template <size_t width>
+REALM_TARGET_AVX512 inline __m512i set1_avx512(int64_t value) noexcept
+{
+    if constexpr (width == 8)
+        return _mm512_set1_epi8(char(value));
+    else if constexpr (width == 16)
+        return _mm512_set1_epi16(short(value));
+    else if constexpr (width == 32)
+        return _mm512_set1_epi32(int(value));
+    else
+        return _mm512_set1_epi64(value);
+}
+
+// One bit per element
+template <class cond, size_t width>
+REALM_TARGET_AVX512 inline uint64_t match_mask_avx512(__m512i v, __m512i needle) noexcept
+{
+    constexpr int predicate = std::is_same_v<cond, Equal>      ? _MM_CMPINT_EQ
+                              : std::is_same_v<cond, NotEqual> ? _MM_CMPINT_NE
+                              : std::is_same_v<cond, Greater>  ? _MM_CMPINT_NLE
+                                                               : _MM_CMPINT_LT;
+    if constexpr (width == 8)
+        return _mm512_cmp_epi8_mask(v, needle, predicate);
+    else if constexpr (width == 16)
+        return _mm512_cmp_epi16_mask(v, needle, predicate);
+    else if constexpr (width == 32)
+        return _mm512_cmp_epi32_mask(v, needle, predicate);
+    else
+        return _mm512_cmp_epi64_mask(v, needle, predicate);
+}
+
+template <bool max, size_t width>
+REALM_TARGET_AVX512 inline __m512i minmax_avx512(__m512i a, __m512i b) noexcept
+{
+    if constexpr (width == 8)
+        return max ? _mm512_max_epi8(a, b) : _mm512_min_epi8(a, b);
+    else if constexpr (width == 16)
+        return max ? _mm512_max_epi16(a, b) : _mm512_min_epi16(a, b);
+    else if constexpr (width == 32)
+        return max ? _mm512_max_epi32(a, b) : _mm512_min_epi32(a, b);
+    else
+        return max ? _mm512_max_epi64(a, b) : _mm512_min_epi64(a, b);
+}
+
+template <class cond, size_t width>
+REALM_TARGET_AVX512 bool find_avx512(const char* data, int64_t value, size_t start, size_t end, size_t baseindex,
+                                     QueryStateBase* state)
+{
+    constexpr size_t per_vector = sizeof(__m512i) / (width / 8);
+
+    const __m512i needle = set1_avx512<width>(value);
+    for (; end - start >= per_vector; start += per_vector) {
+        uint64_t mask = match_mask_avx512<cond, width>(load_avx512<width>(data, start), needle);
+        while (mask) {
+            if (!state->match(start + ctz(mask) + baseindex))
+                return false;
+            mask &= mask - 1;
+        }
+    }
+    return find_tail<cond, width>(data, value, start, end, baseindex, state);
+}
+
+template <size_t width>
+REALM_TARGET_AVX512 int64_t sum_avx512(const char* data, size_t start, size_t end)
+{
+    constexpr size_t per_vector = sizeof(__m512i) / (width / 8);
+    int64_t s = 0;
+    __m512i total = _mm512_setzero_si512(); // 8 x 64 bit
+
+    if constexpr (width == 8) {
+        // See sum_avx2()
+        const __m512i bias = _mm512_set1_epi8(char(0x80));
+        const __m512i zero = _mm512_setzero_si512();
+        size_t n = 0;
+        for (; end - start >= per_vector; start += per_vector, ++n) {
+            __m512i v = _mm512_xor_si512(load_avx512<width>(data, start), bias);
+            total = _mm512_add_epi64(total, _mm512_sad_epu8(v, zero));
+        }
+        s -= int64_t(n * per_vector * 0x80);
+    }
+    else if constexpr (width == 16) {
+        const __m512i ones = _mm512_set1_epi16(1);
+        while (end - start >= per_vector) {
+            size_t n = std::min((end - start) / per_vector, size_t(1) << 14);
+            __m512i acc = _mm512_setzero_si512(); // 16 x 32 bit
+            for (size_t i = 0; i < n; ++i, start += per_vector)
+                acc = _mm512_add_epi32(acc, _mm512_madd_epi16(load_avx512<width>(data, start), ones));
+            total = _mm512_add_epi64(total, _mm512_cvtepi32_epi64(_mm512_castsi512_si256(acc)));
+            total = _mm512_add_epi64(total, _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(acc, 1)));
+        }
+    }
+    else if constexpr (width == 32) {
+        for (; end - start >= per_vector; start += per_vector) {
+            __m512i v = load_avx512<width>(data, start);
+            total = _mm512_add_epi64(total, _mm512_cvtepi32_epi64(_mm512_castsi512_si256(v)));
+            total = _mm512_add_epi64(total, _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(v, 1)));
+        }
+    }
+    else {
+        for (; end - start >= per_vector; start += per_vector)
+            total = _mm512_add_epi64(total, load_avx512<width>(data, start));
+    }
+
+    s += _mm512_reduce_add_epi64(total);
+    return s + sum_tail<width>(data, start, end);
+}
+
+template <bool max, size_t width>
+REALM_TARGET_AVX512 int64_t minmax_avx512(const char* data, size_t start, size_t end)
+{
+    constexpr size_t per_vector = sizeof(__m512i) / (width / 8);
+    int64_t result = elements<width>(data)[start];
+    if (end - start >= per_vector) {
+        __m512i acc = load_avx512<width>(data, start);
+        for (start += per_vector; end - start >= per_vector; start += per_vector)
+            acc = minmax_avx512<max, width>(acc, load_avx512<width>(data, start));
+        alignas(64) element_t<width> lanes[per_vector];
+        _mm512_store_si512(lanes, acc);
+        result = minmax_tail<max, width>(reinterpret_cast<const char*>(lanes), 0, per_vector, result);
+    }
+    return minmax_tail<max, width>(data, start, end, result);
+}
+
+} // anonymous namespace
+
+namespace realm::avx {
+
+template <class cond, size_t width>
+bool find(const char* data, int64_t value, size_t start, size_t end, size_t baseindex, QueryStateBase* state)
+{
+    static_assert(std::is_same_v<cond, Equal> || std::is_same_v<cond, NotEqual> || std::is_same_v<cond, Less> ||
+                  std::is_same_v<cond, Greater>);
+    REALM_ASSERT_DEBUG(sseavx<2>());
+    if (sseavx<512>())
+        return find_avx512<cond, width>(data, value, start, end, baseindex, state);
+    return find_avx2<cond, width>(data, value, start, end, baseindex, state);
+}
+
+template <size_t width>
+int64_t sum(const char* data, size_t start, size_t end)
+{
+    REALM_ASSERT_DEBUG(sseavx<2>());
+    if (sseavx<512>())
+        return sum_avx512<width>(data, start, end);
+    return sum_avx2<width>(data, start, end);
+}
+
+template <bool max, size_t width>
+int64_t minmax(const char* data, size_t start, size_t end)
+{
+    REALM_ASSERT_DEBUG(sseavx<2>());
+    REALM_ASSERT_DEBUG(start < end);
+    if (sseavx<512>())
+        return minmax_avx512<max, width>(data, start, end);
+    return minmax_avx2<max, width>(data, start, end);
+}
+
+template <bool max, class T>
+size_t minmax_float(const T* data, size_t size)
+{
+    static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>);
+    REALM_ASSERT_DEBUG(sseavx<2>());
+    return minmax_float_avx2<max, T>(data, size);
+}
+
+template size_t minmax_float<false, float>(const float*, size_t);
+template size_t minmax_float<true, float>(const float*, size_t);
+template size_t minmax_float<false, double>(const double*, size_t);
+template size_t minmax_float<true, double>(const double*, size_t);
+
+#define REALM_INSTANTIATE_AVX_KERNELS(width)                                                                         \
+    template bool find<Equal, width>(const char*, int64_t, size_t, size_t, size_t, QueryStateBase*);                \
+    template bool find<NotEqual, width>(const char*, int64_t, size_t, size_t, size_t, QueryStateBase*);             \
+    template bool find<Less, width>(const char*, int64_t, size_t, size_t, size_t, QueryStateBase*);                 \
+    template bool find<Greater, width>(const char*, int64_t, size_t, size_t, size_t, QueryStateBase*);              \
+    template int64_t sum<width>(const char*, size_t, size_t);                                                        \
+    template int64_t minmax<false, width>(const char*, size_t, size_t);                                              \
+    template int64_t minmax<true, width>(const char*, size_t, size_t);
+
+REALM_INSTANTIATE_AVX_KERNELS(8)
+REALM_INSTANTIATE_AVX_KERNELS(16)
+REALM_INSTANTIATE_AVX_KERNELS(32)
+REALM_INSTANTIATE_AVX_KERNELS(64)
+
+} // namespace realm::avx
+
+#endif // REALM_COMPILER_AVX
@@ -0,0 +1,70 @@
+/*************************************************************************
+ *
+ * Copyright 2024 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_ARRAY_AVX_HPP
+#define REALM_ARRAY_AVX_HPP
+
+#include <realm/utilities.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace realm {
+
+class QueryStateBase;
+
+/// AVX2 and AVX-512 kernels for integer leaves of width 8, 16, 32 and 64.
+///
+/// The kernels are compiled for their instruction set with function level
+/// target attributes, so the rest of the library is still built for the
+/// baseline architecture. Callers must check `sseavx<2>()` before calling any
+/// of these. Each kernel then uses the widest vectors supported by the CPU
+/// (AVX-512 if `sseavx<512>()`, otherwise AVX2), as detected once by
+/// cpuid_init().
+///
+/// \a data is the payload of the leaf (Array::m_data), and elements are
+/// addressed by index like in the rest of Array. No alignment is required.
+namespace avx {
+
+/// Same contract as ArrayWithFind::find_optimized(): calls
+/// QueryStateBase::match() for every element `v` in [start, end) for which
+/// `cond()(v, value)` holds, and returns false as soon as match() does. Only
+/// Equal, NotEqual, Less and Greater are supported.
+template <class cond, size_t width>
+bool find(const char* data, int64_t value, size_t start, size_t end, size_t baseindex, QueryStateBase* state);
+
+/// Sum of the elements in [start, end).
+template <size_t width>
+int64_t sum(const char* data, size_t start, size_t end);
+
+/// Largest (if \a max) or smallest element in [start, end), which must not
+/// be empty.
+template <bool max, size_t width>
+int64_t minmax(const char* data, size_t start, size_t end);
+
+/// Index of the first occurrence of the largest (if \a max) or smallest of
+/// the \a size values at \a data, ignoring NaN, which includes the null
+/// representation. Returns `size_t(-1)` if all the values are NaN. \a T must
+/// be float or double. These always use 256 bit vectors.
+template <bool max, class T>
+size_t minmax_float(const T* data, size_t size);
+
+} // namespace avx
+} // namespace realm
+
+#endif // REALM_ARRAY_AVX_HPP
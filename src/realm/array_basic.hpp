@@ -84,6 +84,13 @@ public:
 
     size_t find_first(T value, size_t begin = 0, size_t end = npos) const;
 
+    /// Find the smallest (or largest) value in [begin, end), ignoring null and
+    /// NaN. Returns false if there is none. Otherwise \a result is set to the
+    /// value, and, if \a return_ndx is not null, \a *return_ndx is set to the
+    /// index of the first element having it.
+    bool get_min(T& result, size_t begin, size_t end, size_t* return_ndx = nullptr) const;
+    bool get_max(T& result, size_t begin, size_t end, size_t* return_ndx = nullptr) const;
+
     /// Get the specified element without the cost of constructing an
     /// array instance. If an array instance is already available, or
     /// you need to get multiple values, then this method will be
@@ -118,6 +125,9 @@ private:
     /// of the header. The result will be upwards aligned to the
     /// closest 8-byte boundary.
     static size_t calc_aligned_byte_size(size_t size);
+
+    template <bool max>
+    bool minmax(T& result, size_t begin, size_t end, size_t* return_ndx) const;
 };
 
 template <class T>
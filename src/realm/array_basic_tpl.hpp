@@ -20,8 +20,10 @@
 #define REALM_ARRAY_BASIC_TPL_HPP
 
 #include <algorithm>
+#include <cmath>
 #include <limits>
 
+#include <realm/array_avx.hpp>
 #include <realm/array_basic.hpp>
 #include <realm/node.hpp>
 
@@ -200,6 +202,47 @@ inline size_t BasicArray<T>::find_first(T value, size_t begin, size_t end) const
     return i == data + end ? not_found : size_t(i - data);
 }
 
+template <class T>
+inline bool BasicArray<T>::get_min(T& result, size_t begin, size_t end, size_t* return_ndx) const
+{
+    return minmax<false>(result, begin, end, return_ndx);
+}
+
+template <class T>
+inline bool BasicArray<T>::get_max(T& result, size_t begin, size_t end, size_t* return_ndx) const
+{
+    return minmax<true>(result, begin, end, return_ndx);
+}
+
+template <class T>
+template <bool max>
+bool BasicArray<T>::minmax(T& result, size_t begin, size_t end, size_t* return_ndx) const
+{
+    REALM_ASSERT(begin <= m_size && end <= m_size && begin <= end);
+    const T* data = reinterpret_cast<const T*>(m_data);
+    size_t ndx = not_found;
+#ifdef REALM_COMPILER_AVX
+    if (sseavx<2>()) {
+        ndx = avx::minmax_float<max, T>(data + begin, end - begin);
+        if (ndx != not_found)
+            ndx += begin;
+    }
+    else
+#endif
+    {
+        for (size_t i = begin; i < end; ++i) {
+            if (!std::isnan(data[i]) && (ndx == not_found || (max ? data[i] > data[ndx] : data[i] < data[ndx])))
+                ndx = i;
+        }
+    }
+    if (ndx == not_found)
+        return false;
+    result = data[ndx];
+    if (return_ndx)
+        *return_ndx = ndx;
+    return true;
+}
+
 template <class T>
 size_t BasicArrayNull<T>::find_first_null(size_t begin, size_t end) const
 {
@@ -202,6 +202,58 @@ size_t ArrayIntNull::find_first_in_range(int64_t from, int64_t to, size_t start,
     return realm::not_found;
 }
 
+size_t ArrayIntNull::count_nulls(size_t begin, size_t end) const
+{
+    QueryStateCount state;
+    ArrayWithFind(*this).find<Equal>(null_value(), begin + 1, end + 1, 0, &state);
+    return state.match_count();
+}
+
+int64_t ArrayIntNull::get_sum(size_t begin, size_t end, size_t& count) const
+{
+    // Sum everything, and then take out the nulls
+    size_t nulls = count_nulls(begin, end);
+    count = end - begin - nulls;
+    uint64_t sum = uint64_t(Array::get_sum(begin + 1, end + 1));
+    return int64_t(sum - uint64_t(null_value()) * nulls);
+}
+
+bool ArrayIntNull::get_min(int64_t& result, size_t begin, size_t end, size_t* return_ndx) const
+{
+    return minmax_non_null<false>(result, begin, end, return_ndx);
+}
+
+bool ArrayIntNull::get_max(int64_t& result, size_t begin, size_t end, size_t* return_ndx) const
+{
+    return minmax_non_null<true>(result, begin, end, return_ndx);
+}
+
+template <bool max>
+bool ArrayIntNull::minmax_non_null(int64_t& result, size_t begin, size_t end, size_t* return_ndx) const
+{
+    if (count_nulls(begin, end) == 0) {
+        if (!(max ? Array::get_max(result, begin + 1, end + 1, return_ndx)
+                  : Array::get_min(result, begin + 1, end + 1, return_ndx)))
+            return false;
+        if (return_ndx)
+            *return_ndx -= 1;
+        return true;
+    }
+
+    int64_t null = null_value();
+    bool found = false;
+    for (size_t i = begin; i < end; ++i) {
+        int64_t v = Array::get(i + 1);
+        if (v != null && (!found || (max ? v > result : v < result))) {
+            result = v;
+            found = true;
+            if (return_ndx)
+                *return_ndx = i;
+        }
+    }
+    return found;
+}
+
 void ArrayIntNull::get_chunk(size_t ndx, value_type res[8]) const noexcept
 {
     // FIXME: Optimize this
@@ -142,6 +142,15 @@ public:
     size_t find_first(value_type value, size_t begin = 0, size_t end = npos) const;
     size_t find_first_in_range(int64_t from, int64_t to, size_t start, size_t end) const;
 
+    /// Sum of the non-null values in [begin, end). The number of such values
+    /// is returned in \a count.
+    int64_t get_sum(size_t begin, size_t end, size_t& count) const;
+
+    /// Find the smallest (or largest) non-null value in [begin, end). Returns
+    /// false if there is none. See Array::get_min().
+    bool get_min(int64_t& result, size_t begin, size_t end, size_t* return_ndx = nullptr) const;
+    bool get_max(int64_t& result, size_t begin, size_t end, size_t* return_ndx = nullptr) const;
+
 protected:
     void avoid_null_collision(int64_t value);
 
@@ -149,6 +158,9 @@ private:
     int_fast64_t choose_random_null(int64_t incoming) const;
     void replace_nulls_with(int64_t new_null);
     bool can_use_as_null(int64_t value) const;
+    size_t count_nulls(size_t begin, size_t end) const;
+    template <bool max>
+    bool minmax_non_null(int64_t& result, size_t begin, size_t end, size_t* return_ndx) const;
 
     bool find_impl(int cond, value_type value, size_t start, size_t end, QueryStateBase* state) const;
     template <class cond>
@@ -29,6 +29,10 @@ void ArrayWithFind::find_all(IntegerColumn* result, int64_t value, size_t col_of
         end = m_array.m_size;
 
     QueryStateFindAll state(*result);
+    if (m_array.m_is_compressed) {
+        IntegerCompressor::find<Equal>(m_array.get_header(), value, begin, end, col_offset, &state);
+        return;
+    }
     REALM_TEMPEX2(find_optimized, Equal, m_array.m_width, (value, begin, end, col_offset, &state));
 
     return;
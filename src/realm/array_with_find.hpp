@@ -32,6 +32,8 @@ Searching: The main finding function is:
 #define REALM_ARRAY_WITH_FIND_HPP
 
 #include <realm/array.hpp>
+#include <realm/array_avx.hpp>
+#include <realm/integer_compressor.hpp>
 #include <realm/query_conditions.hpp>
 
 /*
@@ -283,10 +285,7 @@ REALM_NOINLINE bool ArrayWithFind::find_all_will_match(size_t start2, size_t end
     REALM_ASSERT_DEBUG(state->match_count() < state->limit());
     size_t process = state->limit() - state->match_count();
     size_t end2 = end - start2 > process ? start2 + process : end;
-    for (; start2 < end2; start2++)
-        if (!state->match(start2 + baseindex))
-            return false;
-    return true;
+    return state->match_range(start2 + baseindex, end2 + baseindex);
 }
 
 // This is the main finding function for Array. Other finding functions are just
@@ -324,6 +323,16 @@ bool ArrayWithFind::find_optimized(int64_t value, size_t start, size_t end, size
     // finder cannot handle this bitwidth
     REALM_ASSERT_3(m_array.m_width, !=, 0);
 
+#if defined(REALM_COMPILER_AVX)
+    // The AVX kernels handle unaligned data and the remainder themselves, so
+    // just make sure there is at least one full 256 bit vector to search.
+    if constexpr (bitwidth >= 8 && (std::is_same_v<cond, Equal> || std::is_same_v<cond, NotEqual> ||
+                                    std::is_same_v<cond, Less> || std::is_same_v<cond, Greater>)) {
+        if (sseavx<2>() && end - start2 >= 256 / bitwidth)
+            return avx::find<cond, bitwidth>(m_array.m_data, value, start2, end, baseindex, state);
+    }
+#endif
+
 #if defined(REALM_COMPILER_SSE)
     // Only use SSE if payload is at least one SSE chunk (128 bits) in size. Also note taht SSE doesn't support
     // Less-than comparison for 64-bit values.
@@ -641,6 +650,8 @@ inline bool ArrayWithFind::compare_equality(int64_t value, size_t start, size_t
 template <class cond>
 bool ArrayWithFind::find(int64_t value, size_t start, size_t end, size_t baseindex, QueryStateBase* state) const
 {
+    if (REALM_UNLIKELY(m_array.m_is_compressed))
+        return IntegerCompressor::find<cond>(m_array.get_header(), value, start, end, baseindex, state);
     REALM_TEMPEX2(return find_optimized, cond, m_array.m_width, (value, start, end, baseindex, state));
 }
 
@@ -750,6 +761,15 @@ bool ArrayWithFind::compare_leafs(const Array* foreign, size_t start, size_t end
 
     int64_t v;
 
+    if (REALM_UNLIKELY(m_array.m_is_compressed || foreign->m_is_compressed)) {
+        for (; start < end; ++start) {
+            v = m_array.get(start);
+            if (c(v, foreign->get(start)) && !state->match(start + baseindex, v))
+                return false;
+        }
+        return true;
+    }
+
     // We can compare first element without checking for out-of-range
     v = m_array.get(start);
     if (c(v, foreign->get(start))) {
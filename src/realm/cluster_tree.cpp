@@ -121,6 +121,8 @@ public:
     void dump_objects(int64_t key_offset, std::string lead) const override;
 
 private:
+    friend class ClusterTree;
+
     static constexpr size_t s_key_ref_index = 0;
     static constexpr size_t s_sub_tree_depth_index = 1;
     static constexpr size_t s_sub_tree_size = 2;
@@ -1040,6 +1042,25 @@ bool ClusterTree::traverse(TraverseFunction func) const
     }
 }
 
+size_t ClusterTree::traverse_parallel(util::WorkStealingPool& pool, ParallelTraverseFunction func) const
+{
+    // Collect the leaves up front. Each worker then attaches its own accessor to the
+    // leaves it is handed, as accessors are not safe to share between threads.
+    std::vector<std::pair<ref_type, uint64_t>> leaves;
+    traverse([&](const Cluster* cluster) {
+        leaves.emplace_back(cluster->get_ref(), cluster->get_offset());
+        return IteratorControl::AdvanceToNext;
+    });
+
+    pool.parallel_for(leaves.size(), [&](size_t leaf_ndx, size_t worker_ndx) {
+        auto [ref, offset] = leaves[leaf_ndx];
+        Cluster leaf(offset, m_alloc, *this);
+        leaf.init(MemRef(m_alloc.translate(ref), ref, m_alloc));
+        func(&leaf, leaf_ndx, worker_ndx);
+    });
+    return leaves.size();
+}
+
 void ClusterTree::update(UpdateFunction func)
 {
     if (m_root->is_leaf()) {
@@ -1083,6 +1104,59 @@ void ClusterTree::verify() const
 #endif
 }
 
+namespace {
+
+// Write a column leaf of a cluster, compressing the arrays holding plain integers
+ref_type typed_write_column(ColKey col, ref_type ref, Allocator& alloc, _impl::ArrayWriterBase& out)
+{
+    bool only_if_modified = true;
+    if (col && !col.is_collection()) {
+        switch (col.get_type()) {
+            case col_type_Int:
+            case col_type_Link:
+                return Array::write(ref, alloc, out, only_if_modified, true); // Throws
+            case col_type_Timestamp: {
+                // Seconds and nanoseconds are held in two integer subarrays
+                if (alloc.is_read_only(ref))
+                    return ref;
+                Array leaf(alloc);
+                leaf.init_from_ref(ref);
+                return leaf.write_deep(out, [&](size_t, ref_type subref) {
+                    return Array::write(subref, alloc, out, only_if_modified, true); // Throws
+                });
+            }
+            default:
+                break;
+        }
+    }
+    return Array::write(ref, alloc, out, only_if_modified); // Throws
+}
+
+} // anonymous namespace
+
+ref_type ClusterTree::typed_write(ref_type ref, _impl::ArrayWriterBase& out) const
+{
+    if (m_alloc.is_read_only(ref))
+        return ref;
+
+    Array node(m_alloc);
+    node.init_from_ref(ref);
+    if (node.is_inner_bptree_node()) {
+        return node.write_deep(out, [&](size_t ndx, ref_type child_ref) {
+            if (ndx < ClusterNodeInner::s_first_node_index)
+                return Array::write(child_ref, m_alloc, out, true); // Throws
+            return typed_write(child_ref, out);                     // Throws
+        });
+    }
+
+    return node.write_deep(out, [&](size_t ndx, ref_type child_ref) {
+        if (ndx < Cluster::s_first_col_index)
+            return Array::write(child_ref, m_alloc, out, true); // Throws
+        ColKey col = m_owner->leaf_ndx2colkey(ColKey::Idx{unsigned(ndx - Cluster::s_first_col_index)});
+        return typed_write_column(col, child_ref, m_alloc, out); // Throws
+    });
+}
+
 void ClusterTree::nullify_incoming_links(ObjKey obj_key, CascadeState& state)
 {
     REALM_ASSERT(state.m_group);
@@ -22,6 +22,7 @@
 #include <realm/cluster.hpp>
 #include <realm/obj.hpp>
 #include <realm/util/function_ref.hpp>
+#include <realm/util/work_stealing_pool.hpp>
 
 namespace realm {
 
@@ -33,6 +34,7 @@ public:
     using TraverseFunction = util::FunctionRef<IteratorControl(const Cluster*)>;
     using UpdateFunction = util::FunctionRef<void(Cluster*)>;
     using ColIterateFunction = util::FunctionRef<IteratorControl(ColKey)>;
+    using ParallelTraverseFunction = util::FunctionRef<void(const Cluster*, size_t leaf_ndx, size_t worker_ndx)>;
 
     ClusterTree(Table* owner, Allocator& alloc, size_t top_position_for_cluster_tree);
     virtual ~ClusterTree();
@@ -177,6 +179,10 @@ public:
     // Visit all leaves and call the supplied function. Stop when function returns IteratorControl::Stop.
     // Not allowed to modify the tree
     bool traverse(TraverseFunction func) const;
+    // Visit all leaves using the threads of the supplied pool. The function is given the ordinal of the
+    // leaf in key order and the index of the worker running it. The function must only read from the tree.
+    // Returns the number of leaves visited.
+    size_t traverse_parallel(util::WorkStealingPool& pool, ParallelTraverseFunction func) const;
     // Visit all leaves and call the supplied function. The function can modify the leaf.
     void update(UpdateFunction func);
 
@@ -190,6 +196,11 @@ public:
     }
     void verify() const;
 
+    /// Write the modified nodes of the tree rooted at \a ref, allowing the
+    /// integer arrays of the column leaves to be compressed (see
+    /// IntegerCompressor). Returns the ref of the written root.
+    ref_type typed_write(ref_type ref, _impl::ArrayWriterBase& out) const;
+
 protected:
     friend class Obj;
     friend class Cluster;
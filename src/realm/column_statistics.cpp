@@ -0,0 +1,168 @@
+/*************************************************************************
+ *
+ * Copyright 2024 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/column_statistics.hpp>
+#include <realm/table.hpp>
+
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <unordered_map>
+
+using namespace realm;
+
+namespace {
+
+// Position of a value on a line, for interpolating between the minimum and
+// the maximum
+std::optional<double> to_double(const Mixed& value)
+{
+    switch (value.get_type()) {
+        case type_Int:
+            return double(value.get_int());
+        case type_Float:
+            return double(value.get_float());
+        case type_Double:
+            return value.get_double();
+        case type_Timestamp: {
+            Timestamp ts = value.get_timestamp();
+            return double(ts.get_seconds()) + double(ts.get_nanoseconds()) / Timestamp::nanoseconds_per_second;
+        }
+        default:
+            return {};
+    }
+}
+
+} // anonymous namespace
+
+ColumnStatistics ColumnStatistics::compute(const Table& table, ColKey col)
+{
+    ColumnStatistics stats;
+    stats.num_objects = table.size();
+    if (col.is_collection() || stats.num_objects == 0)
+        return stats;
+
+    // One object at a random position in each of `n` equally sized parts of
+    // the table, so that the sample is spread evenly but doesn't follow
+    // periodic patterns in the values. The generator is seeded by the size so
+    // that the statistics of a version are always the same.
+    size_t n = std::min(stats.num_objects, max_sample_size);
+    std::mt19937_64 random(stats.num_objects);
+    std::unordered_map<Mixed, size_t> frequencies;
+    size_t nulls = 0;
+    for (size_t i = 0; i < n; ++i) {
+        size_t begin = i * stats.num_objects / n;
+        size_t end = (i + 1) * stats.num_objects / n;
+        size_t ndx = begin + size_t(random() % (end - begin));
+        Mixed value = table.get_object(ndx).get_any(col);
+        if (SortedIndex::is_null_or_nan(value)) {
+            ++nulls;
+            continue;
+        }
+        ++frequencies[value];
+        if (stats.min.is_null() || value.compare(stats.min) < 0)
+            stats.min = value;
+        if (stats.max.is_null() || value.compare(stats.max) > 0)
+            stats.max = value;
+    }
+    stats.num_sampled = n;
+    stats.null_count = nulls * stats.num_objects / n;
+
+    if (n == stats.num_objects) {
+        stats.distinct_count = frequencies.size();
+    }
+    else {
+        // Values seen more than once in the sample are likely to be all the
+        // frequent values there are, while each value seen once stands for
+        // several values which were not sampled
+        size_t seen_once = 0;
+        for (auto& [value, count] : frequencies)
+            seen_once += (count == 1);
+        double scale = std::sqrt(double(stats.num_objects) / n);
+        size_t estimate = size_t(scale * seen_once) + (frequencies.size() - seen_once);
+        stats.distinct_count = std::min(estimate, stats.num_objects - stats.null_count);
+    }
+    return stats;
+}
+
+std::optional<double> ColumnStatistics::selectivity(Mixed value) const
+{
+    if (num_sampled == 0)
+        return {};
+    double total = double(num_objects);
+    if (SortedIndex::is_null_or_nan(value))
+        return null_count / total;
+
+    // A value which is not in the sample is less frequent than any value which is
+    double unseen = num_sampled == num_objects ? 0 : 0.5 / num_sampled;
+    if (distinct_count == 0)
+        return unseen;
+    if (Mixed::types_are_comparable(value, min) && (value.compare(min) < 0 || value.compare(max) > 0))
+        return unseen;
+    return (total - null_count) / total / distinct_count;
+}
+
+std::optional<double> ColumnStatistics::selectivity(const SortedIndex::Range& range) const
+{
+    if (num_sampled == 0)
+        return {};
+    double total = double(num_objects);
+    double nulls = range.include_nulls ? null_count / total : 0;
+    if (distinct_count == 0)
+        return nulls;
+
+    // Ranges outside of the values
+    if (range.begin && Mixed::types_are_comparable(*range.begin, max)) {
+        int c = range.begin->compare(max);
+        if (c > 0 || (c == 0 && !range.begin_inclusive))
+            return nulls;
+    }
+    if (range.end && Mixed::types_are_comparable(*range.end, min)) {
+        int c = range.end->compare(min);
+        if (c < 0 || (c == 0 && !range.end_inclusive))
+            return nulls;
+    }
+
+    double share;
+    auto lo = to_double(min);
+    auto hi = to_double(max);
+    auto begin = range.begin ? to_double(*range.begin) : lo;
+    auto end = range.end ? to_double(*range.end) : hi;
+    if (lo && hi && begin && end) {
+        share = *hi > *lo ? (std::min(*end, *hi) - std::max(*begin, *lo)) / (*hi - *lo) : 1;
+    }
+    else {
+        // Values which can't be interpolated, like strings
+        share = range.begin && range.end ? 1.0 / 9 : 1.0 / 3;
+    }
+    // A range holds at least one of the values it was not ruled out for
+    share = std::clamp(share, 1.0 / distinct_count, 1.0);
+    return nulls + (total - null_count) / total * share;
+}
+
+std::string ColumnStatistics::to_string() const
+{
+    std::ostringstream out;
+    out << num_objects << " objects";
+    if (num_sampled < num_objects)
+        out << " (" << num_sampled << " sampled)";
+    out << ", " << null_count << " nulls, " << distinct_count << " distinct values";
+    if (!min.is_null())
+        out << " from " << min << " to " << max;
+    return out.str();
+}
@@ -0,0 +1,65 @@
+/*************************************************************************
+ *
+ * Copyright 2024 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_COLUMN_STATISTICS_HPP
+#define REALM_COLUMN_STATISTICS_HPP
+
+#include <realm/index_sorted.hpp>
+#include <realm/mixed.hpp>
+
+#include <optional>
+
+namespace realm {
+
+class Table;
+
+/// Statistics of the values of a column, used by the query engine to
+/// estimate how many objects a condition matches.
+///
+/// The statistics are computed from a sample of at most `max_sample_size`
+/// objects spread over the table, so they are exact for small tables
+/// and estimates for larger ones. The number of distinct values of a sampled
+/// column is estimated from the number of values seen once and more than once
+/// in the sample (the GEE estimator of Charikar et al.). Nulls and NaNs are
+/// counted as nulls and are not part of the minimum and maximum.
+struct ColumnStatistics {
+    static constexpr size_t max_sample_size = 1000;
+
+    size_t num_objects = 0;
+    size_t num_sampled = 0;
+    size_t null_count = 0;
+    size_t distinct_count = 0;
+    OwnedMixed min{Mixed()};
+    OwnedMixed max{Mixed()};
+
+    /// Statistics of `col`, which must be a column of single values
+    static ColumnStatistics compute(const Table& table, ColKey col);
+
+    /// The estimated share of the objects which are equal to `value`, or none
+    /// if there are no statistics for the column
+    std::optional<double> selectivity(Mixed value) const;
+    /// The estimated share of the objects with a value in `range`. Values are
+    /// assumed to be evenly spread between the minimum and the maximum.
+    std::optional<double> selectivity(const SortedIndex::Range& range) const;
+
+    std::string to_string() const;
+};
+
+} // namespace realm
+
+#endif // REALM_COLUMN_STATISTICS_HPP
@@ -23,13 +23,17 @@
 #include <cerrno>
 #include <fcntl.h>
 #include <iostream>
+#include <map>
 #include <mutex>
 #include <sstream>
 #include <type_traits>
 #include <random>
+#include <set>
 #include <deque>
+#include <numeric>
 #include <thread>
 #include <chrono>
+#include <cmath>
 #include <condition_variable>
 
 #include <realm/disable_sync_to_disk.hpp>
@@ -43,6 +47,8 @@
 #include <realm/util/scope_exit.hpp>
 #include <realm/util/thread.hpp>
 #include <realm/util/to_string.hpp>
+#include <realm/util/work_stealing_pool.hpp>
+#include <realm/write_ahead_log.hpp>
 
 #ifndef _WIN32
 #include <sys/wait.h>
@@ -80,22 +86,43 @@ namespace {
 //         with a lock.
 // 13      New impl of VersionList and added mutex for it (former RingBuffer)
 // 14      Added field for tracking ongoing encrypted writes
-const uint_fast16_t g_shared_info_version = 14;
+// 15      Read locks are taken and released without the VersionList mutex by
+//         atomic updates of the entries of the VersionList
+// 16      Added `checkpoint_version`, `checkpoint_reader_idx` and
+//         `checkpoint_locked` for the write-ahead log
+// 17      Entries of the VersionList record when a newer version was committed
+//         and the process which last took a read lock on the version
+const uint_fast16_t g_shared_info_version = 17;
 
 
 struct VersionList {
     // the VersionList is an array of ReadCount structures.
     // it is placed in the "lock-file" and accessed via memory mapping
+    //
+    // Entries are allocated and freed while holding the VersionList mutex, but
+    // the counts are updated without it. A reader increments the count of the
+    // newest entry and then checks that the entry still is the newest and
+    // holds the same version. As entries are only freed while they are not the
+    // newest, and only if all counts are zero, a cleanup either sees the
+    // increment or the reader sees that the entry is no longer the newest, in
+    // which case it undoes the increment. Such a transient increment can at
+    // most keep an entry alive until the next cleanup, but the counts of an
+    // entry must never be reset while it is shared.
     struct ReadCount {
-        uint64_t version;
-        uint64_t filesize;
-        uint64_t current_top;
-        uint32_t count_live;
-        uint32_t count_frozen;
-        uint32_t count_full;
-        bool is_active()
+        std::atomic<uint64_t> version;
+        std::atomic<uint64_t> filesize;
+        std::atomic<uint64_t> current_top;
+        std::atomic<uint32_t> count_live;
+        std::atomic<uint32_t> count_frozen;
+        std::atomic<uint32_t> count_full;
+        // Seconds since the epoch at the commit of the next version, zero
+        // while the version is the newest
+        std::atomic<uint32_t> superseded_time;
+        // Process which last took a read lock on the version
+        std::atomic<uint32_t> last_reader_pid;
+        bool is_active() const
         {
-            return version != 0;
+            return version.load() != 0;
         }
         void deactivate()
         {
@@ -107,6 +134,9 @@ struct VersionList {
             version = v;
         }
     };
+    static_assert(std::atomic<uint32_t>::is_always_lock_free && sizeof(std::atomic<uint32_t>) == 4 &&
+                      sizeof(std::atomic<uint64_t>) == 8,
+                  "The entries of the VersionList must be shared by processes");
 
     void reserve(uint32_t size) noexcept
     {
@@ -164,14 +194,21 @@ struct VersionList {
             allocating.exchange(k); // barrier: prevent upward movement of instructions below
             i = k;
         }
+        // The counts may be transiently raised by a reader which saw the entry
+        // as the newest before it was freed. It will undo the increment when
+        // it finds the version changed.
         auto& rc = data()[i];
-        REALM_ASSERT(rc.count_frozen == 0);
-        REALM_ASSERT(rc.count_live == 0);
-        REALM_ASSERT(rc.count_full == 0);
         rc.current_top = top;
         rc.filesize = size;
+        rc.superseded_time = 0;
+        rc.last_reader_pid = 0;
         rc.activate(version);
-        newest.store(i); // barrier: prevent downward movement of instructions above
+        auto previous = newest.exchange(i); // barrier: prevent downward movement of instructions above
+        if (previous != nil && previous != i) {
+            data()[previous].superseded_time = uint32_t(
+                std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch())
+                    .count());
+        }
         return &rc;
     }
 
@@ -182,8 +219,9 @@ struct VersionList {
 
     void free_entry(ReadCount* rc) noexcept
     {
+        // the counts are left alone, see above
+        rc->version = 0;
         rc->current_top = rc->filesize = -1ULL; // easy to recognize in debugger
-        rc->deactivate();
     }
 
     // This method resets the version list to an empty state, then allocates an entry.
@@ -211,47 +249,56 @@ struct VersionList {
         // correct case where an earlier crash may have left the entry at 'allocating' partially initialized:
         const auto index_of_newest = newest.load();
         if (auto a = allocating.load(); a != index_of_newest) {
-            data()[a].deactivate();
+            free_entry(&data()[a]);
+        }
+        // take a snapshot of the active entries, as readers may change the counts
+        // while we look at them. All decisions must be based on the same counts.
+        struct Entry {
+            ReadCount* rc;
+            uint64_t version;
+            uint32_t count_live;
+            uint32_t count_frozen;
+            uint32_t count_full;
+        };
+        std::vector<Entry> active;
+        for (auto* rc = data(); rc < data() + entries; ++rc) {
+            if (auto version = rc->version.load())
+                active.push_back({rc, version, rc->count_live, rc->count_frozen, rc->count_full});
         }
         // determine fully locked versions - after one of those all versions are considered live.
-        for (auto* rc = data(); rc < data() + entries; ++rc) {
-            if (!rc->is_active())
-                continue;
-            if (rc->count_full) {
-                if (rc->version < oldest_full_v)
-                    oldest_full_v = rc->version;
+        for (auto& e : active) {
+            if (e.count_full) {
+                if (e.version < oldest_full_v)
+                    oldest_full_v = e.version;
             }
         }
         // collect reachable versions and determine oldest live reachable version
         // (oldest reachable version is the first entry in the top_refs map, so no need to find it explicitly)
-        for (auto* rc = data(); rc < data() + entries; ++rc) {
-            if (!rc->is_active())
-                continue;
-            if (rc->count_frozen || rc->count_live || rc->version >= oldest_full_v) {
+        for (auto& e : active) {
+            if (e.count_frozen || e.count_live || e.version >= oldest_full_v) {
                 // entry is still reachable
-                top_refs.emplace(rc->version, VersionInfo{to_ref(rc->current_top), to_ref(rc->filesize)});
+                top_refs.emplace(e.version,
+                                 VersionInfo{to_ref(e.rc->current_top.load()), to_ref(e.rc->filesize.load())});
             }
-            if (rc->count_live || rc->version >= oldest_full_v) {
-                if (rc->version < oldest_live_v)
-                    oldest_live_v = rc->version;
+            if (e.count_live || e.version >= oldest_full_v) {
+                if (e.version < oldest_live_v)
+                    oldest_live_v = e.version;
             }
         }
         // we must have found at least one reachable version
         REALM_ASSERT(top_refs.size());
         // free unreachable entries and determine if we want to trigger backdating
         uint64_t oldest_v = top_refs.begin()->first;
-        for (auto* rc = data(); rc < data() + entries; ++rc) {
-            if (!rc->is_active())
-                continue;
-            if (rc->count_frozen == 0 && rc->count_live == 0 && rc->version < oldest_full_v) {
+        for (auto& e : active) {
+            if (e.count_frozen == 0 && e.count_live == 0 && e.version < oldest_full_v) {
                 // entry is becoming unreachable.
                 // if it is also younger than a reachable version, then set 'any_new_unreachables' to trigger
                 // backdating
-                if (rc->version > oldest_v) {
+                if (e.version > oldest_v) {
                     any_new_unreachables = true;
                 }
-                REALM_ASSERT(index_of(*rc) != index_of_newest);
-                free_entry(rc);
+                REALM_ASSERT(index_of(*e.rc) != index_of_newest);
+                free_entry(e.rc);
             }
         }
         REALM_ASSERT(oldest_v != std::numeric_limits<uint64_t>::max());
@@ -263,8 +310,8 @@ struct VersionList {
     {
         util::format(std::cout, "VersionList has %1 entries: \n", entries);
         for (auto* rc = data(); rc < data() + entries; ++rc) {
-            util::format(std::cout, "[%1]: version %2, live: %3, full: %4, frozen: %5\n", index_of(*rc), rc->version,
-                         rc->count_live, rc->count_full, rc->count_frozen);
+            util::format(std::cout, "[%1]: version %2, live: %3, full: %4, frozen: %5\n", index_of(*rc),
+                         rc->version.load(), rc->count_live.load(), rc->count_full.load(), rc->count_frozen.load());
         }
     }
 #endif // REALM_DEBUG
@@ -306,6 +353,59 @@ TransactionRef make_transaction_ref(Args&&... args)
     return TransactionRef(new Transaction(std::forward<Args>(args)...), TransactionDeleter);
 }
 
+// Write the arrays of the commits in the write-ahead log at `path` which are
+// newer than `version`, with top ref `top_ref`, to the attached file, make the
+// file header reference the newest of them and clear the log. Returns true if
+// there were any such commits, in which case the file must be attached again.
+// A log which was not started on top of this version of this file is discarded.
+bool replay_write_ahead_log(const std::string& path, SlabAlloc& alloc, uint64_t version, ref_type top_ref,
+                            util::Logger* logger)
+{
+    if (!File::exists(path))
+        return false;
+    File& file = alloc.get_file();
+    WriteAheadLog wal(path, file); // Throws
+    if (wal.size() == 0)
+        return false;
+    if (!wal.belongs_to(version, top_ref)) {
+        if (logger) {
+            logger->log(util::Logger::Level::warn,
+                        "Discarded a write-ahead log which was not written on top of version %1 of this file",
+                        version);
+        }
+        wal.clear(version, top_ref); // Throws
+        return false;
+    }
+
+    size_t file_size = size_t(file.get_size());
+    auto newest = wal.replay(version, [&](ref_type ref, const char* data, size_t size) {
+        if (ref + size > file_size) {
+            file_size = ref + size;
+            file.prealloc(file_size); // Throws
+        }
+        file.write(ref, data, size); // Throws
+    });
+    if (newest) {
+        if (newest->logical_file_size > file_size)
+            file.prealloc(newest->logical_file_size); // Throws
+        if (!get_disable_sync_to_disk())
+            file.sync(); // Throws
+        // A file created in the last session may not have a file format yet
+        int file_format_version = alloc.get_committed_file_format_version();
+        GroupCommitter out(alloc, file_format_version ? file_format_version : Group::get_current_file_format_version());
+        out.commit(newest->top_ref); // Throws
+        if (logger) {
+            logger->log(util::Logger::Level::info, "Restored versions %1 to %2 from the write-ahead log",
+                        version + 1, newest->version);
+        }
+        wal.clear(newest->version, newest->top_ref); // Throws
+    }
+    else {
+        wal.clear(version, top_ref); // Throws
+    }
+    return bool(newest);
+}
+
 } // anonymous namespace
 
 namespace realm {
@@ -326,7 +426,7 @@ namespace realm {
 /// Members `init_complete`, `shared_info_version`, `size_of_mutex`, and
 /// `size_of_condvar` may only be modified only while holding an exclusive lock
 /// on the file, and may be read only while holding a shared (or exclusive) lock
-/// on the file. All other members (except for the VersionList which has its own mutex)
+/// on the file. All other members (except for the VersionList, see there)
 /// may be accessed only while holding a lock on `controlmutex`.
 ///
 /// SharedInfo must be 8-byte aligned. On 32-bit Apple platforms, mutexes store their
@@ -439,6 +539,16 @@ struct alignas(8) DB::SharedInfo {
     std::atomic<uint64_t> writing_page_offset;
     std::atomic<uint64_t> write_counter;
 
+    /// With Durability::WriteAheadLog, the version referenced by the file
+    /// header is read locked from the first commit of the session on, so that
+    /// its space is not reused by the commits which are only in the
+    /// write-ahead log. The lock is moved to the newest version by every
+    /// checkpoint, whichever session participant makes it. Guarded by the
+    /// write mutex.
+    uint64_t checkpoint_version = 0;
+    uint32_t checkpoint_reader_idx = 0;
+    uint32_t checkpoint_locked = 0;
+
     // IMPORTANT: The VersionList MUST be the last field in SharedInfo - see above.
     VersionList readers;
 
@@ -523,6 +633,11 @@ class DB::VersionManager {
 public:
     VersionManager(util::InterprocessMutex& mutex)
         : m_mutex(mutex)
+#ifdef _WIN32
+        , m_pid(uint32_t(GetCurrentProcessId()))
+#else
+        , m_pid(uint32_t(getpid()))
+#endif
     {
     }
     virtual ~VersionManager() {}
@@ -533,115 +648,109 @@ public:
         std::lock_guard lock(m_mutex);
         util::CheckedLockGuard info_lock(m_info_mutex);
         ensure_reader_mapping();
-        m_info->readers.purge_versions(oldest_live_version, top_refs, any_new_unreachables);
+        info()->readers.purge_versions(oldest_live_version, top_refs, any_new_unreachables);
     }
 
-    version_type get_newest_version() REQUIRES(!m_local_readers_mutex, !m_info_mutex)
+    version_type get_newest_version() REQUIRES(!m_info_mutex)
     {
         return get_version_id_of_latest_snapshot().version;
     }
 
-    VersionID get_version_id_of_latest_snapshot() REQUIRES(!m_local_readers_mutex, !m_info_mutex)
+    VersionID get_version_id_of_latest_snapshot() REQUIRES(!m_info_mutex)
     {
-        {
-            // First check the local cache. This is an unlocked read, so it may
-            // race with adding a new version. If this happens we'll either see
-            // a stale value (acceptable for a racing write on one thread and
-            // a read on another), or a new value which is guaranteed to not
-            // be an active index in the local cache.
-            util::CheckedLockGuard lock(m_local_readers_mutex);
-            util::CheckedLockGuard info_lock(m_info_mutex);
-            auto index = m_info->readers.newest.load();
-            if (index < m_local_readers.size()) {
-                auto& r = m_local_readers[index];
-                if (r.is_active()) {
-                    return {r.version, index};
-                }
-            }
+        // This may race with adding a new version, in which case we either see
+        // the previous newest version or the new one.
+        auto max_entry = m_local_max_entry.load(std::memory_order_acquire);
+        auto& readers = info()->readers;
+        auto index = readers.newest.load();
+        if (index < max_entry) {
+            auto version = readers.get(index).version.load();
+            if (version != 0)
+                return {version, index};
         }
 
         std::lock_guard lock(m_mutex);
         util::CheckedLockGuard info_lock(m_info_mutex);
-        auto index = m_info->readers.newest.load();
+        index = info()->readers.newest.load();
         ensure_reader_mapping(index);
-        return {m_info->readers.get(index).version, index};
+        return {info()->readers.get(index).version, index};
     }
 
-    void release_read_lock(const ReadLockInfo& read_lock) REQUIRES(!m_local_readers_mutex, !m_info_mutex)
+    void release_read_lock(const ReadLockInfo& read_lock) REQUIRES(!m_info_mutex)
     {
-        {
-            util::CheckedLockGuard lock(m_local_readers_mutex);
-            REALM_ASSERT(read_lock.m_reader_idx < m_local_readers.size());
-            auto& r = m_local_readers[read_lock.m_reader_idx];
-            auto& f = field_for_type(r, read_lock.m_type);
-            REALM_ASSERT(f > 0);
-            if (--f > 0)
-                return;
-            if (r.count_live == 0 && r.count_full == 0 && r.count_frozen == 0)
-                r.version = 0;
-        }
-
-        std::lock_guard lock(m_mutex);
-        util::CheckedLockGuard info_lock(m_info_mutex);
         // we should not need to call ensure_full_reader_mapping,
         // since releasing a read lock means it has been grabbed
         // earlier - and hence must reside in mapped memory:
-        REALM_ASSERT(read_lock.m_reader_idx < m_local_max_entry);
-        auto& r = m_info->readers.get(read_lock.m_reader_idx);
+        REALM_ASSERT(read_lock.m_reader_idx < m_local_max_entry.load(std::memory_order_acquire));
+        auto& r = info()->readers.get(read_lock.m_reader_idx);
         REALM_ASSERT(read_lock.m_version == r.version);
-        --field_for_type(r, read_lock.m_type);
+        auto previous = field_for_type(r, read_lock.m_type).fetch_sub(1);
+        REALM_ASSERT(previous > 0);
     }
 
-    ReadLockInfo grab_read_lock(ReadLockInfo::Type type, VersionID version_id = {})
-        REQUIRES(!m_local_readers_mutex, !m_info_mutex)
+    ReadLockInfo grab_read_lock(ReadLockInfo::Type type, VersionID version_id = {}) REQUIRES(!m_info_mutex)
     {
         ReadLockInfo read_lock;
-        if (try_grab_local_read_lock(read_lock, type, version_id))
+        if (try_grab_newest_read_lock(read_lock, type, version_id))
             return read_lock;
 
-        {
-            const bool pick_specific = version_id.version != VersionID().version;
-            std::lock_guard lock(m_mutex);
-            util::CheckedLockGuard info_lock(m_info_mutex);
-            auto newest = m_info->readers.newest.load();
-            REALM_ASSERT(newest != VersionList::nil);
-            read_lock.m_reader_idx = pick_specific ? version_id.index : newest;
-            ensure_reader_mapping((unsigned int)read_lock.m_reader_idx);
-            bool picked_newest = read_lock.m_reader_idx == (unsigned)newest;
-            auto& r = m_info->readers.get(read_lock.m_reader_idx);
-            if (pick_specific && version_id.version != r.version)
+        // Older versions and entries which aren't mapped yet. Older versions may
+        // only be locked while no cleanup can free them.
+        const bool pick_specific = version_id.version != VersionID().version;
+        std::lock_guard lock(m_mutex);
+        util::CheckedLockGuard info_lock(m_info_mutex);
+        auto newest = info()->readers.newest.load();
+        REALM_ASSERT(newest != VersionList::nil);
+        read_lock.m_reader_idx = pick_specific ? version_id.index : newest;
+        ensure_reader_mapping((unsigned int)read_lock.m_reader_idx);
+        bool picked_newest = read_lock.m_reader_idx == (unsigned)newest;
+        auto& r = info()->readers.get(read_lock.m_reader_idx);
+        if (pick_specific && version_id.version != r.version)
+            throw BadVersion(version_id.version);
+        if (!picked_newest) {
+            if (type == ReadLockInfo::Frozen && r.count_frozen == 0 && r.count_live == 0)
+                throw BadVersion(version_id.version);
+            if (type != ReadLockInfo::Frozen && r.count_live == 0)
                 throw BadVersion(version_id.version);
-            if (!picked_newest) {
-                if (type == ReadLockInfo::Frozen && r.count_frozen == 0 && r.count_live == 0)
-                    throw BadVersion(version_id.version);
-                if (type != ReadLockInfo::Frozen && r.count_live == 0)
-                    throw BadVersion(version_id.version);
-            }
-            populate_read_lock(read_lock, r, type);
         }
+        ++field_for_type(r, type);
+        r.last_reader_pid.store(m_pid, std::memory_order_relaxed);
+        populate_read_lock(read_lock, r, type);
+        return read_lock;
+    }
 
-        {
-            util::CheckedLockGuard local_lock(m_local_readers_mutex);
-            grow_local_cache(read_lock.m_reader_idx + 1);
-            auto& r2 = m_local_readers[read_lock.m_reader_idx];
-            if (!r2.is_active()) {
-                r2.version = read_lock.m_version;
-                r2.filesize = read_lock.m_file_size;
-                r2.current_top = read_lock.m_top_ref;
-                r2.count_full = r2.count_live = r2.count_frozen = 0;
-            }
-            REALM_ASSERT_EX(field_for_type(r2, type) == 0, type, r2.count_full, r2.count_live, r2.count_frozen);
-            field_for_type(r2, type) = 1;
+    // Fill in the transactions on `version` in all processes and the age of
+    // the version. Returns false if the version is no longer kept.
+    bool get_pinned_version(uint64_t version, PinnedVersion& pinned) REQUIRES(!m_info_mutex)
+    {
+        std::lock_guard lock(m_mutex);
+        util::CheckedLockGuard info_lock(m_info_mutex);
+        ensure_reader_mapping();
+        auto& readers = info()->readers;
+        for (uint32_t i = 0; i < readers.capacity(); ++i) {
+            auto& r = readers.get(i);
+            if (r.version.load() != version)
+                continue;
+            pinned.version = version;
+            pinned.live_transactions = r.count_live;
+            pinned.frozen_transactions = r.count_frozen;
+            pinned.full_transactions = r.count_full;
+            pinned.last_reader_pid = r.last_reader_pid;
+            auto now = std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::system_clock::now().time_since_epoch());
+            auto superseded_time = std::chrono::seconds(r.superseded_time.load());
+            if (superseded_time.count() != 0 && now > superseded_time)
+                pinned.age = now - superseded_time;
+            return true;
         }
-
-        return read_lock;
+        return false;
     }
 
     void init_versioning(ref_type top_ref, size_t file_size, uint64_t initial_version) REQUIRES(!m_info_mutex)
     {
         std::lock_guard lock(m_mutex);
         util::CheckedLockGuard info_lock(m_info_mutex);
-        m_info->init_versioning(top_ref, file_size, initial_version);
+        info()->init_versioning(top_ref, file_size, initial_version);
     }
 
     void add_version(ref_type new_top_ref, size_t new_file_size, uint64_t new_version) REQUIRES(!m_info_mutex)
@@ -649,63 +758,60 @@ public:
         std::lock_guard lock(m_mutex);
         util::CheckedLockGuard info_lock(m_info_mutex);
         ensure_reader_mapping();
-        if (m_info->readers.try_allocate_entry(new_top_ref, new_file_size, new_version)) {
+        if (info()->readers.try_allocate_entry(new_top_ref, new_file_size, new_version)) {
             return;
         }
         // allocation failed, expand VersionList (and lockfile) and retry
-        auto entries = m_info->readers.capacity();
+        auto entries = info()->readers.capacity();
         auto new_entries = entries + 32;
         expand_version_list(new_entries);
-        m_local_max_entry = new_entries;
-        m_info->readers.reserve(new_entries);
-        auto success = m_info->readers.try_allocate_entry(new_top_ref, new_file_size, new_version);
+        info()->readers.reserve(new_entries);
+        m_local_max_entry.store(new_entries, std::memory_order_release);
+        auto success = info()->readers.try_allocate_entry(new_top_ref, new_file_size, new_version);
         REALM_ASSERT_EX(success, new_entries, new_version);
     }
 
 
 private:
-    void grow_local_cache(size_t new_size) REQUIRES(m_local_readers_mutex)
-    {
-        if (new_size > m_local_readers.size())
-            m_local_readers.resize(new_size, VersionList::ReadCount{});
-    }
-
     void populate_read_lock(ReadLockInfo& read_lock, VersionList::ReadCount& r, ReadLockInfo::Type type)
     {
-        ++field_for_type(r, type);
         read_lock.m_type = type;
         read_lock.m_version = r.version;
-        read_lock.m_top_ref = static_cast<ref_type>(r.current_top);
-        read_lock.m_file_size = static_cast<size_t>(r.filesize);
+        read_lock.m_top_ref = static_cast<ref_type>(r.current_top.load());
+        read_lock.m_file_size = static_cast<size_t>(r.filesize.load());
     }
 
-    bool try_grab_local_read_lock(ReadLockInfo& read_lock, ReadLockInfo::Type type, VersionID version_id)
-        REQUIRES(!m_local_readers_mutex, !m_info_mutex)
+    // Lock the newest version without taking any mutex, see VersionList.
+    // Returns false if the version isn't the newest or if it changed while
+    // trying.
+    bool try_grab_newest_read_lock(ReadLockInfo& read_lock, ReadLockInfo::Type type, VersionID version_id)
+        REQUIRES(!m_info_mutex)
     {
         const bool pick_specific = version_id.version != VersionID().version;
-        auto index = version_id.index;
-        if (!pick_specific) {
-            util::CheckedLockGuard lock(m_info_mutex);
-            index = m_info->readers.newest.load();
-        }
-        util::CheckedLockGuard local_lock(m_local_readers_mutex);
-        if (index >= m_local_readers.size())
+        auto max_entry = m_local_max_entry.load(std::memory_order_acquire);
+        auto& readers = info()->readers;
+        auto index = readers.newest.load();
+        if (index >= max_entry || (pick_specific && index != version_id.index))
             return false;
 
-        auto& r = m_local_readers[index];
-        if (!r.is_active())
-            return false;
-        if (pick_specific && r.version != version_id.version)
+        auto& r = readers.get(index);
+        auto version = r.version.load();
+        if (version == 0 || (pick_specific && version != version_id.version))
             return false;
-        if (field_for_type(r, type) == 0)
+        auto& count = field_for_type(r, type);
+        ++count;
+        if (readers.newest.load() != index || r.version.load() != version) {
+            --count;
             return false;
+        }
+        r.last_reader_pid.store(m_pid, std::memory_order_relaxed);
 
         read_lock.m_reader_idx = index;
         populate_read_lock(read_lock, r, type);
         return true;
     }
 
-    static uint32_t& field_for_type(VersionList::ReadCount& r, ReadLockInfo::Type type)
+    static std::atomic<uint32_t>& field_for_type(VersionList::ReadCount& r, ReadLockInfo::Type type)
     {
         switch (type) {
             case ReadLockInfo::Frozen:
@@ -722,14 +828,14 @@ private:
     void mark_page_for_writing(uint64_t page_offset) REQUIRES(!m_info_mutex)
     {
         util::CheckedLockGuard info_lock(m_info_mutex);
-        m_info->writing_page_offset = page_offset + 1;
-        m_info->write_counter++;
+        info()->writing_page_offset = page_offset + 1;
+        info()->write_counter++;
     }
     void clear_writing_marker() REQUIRES(!m_info_mutex)
     {
         util::CheckedLockGuard info_lock(m_info_mutex);
-        m_info->write_counter++;
-        m_info->writing_page_offset = 0;
+        info()->write_counter++;
+        info()->writing_page_offset = 0;
     }
     // returns false if no page is marked.
     // if a page is marked, returns true and optionally the offset of the page marked for writing
@@ -738,9 +844,9 @@ private:
     {
         util::CheckedLockGuard info_lock(m_info_mutex);
         if (write_counter) {
-            *write_counter = m_info->write_counter;
+            *write_counter = info()->write_counter;
         }
-        uint64_t marked = m_info->writing_page_offset;
+        uint64_t marked = info()->writing_page_offset;
         if (marked && page_offset) {
             *page_offset = marked - 1;
         }
@@ -749,12 +855,20 @@ private:
 
 protected:
     util::InterprocessMutex& m_mutex;
-    util::CheckedMutex m_local_readers_mutex;
-    std::vector<VersionList::ReadCount> m_local_readers GUARDED_BY(m_local_readers_mutex);
+    const uint32_t m_pid;
 
+    // The mapping of the lock file is replaced when the VersionList grows, but
+    // the previous mappings stay valid so that readers can use them without
+    // taking a mutex. m_info is updated before m_local_max_entry, so entries
+    // below m_local_max_entry are always mapped by m_info.
     util::CheckedMutex m_info_mutex;
-    unsigned int m_local_max_entry GUARDED_BY(m_info_mutex) = 0;
-    SharedInfo* m_info GUARDED_BY(m_info_mutex) = nullptr;
+    std::atomic<unsigned int> m_local_max_entry = 0;
+    std::atomic<SharedInfo*> m_info = nullptr;
+
+    SharedInfo* info() const noexcept
+    {
+        return m_info.load(std::memory_order_acquire);
+    }
 
     virtual void ensure_reader_mapping(unsigned int required = -1) REQUIRES(m_info_mutex) = 0;
     virtual void expand_version_list(unsigned new_entries) REQUIRES(m_info_mutex) = 0;
@@ -780,18 +894,17 @@ public:
             m_info = m_reader_map.get_addr();
 
             std::lock_guard lock(m_mutex);
-            m_local_max_entry = m_info->readers.capacity();
-            required_size = sizeof(SharedInfo) + m_info->readers.compute_required_space(m_local_max_entry);
+            m_local_max_entry = info()->readers.capacity();
+            required_size = sizeof(SharedInfo) + info()->readers.compute_required_space(m_local_max_entry);
             REALM_ASSERT(required_size >= size);
         }
     }
 
     void expand_version_list(unsigned new_entries) override REQUIRES(m_info_mutex)
     {
-        size_t new_info_size = sizeof(SharedInfo) + m_info->readers.compute_required_space(new_entries);
-        m_file.prealloc(new_info_size);                                          // Throws
-        m_reader_map.remap(m_file, util::File::access_ReadWrite, new_info_size); // Throws
-        m_info = m_reader_map.get_addr();
+        size_t new_info_size = sizeof(SharedInfo) + info()->readers.compute_required_space(new_entries);
+        m_file.prealloc(new_info_size); // Throws
+        map(new_info_size);             // Throws
     }
 
 private:
@@ -803,18 +916,28 @@ private:
         if (required < m_local_max_entry)
             return;
 
-        auto new_max_entry = m_info->readers.capacity();
+        auto new_max_entry = info()->readers.capacity();
         if (new_max_entry > m_local_max_entry) {
             // handle mapping expansion if required
-            size_t info_size = sizeof(DB::SharedInfo) + m_info->readers.compute_required_space(new_max_entry);
-            m_reader_map.remap(m_file, util::File::access_ReadWrite, info_size); // Throws
-            m_local_max_entry = new_max_entry;
-            m_info = m_reader_map.get_addr();
+            size_t info_size = sizeof(DB::SharedInfo) + info()->readers.compute_required_space(new_max_entry);
+            map(info_size); // Throws
+            m_local_max_entry.store(new_max_entry, std::memory_order_release);
         }
     }
 
+    // Map the lock file anew, keeping the previous mapping for readers which
+    // may still use it
+    void map(size_t size) REQUIRES(m_info_mutex)
+    {
+        File::Map<DB::SharedInfo> new_map(m_file, util::File::access_ReadWrite, size); // Throws
+        m_old_reader_maps.push_back(std::move(m_reader_map));                        // Throws
+        m_reader_map = std::move(new_map);
+        m_info.store(m_reader_map.get_addr(), std::memory_order_release);
+    }
+
     File& m_file;
     File::Map<DB::SharedInfo> m_reader_map;
+    std::vector<File::Map<DB::SharedInfo>> m_old_reader_maps;
 
     friend class DB::EncryptionMarkerObserver;
 };
@@ -863,7 +986,7 @@ public:
         : VersionManager(mutex)
     {
         m_info = info;
-        m_local_max_entry = m_info->readers.capacity();
+        m_local_max_entry = info->readers.capacity();
     }
     void expand_version_list(unsigned) override
     {
@@ -931,6 +1054,9 @@ void DB::open(const std::string& path, const DBOptions& options)
         dg.release();
         return;
     }
+    if (options.durability == Durability::WriteAheadLog && options.encryption_key) {
+        throw InvalidArgument("Durability::WriteAheadLog is not supported for encrypted files");
+    }
     std::string lockfile_path = get_core_file(path, CoreFileType::Lock);
     std::string coordination_dir = get_core_file(path, CoreFileType::Management);
     std::string lockfile_prefix = coordination_dir + "/access_control";
@@ -1165,6 +1291,7 @@ void DB::open(const std::string& path, const DBOptions& options)
                 // need to do more
                 continue;
             }
+            set_memory_limits();
 
             // Determine target file format version for session (upgrade
             // required if greater than file format version of attached file).
@@ -1230,6 +1357,14 @@ void DB::open(const std::string& path, const DBOptions& options)
                 int stored_hist_type = 0;
                 gf::get_version_and_history_info(alloc, top_ref, version, stored_hist_type,
                                                  stored_hist_schema_version);
+                // Commits which were only in the write-ahead log when the last
+                // session ended are written to the file first, whatever the
+                // durability of this session
+                if (!options.encryption_key &&
+                    replay_write_ahead_log(get_core_file(path, CoreFileType::Wal), alloc, version, top_ref,
+                                           m_logger.get())) {
+                    continue;
+                }
                 bool good_history_type = false;
                 switch (openers_hist_type) {
                     case Replication::hist_None:
@@ -1408,6 +1543,21 @@ void DB::open(const std::string& path, const DBOptions& options)
         break;
     }
 
+#ifndef _WIN32
+    // On Windows, syncing the file does not write the pages changed through
+    // other mappings, so the commits are synced like with Durability::Full
+    if (options.durability == Durability::WriteAheadLog) {
+        try {
+            m_write_ahead_log =
+                std::make_unique<WriteAheadLog>(get_core_file(path, CoreFileType::Wal), m_alloc.get_file()); // Throws
+        }
+        catch (...) {
+            close();
+            throw;
+        }
+    }
+#endif
+
     if (m_logger) {
         m_logger->log(util::Logger::Level::debug, "   Number of participants: %1", m_info->num_participants);
         m_logger->log(util::Logger::Level::debug, "   Durability: %1", [&] {
@@ -1418,6 +1568,8 @@ void DB::open(const std::string& path, const DBOptions& options)
                     return "MemOnly";
                 case realm::DBOptions::Durability::Unsafe:
                     return "Unsafe";
+                case realm::DBOptions::Durability::WriteAheadLog:
+                    return "WriteAheadLog";
             }
             return "";
         }());
@@ -1709,6 +1861,7 @@ bool DB::compact(bool bump_version_number, std::optional<const char*> output_enc
         cfg.encryption_key = write_key;
         ref_type top_ref;
         top_ref = m_alloc.attach_file(m_db_path, cfg, m_marker_observer.get());
+        set_memory_limits();
         m_alloc.convert_from_streaming_form(top_ref);
         m_alloc.init_mapping_management(info->latest_version_number);
         info->number_of_versions = 1;
@@ -1994,6 +2147,15 @@ void DB::close_internal(std::unique_lock<InterprocessMutex> lock, bool allow_ope
             throw WrongTransactionState("Closing with open read transactions");
     }
     SharedInfo* info = m_info;
+    if (m_write_ahead_log) {
+        // Leave the file complete if possible. If not, the commits in the log
+        // are restored when the next session begins.
+        try {
+            checkpoint(); // Throws
+        }
+        catch (...) {
+        }
+    }
     {
         if (!lock.owns_lock())
             lock.lock();
@@ -2005,6 +2167,10 @@ void DB::close_internal(std::unique_lock<InterprocessMutex> lock, bool allow_ope
             REALM_ASSERT(info->sync_agent_present);
             info->sync_agent_present = 0; // Set to false
         }
+        if (m_group_persisted_lock) {
+            m_version_manager->release_read_lock(*m_group_persisted_lock);
+            m_group_persisted_lock.reset();
+        }
         release_all_read_locks();
         --info->num_participants;
         bool end_of_session = info->num_participants == 0;
@@ -2020,7 +2186,11 @@ void DB::close_internal(std::unique_lock<InterprocessMutex> lock, bool allow_ope
                 catch (...) {
                 } // ignored on purpose.
             }
+            if (m_write_ahead_log && m_write_ahead_log->size() == 0) {
+                util::File::try_remove(get_core_file(m_db_path, CoreFileType::Wal));
+            }
         }
+        m_write_ahead_log.reset();
         lock.unlock();
     }
     {
@@ -2149,6 +2319,285 @@ void DB::async_sync_to_disk(util::UniqueFunction<void()> fn)
     m_commit_helper->sync_to_disk(std::move(fn));
 }
 
+bool DB::uses_group_commit() const noexcept
+{
+#ifdef _WIN32
+    // FlushFileBuffers() does not write pages modified through other mappings
+    return false;
+#else
+    return m_group_commit && Durability(m_info->durability) == Durability::Full;
+#endif
+}
+
+void DB::wait_for_group_commit(Transaction& transaction, version_type version)
+{
+    // The first thread to find no sync in progress syncs all versions
+    // committed so far. Threads committing while it does so wait for it to
+    // finish, and then one of them syncs the versions committed meanwhile.
+    util::CheckedUniqueLock lock(m_group_commit_mutex);
+    while (m_group_synced_version < version) {
+        if (m_group_sync_in_progress) {
+            m_group_commit_cv.wait(lock.native_handle());
+            continue;
+        }
+        m_group_sync_in_progress = true;
+        lock.unlock();
+        version_type synced_version = 0;
+        std::exception_ptr error;
+        try {
+            synced_version = sync_group_commits(transaction); // Throws
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+        lock.lock();
+        m_group_sync_in_progress = false;
+        m_group_synced_version = std::max(m_group_synced_version, synced_version);
+        m_group_commit_cv.notify_all();
+        if (error)
+            std::rethrow_exception(error);
+    }
+}
+
+void DB::checkpoint()
+{
+    if (!m_write_ahead_log)
+        return;
+    do_begin_write(); // Throws
+    auto end_write = util::make_scope_exit([&]() noexcept {
+        do_end_write();
+    });
+    checkpoint_write_ahead_log(m_file_format_version); // Throws
+}
+
+namespace {
+
+// Reads the trees of a version level by level. The arrays of a level are read
+// by the threads of a pool, which collect the refs of the next level. The first
+// exception thrown by a thread is rethrown by run() once all threads stopped.
+class Prefetcher {
+public:
+    enum class Mode {
+        Tree,    // the inner nodes of a cluster tree and its clusters
+        Cluster, // a cluster tree, with the data of the selected columns
+        Deep,    // an array and everything below it
+    };
+    struct Node {
+        ref_type ref;
+        Mode mode;
+        // Cluster: the columns whose data is read, by leaf index. All if null.
+        const std::vector<size_t>* columns = nullptr;
+    };
+
+    Prefetcher(Allocator& alloc, size_t num_threads, bool advise)
+        : m_alloc(alloc)
+        , m_pool(num_threads)
+        , m_advise(advise)
+        , m_next(m_pool.num_workers())
+    {
+    }
+
+    void run(std::vector<Node> level, const std::function<bool(size_t, size_t)>& progress)
+    {
+        std::vector<size_t> bytes(m_pool.num_workers());
+        size_t arrays = 0;
+        while (!level.empty()) {
+            m_pool.parallel_for(level.size(), [&](size_t i, size_t worker) {
+                bytes[worker] += read(level[i], m_next[worker]); // Throws
+            });
+            arrays += level.size();
+            level.clear();
+            for (auto& next : m_next) {
+                level.insert(level.end(), next.begin(), next.end());
+                next.clear();
+            }
+            if (progress && !progress(arrays, std::accumulate(bytes.begin(), bytes.end(), size_t(0))))
+                return;
+        }
+    }
+
+private:
+    Allocator& m_alloc;
+    util::WorkStealingPool m_pool;
+    const bool m_advise;
+    std::vector<std::vector<Node>> m_next;
+    // The slots of a cluster before those of the columns hold its keys
+    static constexpr size_t s_first_col_index = 1;
+
+    size_t read(const Node& node, std::vector<Node>& next) const
+    {
+        char* header = m_alloc.translate(node.ref);
+        size_t size = NodeHeader::get_byte_size_from_header(header);
+        // Read the rest of the array in one request rather than a page at a
+        // time
+        if (m_advise && size > util::page_size())
+            util::madvise(header, size, util::MemoryAdvice::WillNeed);
+        if (!NodeHeader::get_hasrefs_from_header(header))
+            return size;
+
+        bool inner = NodeHeader::get_is_inner_bptree_node_from_header(header);
+        if (node.mode == Mode::Tree && !inner)
+            return size;
+        Array array(m_alloc);
+        array.init_from_mem(MemRef(header, node.ref, m_alloc));
+        for (size_t i = 0; i < array.size(); ++i) {
+            int64_t value = array.get(i);
+            // Skip null refs and tagged values
+            if (value == 0 || (value & 1) == 1)
+                continue;
+            Mode mode = node.mode;
+            if (mode == Mode::Cluster && !inner) {
+                // The data of a column is below its slot in the cluster
+                if (i < s_first_col_index)
+                    continue;
+                if (node.columns && std::find(node.columns->begin(), node.columns->end(), i - s_first_col_index) ==
+                                        node.columns->end())
+                    continue;
+                mode = Mode::Deep;
+            }
+            next.push_back({to_ref(value), mode, node.columns}); // Throws
+        }
+        return size;
+    }
+};
+
+} // anonymous namespace
+
+void DB::prefetch(const PrefetchOptions& options)
+{
+    auto tr = start_read(); // Throws
+    // The columns of the selected tables by leaf index, and the starting
+    // nodes. Opening the table accessors reads the top of each table.
+    std::vector<std::vector<size_t>> columns(options.tables.size());
+    std::vector<Prefetcher::Node> roots;
+    std::set<TableKey> selected;
+    for (size_t t = 0; t < options.tables.size(); ++t) {
+        auto& spec = options.tables[t];
+        ConstTableRef table = tr->get_table(spec.name);
+        if (!table)
+            throw NoSuchTable();
+        std::vector<ColKey> col_keys;
+        for (auto& name : spec.columns) {
+            ColKey col_key = table->get_column_key(name);
+            if (!col_key)
+                throw InvalidColumnKey(name);
+            col_keys.push_back(col_key);
+            columns[t].push_back(col_key.get_index().val);
+        }
+        if (spec.columns.empty()) {
+            for (auto col_key : table->get_column_keys())
+                col_keys.push_back(col_key);
+        }
+        roots.push_back({table->get_cluster_tree_ref(), Prefetcher::Mode::Cluster,
+                         spec.columns.empty() ? nullptr : &columns[t]});
+        if (spec.search_indexes) {
+            for (auto col_key : col_keys) {
+                if (ref_type ref = table->get_search_index_ref(col_key))
+                    roots.push_back({ref, Prefetcher::Mode::Deep});
+            }
+        }
+        selected.insert(table->get_key());
+    }
+    for (auto key : tr->get_table_keys()) {
+        if (selected.count(key))
+            continue;
+        ConstTableRef table = tr->get_table(key);
+        roots.push_back({table->get_cluster_tree_ref(), Prefetcher::Mode::Tree});
+    }
+
+    Prefetcher prefetcher(m_alloc, options.num_threads, !m_alloc.get_file().get_encryption()); // Throws
+    prefetcher.run(std::move(roots), options.progress);                                       // Throws
+}
+
+void DB::checkpoint_write_ahead_log(int file_format_version)
+{
+    SharedInfo* info = m_info;
+    ReadLockInfo newest = m_version_manager->grab_read_lock(ReadLockInfo::Frozen); // Throws
+    auto release_newest = util::make_scope_exit([&]() noexcept {
+        m_version_manager->release_read_lock(newest);
+    });
+    if (m_write_ahead_log->size() > 0) {
+        // The arrays of all commits since the last checkpoint must be on disk
+        // before the header references them
+        if (!get_disable_sync_to_disk())
+            m_alloc.get_file().sync(); // Throws
+        GroupCommitter out(m_alloc, file_format_version, Durability::Full, m_marker_observer.get());
+        out.commit(newest.m_top_ref); // Throws
+        if (m_logger) {
+            m_logger->log(util::LogCategory::transaction, util::Logger::Level::debug,
+                          "Checkpoint of version %1 to disk", newest.m_version);
+        }
+    }
+    else if (info->checkpoint_locked) {
+        // The header references the newest version already
+        return;
+    }
+    else if (m_alloc.get_committed_file_format_version() != file_format_version) {
+        // Older versions of the library do not replay the log, so they must
+        // refuse to open the file while commits may be only in the log. The
+        // header gets the file format of the session, which they don't accept,
+        // before the first commit is logged.
+        GroupCommitter out(m_alloc, file_format_version, Durability::Full, m_marker_observer.get());
+        out.commit(newest.m_top_ref); // Throws
+    }
+    m_write_ahead_log->clear(newest.m_version, newest.m_top_ref); // Throws
+
+    // Move the lock on the version referenced by the header
+    if (info->checkpoint_locked) {
+        ReadLockInfo previous;
+        previous.m_version = info->checkpoint_version;
+        previous.m_reader_idx = info->checkpoint_reader_idx;
+        previous.m_type = ReadLockInfo::Frozen;
+        m_version_manager->release_read_lock(previous);
+    }
+    info->checkpoint_version = newest.m_version;
+    info->checkpoint_reader_idx = uint32_t(newest.m_reader_idx);
+    info->checkpoint_locked = 1;
+    release_newest.cancel();
+}
+
+DB::version_type DB::sync_group_commits(Transaction& transaction)
+{
+    // Sync the data of the commits without holding the write mutex, so that
+    // other threads can go on committing. Only the update of the header needs
+    // the write mutex, and mostly finds the data on disk already.
+    auto sync_start = std::chrono::steady_clock::now();
+    if (!get_disable_sync_to_disk())
+        m_alloc.get_file().sync(); // Throws
+    {
+        CheckedLockGuard lock(m_mutex);
+        m_metrics.sync.record(
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - sync_start));
+    }
+
+    do_begin_possibly_async_write(); // Throws
+    auto end_write = util::make_scope_exit([&]() noexcept {
+        end_write_on_correct_thread();
+    });
+    // No commits can happen now, so the newest version includes all commits
+    // which are waiting for a sync
+    ReadLockInfo read_lock = m_version_manager->grab_read_lock(ReadLockInfo::Frozen); // Throws
+    try {
+        if (m_logger) {
+            m_logger->log(util::LogCategory::transaction, util::Logger::Level::debug,
+                          "Group commit of version %1 to disk", read_lock.m_version);
+        }
+        GroupCommitter out(transaction, Durability::Full, m_marker_observer.get());
+        out.commit(read_lock.m_top_ref); // Throws
+    }
+    catch (...) {
+        m_version_manager->release_read_lock(read_lock);
+        throw;
+    }
+    // The header references the newest version now, which needs no lock
+    m_version_manager->release_read_lock(read_lock);
+    if (m_group_persisted_lock) {
+        m_version_manager->release_read_lock(*m_group_persisted_lock);
+        m_group_persisted_lock.reset();
+    }
+    return read_lock.m_version;
+}
+
 bool DB::has_changed(TransactionRef& tr)
 {
     if (m_fake_read_lock_if_immutable)
@@ -2199,7 +2648,7 @@ bool DB::needs_file_format_upgrade(const std::string& file, Span<const char> enc
     try {
         alloc.attach_file(file, cfg);
         if (auto current_file_format_version = alloc.get_committed_file_format_version()) {
-            auto target_file_format_version = Group::g_current_file_format_version;
+            auto target_file_format_version = Group::get_current_file_format_version();
             return current_file_format_version < target_file_format_version;
         }
     }
@@ -2211,6 +2660,81 @@ bool DB::needs_file_format_upgrade(const std::string& file, Span<const char> enc
     return false;
 }
 
+void DB::set_memory_limits()
+{
+    m_alloc.set_mapping_limit(m_mapped_memory_limit);
+#if REALM_ENABLE_ENCRYPTION
+    if (auto encryption = m_alloc.get_file().get_encryption()) {
+        encryption->set_page_budget(m_decrypted_page_cache_size / util::EncryptedFile::page_size);
+    }
+#endif // REALM_ENABLE_ENCRYPTION
+}
+
+void DB::get_stats(DecryptedPageStats& stats) const
+{
+    stats = {};
+#if REALM_ENABLE_ENCRYPTION
+    if (auto encryption = m_alloc.get_file().get_encryption()) {
+        auto page_stats = encryption->get_page_stats();
+        stats.memory = page_stats.pages * util::EncryptedFile::page_size;
+        stats.memory_limit = page_stats.page_budget * util::EncryptedFile::page_size;
+        stats.hits = page_stats.hits;
+        stats.misses = page_stats.misses;
+        stats.read_ahead = page_stats.read_ahead;
+        stats.evictions = page_stats.evictions;
+    }
+#endif // REALM_ENABLE_ENCRYPTION
+}
+
+void DB::get_stats(MappingStats& stats) const
+{
+    stats = m_alloc.get_mapping_stats();
+}
+
+void DB::LatencyHistogram::record(std::chrono::microseconds duration) noexcept
+{
+    auto micros = duration.count();
+    size_t bucket = micros <= 0 ? 0 : std::min(size_t(log2(size_t(micros)) + 1), num_buckets - 1);
+    ++buckets[bucket];
+    ++count;
+    total += duration;
+    max = std::max(max, duration);
+}
+
+std::chrono::microseconds DB::LatencyHistogram::percentile(double fraction) const noexcept
+{
+    uint64_t target = uint64_t(std::ceil(fraction * count));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < num_buckets; ++i) {
+        seen += buckets[i];
+        if (seen >= target && seen > 0)
+            return std::min(std::chrono::microseconds(int64_t(1) << i), max);
+    }
+    return max;
+}
+
+void DB::get_stats(Metrics& metrics) const
+{
+    CheckedLockGuard lock(m_mutex);
+    metrics = m_metrics;
+    metrics.active_read_locks = m_local_locks_held.size();
+}
+
+void DB::reset_metrics()
+{
+    CheckedLockGuard lock(m_mutex);
+    // The state of the file as of the last commit is kept
+    Metrics metrics;
+    metrics.live_versions = m_metrics.live_versions;
+    metrics.oldest_live_version = m_metrics.oldest_live_version;
+    metrics.newest_version = m_metrics.newest_version;
+    metrics.file_size = m_metrics.file_size;
+    metrics.pinned_space = m_metrics.pinned_space;
+    metrics.evacuation_stage = m_metrics.evacuation_stage;
+    metrics.evacuation_limit = m_metrics.evacuation_limit;
+    m_metrics = metrics;
+}
+
 void DB::upgrade_file_format(bool allow_file_format_upgrade, int target_file_format_version,
                              int current_hist_schema_version, int target_hist_schema_version)
 {
@@ -2311,7 +2835,8 @@ void DB::do_release_read_lock(ReadLockInfo& read_lock) noexcept
     // simple linear search and move-last-over if a match is found.
     // common case should have only a modest number of transactions in play..
     for (size_t j = 0; j < m_local_locks_held.size(); ++j) {
-        if (m_local_locks_held[j].m_version == read_lock.m_version) {
+        if (m_local_locks_held[j].m_version == read_lock.m_version &&
+            m_local_locks_held[j].m_type == read_lock.m_type) {
             m_local_locks_held[j] = m_local_locks_held.back();
             m_local_locks_held.pop_back();
             found_match = true;
@@ -2336,6 +2861,7 @@ DB::ReadLockInfo DB::grab_read_lock(ReadLockInfo::Type type, VersionID version_i
 
     m_local_locks_held.emplace_back(read_lock);
     ++m_transaction_count;
+    ++m_metrics.read_locks;
     REALM_ASSERT(read_lock.m_file_size > read_lock.m_top_ref);
     return read_lock;
 }
@@ -2346,7 +2872,8 @@ void DB::leak_read_lock(ReadLockInfo& read_lock) noexcept
     // simple linear search and move-last-over if a match is found.
     // common case should have only a modest number of transactions in play..
     for (size_t j = 0; j < m_local_locks_held.size(); ++j) {
-        if (m_local_locks_held[j].m_version == read_lock.m_version) {
+        if (m_local_locks_held[j].m_version == read_lock.m_version &&
+            m_local_locks_held[j].m_type == read_lock.m_type) {
             m_local_locks_held[j] = m_local_locks_held.back();
             m_local_locks_held.pop_back();
             --m_transaction_count;
@@ -2360,9 +2887,10 @@ bool DB::do_try_begin_write()
     // In the non-blocking case, we will only succeed if there is no contention for
     // the write mutex. For this case we are trivially fair and can ignore the
     // fairness machinery.
+    auto start = std::chrono::steady_clock::now();
     bool got_the_lock = m_writemutex.try_lock();
     if (got_the_lock) {
-        finish_begin_write();
+        finish_begin_write(start);
     }
     return got_the_lock;
 }
@@ -2374,6 +2902,7 @@ void DB::do_begin_write()
     }
 
     SharedInfo* info = m_info;
+    auto start = std::chrono::steady_clock::now();
 
     // Get write lock - the write lock is held until do_end_write().
     //
@@ -2430,13 +2959,13 @@ void DB::do_begin_write()
     // In doing so, we may bypass other waiters, hence the condition for yielding
     // should take this situation into account by comparing with '>' instead of '!='
     info->next_served = my_ticket;
-    finish_begin_write();
+    finish_begin_write(start);
     if (m_logger) {
         m_logger->log(util::LogCategory::transaction, util::Logger::Level::trace, "writemutex acquired");
     }
 }
 
-void DB::finish_begin_write()
+void DB::finish_begin_write(std::chrono::steady_clock::time_point start)
 {
     if (m_info->commit_in_critical_phase) {
         m_writemutex.unlock();
@@ -2447,6 +2976,8 @@ void DB::finish_begin_write()
     {
         CheckedLockGuard local_lock(m_mutex);
         m_write_transaction_open = true;
+        m_metrics.begin_write_wait.record(
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start));
     }
     m_alloc.set_read_only(false);
 }
@@ -2455,19 +2986,38 @@ void DB::do_end_write() noexcept
 {
     m_info->next_served.fetch_add(1, std::memory_order_relaxed);
 
-    CheckedLockGuard local_lock(m_mutex);
-    REALM_ASSERT(m_write_transaction_open);
-    m_alloc.set_read_only(true);
-    m_write_transaction_open = false;
-    m_pick_next_writer.notify_all();
-    m_writemutex.unlock();
-    if (m_logger) {
-        m_logger->log(util::LogCategory::transaction, util::Logger::Level::trace, "writemutex released");
+    std::optional<PinnedVersion> pinned;
+    {
+        CheckedLockGuard local_lock(m_mutex);
+        REALM_ASSERT(m_write_transaction_open);
+        m_alloc.set_read_only(true);
+        m_write_transaction_open = false;
+        pinned = std::move(m_pending_pinned_version);
+        m_pending_pinned_version.reset();
+        m_pick_next_writer.notify_all();
+        m_writemutex.unlock();
+        if (m_logger) {
+            m_logger->log(util::LogCategory::transaction, util::Logger::Level::trace, "writemutex released");
+        }
+    }
+
+    // Called without any lock held, so the handler may use the DB, for
+    // instance to release the transactions pinning the version
+    if (pinned) {
+        try {
+            m_pinned_version_handler(*pinned);
+        }
+        catch (const std::exception& e) {
+            if (m_logger) {
+                m_logger->log(util::LogCategory::storage, util::Logger::Level::error,
+                              "Pinned version handler failed: %1", e.what());
+            }
+        }
     }
 }
 
 
-Replication::version_type DB::do_commit(Transaction& transaction, bool commit_to_disk)
+Replication::version_type DB::do_commit(Transaction& transaction, bool commit_to_disk, bool group_commit)
 {
     version_type current_version;
     {
@@ -2475,6 +3025,15 @@ Replication::version_type DB::do_commit(Transaction& transaction, bool commit_to
     }
     version_type new_version = current_version + 1;
 
+    // With group commits the new version is made durable afterwards by
+    // sync_group_commits(), together with the versions committed meanwhile
+    REALM_ASSERT(!group_commit || (commit_to_disk && uses_group_commit()));
+    if (group_commit && !m_group_persisted_lock) {
+        // The version referenced by the file header must not be overwritten
+        // until the header references a newer one
+        m_group_persisted_lock = m_version_manager->grab_read_lock(ReadLockInfo::Frozen); // Throws
+    }
+
     if (!transaction.m_tables_to_clear.empty()) {
         for (auto table_key : transaction.m_tables_to_clear) {
             transaction.get_table_unchecked(table_key)->clear();
@@ -2486,12 +3045,12 @@ Replication::version_type DB::do_commit(Transaction& transaction, bool commit_to
         // fails. The application then has the option of terminating the
         // transaction with a call to Transaction::Rollback(), which in turn
         // must call Replication::abort_transact().
-        new_version = repl->prepare_commit(current_version);        // Throws
-        low_level_commit(new_version, transaction, commit_to_disk); // Throws
+        new_version = repl->prepare_commit(current_version);                          // Throws
+        low_level_commit(new_version, transaction, commit_to_disk && !group_commit); // Throws
         repl->finalize_commit();
     }
     else {
-        low_level_commit(new_version, transaction); // Throws
+        low_level_commit(new_version, transaction, !group_commit); // Throws
     }
 
     {
@@ -2521,6 +3080,15 @@ DB::version_type DB::get_version_of_latest_snapshot()
 void DB::low_level_commit(uint_fast64_t new_version, Transaction& transaction, bool commit_to_disk)
 {
     SharedInfo* info = m_info;
+    auto commit_start = std::chrono::steady_clock::now();
+
+    if (m_write_ahead_log) {
+        // The first commit of the session locks the version referenced by the
+        // file header, and commits finding the log too large fold it into the file
+        if (!info->checkpoint_locked || m_write_ahead_log->size() >= m_max_write_ahead_log_size)
+            checkpoint_write_ahead_log(transaction.get_file_format_version()); // Throws
+        m_write_ahead_log->begin_commit();
+    }
 
     // Version of oldest snapshot currently (or recently) bound in a transaction
     // of the current session.
@@ -2547,6 +3115,8 @@ void DB::low_level_commit(uint_fast64_t new_version, Transaction& transaction, b
 
     GroupWriter out(transaction, Durability(info->durability), m_marker_observer.get()); // Throws
     out.set_versions(new_version, top_refs, any_new_unreachables);
+    out.set_compression(m_compress_integer_leaves);
+    out.set_write_ahead_log(m_write_ahead_log.get());
     out.prepare_evacuation();
     auto t1 = std::chrono::steady_clock::now();
     auto commit_size = m_alloc.get_commit_size();
@@ -2562,26 +3132,59 @@ void DB::low_level_commit(uint_fast64_t new_version, Transaction& transaction, b
     }
 
     ref_type new_top_ref;
+    auto write_start = std::chrono::steady_clock::now();
     // Recursively write all changed arrays to end of file
     {
         // protect against race with any other DB trying to attach to the file
         std::lock_guard<InterprocessMutex> lock(m_controlmutex); // Throws
         new_top_ref = out.write_group();                         // Throws
     }
+    auto t_written = std::chrono::steady_clock::now();
     {
         // protect access to shared variables and m_reader_mapping from here
         CheckedLockGuard lock_guard(m_mutex);
         m_free_space = out.get_free_space_size();
         m_locked_space = out.get_locked_space_size();
         m_used_space = out.get_logical_size() - m_free_space;
+        m_free_list_stats.free_chunks = out.get_free_chunk_count();
+        m_free_list_stats.locked_chunks = out.get_locked_chunk_count();
+        m_free_list_stats.largest_free_chunk = out.get_largest_free_chunk();
+        m_free_list_stats.time = out.get_free_list_time();
         m_evac_stage.store(EvacStage(out.get_evacuation_stage()));
-        out.sync_according_to_durability();
-        if (Durability(info->durability) == Durability::Full || Durability(info->durability) == Durability::Unsafe) {
+        m_metrics.bytes_written += out.get_bytes_written();
+        m_metrics.last_commit_bytes = out.get_bytes_written();
+        m_metrics.write_group.record(std::chrono::duration_cast<std::chrono::microseconds>(t_written - write_start));
+        m_metrics.free_list.record(out.get_free_list_time());
+        m_metrics.live_versions = live_versions + 1;
+        m_metrics.oldest_live_version = oldest_version;
+        m_metrics.newest_version = new_version;
+        m_metrics.file_size = out.get_logical_size();
+        m_metrics.pinned_space = m_locked_space;
+        m_metrics.evacuation_stage = m_evac_stage;
+        m_metrics.evacuation_limit = out.get_evacuation_limit();
+        if (m_write_ahead_log) {
+            // The data is synced by the next checkpoint. Commits which are
+            // not committed to disk are synced along with the next one which is.
+            out.flush_all_mappings();
+            m_write_ahead_log->end_commit(new_version, new_top_ref, out.get_logical_size(), commit_to_disk); // Throws
+        }
+        else if (commit_to_disk || !m_group_persisted_lock) {
+            out.sync_according_to_durability();
+        }
+        else {
+            // The data is synced by sync_group_commits() together with the
+            // data of the other commits
+            out.flush_all_mappings();
+        }
+        if (Durability(info->durability) == Durability::Full || Durability(info->durability) == Durability::Unsafe ||
+            (Durability(info->durability) == Durability::WriteAheadLog && !m_write_ahead_log)) {
             if (commit_to_disk) {
                 GroupCommitter cm(transaction, Durability(info->durability), m_marker_observer.get());
                 cm.commit(new_top_ref);
             }
         }
+        m_metrics.sync.record(
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t_written));
         size_t new_file_size = out.get_logical_size();
         // We must reset the allocators free space tracking before communicating the new
         // version through the ring buffer. If not, a reader may start updating the allocators
@@ -2613,12 +3216,60 @@ void DB::low_level_commit(uint_fast64_t new_version, Transaction& transaction, b
         m_new_commit_available.notify_all();
     }
     auto t2 = std::chrono::steady_clock::now();
+    {
+        CheckedLockGuard lock(m_mutex);
+        ++m_metrics.commits;
+        m_metrics.commit.record(std::chrono::duration_cast<std::chrono::microseconds>(t2 - commit_start));
+    }
     if (m_logger) {
         std::string to_disk_str = commit_to_disk ? util::format(" ref %1", new_top_ref) : " (no commit to disk)";
         m_logger->log(util::LogCategory::transaction, util::Logger::Level::debug, "Commit of size %1 done in %2 us%3",
                       commit_size, std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count(),
                       to_disk_str);
     }
+    check_pinned_version(oldest_version, live_versions);
+}
+
+void DB::check_pinned_version(version_type oldest_version, size_t live_versions)
+{
+    if (m_pinned_version_age_limit.count() == 0 && m_pinned_space_limit == 0)
+        return;
+
+    // The version committed before is always kept, so a version is pinned
+    // only if there are more
+    PinnedVersion pinned;
+    if (live_versions > 1 && oldest_version != m_reported_pinned_version &&
+        m_version_manager->get_pinned_version(oldest_version, pinned)) {
+        {
+            CheckedLockGuard lock(m_mutex);
+            pinned.pinned_space = m_locked_space;
+            for (auto& read_lock : m_local_locks_held) {
+                if (read_lock.m_version == oldest_version) {
+                    ++pinned.local_transactions;
+                    if (read_lock.m_type == ReadLockInfo::Frozen)
+                        ++pinned.local_frozen_transactions;
+                }
+            }
+        }
+        bool too_old = m_pinned_version_age_limit.count() > 0 && pinned.age >= m_pinned_version_age_limit;
+        bool too_large = m_pinned_space_limit > 0 && pinned.pinned_space >= m_pinned_space_limit;
+        if (too_old || too_large) {
+            m_reported_pinned_version = oldest_version;
+            if (m_logger) {
+                m_logger->log(util::LogCategory::storage, util::Logger::Level::warn,
+                              "Version %1 superseded %2 s ago is kept alive by %3 live, %4 frozen and %5 full "
+                              "transactions, %6 of them in this DB, last started by process %7. It keeps %8 bytes "
+                              "of the file from being reused.",
+                              pinned.version, pinned.age.count(), pinned.live_transactions,
+                              pinned.frozen_transactions, pinned.full_transactions, pinned.local_transactions,
+                              pinned.last_reader_pid, pinned.pinned_space);
+            }
+            if (m_pinned_version_handler) {
+                CheckedLockGuard lock(m_mutex);
+                m_pending_pinned_version = pinned;
+            }
+        }
+    }
 }
 
 #ifdef REALM_DEBUG
@@ -2657,6 +3308,8 @@ std::string DB::get_core_file(const std::string& base_path, CoreFileType type)
             return base_path + ".note";
         case CoreFileType::Log:
             return base_path + ".log";
+        case CoreFileType::Wal:
+            return base_path + ".wal";
     }
     REALM_UNREACHABLE();
 }
@@ -2669,6 +3322,7 @@ void DB::delete_files(const std::string& base_path, bool* did_delete, bool delet
 
     File::try_remove(get_core_file(base_path, CoreFileType::Note));
     File::try_remove(get_core_file(base_path, CoreFileType::Log));
+    File::try_remove(get_core_file(base_path, CoreFileType::Wal));
     util::try_remove_dir_recursive(get_core_file(base_path, CoreFileType::Management));
 
     if (delete_lockfile) {
@@ -2804,6 +3458,14 @@ void DB::async_request_write_mutex(TransactionRef& tr, util::UniqueFunction<void
 inline DB::DB(Private, const DBOptions& options)
     : m_upgrade_callback(std::move(options.upgrade_callback))
     , m_log_id(util::gen_log_id(this))
+    , m_compress_integer_leaves(options.compress_integer_leaves)
+    , m_group_commit(options.group_commit)
+    , m_max_write_ahead_log_size(options.max_write_ahead_log_size)
+    , m_decrypted_page_cache_size(options.decrypted_page_cache_size)
+    , m_mapped_memory_limit(options.mapped_memory_limit)
+    , m_pinned_version_age_limit(options.pinned_version_age_limit)
+    , m_pinned_space_limit(options.pinned_space_limit)
+    , m_pinned_version_handler(options.pinned_version_handler)
 {
     if (options.enable_async_writes) {
         m_commit_helper = std::make_unique<AsyncCommitHelper>(this);
@@ -33,15 +33,19 @@
 #include <realm/util/encrypted_file_mapping.hpp>
 #include <realm/version_id.hpp>
 
+#include <array>
 #include <functional>
 #include <cstdint>
 #include <limits>
+#include <chrono>
 #include <condition_variable>
+#include <optional>
 
 namespace realm {
 
 class Transaction;
 using TransactionRef = std::shared_ptr<Transaction>;
+class WriteAheadLog;
 
 /// Thrown by DB::create() if the lock file is already open in another
 /// process which can't share mutexes with this process
@@ -279,6 +283,99 @@ public:
     // Notice that we will always have two live versions - the current and the
     // previous.
     void get_stats(size_t& free_space, size_t& used_space, size_t* locked_space = nullptr) const REQUIRES(!m_mutex);
+
+    // Statistics of the free list written by the last commit done on THIS DB.
+    struct FreeListStats {
+        // Number of chunks of free space which can be reused
+        size_t free_chunks = 0;
+        // Number of chunks which are free in the current version, but still
+        // used by live versions
+        size_t locked_chunks = 0;
+        // Size of the largest chunk which can be reused
+        size_t largest_free_chunk = 0;
+        // Time spent reading in, merging and recreating the free list
+        std::chrono::microseconds time{0};
+    };
+    void get_stats(FreeListStats& stats) const REQUIRES(!m_mutex);
+
+    // Statistics of the decrypted pages of an encrypted file, shared by all
+    // DB objects of the file in this process. All zero if the file isn't
+    // encrypted.
+    struct DecryptedPageStats {
+        // Memory used by decrypted pages, and the limit set by
+        // DBOptions::decrypted_page_cache_size
+        size_t memory = 0;
+        size_t memory_limit = 0;
+        // Pages which were decrypted already when accessed, and which had to
+        // be decrypted
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        // Pages decrypted ahead of sequential reads
+        uint64_t read_ahead = 0;
+        // Pages released to stay within the limit
+        uint64_t evictions = 0;
+    };
+    void get_stats(DecryptedPageStats& stats) const;
+
+    // Size of the mappings of the file, the part of them in memory, the limit
+    // set by DBOptions::mapped_memory_limit and the number of chunks released
+    using MappingStats = SlabAlloc::MappingStats;
+    void get_stats(MappingStats& stats) const;
+
+    // Distribution of durations. Bucket 0 counts durations below 1 us, and
+    // bucket i counts durations from 2^(i-1) us up to 2^i us.
+    struct LatencyHistogram {
+        static constexpr size_t num_buckets = 32;
+        std::array<uint64_t, num_buckets> buckets{};
+        uint64_t count = 0;
+        std::chrono::microseconds total{0};
+        std::chrono::microseconds max{0};
+
+        void record(std::chrono::microseconds duration) noexcept;
+        // Upper bound of the durations of the given fraction of the recorded
+        // durations, e.g. 0.99 for the 99th percentile
+        std::chrono::microseconds percentile(double fraction) const noexcept;
+    };
+
+    enum class EvacStage { idle, evacuating, waiting, blocked };
+
+    // Counters and latencies of the transactions of THIS DB since it was
+    // opened, and the versions and space of the file as of its last commit.
+    struct Metrics {
+        // Write transactions committed, and the bytes they wrote to the file
+        uint64_t commits = 0;
+        uint64_t bytes_written = 0;
+        uint64_t last_commit_bytes = 0;
+        // Time waiting for the write lock in begin_write()
+        LatencyHistogram begin_write_wait;
+        // Time of commits, and of their phases: writing the changed arrays and
+        // the free list, recreating the free list, and making them durable
+        LatencyHistogram commit;
+        LatencyHistogram write_group;
+        LatencyHistogram free_list;
+        LatencyHistogram sync;
+        // Read locks taken, and read locks held now
+        uint64_t read_locks = 0;
+        size_t active_read_locks = 0;
+        // Versions kept alive by transactions in any process, the oldest of
+        // them and the newest version
+        uint64_t live_versions = 0;
+        version_type oldest_live_version = 0;
+        version_type newest_version = 0;
+        // Size of the file, and the space freed by newer versions but which
+        // cannot be reused while older versions are alive
+        size_t file_size = 0;
+        size_t pinned_space = 0;
+        // Compaction of the file by moving data out of its end
+        EvacStage evacuation_stage = EvacStage::idle;
+        size_t evacuation_limit = 0;
+    };
+    void get_stats(Metrics& metrics) const REQUIRES(!m_mutex);
+    void reset_metrics() REQUIRES(!m_mutex);
+
+    // The oldest version kept alive by transactions, see
+    // DBOptions::pinned_version_age_limit
+    using PinnedVersion = DBOptions::PinnedVersion;
     //@}
 
     enum TransactStage {
@@ -288,8 +385,6 @@ public:
         transact_Frozen,
     };
 
-    enum class EvacStage { idle, evacuating, waiting, blocked };
-
     EvacStage get_evacuation_stage() const
     {
         return m_evac_stage;
@@ -332,6 +427,41 @@ public:
 
     void write_copy(std::string_view path, const char* output_encryption_key) REQUIRES(!m_mutex);
 
+    /// With Durability::WriteAheadLog, sync the file, make its header reference
+    /// the newest version and clear the write-ahead log. Waits for the write
+    /// mutex, so it can be called from a background thread to keep the checkpoints
+    /// out of the commits. Does nothing with other durabilities.
+    void checkpoint() REQUIRES(!m_mutex);
+
+    struct PrefetchOptions {
+        struct Table {
+            std::string name;
+            // The columns whose data is read. All columns if empty.
+            std::vector<std::string> columns;
+            // Also read the search indexes of the columns
+            bool search_indexes = false;
+        };
+        // Tables whose data is read, in addition to the top of the file and
+        // the table accessors and cluster tree nodes above the leaves of all
+        // tables
+        std::vector<Table> tables;
+        // Number of threads reading in parallel. Zero means one per hardware
+        // thread.
+        size_t num_threads = 0;
+        // Called after each level of the trees is read, with the number of
+        // arrays and bytes read so far. Returning false stops the prefetch.
+        std::function<bool(size_t arrays, size_t bytes)> progress;
+    };
+    /// Read the newest version of the file into memory ahead of use, so that
+    /// the first queries after opening the file don't wait for the pages they
+    /// access to be read one by one. The arrays of each level of the trees are
+    /// read in parallel, and arrays larger than a page are read in with one
+    /// request. Throws if a table or column does not exist. An exception thrown
+    /// while reading, such as std::bad_alloc, is rethrown once all threads
+    /// have stopped. Can be called from a background thread right after the
+    /// DB is opened.
+    void prefetch(const PrefetchOptions& options);
+
 #ifdef REALM_DEBUG
     void test_ringbuf();
 #endif
@@ -406,6 +536,7 @@ public:
         Management,
         Note,
         Log,
+        Wal,
     };
 
     /// Get the path for the given type of file for a base Realm file path.
@@ -489,6 +620,8 @@ private:
     size_t m_free_space GUARDED_BY(m_mutex) = 0;
     size_t m_locked_space GUARDED_BY(m_mutex) = 0;
     size_t m_used_space GUARDED_BY(m_mutex) = 0;
+    FreeListStats m_free_list_stats GUARDED_BY(m_mutex);
+    Metrics m_metrics GUARDED_BY(m_mutex);
     std::vector<ReadLockInfo> m_local_locks_held GUARDED_BY(m_mutex); // tracks all read locks held by this DB
     std::atomic<EvacStage> m_evac_stage = EvacStage::idle;
     util::File m_file;
@@ -515,6 +648,33 @@ private:
     // The path cannot be used as this would not allow us to distinguish between two DBs opening
     // the same realm.
     unsigned m_log_id;
+    const bool m_compress_integer_leaves;
+
+    // Group commits, see DBOptions::group_commit
+    const bool m_group_commit;
+    util::CheckedMutex m_group_commit_mutex;
+    std::condition_variable m_group_commit_cv;
+    bool m_group_sync_in_progress GUARDED_BY(m_group_commit_mutex) = false;
+    version_type m_group_synced_version GUARDED_BY(m_group_commit_mutex) = 0;
+    // Lock on the version referenced by the file header while there are
+    // commits which are not yet on disk, so that its space isn't reused.
+    // Only accessed while holding the write mutex, or on close.
+    std::optional<ReadLockInfo> m_group_persisted_lock;
+
+    // Write-ahead log, see Durability::WriteAheadLog. Null with other durabilities.
+    std::unique_ptr<WriteAheadLog> m_write_ahead_log;
+    const size_t m_max_write_ahead_log_size;
+    const size_t m_decrypted_page_cache_size;
+    const size_t m_mapped_memory_limit;
+
+    // Reporting of pinned versions, see DBOptions::PinnedVersion
+    const std::chrono::seconds m_pinned_version_age_limit;
+    const size_t m_pinned_space_limit;
+    const std::function<void(const PinnedVersion&)> m_pinned_version_handler;
+    // Only accessed while holding the write mutex
+    version_type m_reported_pinned_version = 0;
+    // Passed to the handler once the write lock is released
+    std::optional<PinnedVersion> m_pending_pinned_version GUARDED_BY(m_mutex);
 
     /// Attach this DB instance to the specified database file.
     ///
@@ -593,7 +753,9 @@ private:
     bool do_try_begin_write() REQUIRES(!m_mutex);
     void do_begin_write() REQUIRES(!m_mutex);
     void do_begin_possibly_async_write() REQUIRES(!m_mutex);
-    version_type do_commit(Transaction&, bool commit_to_disk = true) REQUIRES(!m_mutex);
+    // If `group_commit` is set, the new version is not synced to disk, and the
+    // caller must call wait_for_group_commit() after releasing the write mutex
+    version_type do_commit(Transaction&, bool commit_to_disk = true, bool group_commit = false) REQUIRES(!m_mutex);
     void do_end_write() noexcept REQUIRES(!m_mutex);
     void end_write_on_correct_thread() noexcept REQUIRES(!m_mutex);
     // Must be called only by someone that has a lock on the write mutex.
@@ -602,14 +764,31 @@ private:
 
     void do_async_commits();
 
+    bool uses_group_commit() const noexcept;
+    // Returns once `version`, committed by do_commit() as a group commit, is
+    // on disk. Must be called after releasing the write mutex.
+    void wait_for_group_commit(Transaction&, version_type version) REQUIRES(!m_group_commit_mutex);
+    version_type sync_group_commits(Transaction&);
+
+    // Must be called only by someone that has a lock on the write mutex.
+    void checkpoint_write_ahead_log(int file_format_version);
+
     /// Upgrade file format and/or history schema
     void upgrade_file_format(bool allow_file_format_upgrade, int target_file_format_version,
                              int current_hist_schema_version, int target_hist_schema_version) REQUIRES(!m_mutex);
 
     int get_file_format_version() const noexcept;
 
+    // Apply DBOptions::decrypted_page_cache_size and mapped_memory_limit after
+    // attaching the file
+    void set_memory_limits();
+
     /// finish up the process of starting a write transaction. Internal use only.
-    void finish_begin_write() REQUIRES(!m_mutex);
+    void finish_begin_write(std::chrono::steady_clock::time_point start) REQUIRES(!m_mutex);
+    // Report the oldest live version if it exceeds the limits set by
+    // DBOptions::pinned_version_age_limit and pinned_space_limit. Called by
+    // commits; the handler is called by do_end_write().
+    void check_pinned_version(version_type oldest_version, size_t live_versions) REQUIRES(!m_mutex);
 
     void reset_free_space_tracking()
     {
@@ -637,6 +816,12 @@ inline void DB::get_stats(size_t& free_space, size_t& used_space, size_t* locked
     }
 }
 
+inline void DB::get_stats(FreeListStats& stats) const
+{
+    util::CheckedLockGuard lock(m_mutex);
+    stats = m_free_list_stats;
+}
+
 
 class DisableReplication {
 public:
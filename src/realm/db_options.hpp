@@ -19,6 +19,8 @@
 #ifndef REALM_GROUP_SHARED_OPTIONS_HPP
 #define REALM_GROUP_SHARED_OPTIONS_HPP
 
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <string>
 #include <realm/backup_restore.hpp>
@@ -31,7 +33,12 @@ struct DBOptions {
     enum class Durability : uint16_t {
         Full,
         MemOnly,
-        Unsafe // If you use this, you loose ACID property
+        Unsafe, // If you use this, you loose ACID property
+        // Commits are made durable by appending the arrays they write to a
+        // write-ahead log next to the file, with a single sync. The file is
+        // synced and its header updated at checkpoints. Not supported for
+        // encrypted files. Behaves like Full on Windows.
+        WriteAheadLog
     };
 
     explicit DBOptions(Durability level = Durability::Full, const char* key = nullptr)
@@ -102,10 +109,83 @@ struct DBOptions {
     /// a performance impact.
     bool enable_async_writes = false;
 
+    /// If set, write transactions committed with Transaction::commit() by
+    /// several threads while an earlier commit is being synchronized to disk
+    /// are made durable together, by one update of the file header and one
+    /// sync, instead of one after the other. commit() still returns only once
+    /// the new version is on disk, but other threads may see the version
+    /// before that. As commit() may have to wait for the write mutex, it must
+    /// not be called while holding a lock that another writer may need. Only
+    /// applies to Durability::Full, and is not supported on Windows.
+    bool group_commit = false;
+
+    /// With Durability::WriteAheadLog, a commit which finds the write-ahead log
+    /// larger than this first makes a checkpoint, which syncs the Realm file,
+    /// makes its header reference the newest version and clears the log. A
+    /// checkpoint is also made by DB::checkpoint() and when a DB is closed.
+    size_t max_write_ahead_log_size = 16 * 1024 * 1024;
+
+    /// Limit on the memory used by the decrypted pages of an encrypted Realm
+    /// file, in bytes. Zero means no limit. Pages not accessed recently are
+    /// released once the limit is exceeded, but pages which a live transaction
+    /// may still access are kept, so the limit can be exceeded while old
+    /// transactions are kept open. Has no effect on Windows.
+    size_t decrypted_page_cache_size = 0;
+
+    /// Limit on the memory used by the mappings of an unencrypted Realm file,
+    /// in bytes. Zero means no limit. The file is mapped in 64 MB sections,
+    /// whose accesses are tracked in 1 MB chunks. Once more chunks than the
+    /// limit may be in memory, those not accessed recently are released from
+    /// the mappings and read back from the file when accessed again. This
+    /// bounds the resident memory, but not the address space used. Has no
+    /// effect on Windows.
+    size_t mapped_memory_limit = 0;
+
+    /// The oldest version of the file kept alive by transactions while newer
+    /// versions were committed. The space freed by the newer versions cannot
+    /// be reused while it is alive, so the file grows.
+    struct PinnedVersion {
+        uint64_t version = 0;
+        /// Time since a newer version was committed
+        std::chrono::seconds age{0};
+        /// Space freed since the version which cannot be reused, in bytes
+        size_t pinned_space = 0;
+        /// Transactions on the version in all processes, by type
+        uint32_t live_transactions = 0;
+        uint32_t frozen_transactions = 0;
+        uint32_t full_transactions = 0;
+        /// Process which last started a transaction on the version
+        uint32_t last_reader_pid = 0;
+        /// Transactions on the version started by the DB reporting it, and
+        /// how many of them are frozen
+        uint32_t local_transactions = 0;
+        uint32_t local_frozen_transactions = 0;
+    };
+
+    /// A commit which finds that the oldest version kept alive was superseded
+    /// by a newer version more than `pinned_version_age_limit` ago, or that it
+    /// keeps more than `pinned_space_limit` bytes from being reused, logs a
+    /// warning and calls `pinned_version_handler` if set. Each pinned version
+    /// is reported once by each DB. Zero disables a limit. The handler is
+    /// called once the write lock is released, on the thread which ends the
+    /// write transaction. Frozen transactions may be used on any thread, so
+    /// they are never closed by the DB; the handler can release them.
+    std::chrono::seconds pinned_version_age_limit{0};
+    size_t pinned_space_limit = 0;
+    std::function<void(const PinnedVersion&)> pinned_version_handler;
+
     /// If set, opening a file which is not a Realm file or cannot be decrypted
     /// will clear and reinitialize the file.
     bool clear_on_invalid_file = false;
 
+    /// If set, integer, link and timestamp column leaves modified by a commit
+    /// are written in a compressed encoding (bit packing relative to the
+    /// smallest value, or a dictionary of the distinct values) when that makes
+    /// them smaller. Compressed leaves are read in place, and expanded again
+    /// when modified. Files written with this enabled cannot be read by
+    /// versions of Realm that do not support compressed leaves.
+    bool compress_integer_leaves = false;
+
     /// sys_tmp_dir will be used if the temp_dir is empty when creating DBOptions.
     /// It must be writable and allowed to create pipe/fifo file on it.
     /// set_sys_tmp_dir is not a thread-safe call and it is only supposed to be called once
@@ -324,12 +324,8 @@ int Group::get_target_file_format_version_for_session(int current_file_format_ve
     // Please see Group::get_file_format_version() for information about the
     // individual file format versions.
 
-    if (requested_history_type == Replication::hist_None) {
-        if (current_file_format_version == 24) {
-            // We are able to open these file formats in RO mode
-            return current_file_format_version;
-        }
-    }
+    static_cast<void>(current_file_format_version);
+    static_cast<void>(requested_history_type);
 
     return g_current_file_format_version;
 }
@@ -419,6 +415,9 @@ int Group::read_only_version_check(SlabAlloc& alloc, ref_type top_ref, const std
         case 0:
             file_format_ok = (top_ref == 0);
             break;
+        case 24:
+            // Version 25 only adds to version 24, so these files can be read
+            // as they are
         case g_current_file_format_version:
             file_format_ok = true;
             break;
@@ -437,16 +436,12 @@ void Group::open(ref_type top_ref, const std::string& file_path)
     SlabAlloc::DetachGuard dg(m_alloc);
     m_file_format_version = read_only_version_check(m_alloc, top_ref, file_path);
 
-    Replication::HistoryType history_type = Replication::hist_None;
-    int target_file_format_version = get_target_file_format_version_for_session(m_file_format_version, history_type);
+    // From a technical point of view, we could upgrade the Realm file format
+    // in memory here, but since upgrading can be expensive, it is currently
+    // disallowed, and a version 24 file is read as it is.
     if (m_file_format_version == 0) {
-        set_file_format_version(target_file_format_version);
-    }
-    else {
-        // From a technical point of view, we could upgrade the Realm file
-        // format in memory here, but since upgrading can be expensive, it is
-        // currently disallowed.
-        REALM_ASSERT(target_file_format_version == m_file_format_version);
+        Replication::HistoryType history_type = Replication::hist_None;
+        set_file_format_version(get_target_file_format_version_for_session(m_file_format_version, history_type));
     }
 
     // Make all dynamically allocated memory (space beyond the attached file) as
@@ -1039,8 +1034,9 @@ void Group::write(std::ostream& out, int file_format_version, TableWriter& table
     if (no_top_array) {
         file_format_version = 0;
     }
-    else if (file_format_version == 0) {
-        // Use current file format version
+    else if (file_format_version == 0 || file_format_version == 24) {
+        // Use current file format version. A group read from a version 24
+        // file may have been given what version 25 adds since.
         file_format_version = get_target_file_format_version_for_session(0, Replication::hist_None);
     }
     SlabAlloc::init_streaming_header(&streaming_header, file_format_version);
@@ -1524,6 +1520,22 @@ private:
 
 #endif
 
+ref_type Group::typed_write_tables(_impl::ArrayWriterBase& out) const
+{
+    ref_type ref = m_tables.get_ref();
+    if (m_alloc.is_read_only(ref))
+        return ref;
+
+    return m_tables.write_deep(out, [&](size_t ndx, ref_type table_ref) {
+        // The column types are only known to the table accessor, so tables
+        // without one are written without compression
+        Table* table = ndx < m_table_accessors.size() ? m_table_accessors[ndx] : nullptr;
+        if (table)
+            return table->typed_write(table_ref, out);      // Throws
+        return Array::write(table_ref, m_alloc, out, true); // Throws
+    });
+}
+
 void Group::verify() const
 {
 #ifdef REALM_DEBUG
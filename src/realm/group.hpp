@@ -763,6 +763,16 @@ private:
     ///     Backlinks in BPlusTree
     ///     Sort order of Strings changed (affects sets and the string index)
     ///
+    ///  25 Compressed integer leaves (width type wtype_Extend), written when
+    ///     DBOptions::compress_integer_leaves is set.
+    ///     Sorted search indexes (col_attr_Sorted_Indexed), which older
+    ///     versions would not update when the column changes.
+    ///     Composite indexes (slot 14 of the table top array), which older
+    ///     versions would also leave stale.
+    ///     Version 24 files are upgraded without changes, but older versions
+    ///     of the library cannot read these, so they must not open version 25
+    ///     files.
+    ///
     /// IMPORTANT: When introducing a new file format version, be sure to review
     /// the file validity checks in Group::open() and DB::do_open, the file
     /// format selection logic in
@@ -770,7 +780,7 @@ private:
     /// upgrade logic in Group::upgrade_file_format(), AND the lists of accepted
     /// file formats and the version deletion list residing in "backup_restore.cpp"
 
-    static constexpr int g_current_file_format_version = 24;
+    static constexpr int g_current_file_format_version = 25;
 
     int get_file_format_version() const noexcept;
     void set_file_format_version(int) noexcept;
@@ -792,6 +802,9 @@ private:
     {
         return get_logical_file_size(m_top);
     }
+    // Write the modified tables like `m_tables.write()` does, but compress the
+    // integer column leaves of tables with an accessor. Used by GroupWriter.
+    ref_type typed_write_tables(_impl::ArrayWriterBase& out) const;
     void clear_history();
     void set_history_schema_version(int version);
     template <class Accessor>
@@ -29,6 +29,7 @@
 #include <realm/impl/destroy_guard.hpp>
 #include <realm/impl/simulated_failure.hpp>
 #include <realm/util/safe_int_ops.hpp>
+#include <realm/write_ahead_log.hpp>
 
 using namespace realm;
 using namespace realm::util;
@@ -230,10 +231,16 @@ WriteWindowMgr::WriteWindowMgr(SlabAlloc& alloc, Durability dura, WriteMarker* w
 }
 
 GroupCommitter::GroupCommitter(Transaction& group, Durability dura, WriteMarker* write_marker)
-    : m_group(group)
-    , m_alloc(group.m_alloc)
+    : GroupCommitter(group.m_alloc, group.get_file_format_version(), dura, write_marker)
+{
+}
+
+GroupCommitter::GroupCommitter(SlabAlloc& alloc, int file_format_version, Durability dura,
+                               WriteMarker* write_marker)
+    : m_alloc(alloc)
+    , m_file_format_version(file_format_version)
     , m_durability(dura)
-    , m_window_mgr(group.m_alloc, dura, write_marker)
+    , m_window_mgr(alloc, dura, write_marker)
 {
 }
 
@@ -310,6 +317,7 @@ void GroupWriter::sync_according_to_durability()
     switch (m_durability) {
         case Durability::Full:
         case Durability::Unsafe:
+        case Durability::WriteAheadLog:
             m_window_mgr.sync_all_mappings();
             break;
         case Durability::MemOnly:
@@ -647,8 +655,10 @@ ref_type GroupWriter::write_group()
     ALLOC_DBG_COUT("Commit nr " << m_current_version << "   ( from " << m_oldest_reachable_version << " )"
                                 << std::endl);
 
+    auto t1 = std::chrono::steady_clock::now();
     read_in_freelist();
     // Now, 'm_size_map' holds all free elements candidate for recycling
+    auto t2 = std::chrono::steady_clock::now();
 
     Array& top = m_group.m_top;
     ALLOC_DBG_COUT("  Allocating file space for data:" << std::endl);
@@ -667,7 +677,8 @@ ref_type GroupWriter::write_group()
         writer = in_memory_writer.get();
     }
     ref_type names_ref = m_group.m_table_names.write(*writer, deep, only_if_modified); // Throws
-    ref_type tables_ref = m_group.m_tables.write(*writer, deep, only_if_modified);     // Throws
+    ref_type tables_ref = m_compress ? m_group.typed_write_tables(*writer)
+                                     : m_group.m_tables.write(*writer, deep, only_if_modified); // Throws
 
     int_fast64_t value_1 = from_ref(names_ref);
     int_fast64_t value_2 = from_ref(tables_ref);
@@ -805,7 +816,10 @@ ref_type GroupWriter::write_group()
     // Now, let's update the realm-style freelists, which will later be written to file.
     // Function returns index of element holding the space reserved for the free
     // lists in the file.
+    auto t3 = std::chrono::steady_clock::now();
     size_t reserve_ndx = recreate_freelist(reserve_pos);
+    auto t4 = std::chrono::steady_clock::now();
+    m_free_list_time = std::chrono::duration_cast<std::chrono::microseconds>((t2 - t1) + (t4 - t3));
 
     ALLOC_DBG_COUT("  Freelist size after merge: " << m_free_positions.size() << "   freelist space required: "
                                                    << max_free_space_needed << std::endl);
@@ -899,6 +913,7 @@ ref_type GroupWriter::write_group()
     m_free_positions.set(reserve_ndx, value_8); // Throws
     m_free_lengths.set(reserve_ndx, value_9);   // Throws
     m_free_space_size += rest;
+    m_largest_free_chunk = std::max(m_largest_free_chunk, rest);
 
 #if REALM_ALLOC_DEBUG
     std::cout << "  Final Freelist:" << std::endl;
@@ -1016,7 +1031,7 @@ void GroupWriter::read_in_freelist()
     merge_adjacent_entries_in_freelist(free_in_file);
     // Previous step produces - potentially - some entries with size of zero. These
     // entries will be skipped in the next step.
-    move_free_in_file_to_size_map(free_in_file, m_size_map);
+    move_free_in_file_to_size_map(free_in_file);
 }
 
 size_t GroupWriter::recreate_freelist(size_t reserve_pos)
@@ -1024,37 +1039,50 @@ size_t GroupWriter::recreate_freelist(size_t reserve_pos)
     std::vector<FreeSpaceEntry> free_in_file;
     auto& new_free_space = m_group.m_alloc.get_free_read_only(); // Throws
     auto nb_elements =
-        m_size_map.size() + m_not_free_in_file.size() + m_under_evacuation.size() + new_free_space.size();
+        m_position_map.size() + m_not_free_in_file.size() + m_under_evacuation.size() + new_free_space.size();
     free_in_file.reserve(nb_elements);
 
     size_t reserve_ndx = realm::npos;
 
-    for (const auto& entry : m_size_map) {
-        free_in_file.emplace_back(entry.second, entry.first, 0);
+    // Each of the sources is ordered by position, so they only need to be merged
+    auto by_ref = [](const FreeSpaceEntry& a, const FreeSpaceEntry& b) {
+        return a.ref < b.ref;
+    };
+    auto merge_from = [&](size_t mid) {
+        std::inplace_merge(free_in_file.begin(), free_in_file.begin() + mid, free_in_file.end(), by_ref);
+    };
+
+    for (const auto& [ref, size] : m_position_map) {
+        free_in_file.emplace_back(ref, size, 0);
     }
+    size_t num_free = free_in_file.size();
 
     {
         size_t locked_space_size = 0;
+        size_t mid = free_in_file.size();
         for (const auto& locked : m_not_free_in_file) {
             free_in_file.emplace_back(locked.ref, locked.size, locked.released_at_version);
             locked_space_size += locked.size;
         }
+        merge_from(mid);
 
+        mid = free_in_file.size();
         for (const auto& free_space : new_free_space) {
             free_in_file.emplace_back(free_space.first, free_space.second, m_current_version);
             locked_space_size += free_space.second;
         }
+        merge_from(mid);
         m_locked_space_size = locked_space_size;
+        m_locked_chunk_count = free_in_file.size() - num_free;
     }
 
+    size_t mid = free_in_file.size();
     for (const auto& elem : m_under_evacuation) {
         free_in_file.emplace_back(elem.ref, elem.size, 0);
     }
+    merge_from(mid);
 
     REALM_ASSERT(free_in_file.size() == nb_elements);
-    std::sort(begin(free_in_file), end(free_in_file), [](auto& a, auto& b) {
-        return a.ref < b.ref;
-    });
 
     {
         // Copy into arrays while checking consistency
@@ -1090,6 +1118,8 @@ size_t GroupWriter::recreate_freelist(size_t reserve_pos)
                 // The reserved chunk should not be counted in now. We don't know how much of it
                 // will eventually be used.
                 free_space_size += free_space.size;
+                if (free_space.released_at_version == 0)
+                    m_largest_free_chunk = std::max(m_largest_free_chunk, free_space.size);
             }
             m_free_positions.add(free_space.ref);
             m_free_lengths.add(free_space.size);
@@ -1100,6 +1130,7 @@ size_t GroupWriter::recreate_freelist(size_t reserve_pos)
         REALM_ASSERT_RELEASE(reserve_ndx != realm::npos);
 
         m_free_space_size = free_space_size;
+        m_free_chunk_count = free_in_file.size() - m_locked_chunk_count;
     }
 
     return reserve_ndx;
@@ -1124,8 +1155,7 @@ void GroupWriter::merge_adjacent_entries_in_freelist(std::vector<GroupWriter::Fr
     }
 }
 
-void GroupWriter::move_free_in_file_to_size_map(const std::vector<GroupWriter::FreeSpaceEntry>& list,
-                                                std::multimap<size_t, size_t>& size_map)
+void GroupWriter::move_free_in_file_to_size_map(const std::vector<GroupWriter::FreeSpaceEntry>& list)
 {
     ALLOC_DBG_COUT("  Freelist (true free): ");
     for (auto& elem : list) {
@@ -1133,13 +1163,47 @@ void GroupWriter::move_free_in_file_to_size_map(const std::vector<GroupWriter::F
         if (elem.size) {
             REALM_ASSERT_RELEASE_EX(!(elem.size & 7), elem.size);
             REALM_ASSERT_RELEASE_EX(!(elem.ref & 7), elem.ref);
-            size_map.emplace(elem.size, elem.ref);
+            // The list is ordered by position, so every entry goes at the end
+            m_position_map.emplace_hint(m_position_map.end(), elem.ref, elem.size);
+            m_size_map.emplace(elem.size, elem.ref);
             ALLOC_DBG_COUT("[" << elem.ref << ", " << elem.size << "] ");
         }
     }
     ALLOC_DBG_COUT(std::endl);
 }
 
+GroupWriter::FreeListElement GroupWriter::add_free_chunk(size_t ref, size_t size)
+{
+    m_position_map.emplace(ref, size);
+    return m_size_map.emplace(size, ref).first;
+}
+
+void GroupWriter::remove_free_chunk(FreeListElement it)
+{
+    m_position_map.erase(it->second);
+    m_size_map.erase(it);
+}
+
+GroupWriter::FreeListElement GroupWriter::release_free_chunk(size_t ref, size_t size)
+{
+    auto next = m_position_map.lower_bound(ref);
+    if (next != m_position_map.end() && next->first == ref + size) {
+        size += next->second;
+        m_size_map.erase({next->second, next->first});
+        next = m_position_map.erase(next);
+    }
+    if (next != m_position_map.begin()) {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == ref) {
+            ref = prev->first;
+            size += prev->second;
+            m_size_map.erase({prev->second, prev->first});
+            m_position_map.erase(prev);
+        }
+    }
+    return add_free_chunk(ref, size);
+}
+
 size_t GroupWriter::get_free_space(size_t size)
 {
     REALM_ASSERT_3(size % 8, ==, 0); // 8-byte alignment
@@ -1154,13 +1218,13 @@ size_t GroupWriter::get_free_space(size_t size)
     REALM_ASSERT_RELEASE_EX(!(chunk_size & 7), chunk_size);
 
     size_t rest = chunk_size - size;
-    m_size_map.erase(p);
+    remove_free_chunk(p);
     if (rest > 0) {
         // Allocating part of chunk - this alway happens from the beginning
         // of the chunk. The call to reserve_free_space may split chunks
         // in order to make sure that it returns a chunk from which allocation
         // can be done from the beginning
-        m_size_map.emplace(rest, chunk_pos + size);
+        add_free_chunk(chunk_pos + size, rest);
     }
     return chunk_pos;
 }
@@ -1170,14 +1234,14 @@ inline GroupWriter::FreeListElement GroupWriter::split_freelist_chunk(FreeListEl
 {
     size_t start_pos = it->second;
     size_t chunk_size = it->first;
-    m_size_map.erase(it);
+    remove_free_chunk(it);
     REALM_ASSERT_RELEASE_EX(alloc_pos > start_pos, alloc_pos, start_pos);
 
     REALM_ASSERT_RELEASE_EX(!(alloc_pos & 7), alloc_pos);
     size_t size_first = alloc_pos - start_pos;
     size_t size_second = chunk_size - size_first;
-    m_size_map.emplace(size_first, start_pos);
-    return m_size_map.emplace(size_second, alloc_pos);
+    add_free_chunk(start_pos, size_first);
+    return add_free_chunk(alloc_pos, size_second);
 }
 
 GroupWriter::FreeListElement GroupWriter::search_free_space_in_free_list_element(FreeListElement it, size_t size)
@@ -1205,7 +1269,8 @@ GroupWriter::FreeListElement GroupWriter::search_free_space_in_free_list_element
 
 GroupWriter::FreeListElement GroupWriter::search_free_space_in_part_of_freelist(size_t size)
 {
-    auto it = m_size_map.lower_bound(size);
+    // Among chunks of the same size, the one closest to the start of the file is used first
+    auto it = m_size_map.lower_bound({size, 0});
     while (it != m_size_map.end()) {
         // Accept either a perfect match or a block that is twice the size. Tests have shown
         // that this is a good strategy.
@@ -1218,7 +1283,7 @@ GroupWriter::FreeListElement GroupWriter::search_free_space_in_part_of_freelist(
         }
         else {
             // If block was too small, search for the first that is at least twice as big.
-            it = m_size_map.lower_bound(2 * size);
+            it = m_size_map.lower_bound({2 * size, 0});
         }
     }
     // No match
@@ -1235,7 +1300,7 @@ GroupWriter::FreeListElement GroupWriter::reserve_free_space(size_t size)
             // Just give up
             // But first we will release all kept back elements
             for (auto& elem : m_under_evacuation) {
-                m_size_map.emplace(elem.size, elem.ref);
+                release_free_chunk(elem.ref, elem.size);
             }
             m_under_evacuation.clear();
             m_evacuation_limit = 0;
@@ -1320,7 +1385,8 @@ GroupWriter::FreeListElement GroupWriter::extend_free_space(size_t requested_siz
     size_t chunk_size = new_file_size - logical_file_size;
     REALM_ASSERT_RELEASE_EX(!(chunk_size & 7), chunk_size);
     REALM_ASSERT_RELEASE(chunk_size != 0);
-    auto it = m_size_map.emplace(chunk_size, logical_file_size);
+    // Free space at the end of the file becomes part of the new chunk
+    auto it = release_free_chunk(logical_file_size, chunk_size);
 
     // Update the logical file size
     m_logical_size = new_file_size;
@@ -1350,6 +1416,9 @@ ref_type GroupWriter::write_array(const char* data, size_t size, uint32_t checks
     memcpy(dest_addr, &checksum, 4);
     memcpy(dest_addr + 4, data + 4, size - 4);
     window->encryption_write_barrier(dest_addr, size);
+    m_bytes_written += size;
+    if (m_write_ahead_log)
+        m_write_ahead_log->add(pos, dest_addr, size); // Throws
     // return ref of the written array
     ref_type ref = to_ref(pos);
     return ref;
@@ -1368,6 +1437,9 @@ void GroupWriter::write_array_at(T* translator, ref_type ref, const char* data,
     uint32_t dummy_checksum = 0x41414141UL; // "AAAA" in ASCII
     memcpy(dest_addr, &dummy_checksum, 4);
     memcpy(dest_addr + 4, data + 4, size - 4);
+    m_bytes_written += size;
+    if (m_write_ahead_log)
+        m_write_ahead_log->add(ref, dest_addr, size); // Throws
 }
 
 
@@ -1389,7 +1461,7 @@ void GroupCommitter::commit(ref_type new_top_ref)
     int slot_selector = ((new_flags & SlabAlloc::flags_SelectBit) != 0 ? 1 : 0);
 
     // Update top ref and file format version
-    int file_format_version = m_group.get_file_format_version();
+    int file_format_version = m_file_format_version;
     using type_1 = std::remove_reference<decltype(file_header.m_file_format[0])>::type;
     REALM_ASSERT(!util::int_cast_has_overflow<type_1>(file_format_version));
     // only write the file format field if necessary (optimization)
@@ -22,6 +22,8 @@
 #include <cstdint> // unint8_t etc
 #include <utility>
 #include <map>
+#include <set>
+#include <chrono>
 
 #include <realm/util/file.hpp>
 #include <realm/alloc.hpp>
@@ -35,6 +37,7 @@ namespace realm {
 // Pre-declarations
 class Transaction;
 class SlabAlloc;
+class WriteAheadLog;
 namespace util {
 class WriteMarker;
 }
@@ -95,6 +98,8 @@ public:
     using Durability = DBOptions::Durability;
     using MapWindow = WriteWindowMgr::MapWindow;
     GroupCommitter(Transaction&, Durability dura = Durability::Full, util::WriteMarker* write_marker = nullptr);
+    GroupCommitter(SlabAlloc&, int file_format_version, Durability dura = Durability::Full,
+                   util::WriteMarker* write_marker = nullptr);
     ~GroupCommitter();
     /// Flush changes to physical medium, then write the new top ref
     /// to the file header, then flush again. Pass the top ref
@@ -102,8 +107,8 @@ public:
     void commit(ref_type new_top_ref);
 
 protected:
-    Transaction& m_group;
     SlabAlloc& m_alloc;
+    int m_file_format_version;
     Durability m_durability;
     WriteWindowMgr m_window_mgr;
 };
@@ -129,6 +134,19 @@ public:
 
     void set_versions(uint64_t current, TopRefMap& top_refs, bool any_num_unreachables) noexcept;
 
+    /// Allow integer column leaves to be written in a compressed encoding (see
+    /// IntegerCompressor). Off by default.
+    void set_compression(bool enable) noexcept
+    {
+        m_compress = enable;
+    }
+
+    /// Add the arrays written by write_group() to the current record of `wal`
+    void set_write_ahead_log(WriteAheadLog* wal) noexcept
+    {
+        m_write_ahead_log = wal;
+    }
+
     /// Write all changed array nodes into free space.
     ///
     /// Returns the new top ref. When in full durability mode, call
@@ -169,6 +187,35 @@ public:
         return m_free_positions.size() * size_per_free_list_entry();
     }
 
+    /// Number of chunks in the written free list which can be reused
+    size_t get_free_chunk_count() const noexcept
+    {
+        return m_free_chunk_count;
+    }
+
+    /// Number of chunks in the written free list which are still used by live versions
+    size_t get_locked_chunk_count() const noexcept
+    {
+        return m_locked_chunk_count;
+    }
+
+    size_t get_largest_free_chunk() const noexcept
+    {
+        return m_largest_free_chunk;
+    }
+
+    /// Time spent reading in and recreating the free list
+    std::chrono::microseconds get_free_list_time() const noexcept
+    {
+        return m_free_list_time;
+    }
+
+    /// Number of bytes of arrays written to the file by write_group()
+    size_t get_bytes_written() const noexcept
+    {
+        return m_bytes_written;
+    }
+
     /// Prepare for a round of evacuation (if applicable)
     void prepare_evacuation();
 
@@ -197,6 +244,12 @@ public:
         }
     }
     void sync_according_to_durability();
+    /// Make the written data visible through other mappings of the file,
+    /// without waiting for it to reach the disk
+    void flush_all_mappings()
+    {
+        m_window_mgr.flush_all_mappings();
+    }
 
 private:
     friend class InMemoryWriter;
@@ -213,8 +266,7 @@ private:
     };
 
     static void merge_adjacent_entries_in_freelist(std::vector<FreeSpaceEntry>& list);
-    static void move_free_in_file_to_size_map(const std::vector<GroupWriter::FreeSpaceEntry>& list,
-                                              std::multimap<size_t, size_t>& size_map);
+    void move_free_in_file_to_size_map(const std::vector<GroupWriter::FreeSpaceEntry>& list);
 
     Transaction& m_group;
     SlabAlloc& m_alloc;
@@ -232,17 +284,33 @@ private:
     size_t m_evacuation_limit;
     int64_t m_backoff;
     size_t m_logical_size = 0;
+    bool m_compress = false;
+    WriteAheadLog* m_write_ahead_log = nullptr;
+    size_t m_free_chunk_count = 0;
+    size_t m_locked_chunk_count = 0;
+    size_t m_largest_free_chunk = 0;
+    std::chrono::microseconds m_free_list_time{0};
+    size_t m_bytes_written = 0;
 
     //  m_free_in_file;
     std::vector<FreeSpaceEntry> m_not_free_in_file;
     std::vector<FreeSpaceEntry> m_under_evacuation;
-    std::multimap<size_t, size_t> m_size_map;
+    // The chunks which can be allocated from, indexed both by (size, position)
+    // for allocation and by position for merging of adjacent chunks.
+    std::set<std::pair<size_t, size_t>> m_size_map;
+    std::map<size_t, size_t> m_position_map;
     std::vector<size_t> m_evacuation_progress;
-    using FreeListElement = std::multimap<size_t, size_t>::iterator;
+    using FreeListElement = std::set<std::pair<size_t, size_t>>::iterator;
 
     void read_in_freelist();
     size_t recreate_freelist(size_t reserve_pos);
 
+    FreeListElement add_free_chunk(size_t ref, size_t size);
+    void remove_free_chunk(FreeListElement);
+    /// Add a chunk which is released back to the free space, merging it with
+    /// the chunks right before and after it, if they are free too.
+    FreeListElement release_free_chunk(size_t ref, size_t size);
+
     /// Allocate a chunk of free space of the specified size. The
     /// specified size must be 8-byte aligned. Extend the file if
     /// required. The returned chunk is removed from the amount of
@@ -0,0 +1,335 @@
+/*************************************************************************
+ *
+ * Copyright 2024 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/index_composite.hpp>
+#include <realm/array_integer.hpp>
+#include <realm/column_binary.hpp>
+#include <realm/obj.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace realm;
+
+namespace {
+
+constexpr size_t s_columns_ndx = 0;
+constexpr size_t s_values_ndx = 1;
+constexpr size_t s_keys_ndx = 2;
+
+int compare(BinaryData a, const std::string& b)
+{
+    size_t n = std::min(a.size(), b.size());
+    if (int c = (n ? std::memcmp(a.data(), b.data(), n) : 0))
+        return c;
+    return a.size() < b.size() ? -1 : (a.size() > b.size() ? 1 : 0);
+}
+
+bool starts_with(BinaryData a, const std::string& prefix)
+{
+    return a.size() >= prefix.size() && std::memcmp(a.data(), prefix.data(), prefix.size()) == 0;
+}
+
+// Accessors for the two trees of the index, created for each operation like
+// in the SortedIndex, so that lookups on a shared index are thread safe.
+class Entries {
+public:
+    // For modification
+    Entries(Array& top)
+        : m_values(top.get_alloc())
+        , m_keys(top.get_alloc())
+    {
+        m_values.set_parent(&top, s_values_ndx);
+        m_values.init_from_parent();
+        m_keys.set_parent(&top, s_keys_ndx);
+        m_keys.init_from_parent();
+    }
+    // For lookup
+    Entries(const Array& top)
+        : m_values(top.get_alloc())
+        , m_keys(top.get_alloc())
+    {
+        m_values.init_from_ref(top.get_as_ref(s_values_ndx));
+        m_keys.init_from_ref(top.get_as_ref(s_keys_ndx));
+    }
+
+    size_t size() const
+    {
+        return m_keys.size();
+    }
+    BinaryData value(size_t ndx) const
+    {
+        return m_values.get(ndx);
+    }
+    ObjKey key(size_t ndx) const
+    {
+        return ObjKey(m_keys.get(ndx));
+    }
+
+    void insert(size_t ndx, ObjKey key, const std::string& value)
+    {
+        m_values.insert(ndx, BinaryData(value.data(), value.size()));
+        m_keys.insert(ndx, key.value);
+    }
+    void erase(size_t ndx)
+    {
+        m_values.erase(ndx);
+        m_keys.erase(ndx);
+    }
+    void clear()
+    {
+        m_values.clear();
+        m_keys.clear();
+    }
+    void verify() const
+    {
+        m_values.verify();
+        m_keys.verify();
+        REALM_ASSERT(m_values.size() == m_keys.size());
+    }
+
+    template <class Pred>
+    size_t partition_point(Pred&& pred) const
+    {
+        size_t lo = 0;
+        size_t hi = size();
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (pred(mid))
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    // Position of the entry (value, key), or of where it would be inserted
+    size_t find_position(const std::string& value, ObjKey key) const
+    {
+        return partition_point([&](size_t ndx) {
+            int c = compare(this->value(ndx), value);
+            return c < 0 || (c == 0 && this->key(ndx) < key);
+        });
+    }
+
+    // Positions [begin, end) of the entries starting with `prefix`
+    std::pair<size_t, size_t> find_prefix(const std::string& prefix) const
+    {
+        size_t begin = partition_point([&](size_t ndx) {
+            return compare(value(ndx), prefix) < 0;
+        });
+        size_t end = partition_point([&](size_t ndx) {
+            BinaryData v = value(ndx);
+            return compare(v, prefix) < 0 || starts_with(v, prefix);
+        });
+        return {begin, end};
+    }
+
+private:
+    BPlusTree<BinaryData> m_values;
+    BPlusTree<Int> m_keys;
+};
+
+} // anonymous namespace
+
+CompositeIndex::CompositeIndex(const std::vector<ColKey>& columns, Allocator& alloc)
+    : m_top(alloc)
+    , m_columns(columns)
+{
+    REALM_ASSERT(!columns.empty());
+    m_top.create(Array::type_HasRefs); // Throws
+    {
+        Array cols(alloc);
+        cols.create(Array::type_Normal); // Throws
+        for (auto col : columns)
+            cols.add(col.value); // Throws
+        m_top.add(from_ref(cols.get_ref())); // Throws
+    }
+    m_top.add(0); // Throws
+    m_top.add(0); // Throws
+    BPlusTree<BinaryData> values(alloc);
+    values.set_parent(&m_top, s_values_ndx);
+    values.create(); // Throws
+    BPlusTree<Int> keys(alloc);
+    keys.set_parent(&m_top, s_keys_ndx);
+    keys.create(); // Throws
+}
+
+CompositeIndex::CompositeIndex(ref_type ref, ArrayParent* parent, size_t ndx_in_parent, Allocator& alloc)
+    : m_top(alloc)
+{
+    m_top.init_from_ref(ref);
+    m_top.set_parent(parent, ndx_in_parent);
+    Array cols(alloc);
+    cols.init_from_ref(m_top.get_as_ref(s_columns_ndx));
+    for (size_t i = 0; i < cols.size(); ++i)
+        m_columns.push_back(ColKey(cols.get(i)));
+}
+
+bool CompositeIndex::type_supported(ColKey col)
+{
+    if (col.is_collection())
+        return false;
+    switch (col.get_type()) {
+        case col_type_Int:
+        case col_type_Bool:
+        case col_type_String:
+        case col_type_Timestamp:
+        case col_type_ObjectId:
+        case col_type_UUID:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool CompositeIndex::covers(ColKey col) const noexcept
+{
+    return std::find(m_columns.begin(), m_columns.end(), col) != m_columns.end();
+}
+
+void CompositeIndex::encode(std::string& buffer, ColKey col, Mixed value) const
+{
+    // Every value has a fixed size for its type, or is preceded by its size,
+    // so that the encoding of one column never is a prefix of another one
+    if (value.is_null()) {
+        buffer += '\0';
+        return;
+    }
+    buffer += '\1';
+    auto append = [&buffer](uint64_t v, int num_bytes) {
+        for (int i = num_bytes - 1; i >= 0; --i)
+            buffer += char(v >> (8 * i));
+    };
+    switch (col.get_type()) {
+        case col_type_Int:
+            append(uint64_t(value.get_int()), 8);
+            break;
+        case col_type_Bool:
+            buffer += char(value.get_bool());
+            break;
+        case col_type_String: {
+            StringData str = value.get_string();
+            append(str.size(), 4);
+            buffer.append(str.data(), str.size());
+            break;
+        }
+        case col_type_Timestamp: {
+            Timestamp ts = value.get_timestamp();
+            append(uint64_t(ts.get_seconds()), 8);
+            append(uint32_t(ts.get_nanoseconds()), 4);
+            break;
+        }
+        case col_type_ObjectId: {
+            auto bytes = value.get<ObjectId>().to_bytes();
+            buffer.append(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+            break;
+        }
+        case col_type_UUID: {
+            auto bytes = value.get<UUID>().to_bytes();
+            buffer.append(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+            break;
+        }
+        default:
+            REALM_UNREACHABLE();
+    }
+}
+
+std::string CompositeIndex::encode(const Obj& obj, ColKey replaced_col, Mixed replacement) const
+{
+    std::string buffer;
+    for (auto col : m_columns)
+        encode(buffer, col, col == replaced_col ? replacement : obj.get_any(col));
+    return buffer;
+}
+
+void CompositeIndex::do_insert(const std::string& value, ObjKey key)
+{
+    Entries entries(m_top);
+    entries.insert(entries.find_position(value, key), key, value); // Throws
+}
+
+void CompositeIndex::do_erase(const std::string& value, ObjKey key)
+{
+    Entries entries(m_top);
+    size_t ndx = entries.find_position(value, key);
+    REALM_ASSERT(ndx < entries.size() && entries.key(ndx) == key);
+    entries.erase(ndx); // Throws
+}
+
+void CompositeIndex::insert(const Obj& obj)
+{
+    do_insert(encode(obj), obj.get_key()); // Throws
+}
+
+void CompositeIndex::erase(const Obj& obj)
+{
+    do_erase(encode(obj), obj.get_key()); // Throws
+}
+
+void CompositeIndex::set(const Obj& obj, ColKey col, Mixed new_value)
+{
+    std::string old_entry = encode(obj);
+    std::string new_entry = encode(obj, col, new_value);
+    if (old_entry == new_entry)
+        return;
+    do_erase(old_entry, obj.get_key()); // Throws
+    do_insert(new_entry, obj.get_key()); // Throws
+}
+
+void CompositeIndex::clear()
+{
+    Entries(m_top).clear(); // Throws
+}
+
+size_t CompositeIndex::count(const std::vector<Mixed>& values) const
+{
+    REALM_ASSERT(values.size() <= m_columns.size());
+    std::string prefix;
+    for (size_t i = 0; i < values.size(); ++i)
+        encode(prefix, m_columns[i], values[i]);
+    auto [begin, end] = Entries(m_top).find_prefix(prefix);
+    return end - begin;
+}
+
+void CompositeIndex::find_all(std::vector<ObjKey>& result, const std::vector<Mixed>& values) const
+{
+    REALM_ASSERT(values.size() <= m_columns.size());
+    std::string prefix;
+    for (size_t i = 0; i < values.size(); ++i)
+        encode(prefix, m_columns[i], values[i]);
+    Entries entries(m_top);
+    auto [begin, end] = entries.find_prefix(prefix);
+    result.reserve(result.size() + end - begin);
+    for (size_t ndx = begin; ndx < end; ++ndx)
+        result.push_back(entries.key(ndx));
+}
+
+void CompositeIndex::verify() const
+{
+#ifdef REALM_DEBUG
+    Entries entries(m_top);
+    entries.verify();
+    size_t sz = entries.size();
+    for (size_t ndx = 1; ndx < sz; ++ndx) {
+        BinaryData prev = entries.value(ndx - 1);
+        int c = compare(entries.value(ndx), std::string(prev.data(), prev.size()));
+        REALM_ASSERT(c > 0 || (c == 0 && entries.key(ndx - 1) < entries.key(ndx)));
+    }
+#endif
+}
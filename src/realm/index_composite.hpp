@@ -0,0 +1,110 @@
+/*************************************************************************
+ *
+ * Copyright 2024 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_INDEX_COMPOSITE_HPP
+#define REALM_INDEX_COMPOSITE_HPP
+
+#include <realm/array.hpp>
+#include <realm/keys.hpp>
+#include <realm/mixed.hpp>
+
+#include <vector>
+
+/*
+A CompositeIndex indexes the objects of a table by the values of an ordered list of columns. For every object it holds
+an entry made of the values of the columns, encoded one after the other into a byte string, and the key of the
+object. The encoding of each value is self-delimiting, so the objects which have the same values in the first N
+columns are exactly those whose byte strings start with the same prefix. The entries are ordered by byte string and
+then by key, which places those objects next to each other:
+
+       values:  (1, "a")   (1, "b")   (1, "b")   (2, "a")
+       keys:       4          0          7          2
+
+A lookup of equal values in any number of leading columns is a binary search for the bounds of a prefix. The index
+does not order the values in a meaningful way, so it cannot answer range lookups.
+
+The index consists of a top array holding the column keys, a B+ tree of the byte strings and a B+ tree of the object
+keys. It is maintained by the Table for every change to one of its columns.
+*/
+
+namespace realm {
+
+class Obj;
+
+class CompositeIndex {
+public:
+    /// Create a new index on `columns`. The index is empty.
+    CompositeIndex(const std::vector<ColKey>& columns, Allocator&);
+    /// Attach to an existing index
+    CompositeIndex(ref_type, ArrayParent*, size_t ndx_in_parent, Allocator&);
+
+    /// Int, bool, string, timestamp, ObjectId and UUID properties can be
+    /// part of a composite index, but not collections of them.
+    static bool type_supported(ColKey col);
+
+    const std::vector<ColKey>& get_columns() const noexcept
+    {
+        return m_columns;
+    }
+    bool covers(ColKey col) const noexcept;
+
+    void insert(const Obj& obj);
+    void erase(const Obj& obj);
+    /// Must be called before the value of `col` in `obj` is changed to `new_value`
+    void set(const Obj& obj, ColKey col, Mixed new_value);
+    void clear();
+
+    /// Number of objects whose values in the first `values.size()` columns
+    /// are equal to `values`
+    size_t count(const std::vector<Mixed>& values) const;
+    /// Append the keys of the objects whose values in the first
+    /// `values.size()` columns are equal to `values` to `result`. The keys
+    /// are in key order only if values are given for all columns.
+    void find_all(std::vector<ObjKey>& result, const std::vector<Mixed>& values) const;
+
+    ref_type get_ref() const noexcept
+    {
+        return m_top.get_ref();
+    }
+    void set_parent(ArrayParent* parent, size_t ndx_in_parent) noexcept
+    {
+        m_top.set_parent(parent, ndx_in_parent);
+    }
+    void update_from_parent() noexcept
+    {
+        m_top.update_from_parent();
+    }
+    void destroy() noexcept
+    {
+        m_top.destroy_deep();
+    }
+    void verify() const;
+
+private:
+    Array m_top;
+    std::vector<ColKey> m_columns;
+
+    void encode(std::string& buffer, ColKey col, Mixed value) const;
+    std::string encode(const Obj& obj, ColKey replaced_col = {}, Mixed replacement = {}) const;
+    void do_insert(const std::string& value, ObjKey key);
+    void do_erase(const std::string& value, ObjKey key);
+};
+
+} // namespace realm
+
+#endif // REALM_INDEX_COMPOSITE_HPP
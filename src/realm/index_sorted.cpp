@@ -0,0 +1,393 @@
+/*************************************************************************
+ *
+ * Copyright 2024 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/index_sorted.hpp>
+#include <realm/array_mixed.hpp>
+#include <realm/array_unsigned.hpp>
+
+#include <cmath>
+#include <iostream>
+
+using namespace realm;
+
+namespace {
+
+constexpr size_t s_values_ndx = 0;
+constexpr size_t s_keys_ndx = 1;
+
+// Accessors for the two trees of the index. The index itself only keeps the
+// top array, so that lookups on a shared (frozen) index do not compete for the
+// leaf caches of the trees.
+class Entries {
+public:
+    // For modification
+    Entries(Array& top)
+        : m_values(top.get_alloc())
+        , m_keys(top.get_alloc())
+    {
+        m_values.set_parent(&top, s_values_ndx);
+        m_values.init_from_parent();
+        m_keys.set_parent(&top, s_keys_ndx);
+        m_keys.init_from_parent();
+    }
+    // For lookup
+    Entries(const Array& top)
+        : m_values(top.get_alloc())
+        , m_keys(top.get_alloc())
+    {
+        m_values.init_from_ref(top.get_as_ref(s_values_ndx));
+        m_keys.init_from_ref(top.get_as_ref(s_keys_ndx));
+    }
+
+    size_t size() const
+    {
+        return m_keys.size();
+    }
+    Mixed value(size_t ndx) const
+    {
+        return m_values.get(ndx);
+    }
+    ObjKey key(size_t ndx) const
+    {
+        return ObjKey(m_keys.get(ndx));
+    }
+
+    void insert(size_t ndx, ObjKey key, const Mixed& value)
+    {
+        m_values.insert(ndx, value);
+        m_keys.insert(ndx, key.value);
+    }
+    void erase(size_t ndx)
+    {
+        m_values.erase(ndx);
+        m_keys.erase(ndx);
+    }
+    void clear()
+    {
+        m_values.clear();
+        m_keys.clear();
+    }
+    void verify() const
+    {
+        m_values.verify();
+        m_keys.verify();
+        REALM_ASSERT(m_values.size() == m_keys.size());
+    }
+
+    // The first position at which `pred` is false. `pred` must be true for a
+    // (possibly empty) prefix of the entries and false for the rest.
+    template <class Pred>
+    size_t partition_point(Pred&& pred) const
+    {
+        size_t lo = 0;
+        size_t hi = size();
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (pred(mid))
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    // Position of the entry (value, key), or of where it would be inserted
+    size_t find_position(const Mixed& value, ObjKey key) const
+    {
+        return partition_point([&](size_t ndx) {
+            int c = this->value(ndx).compare(value);
+            return c < 0 || (c == 0 && this->key(ndx) < key);
+        });
+    }
+
+    // Positions [begin, end) of the entries equal to `value`
+    std::pair<size_t, size_t> find_equal(const Mixed& value) const
+    {
+        size_t begin = partition_point([&](size_t ndx) {
+            return this->value(ndx).compare(value) < 0;
+        });
+        size_t end = partition_point([&](size_t ndx) {
+            return this->value(ndx).compare(value) <= 0;
+        });
+        return {begin, end};
+    }
+
+    // Positions [begin, end) of the entries in `range`
+    std::pair<size_t, size_t> find_range(const SortedIndex::Range& range) const
+    {
+        size_t begin = 0;
+        if (range.begin) {
+            const Mixed& bound = *range.begin;
+            begin = partition_point([&](size_t ndx) {
+                int c = value(ndx).compare(bound);
+                return range.begin_inclusive ? c < 0 : c <= 0;
+            });
+        }
+        else if (!range.include_nulls) {
+            begin = partition_point([&](size_t ndx) {
+                return SortedIndex::is_null_or_nan(value(ndx));
+            });
+        }
+        size_t end = size();
+        if (range.end) {
+            const Mixed& bound = *range.end;
+            end = partition_point([&](size_t ndx) {
+                int c = value(ndx).compare(bound);
+                return range.end_inclusive ? c <= 0 : c < 0;
+            });
+        }
+        return {begin, std::max(begin, end)};
+    }
+
+private:
+    BPlusTree<Mixed> m_values;
+    BPlusTree<Int> m_keys;
+};
+
+} // anonymous namespace
+
+void SortedIndex::Range::intersect(const Range& other)
+{
+    if (other.begin) {
+        int c = begin ? begin->compare(*other.begin) : -1;
+        if (c < 0) {
+            begin = other.begin;
+            begin_inclusive = other.begin_inclusive;
+        }
+        else if (c == 0) {
+            begin_inclusive = begin_inclusive && other.begin_inclusive;
+        }
+    }
+    if (other.end) {
+        int c = end ? end->compare(*other.end) : 1;
+        if (c > 0) {
+            end = other.end;
+            end_inclusive = other.end_inclusive;
+        }
+        else if (c == 0) {
+            end_inclusive = end_inclusive && other.end_inclusive;
+        }
+    }
+    include_nulls = include_nulls && other.include_nulls;
+}
+
+bool SortedIndex::is_null_or_nan(const Mixed& value)
+{
+    if (value.is_null())
+        return true;
+    if (value.is_type(type_Float))
+        return std::isnan(value.get<float>());
+    if (value.is_type(type_Double))
+        return std::isnan(value.get<double>());
+    return false;
+}
+
+SortedIndex::SortedIndex(const ClusterColumn& target_column, Allocator& alloc)
+    : SearchIndex(target_column, &m_top)
+    , m_top(alloc)
+{
+    m_top.create(Array::type_HasRefs); // Throws
+    m_top.add(0);                      // Throws
+    m_top.add(0);                      // Throws
+    BPlusTree<Mixed> values(alloc);
+    values.set_parent(&m_top, s_values_ndx);
+    values.create(); // Throws
+    BPlusTree<Int> keys(alloc);
+    keys.set_parent(&m_top, s_keys_ndx);
+    keys.create(); // Throws
+}
+
+SortedIndex::SortedIndex(ref_type ref, ArrayParent* parent, size_t ndx_in_parent,
+                         const ClusterColumn& target_column, Allocator& alloc)
+    : SearchIndex(target_column, &m_top)
+    , m_top(alloc)
+{
+    m_top.init_from_ref(ref);
+    set_parent(parent, ndx_in_parent);
+}
+
+void SortedIndex::insert(ObjKey key, const Mixed& value)
+{
+    Entries entries(m_top);
+    entries.insert(entries.find_position(value, key), key, value); // Throws
+}
+
+void SortedIndex::set(ObjKey key, const Mixed& new_value)
+{
+    Mixed old_value = m_target_column.get_value(key);
+    if (old_value.compare(new_value) == 0)
+        return;
+
+    Entries entries(m_top);
+    size_t ndx = entries.find_position(old_value, key);
+    REALM_ASSERT(ndx < entries.size() && entries.key(ndx) == key);
+    entries.erase(ndx);                                                    // Throws
+    entries.insert(entries.find_position(new_value, key), key, new_value); // Throws
+}
+
+void SortedIndex::erase(ObjKey key)
+{
+    Entries entries(m_top);
+    size_t ndx = entries.find_position(m_target_column.get_value(key), key);
+    REALM_ASSERT(ndx < entries.size() && entries.key(ndx) == key);
+    entries.erase(ndx); // Throws
+}
+
+ObjKey SortedIndex::find_first(const Mixed& value) const
+{
+    Entries entries(m_top);
+    auto [begin, end] = entries.find_equal(value);
+    return begin < end ? entries.key(begin) : ObjKey();
+}
+
+void SortedIndex::find_all(std::vector<ObjKey>& result, Mixed value, bool case_insensitive) const
+{
+    // Case insensitive lookups would need a different order of the strings
+    REALM_ASSERT(!case_insensitive);
+    Entries entries(m_top);
+    auto [begin, end] = entries.find_equal(value);
+    for (size_t ndx = begin; ndx < end; ++ndx)
+        result.push_back(entries.key(ndx));
+}
+
+FindRes SortedIndex::find_all_no_copy(Mixed value, InternalFindResult& result) const
+{
+    Entries entries(m_top);
+    auto [begin, end] = entries.find_equal(value);
+    if (begin == end)
+        return FindRes_not_found;
+    if (end - begin == 1) {
+        result.payload = entries.key(begin).value;
+        return FindRes_single;
+    }
+    // Keys of equal values are sorted, so the key tree can be used directly
+    result.payload = int64_t(m_top.get_as_ref(s_keys_ndx));
+    result.start_ndx = begin;
+    result.end_ndx = end;
+    return FindRes_column;
+}
+
+size_t SortedIndex::count(const Mixed& value) const
+{
+    auto [begin, end] = Entries(m_top).find_equal(value);
+    return end - begin;
+}
+
+void SortedIndex::insert_bulk(const ArrayUnsigned* keys, uint64_t key_offset, size_t num_values,
+                              ArrayPayload& values)
+{
+    Entries entries(m_top);
+    for (size_t i = 0; i < num_values; ++i) {
+        ObjKey key(int64_t(keys ? keys->get(i) + key_offset : i + key_offset));
+        Mixed value = values.get_any(i);
+        entries.insert(entries.find_position(value, key), key, value); // Throws
+    }
+}
+
+void SortedIndex::insert_bulk_list(const ArrayUnsigned*, uint64_t, size_t, ArrayInteger&)
+{
+    // Lists are not supported by the sorted index
+    REALM_UNREACHABLE();
+}
+
+void SortedIndex::clear()
+{
+    Entries(m_top).clear(); // Throws
+}
+
+bool SortedIndex::has_duplicate_values() const noexcept
+{
+    Entries entries(m_top);
+    size_t sz = entries.size();
+    for (size_t ndx = 1; ndx < sz; ++ndx) {
+        if (entries.value(ndx - 1).compare(entries.value(ndx)) == 0)
+            return true;
+    }
+    return false;
+}
+
+bool SortedIndex::is_empty() const
+{
+    return Entries(m_top).size() == 0;
+}
+
+void SortedIndex::verify() const
+{
+#ifdef REALM_DEBUG
+    Entries entries(m_top);
+    entries.verify();
+    size_t sz = entries.size();
+    for (size_t ndx = 1; ndx < sz; ++ndx) {
+        int c = entries.value(ndx - 1).compare(entries.value(ndx));
+        REALM_ASSERT(c < 0 || (c == 0 && entries.key(ndx - 1) < entries.key(ndx)));
+    }
+#endif
+}
+
+#ifdef REALM_DEBUG
+void SortedIndex::print() const
+{
+    Entries entries(m_top);
+    size_t sz = entries.size();
+    std::cout << "SortedIndex: " << sz << " entries" << std::endl;
+    for (size_t ndx = 0; ndx < sz; ++ndx)
+        std::cout << "  " << entries.value(ndx) << ": " << entries.key(ndx) << std::endl;
+}
+#endif
+
+size_t SortedIndex::count(const Range& range) const
+{
+    auto [begin, end] = Entries(m_top).find_range(range);
+    return end - begin;
+}
+
+void SortedIndex::find_range(std::vector<ObjKey>& result, const Range& range) const
+{
+    Entries entries(m_top);
+    auto [begin, end] = entries.find_range(range);
+    result.reserve(result.size() + end - begin);
+    for (size_t ndx = begin; ndx < end; ++ndx)
+        result.push_back(entries.key(ndx));
+}
+
+void SortedIndex::for_each_sorted(bool ascending, util::FunctionRef<IteratorControl(ObjKey)> func) const
+{
+    Entries entries(m_top);
+    size_t sz = entries.size();
+    if (ascending) {
+        for (size_t ndx = 0; ndx < sz; ++ndx) {
+            if (func(entries.key(ndx)) == IteratorControl::Stop)
+                return;
+        }
+        return;
+    }
+
+    // Visit the runs of equal values from the end, each run in key order
+    size_t run_end = sz;
+    while (run_end > 0) {
+        Mixed value = entries.value(run_end - 1);
+        size_t run_begin = run_end - 1;
+        while (run_begin > 0 && entries.value(run_begin - 1).compare(value) == 0)
+            --run_begin;
+        for (size_t ndx = run_begin; ndx < run_end; ++ndx) {
+            if (func(entries.key(ndx)) == IteratorControl::Stop)
+                return;
+        }
+        run_end = run_begin;
+    }
+}
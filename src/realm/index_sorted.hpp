@@ -0,0 +1,111 @@
+/*************************************************************************
+ *
+ * Copyright 2024 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_INDEX_SORTED_HPP
+#define REALM_INDEX_SORTED_HPP
+
+#include <realm/array.hpp>
+#include <realm/bplustree.hpp>
+#include <realm/search_index.hpp>
+#include <realm/util/function_ref.hpp>
+
+/*
+The SortedIndex keeps the objects of a table ordered by the value of one column. It consists of two B+ trees of the
+same size, one holding the values and one holding the object keys:
+
+       values:  null   1   4   4   9
+       keys:      7    3   0   5   1
+
+The entries are ordered by value as defined by Mixed::compare, so nulls (and NaNs) come before every other value.
+Entries with the same value are ordered by object key. An entry is found by binary search on (value, key), which
+makes insertion, removal and the lookup of the bounds of a value range logarithmic. The keys of a range are
+consecutive in the key tree, which makes it possible to visit the objects in value order without sorting.
+
+Unlike the StringIndex, which is organized by the bytes of the values and can only answer equality lookups, the
+SortedIndex can answer range lookups (<, <=, >, >=, between) and deliver objects in sorted order.
+*/
+
+namespace realm {
+
+class SortedIndex : public SearchIndex {
+public:
+    /// A range of values. An unset bound leaves that end of the range open.
+    /// Nulls are smaller than all other values, but are only part of a range
+    /// with an open lower bound, and only if `include_nulls` is set. NaNs are
+    /// never part of a range.
+    struct Range {
+        std::optional<Mixed> begin;
+        std::optional<Mixed> end;
+        bool begin_inclusive = true;
+        bool end_inclusive = true;
+        bool include_nulls = false;
+
+        /// Restrict this range to the values which are also in `other`
+        void intersect(const Range& other);
+    };
+
+    SortedIndex(const ClusterColumn& target_column, Allocator&);
+    SortedIndex(ref_type, ArrayParent*, size_t ndx_in_parent, const ClusterColumn& target_column, Allocator&);
+
+    static bool type_supported(DataType type)
+    {
+        return (type == type_Int || type == type_Float || type == type_Double || type == type_Timestamp ||
+                type == type_String);
+    }
+    /// Nulls and NaNs are ordered before all other values
+    static bool is_null_or_nan(const Mixed& value);
+
+    // SearchIndex interface:
+
+    void insert(ObjKey key, const Mixed& value) final;
+    void set(ObjKey key, const Mixed& new_value) final;
+    void erase(ObjKey key) final;
+    ObjKey find_first(const Mixed& value) const final;
+    void find_all(std::vector<ObjKey>& result, Mixed value, bool case_insensitive = false) const final;
+    FindRes find_all_no_copy(Mixed value, InternalFindResult& result) const final;
+    size_t count(const Mixed& value) const final;
+    void insert_bulk(const ArrayUnsigned* keys, uint64_t key_offset, size_t num_values, ArrayPayload& values) final;
+    void insert_bulk_list(const ArrayUnsigned* keys, uint64_t key_offset, size_t num_values,
+                          ArrayInteger& ref_array) final;
+    void clear() final;
+    bool has_duplicate_values() const noexcept final;
+    bool is_empty() const final;
+    void verify() const final;
+#ifdef REALM_DEBUG
+    void print() const final;
+#endif
+
+    // SortedIndex interface:
+
+    /// Number of objects with a value in `range`
+    size_t count(const Range& range) const;
+    /// Append the keys of the objects with a value in `range` to `result`, in value order
+    void find_range(std::vector<ObjKey>& result, const Range& range) const;
+    /// Call `func` with the keys of all objects in value order until it
+    /// returns IteratorControl::Stop. Objects with equal values are visited
+    /// in key order in both directions, which matches a stable sort of the
+    /// objects in key order.
+    void for_each_sorted(bool ascending, util::FunctionRef<IteratorControl(ObjKey)> func) const;
+
+private:
+    Array m_top;
+};
+
+} // namespace realm
+
+#endif // REALM_INDEX_SORTED_HPP
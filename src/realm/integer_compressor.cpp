@@ -0,0 +1,128 @@
+/*************************************************************************
+ *
+ * Copyright 2024 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/integer_compressor.hpp>
+#include <realm/array.hpp>
+#include <realm/array_direct.hpp>
+
+#include <cstring>
+
+using namespace realm;
+
+namespace {
+
+// Number of bits needed to represent `v` as an unsigned value
+size_t bits_needed(uint64_t v) noexcept
+{
+    size_t bits = 0;
+    while (v) {
+        ++bits;
+        v >>= 1;
+    }
+    return bits;
+}
+
+void pack_code(uint64_t* codes, size_t code_width, size_t ndx, uint64_t code) noexcept
+{
+    if (code_width == 0)
+        return;
+    size_t bit = ndx * code_width;
+    size_t word = bit >> 6;
+    size_t shift = bit & 63;
+    codes[word] |= code << shift;
+    if (shift + code_width > 64)
+        codes[word + 1] |= code >> (64 - shift);
+}
+
+} // anonymous namespace
+
+bool IntegerCompressor::compress(const Array& arr, std::vector<uint64_t>& buffer)
+{
+    REALM_ASSERT_DEBUG(!arr.has_refs());
+    const char* header = arr.get_header();
+    REALM_ASSERT_DEBUG(NodeHeader::get_wtype_from_header(header) == NodeHeader::wtype_Bits);
+
+    size_t size = arr.size();
+    if (size == 0 || arr.get_width() == 0)
+        return false;
+
+    std::vector<int64_t> values(size);
+    for (size_t i = 0; i < size; ++i)
+        values[i] = arr.get(i);
+    std::vector<int64_t> dict(values);
+    std::sort(dict.begin(), dict.end());
+    dict.erase(std::unique(dict.begin(), dict.end()), dict.end());
+
+    int64_t min = dict.front();
+    size_t packed_width = bits_needed(uint64_t(dict.back()) - uint64_t(min));
+    size_t dict_width = bits_needed(dict.size() - 1);
+
+    uint64_t descriptor = 0;
+    size_t best_size = arr.get_byte_size();
+    if (packed_width < 64) {
+        uint64_t packed = NodeHeader::make_descriptor(NodeHeader::encoding_Packed, packed_width, 0);
+        size_t packed_size = NodeHeader::calc_compressed_byte_size(packed, size);
+        if (packed_size < best_size) {
+            descriptor = packed;
+            best_size = packed_size;
+        }
+    }
+    uint64_t dictionary = NodeHeader::make_descriptor(NodeHeader::encoding_Dict, dict_width, dict.size());
+    size_t dict_size = NodeHeader::calc_compressed_byte_size(dictionary, size);
+    if (dict_size < best_size) {
+        descriptor = dictionary;
+        best_size = dict_size;
+    }
+    if (descriptor == 0)
+        return false;
+
+    buffer.assign(best_size / 8, 0);
+    char* new_header = reinterpret_cast<char*>(buffer.data());
+    std::memcpy(new_header, header, NodeHeader::header_size);
+    NodeHeader::set_wtype_in_header(NodeHeader::wtype_Extend, new_header);
+
+    uint64_t* words = buffer.data() + 1;
+    words[0] = descriptor;
+    uint64_t* codes = words + NodeHeader::get_codes_offset_from_descriptor(descriptor);
+    size_t code_width = NodeHeader::get_code_width_from_descriptor(descriptor);
+    if (NodeHeader::get_encoding_from_descriptor(descriptor) == NodeHeader::encoding_Dict) {
+        std::copy(dict.begin(), dict.end(), reinterpret_cast<int64_t*>(words + 1));
+        for (size_t i = 0; i < size; ++i) {
+            size_t code = std::lower_bound(dict.begin(), dict.end(), values[i]) - dict.begin();
+            pack_code(codes, code_width, i, code);
+        }
+    }
+    else {
+        words[1] = uint64_t(min);
+        for (size_t i = 0; i < size; ++i)
+            pack_code(codes, code_width, i, uint64_t(values[i]) - uint64_t(min));
+    }
+    return true;
+}
+
+void IntegerCompressor::decompress(const char* header, char* dest_header) noexcept
+{
+    REALM_ASSERT_DEBUG(NodeHeader::get_wtype_from_header(dest_header) == NodeHeader::wtype_Bits);
+    REALM_ASSERT_DEBUG(NodeHeader::get_width_from_header(dest_header) == NodeHeader::get_width_from_header(header));
+    Decoder decoder(header);
+    size_t size = NodeHeader::get_size_from_header(header);
+    size_t width = NodeHeader::get_width_from_header(dest_header);
+    char* data = NodeHeader::get_data_from_header(dest_header);
+    for (size_t i = 0; i < size; ++i)
+        set_direct(data, width, i, decoder.get(i));
+}
@@ -0,0 +1,225 @@
+/*************************************************************************
+ *
+ * Copyright 2024 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_INTEGER_COMPRESSOR_HPP
+#define REALM_INTEGER_COMPRESSOR_HPP
+
+#include <realm/node_header.hpp>
+#include <realm/query_conditions.hpp>
+#include <realm/query_state.hpp>
+
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+namespace realm {
+
+class Array;
+
+/// Encoding and decoding of compressed integer arrays (wtype_Extend).
+///
+/// When a modified integer leaf is written to the file at commit time, it may
+/// be replaced by a compressed copy using one of two encodings:
+///
+/// - encoding_Packed (frame of reference): every element is stored as its
+///   offset from the smallest element, using just enough bits for the largest
+///   offset.
+///
+/// - encoding_Dict: the distinct values are stored once in a sorted
+///   dictionary, and every element is stored as an index into it. This wins
+///   for low cardinality leaves with a wide value range.
+///
+/// Unlike the regular power of two widths, codes may use any number of bits.
+/// With both encodings codes are ordered like the values they represent, so
+/// the search kernels translate the needle into a code once, and then compare
+/// codes without decoding the elements.
+///
+/// Compressed arrays only exist in the file, so they are always read-only. A
+/// modification goes through copy-on-write, which decompresses the array into
+/// the regular format (see Node::do_copy_on_write()).
+class IntegerCompressor {
+public:
+    /// Encode the elements of \a arr, which must be a leaf of plain integers,
+    /// using the encoding giving the smallest array. The result, header
+    /// included, is placed in \a buffer. Returns false, leaving \a buffer
+    /// unspecified, if no encoding would make the array smaller.
+    static bool compress(const Array& arr, std::vector<uint64_t>& buffer);
+
+    /// Decode the compressed array at \a header into the payload of \a
+    /// dest_header, an uncompressed wtype_Bits array of the same size and the
+    /// width recorded in \a header.
+    static void decompress(const char* header, char* dest_header) noexcept;
+
+    static int64_t get(const char* header, size_t ndx) noexcept;
+
+    template <class cond>
+    static bool find(const char* header, int64_t value, size_t start, size_t end, size_t baseindex,
+                     QueryStateBase* state);
+
+private:
+    class Decoder;
+};
+
+class IntegerCompressor::Decoder {
+public:
+    explicit Decoder(const char* header) noexcept
+    {
+        uint64_t descriptor = NodeHeader::get_descriptor_from_header(header);
+        auto words = reinterpret_cast<const uint64_t*>(NodeHeader::get_data_from_header(header));
+        m_is_dict = NodeHeader::get_encoding_from_descriptor(descriptor) == NodeHeader::encoding_Dict;
+        m_code_width = NodeHeader::get_code_width_from_descriptor(descriptor);
+        m_mask = (uint64_t(1) << m_code_width) - 1;
+        m_dict = words + 1;
+        m_base = m_is_dict ? 0 : words[1];
+        m_code_limit = m_is_dict ? NodeHeader::get_dict_size_from_descriptor(descriptor) : m_mask + 1;
+        m_codes = words + NodeHeader::get_codes_offset_from_descriptor(descriptor);
+    }
+
+    uint64_t code(size_t ndx) const noexcept
+    {
+        if (m_code_width == 0)
+            return 0;
+        size_t bit = ndx * m_code_width;
+        size_t word = bit >> 6;
+        size_t shift = bit & 63;
+        uint64_t v = m_codes[word] >> shift;
+        if (shift + m_code_width > 64)
+            v |= m_codes[word + 1] << (64 - shift);
+        return v & m_mask;
+    }
+
+    int64_t decode(uint64_t code) const noexcept
+    {
+        return m_is_dict ? int64_t(m_dict[code]) : int64_t(m_base + code);
+    }
+
+    int64_t get(size_t ndx) const noexcept
+    {
+        return decode(code(ndx));
+    }
+
+    /// All codes are less than this
+    uint64_t code_limit() const noexcept
+    {
+        return m_code_limit;
+    }
+
+    /// The smallest code representing a value not less than \a value, or
+    /// code_limit() if there is none.
+    uint64_t lower_code(int64_t value) const noexcept
+    {
+        if (m_is_dict) {
+            auto dict = reinterpret_cast<const int64_t*>(m_dict);
+            return std::lower_bound(dict, dict + m_code_limit, value) - dict;
+        }
+        if (value <= int64_t(m_base))
+            return 0;
+        return std::min(uint64_t(value) - m_base, m_code_limit);
+    }
+
+    /// The smallest code representing a value greater than \a value, or
+    /// code_limit() if there is none.
+    uint64_t upper_code(int64_t value) const noexcept
+    {
+        if (m_is_dict) {
+            auto dict = reinterpret_cast<const int64_t*>(m_dict);
+            return std::upper_bound(dict, dict + m_code_limit, value) - dict;
+        }
+        if (value < int64_t(m_base))
+            return 0;
+        return std::min(uint64_t(value) - m_base, m_code_limit - 1) + 1;
+    }
+
+    template <class Pred>
+    bool find_codes(size_t start, size_t end, size_t baseindex, QueryStateBase* state, Pred pred) const
+    {
+        for (; start < end; ++start) {
+            if (pred(code(start)) && !state->match(start + baseindex))
+                return false;
+        }
+        return true;
+    }
+
+private:
+    bool m_is_dict;
+    size_t m_code_width;
+    uint64_t m_mask;
+    uint64_t m_base;
+    uint64_t m_code_limit;
+    const uint64_t* m_dict;
+    const uint64_t* m_codes;
+};
+
+inline int64_t IntegerCompressor::get(const char* header, size_t ndx) noexcept
+{
+    return Decoder(header).get(ndx);
+}
+
+template <class cond>
+bool IntegerCompressor::find(const char* header, int64_t value, size_t start, size_t end, size_t baseindex,
+                             QueryStateBase* state)
+{
+    Decoder decoder(header);
+    if (end == npos)
+        end = NodeHeader::get_size_from_header(header);
+
+    if constexpr (std::is_same_v<cond, Equal> || std::is_same_v<cond, NotEqual>) {
+        uint64_t needle = decoder.lower_code(value);
+        bool present = needle < decoder.code_limit() && decoder.decode(needle) == value;
+        if constexpr (std::is_same_v<cond, Equal>) {
+            if (!present)
+                return true;
+            return decoder.find_codes(start, end, baseindex, state, [needle](uint64_t code) {
+                return code == needle;
+            });
+        }
+        else {
+            if (!present)
+                needle = decoder.code_limit(); // Matches no code, so every element is different
+            return decoder.find_codes(start, end, baseindex, state, [needle](uint64_t code) {
+                return code != needle;
+            });
+        }
+    }
+    else if constexpr (std::is_same_v<cond, Greater>) {
+        uint64_t limit = decoder.upper_code(value);
+        if (limit == decoder.code_limit())
+            return true;
+        return decoder.find_codes(start, end, baseindex, state, [limit](uint64_t code) {
+            return code >= limit;
+        });
+    }
+    else if constexpr (std::is_same_v<cond, Less>) {
+        uint64_t limit = decoder.lower_code(value);
+        if (limit == 0)
+            return true;
+        return decoder.find_codes(start, end, baseindex, state, [limit](uint64_t code) {
+            return code < limit;
+        });
+    }
+    else {
+        cond c;
+        return decoder.find_codes(start, end, baseindex, state, [&](uint64_t code) {
+            return c(decoder.decode(code), value);
+        });
+    }
+}
+
+} // namespace realm
+
+#endif // REALM_INTEGER_COMPRESSOR_HPP
@@ -17,6 +17,7 @@
  **************************************************************************/
 
 #include <realm/node.hpp>
+#include <realm/integer_compressor.hpp>
 #include <realm/utilities.hpp>
 #include <realm/mixed.hpp>
 
@@ -127,8 +128,15 @@ void Node::do_copy_on_write(size_t minimum_size)
 {
     const char* header = get_header_from_data(m_data);
 
+    // A compressed array is expanded to the regular format before it can be
+    // modified
+    WidthType wtype = get_wtype_from_header(header);
+    bool is_compressed = wtype == wtype_Extend;
+    if (is_compressed)
+        wtype = wtype_Bits;
+
     // Calculate size in bytes
-    size_t array_size = calc_byte_size(get_wtype_from_header(header), m_size, get_width_from_header(header));
+    size_t array_size = calc_byte_size(wtype, m_size, get_width_from_header(header));
     size_t new_size = std::max(array_size, minimum_size);
     new_size = (new_size + 0x7) & ~size_t(0x7); // 64bit blocks
     // Plus a bit of matchcount room for expansion
@@ -137,9 +145,17 @@ void Node::do_copy_on_write(size_t minimum_size)
     // Create new copy of array
     MemRef mref = m_alloc.alloc(new_size); // Throws
     const char* old_begin = header;
-    const char* old_end = header + array_size;
+    const char* old_end = header + (is_compressed ? get_byte_size_from_header(header) : array_size);
     char* new_begin = mref.get_addr();
-    realm::safe_copy_n(old_begin, old_end - old_begin, new_begin);
+    if (is_compressed) {
+        init_header(new_begin, get_is_inner_bptree_node_from_header(header), get_hasrefs_from_header(header),
+                    get_context_flag_from_header(header), wtype_Bits, get_width_from_header(header), m_size,
+                    new_size);
+        IntegerCompressor::decompress(header, new_begin);
+    }
+    else {
+        realm::safe_copy_n(old_begin, old_end - old_begin, new_begin);
+    }
 
     ref_type old_ref = m_ref;
 
@@ -52,6 +52,27 @@ public:
         wtype_Bits = 0,     // width indicates how many bits every element occupies
         wtype_Multiply = 1, // width indicates how many bytes every element occupies
         wtype_Ignore = 2,   // each element is 1 byte
+        wtype_Extend = 3,   // compressed integers, see "Compressed arrays" below
+    };
+
+    /// Compressed arrays
+    ///
+    /// Integer leaves may be stored in a compressed form when they are written
+    /// to the file (see IntegerCompressor). Such arrays have width type
+    /// wtype_Extend, and the width field holds the width the array will get
+    /// when it is decompressed. The first 64-bit word of the payload is a
+    /// descriptor:
+    ///
+    ///     bits  0-7   encoding (see Encoding)
+    ///     bits  8-15  number of bits per element code (0-63)
+    ///     bits 16-39  number of dictionary entries (encoding_Dict only)
+    ///
+    /// It is followed by the encoding specific words (the base value for
+    /// encoding_Packed, the sorted dictionary for encoding_Dict), and finally the
+    /// element codes, bit packed into 64-bit words.
+    enum Encoding {
+        encoding_Packed = 1, // value = base + code
+        encoding_Dict = 2,   // value = dictionary[code]
     };
 
     static const int header_size = 8; // Number of bytes used by header
@@ -159,6 +180,7 @@ public:
         // 0: bits      (width/8) * size
         // 1: multiply  width * size
         // 2: ignore    1 * size
+        // 3: extend    see calc_compressed_byte_size()
         typedef unsigned char uchar;
         uchar* h = reinterpret_cast<uchar*>(header);
         h[4] = uchar((int(h[4]) & ~0x18) | int(value) << 3);
@@ -200,11 +222,55 @@ public:
         h[2] = uchar(value >> 3 & 0x000000FF);
     }
 
+    static uint64_t get_descriptor_from_header(const char* header) noexcept
+    {
+        REALM_ASSERT_DEBUG(get_wtype_from_header(header) == wtype_Extend);
+        return *reinterpret_cast<const uint64_t*>(get_data_from_header(header));
+    }
+
+    static uint64_t make_descriptor(Encoding encoding, size_t code_width, size_t dict_size) noexcept
+    {
+        REALM_ASSERT_DEBUG(code_width < 64 && dict_size <= max_array_size);
+        return uint64_t(encoding) | uint64_t(code_width) << 8 | uint64_t(dict_size) << 16;
+    }
+
+    static Encoding get_encoding_from_descriptor(uint64_t descriptor) noexcept
+    {
+        return Encoding(descriptor & 0xFF);
+    }
+
+    static size_t get_code_width_from_descriptor(uint64_t descriptor) noexcept
+    {
+        return size_t((descriptor >> 8) & 0xFF);
+    }
+
+    static size_t get_dict_size_from_descriptor(uint64_t descriptor) noexcept
+    {
+        return size_t((descriptor >> 16) & 0xFFFFFF);
+    }
+
+    /// Number of 64-bit words preceding the element codes of a compressed
+    /// array, including the descriptor.
+    static size_t get_codes_offset_from_descriptor(uint64_t descriptor) noexcept
+    {
+        return get_encoding_from_descriptor(descriptor) == encoding_Dict ? 1 + get_dict_size_from_descriptor(descriptor)
+                                                                          : 2;
+    }
+
+    static size_t calc_compressed_byte_size(uint64_t descriptor, size_t size) noexcept
+    {
+        size_t num_words = get_codes_offset_from_descriptor(descriptor);
+        num_words += (size * get_code_width_from_descriptor(descriptor) + 63) >> 6;
+        return header_size + num_words * 8;
+    }
+
     static size_t get_byte_size_from_header(const char* header) noexcept
     {
         size_t size = get_size_from_header(header);
-        uint_least8_t width = get_width_from_header(header);
         WidthType wtype = get_wtype_from_header(header);
+        if (REALM_UNLIKELY(wtype == wtype_Extend))
+            return calc_compressed_byte_size(get_descriptor_from_header(header), size);
+        uint_least8_t width = get_width_from_header(header);
         size_t num_bytes = calc_byte_size(wtype, size, width);
         return num_bytes;
     }
@@ -228,6 +294,10 @@ public:
             case wtype_Ignore:
                 num_bytes = size;
                 break;
+            case wtype_Extend:
+                // Depends on the descriptor, use calc_compressed_byte_size()
+                REALM_ASSERT_DEBUG(false);
+                break;
         }
 
         // Ensure 8-byte alignment
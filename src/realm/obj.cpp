@@ -552,6 +552,8 @@ int64_t Obj::_get<int64_t>(ColKey::Idx col_ndx) const
 
     ref_type ref = to_ref(Array::get(m_mem.get_addr(), col_ndx.val + 1));
     char* header = alloc.translate(ref);
+    if (REALM_UNLIKELY(Array::get_wtype_from_header(header) == Array::wtype_Extend))
+        return Array::get(header, m_row_ndx);
     int width = Array::get_width_from_header(header);
     char* data = Array::get_data_from_header(header);
     REALM_TEMPEX(return get_direct, width, (data, m_row_ndx));
@@ -1307,6 +1309,9 @@ Obj& Obj::set<int64_t>(ColKey col_key, int64_t value, bool is_default)
         index->set(m_key, value);
     }
 
+    if (m_table->has_composite_indexes() && !m_key.is_unresolved())
+        m_table->set_in_composite_indexes(*this, col_key, value);
+
     Allocator& alloc = get_alloc();
     alloc.bump_content_version();
     Array fallback(alloc);
@@ -1385,6 +1390,8 @@ Obj& Obj::add_int(ColKey col_key, int64_t value)
                 if (SearchIndex* index = m_table->get_search_index(col_key)) {
                     index->set(m_key, new_val);
                 }
+                if (m_table->has_composite_indexes())
+                    m_table->set_in_composite_indexes(*this, col_key, new_val);
                 values.set(m_row_ndx, new_val);
             }
             else {
@@ -1400,6 +1407,8 @@ Obj& Obj::add_int(ColKey col_key, int64_t value)
             if (SearchIndex* index = m_table->get_search_index(col_key)) {
                 index->set(m_key, new_val);
             }
+            if (m_table->has_composite_indexes())
+                m_table->set_in_composite_indexes(*this, col_key, new_val);
             values.set(m_row_ndx, new_val);
         }
     }
@@ -1679,6 +1688,9 @@ Obj& Obj::set(ColKey col_key, T value, bool is_default)
         index->set(m_key, value);
     }
 
+    if (m_table->has_composite_indexes() && !m_key.is_unresolved())
+        m_table->set_in_composite_indexes(*this, col_key, value);
+
     Allocator& alloc = get_alloc();
     alloc.bump_content_version();
     Array fallback(alloc);
@@ -2328,6 +2340,9 @@ Obj& Obj::set_null(ColKey col_key, bool is_default)
         index->set(m_key, null{});
     }
 
+    if (m_table->has_composite_indexes() && !m_key.is_unresolved())
+        m_table->set_in_composite_indexes(*this, col_key, Mixed());
+
     switch (col_type) {
         case col_type_Int:
             do_set_null<ArrayIntNull>(col_key);
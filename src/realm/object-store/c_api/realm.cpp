@@ -54,6 +54,47 @@ RLM_API bool realm_get_num_versions(const realm_t* realm, uint64_t* out_versions
     });
 }
 
+static_assert(realm_evacuation_stage_e(DB::EvacStage::idle) == RLM_EVACUATION_STAGE_IDLE);
+static_assert(realm_evacuation_stage_e(DB::EvacStage::evacuating) == RLM_EVACUATION_STAGE_EVACUATING);
+static_assert(realm_evacuation_stage_e(DB::EvacStage::waiting) == RLM_EVACUATION_STAGE_WAITING);
+static_assert(realm_evacuation_stage_e(DB::EvacStage::blocked) == RLM_EVACUATION_STAGE_BLOCKED);
+
+static void to_capi(const DB::LatencyHistogram& histogram, realm_latency_histogram_t& out)
+{
+    static_assert(DB::LatencyHistogram::num_buckets == RLM_LATENCY_HISTOGRAM_BUCKETS);
+    std::copy(histogram.buckets.begin(), histogram.buckets.end(), out.buckets);
+    out.count = histogram.count;
+    out.total_us = uint64_t(histogram.total.count());
+    out.max_us = uint64_t(histogram.max.count());
+}
+
+RLM_API bool realm_get_storage_metrics(const realm_t* realm, realm_storage_metrics_t* out_metrics)
+{
+    return wrap_err([&]() {
+        if (out_metrics) {
+            auto metrics = (*realm)->get_storage_metrics();
+            out_metrics->commits = metrics.commits;
+            out_metrics->bytes_written = metrics.bytes_written;
+            out_metrics->last_commit_bytes = metrics.last_commit_bytes;
+            to_capi(metrics.begin_write_wait, out_metrics->begin_write_wait);
+            to_capi(metrics.commit, out_metrics->commit);
+            to_capi(metrics.write_group, out_metrics->write_group);
+            to_capi(metrics.free_list, out_metrics->free_list);
+            to_capi(metrics.sync, out_metrics->sync);
+            out_metrics->read_locks = metrics.read_locks;
+            out_metrics->active_read_locks = metrics.active_read_locks;
+            out_metrics->live_versions = metrics.live_versions;
+            out_metrics->oldest_live_version = metrics.oldest_live_version;
+            out_metrics->newest_version = metrics.newest_version;
+            out_metrics->file_size = metrics.file_size;
+            out_metrics->pinned_space = metrics.pinned_space;
+            out_metrics->evacuation_stage = realm_evacuation_stage_e(metrics.evacuation_stage);
+            out_metrics->evacuation_limit = metrics.evacuation_limit;
+        }
+        return true;
+    });
+}
+
 RLM_API const char* realm_get_library_version()
 {
     return REALM_VERSION_STRING;
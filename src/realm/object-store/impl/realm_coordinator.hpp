@@ -117,6 +117,13 @@ public:
     {
         return m_db->get_number_of_versions();
     }
+    // Returns the counters and latencies of the transactions on the file.
+    DB::Metrics get_storage_metrics() const
+    {
+        DB::Metrics metrics;
+        m_db->get_stats(metrics);
+        return metrics;
+    }
 
     // To avoid having to re-read and validate the file's schema every time a
     // new read transaction is begun, RealmCoordinator maintains a cache of the
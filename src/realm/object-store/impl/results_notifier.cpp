@@ -114,6 +114,12 @@ bool ResultsNotifier::do_add_required_change_info(TransactionChangeInfo& info)
         update_related_tables(*m_query->get_table());
     }
 
+    // Gather the changes to the table also when there are no callbacks, so
+    // that the results can be updated from them instead of rerunning the query
+    m_tracks_table_changes = m_query->get_table() && has_run() && m_previous_objs_are_current;
+    if (m_tracks_table_changes)
+        info.tables[m_query->get_table()->get_key()];
+
     return m_query->get_table() && has_run() && have_callbacks();
 }
 
@@ -166,8 +172,10 @@ void ResultsNotifier::run()
     {
         auto lock = lock_target();
         // Don't run the query if the results aren't actually going to be used
-        if (!get_realm() || (!have_callbacks() && !m_results_were_used))
+        if (!get_realm() || (!have_callbacks() && !m_results_were_used)) {
+            m_previous_objs_are_current = false;
             return;
+        }
     }
 
     auto new_versions = m_query->sync_view_if_needed();
@@ -190,11 +198,42 @@ void ResultsNotifier::run()
     }
 
     m_run_tv = TableView(*m_query, size_t(-1));
-    // Syncing will be done here
-    m_run_tv.apply_descriptor_ordering(m_descriptor_ordering);
+    if (!run_incrementally(new_versions)) {
+        // Syncing will be done here
+        m_run_tv.apply_descriptor_ordering(m_descriptor_ordering);
+    }
     m_last_seen_version = std::move(new_versions);
 
     calculate_changes();
+    m_previous_objs_are_current = true;
+}
+
+bool ResultsNotifier::run_incrementally(const TableVersions& new_versions)
+{
+    if (!m_tracks_table_changes || m_info->schema_changed)
+        return false;
+
+    // Only the table of the query may have changed, as changes to other
+    // tables are not gathered
+    auto table_key = m_query->get_table()->get_key();
+    if (new_versions.size() != m_last_seen_version.size())
+        return false;
+    for (size_t i = 0; i < new_versions.size(); ++i) {
+        if (new_versions[i].first != m_last_seen_version[i].first)
+            return false;
+        if (new_versions[i].first != table_key && new_versions[i].second != m_last_seen_version[i].second)
+            return false;
+    }
+
+    std::unordered_set<ObjKey> changed_keys;
+    if (auto it = m_info->tables.find(table_key); it != m_info->tables.end()) {
+        auto& changes = it->second;
+        changed_keys.insert(changes.get_insertions().begin(), changes.get_insertions().end());
+        changed_keys.insert(changes.get_deletions().begin(), changes.get_deletions().end());
+        for (auto& [key, columns] : changes.get_modifications())
+            changed_keys.insert(key);
+    }
+    return m_run_tv.apply_descriptor_ordering(m_descriptor_ordering, m_previous_objs, changed_keys);
 }
 
 void ResultsNotifier::do_prepare_handover(Transaction& sg)
@@ -71,11 +71,17 @@ private:
 
     // The objects from the previous run of the query, for calculating diffs
     ObjKeys m_previous_objs;
+    // Whether m_previous_objs is the result at the version the notifier is
+    // at, so that it can be updated from the changes to the table
+    bool m_previous_objs_are_current = false;
+    // Whether the changes to the table of the query are gathered in m_info
+    bool m_tracks_table_changes = false;
 
     TransactionChangeInfo* m_info = nullptr;
     bool m_results_were_used = true;
 
     void calculate_changes();
+    bool run_incrementally(const TableVersions& new_versions);
 
     void run() override;
     void do_prepare_handover(Transaction&) override;
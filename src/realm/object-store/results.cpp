@@ -769,6 +769,18 @@ const DescriptorOrdering& Results::get_ordering() const REQUIRES(!m_mutex)
     return m_descriptor_ordering;
 }
 
+std::string Results::explain()
+{
+    util::CheckedUniqueLock lock(m_mutex);
+    Query query = do_get_query();
+    std::string plan = query.explain();
+    if (query.get_table() && !m_descriptor_ordering.is_empty()) {
+        plan += util::format("\nOrdering: %1", m_descriptor_ordering.get_description(query.get_table()));
+        plan += util::format("\nResult after ordering: %1 objects", do_size());
+    }
+    return plan;
+}
+
 ConstTableRef Results::get_table() const
 {
     util::CheckedUniqueLock lock(m_mutex);
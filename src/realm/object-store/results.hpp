@@ -93,6 +93,10 @@ public:
     // Get ordering for the query associated with the result
     const DescriptorOrdering& get_ordering() const;
 
+    // Describe how the query of this Results is run (see Query::explain()),
+    // followed by the sort, distinct and limit operations applied to it
+    std::string explain() REQUIRES(!m_mutex);
+
     // Get the Collection this Results is derived from, if any
     const std::shared_ptr<CollectionBase>& get_collection() const
     {
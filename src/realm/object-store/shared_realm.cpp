@@ -696,6 +696,12 @@ uint_fast64_t Realm::get_number_of_versions() const
     return m_coordinator->get_number_of_versions();
 }
 
+DB::Metrics Realm::get_storage_metrics() const
+{
+    verify_open();
+    return m_coordinator->get_storage_metrics();
+}
+
 bool Realm::is_in_transaction() const noexcept
 {
     return !m_config.immutable() && !is_closed() && m_transaction &&
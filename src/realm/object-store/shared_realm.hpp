@@ -333,6 +333,9 @@ public:
 
     // Returns the number of versions in the Realm file.
     uint_fast64_t get_number_of_versions() const;
+    // Returns the counters and latencies of the transactions on the Realm file
+    // in this process, and its versions and space as of the last commit.
+    DB::Metrics get_storage_metrics() const;
 
     VersionID read_transaction_version() const;
     Group& read_group();
@@ -31,7 +31,10 @@
 #include "realm/parser/generated/query_flex.hpp"
 
 #include <external/mpark/variant.hpp>
+#include <list>
+#include <mutex>
 #include <stdexcept>
+#include <unordered_map>
 
 using namespace realm;
 using namespace std::string_literals;
@@ -956,6 +959,7 @@ std::unique_ptr<Subexpr> PropertyNode::visit(ParserDriver* drv, DataType)
         // This is a backlink aggregate query
         path->path_elems.pop_back();
         auto link_chain = path->visit(drv, comp_type);
+        path->path_elems.emplace_back(identifier); // The parse tree may be visited again
         auto sub = link_chain.get_backlink_count<Int>();
         return sub.clone();
     }
@@ -970,7 +974,7 @@ std::unique_ptr<Subexpr> PropertyNode::visit(ParserDriver* drv, DataType)
 
     Path indexes;
     while (!path->at_end()) {
-        indexes.emplace_back(std::move(*(path->current_path_elem++)));
+        indexes.push_back(*(path->current_path_elem++));
     }
 
     if (!indexes.empty()) {
@@ -1016,12 +1020,15 @@ std::unique_ptr<Subexpr> PropertyNode::visit(ParserDriver* drv, DataType)
                 if (!post_op && is_length_suffix(trailing)) {
                     // If 'length' is the operator, the last id in the path must be the name
                     // of a list property
+                    PathElement suffix = path->path_elems.back();
                     path->path_elems.pop_back();
                     const std::string& prop = path->path_elems.back().get_key();
                     std::unique_ptr<Subexpr> subexpr{path->visit(drv, comp_type).column(prop, false)};
                     if (auto list = dynamic_cast<ColumnListBase*>(subexpr.get())) {
-                        if (auto length_expr = list->get_element_length())
+                        if (auto length_expr = list->get_element_length()) {
+                            path->path_elems.push_back(std::move(suffix));
                             return length_expr;
+                        }
                     }
                 }
                 throw InvalidQueryError(util::format("Property '%1.%2' has no property '%3'",
@@ -1138,8 +1145,7 @@ std::unique_ptr<Subexpr> LinkAggrNode::visit(ParserDriver* drv, DataType)
                                              agg_op_type_to_str(type), property->get_identifier()));
     }
     const LinkChain& link_chain = property->link_chain();
-    prop_name = drv->translate(link_chain, prop_name);
-    auto col_key = link_chain.get_current_table()->get_column_key(prop_name);
+    auto col_key = link_chain.get_current_table()->get_column_key(drv->translate(link_chain, prop_name));
 
     switch (col_key.get_type()) {
         case col_type_Int:
@@ -1691,7 +1697,11 @@ std::unique_ptr<Subexpr> ListNode::visit(ParserDriver* drv, DataType hint)
 void PathNode::resolve_arg(ParserDriver* drv)
 {
     if (arg.size()) {
-        if (path_elems.size()) {
+        if (arg_resolved) {
+            // The parse tree is visited again, maybe with another argument
+            path_elems.clear();
+        }
+        else if (path_elems.size()) {
             throw InvalidQueryError("Key path argument cannot be mixed with other elements");
         }
         auto arg_str = drv->get_arg_for_key_path(arg);
@@ -1702,6 +1712,7 @@ void PathNode::resolve_arg(ParserDriver* drv)
             add_element(elem);
             path = p;
         } while (*path++ == '.');
+        arg_resolved = true;
     }
 }
 
@@ -1840,6 +1851,7 @@ PathElement ParserDriver::get_arg_for_index(const std::string& i)
 {
     REALM_ASSERT(i[0] == '$');
     size_t arg_no = size_t(strtol(i.substr(1).c_str(), nullptr, 10));
+    m_parse_uses_args = true;
     if (m_args.is_argument_null(arg_no) || m_args.is_argument_list(arg_no)) {
         throw InvalidQueryError("Invalid index parameter");
     }
@@ -1874,6 +1886,7 @@ double ParserDriver::get_arg_for_coordinate(const std::string& str)
 {
     REALM_ASSERT(str[0] == '$');
     size_t arg_no = size_t(strtol(str.substr(1).c_str(), nullptr, 10));
+    m_parse_uses_args = true;
     if (m_args.is_argument_null(arg_no)) {
         throw InvalidQueryError(util::format("NULL cannot be used in coordinate at argument '%1'", str));
     }
@@ -1992,6 +2005,118 @@ void parse(const std::string& str)
     driver.parse(str);
 }
 
+namespace {
+
+// The parse tree of a query string. It depends on neither the table nor the
+// arguments of a query, which are only bound when the tree is visited, so it
+// can be visited again for the next query with the same string.
+struct ParseTree {
+    ParserDriver::ParserNodeStore nodes;
+    QueryNode* result;
+    DescriptorOrderingNode* ordering;
+};
+
+// The parse trees of the most recently used query strings. A tree is taken
+// out of the cache while it is visited, as visiting it uses the state of its
+// nodes, and put back afterwards. Concurrent queries with the same string
+// each parse their own tree.
+class ParseTreeCache {
+public:
+    static ParseTreeCache& get()
+    {
+        static ParseTreeCache cache;
+        return cache;
+    }
+
+    std::unique_ptr<ParseTree> take(const std::string& query_string)
+    {
+        std::lock_guard lock(m_mutex);
+        auto it = m_entries.find(query_string);
+        if (it == m_entries.end() || !it->second.tree) {
+            ++m_misses;
+            return nullptr;
+        }
+        ++m_hits;
+        m_lru.splice(m_lru.begin(), m_lru, it->second.lru_pos);
+        return std::move(it->second.tree);
+    }
+
+    void put(const std::string& query_string, std::unique_ptr<ParseTree> tree)
+    {
+        std::lock_guard lock(m_mutex);
+        auto it = m_entries.find(query_string);
+        if (it != m_entries.end()) {
+            if (!it->second.tree)
+                it->second.tree = std::move(tree);
+            m_lru.splice(m_lru.begin(), m_lru, it->second.lru_pos);
+            return;
+        }
+        if (m_capacity == 0)
+            return;
+        while (m_entries.size() >= m_capacity) {
+            m_entries.erase(m_lru.back());
+            m_lru.pop_back();
+        }
+        m_lru.push_front(query_string);
+        m_entries.emplace(query_string, Entry{std::move(tree), m_lru.begin()});
+    }
+
+    void set_capacity(size_t capacity)
+    {
+        std::lock_guard lock(m_mutex);
+        m_capacity = capacity;
+        while (m_entries.size() > m_capacity) {
+            m_entries.erase(m_lru.back());
+            m_lru.pop_back();
+        }
+    }
+
+    void clear()
+    {
+        std::lock_guard lock(m_mutex);
+        m_entries.clear();
+        m_lru.clear();
+        m_hits = 0;
+        m_misses = 0;
+    }
+
+    ParseCacheStats get_stats()
+    {
+        std::lock_guard lock(m_mutex);
+        return {m_hits, m_misses, m_entries.size(), m_capacity};
+    }
+
+private:
+    struct Entry {
+        std::unique_ptr<ParseTree> tree; // Null while the tree is visited
+        std::list<std::string>::iterator lru_pos;
+    };
+
+    std::mutex m_mutex;
+    std::unordered_map<std::string, Entry> m_entries;
+    std::list<std::string> m_lru; // Most recently used first
+    size_t m_capacity = 256;
+    size_t m_hits = 0;
+    size_t m_misses = 0;
+};
+
+} // namespace
+
+void set_parse_cache_capacity(size_t capacity)
+{
+    ParseTreeCache::get().set_capacity(capacity);
+}
+
+ParseCacheStats get_parse_cache_stats()
+{
+    return ParseTreeCache::get().get_stats();
+}
+
+void clear_parse_cache()
+{
+    ParseTreeCache::get().clear();
+}
+
 std::string check_escapes(const char* str)
 {
     std::string ret;
@@ -2048,10 +2173,27 @@ Query Table::query(const std::string& query_string, const std::vector<MixedArgum
 Query Table::query(const std::string& query_string, query_parser::Arguments& args,
                    const query_parser::KeyPathMapping& mapping) const
 {
+    auto& cache = query_parser::ParseTreeCache::get();
     ParserDriver driver(m_own_ref, args, mapping);
-    driver.parse(query_string);
-    driver.result->canonicalize();
-    return driver.result->visit(&driver).set_ordering(driver.ordering->visit(&driver));
+    auto tree = cache.take(query_string);
+    if (tree) {
+        driver.result = tree->result;
+        driver.ordering = tree->ordering;
+    }
+    else {
+        driver.parse(query_string);
+        driver.result->canonicalize();
+    }
+    Query query = driver.result->visit(&driver).set_ordering(driver.ordering->visit(&driver));
+    // A tree which could not be visited is dropped, as the visit may have
+    // left its nodes in an intermediate state
+    if (!tree && !driver.m_parse_uses_args) {
+        tree = std::make_unique<query_parser::ParseTree>(
+            query_parser::ParseTree{std::move(driver.m_parse_nodes), driver.result, driver.ordering});
+    }
+    if (tree)
+        cache.put(query_string, std::move(tree));
+    return query;
 }
 
 std::unique_ptr<Subexpr> LinkChain::column(const std::string& col, bool has_path)
@@ -341,6 +341,7 @@ private:
     std::string arg;
     std::string backlink_str;
     int backlink = 0;
+    bool arg_resolved = false;
 };
 
 class PropertyNode : public ValueNode {
@@ -657,6 +658,9 @@ public:
     query_parser::KeyPathMapping m_mapping;
     ParserNodeStore m_parse_nodes;
     void* m_yyscanner;
+    // Set when arguments are bound by the parser itself, which makes the parse
+    // tree specific to those arguments
+    bool m_parse_uses_args = false;
 
     // Run the parser on file F.  Return 0 on success.
     int parse(const std::string& str);
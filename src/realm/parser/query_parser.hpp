@@ -341,6 +341,23 @@ public:
 
 void parse(const std::string&);
 
+struct ParseCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t size = 0;
+    size_t capacity = 0;
+};
+
+/// Table::query() keeps the parse trees of the most recently used query
+/// strings, 256 by default, and only binds the table, the key path mapping and
+/// the arguments when a string is used again. The cache is shared by all
+/// tables and files, and as parse trees don't depend on the schema it does
+/// not need to be invalidated by schema changes. A capacity of 0 disables it.
+void set_parse_cache_capacity(size_t capacity);
+ParseCacheStats get_parse_cache_stats();
+/// Drop all parse trees and reset the counters
+void clear_parse_cache();
+
 } // namespace realm::query_parser
 
 
@@ -27,11 +27,55 @@
 #include <realm/query_expression.hpp>
 #include <realm/table_view.hpp>
 #include <realm/set.hpp>
+#include <realm/util/work_stealing_pool.hpp>
 
 #include <algorithm>
+#include <cmath>
 
 using namespace realm;
 
+namespace {
+
+// Gathers the keys of matching objects when find_all() is executed in parallel
+class QueryStateCollectKeys : public QueryStateBase {
+public:
+    bool match(size_t index, Mixed) noexcept final
+    {
+        return match(index);
+    }
+    bool match(size_t index) noexcept final
+    {
+        ++m_match_count;
+        int64_t key_value = (m_key_values ? m_key_values->get(index) : index) + m_key_offset;
+        m_keys.push_back(ObjKey(key_value));
+        return true;
+    }
+    std::unique_ptr<QueryStateBase> make_partial() const final
+    {
+        return std::make_unique<QueryStateCollectKeys>();
+    }
+    void merge_partial(const QueryStateBase& other) final
+    {
+        auto& partial = static_cast<const QueryStateCollectKeys&>(other);
+        m_keys.insert(m_keys.end(), partial.m_keys.begin(), partial.m_keys.end());
+        m_match_count += partial.m_match_count;
+    }
+    const std::vector<ObjKey>& get_keys() const noexcept
+    {
+        return m_keys;
+    }
+
+private:
+    std::vector<ObjKey> m_keys;
+};
+
+ArrayPayload* no_payload(const Cluster*, size_t)
+{
+    return nullptr;
+}
+
+} // anonymous namespace
+
 Query::Query()
 {
     create();
@@ -87,6 +131,7 @@ Query::Query(const Query& source)
     , m_groups(source.m_groups)
     , m_table(source.m_table)
     , m_ordering(source.m_ordering)
+    , m_pool(source.m_pool)
 {
     if (source.m_owned_source_table_view) {
         m_owned_source_table_view = source.m_owned_source_table_view->clone();
@@ -111,6 +156,7 @@ Query& Query::operator=(const Query& source)
     if (this != &source) {
         m_groups = source.m_groups;
         m_table = source.m_table;
+        m_pool = source.m_pool;
 
         if (source.m_owned_source_table_view) {
             m_owned_source_table_view = source.m_owned_source_table_view->clone();
@@ -158,6 +204,7 @@ Query::Query(const Query* source, Transaction* tr, PayloadPolicy policy)
         REALM_ASSERT_DEBUG(m_view);
     }
     m_groups = source->m_groups;
+    m_pool = source->m_pool;
     if (source->m_table)
         set_table(tr->import_copy_of(source->m_table));
     // otherwise: empty query.
@@ -1106,9 +1153,23 @@ void Query::aggregate(QueryStateBase& st, ColKey column_key) const
 {
     using LeafType = typename ColumnTypeTraits<T>::cluster_leaf_type;
 
+    auto run_parallel = [&] {
+        if (!can_run_in_parallel())
+            return false;
+        // One leaf accessor per worker
+        std::vector<std::unique_ptr<LeafType>> leaves;
+        for (size_t i = 0; i < m_pool->num_workers(); ++i)
+            leaves.push_back(std::make_unique<LeafType>(m_table.unchecked_ptr()->get_alloc()));
+        return aggregate_parallel(st, [&](const Cluster* cluster, size_t worker_ndx) -> ArrayPayload* {
+            cluster->init_leaf(column_key, leaves[worker_ndx].get());
+            return leaves[worker_ndx].get();
+        });
+    };
+
     if (!has_conditions() && !m_view) {
         // use table aggregate
-        m_table.unchecked_ptr()->aggregate<T>(st, column_key);
+        if (!run_parallel())
+            m_table.unchecked_ptr()->aggregate<T>(st, column_key);
     }
     else {
 
@@ -1133,7 +1194,7 @@ void Query::aggregate(QueryStateBase& st, ColKey column_key) const
                     }
                 }
             }
-            else {
+            else if (!run_parallel()) {
                 // no index, traverse cluster tree
                 node = pn;
                 LeafType leaf(m_table.unchecked_ptr()->get_alloc());
@@ -1223,6 +1284,107 @@ void Query::aggregate_internal(ParentNode* pn, QueryStateBase* st, size_t start,
     }
 }
 
+bool Query::can_run_in_parallel() const
+{
+    return m_pool && !m_view && m_table && m_table->is_frozen();
+}
+
+/**************************************************************************************************************
+ *                                                                                                             *
+ * Parallel execution. The leaves of the table are distributed over the workers of the pool. Every worker has *
+ * its own copy of the condition nodes, and every leaf is aggregated into its own partial state. The partial  *
+ * states are merged in leaf order at the end, so that the result is the same as that of a sequential run.     *
+ *                                                                                                             *
+ **************************************************************************************************************/
+
+bool Query::aggregate_parallel(QueryStateBase& st, PayloadFunction get_payload) const
+{
+    REALM_ASSERT(can_run_in_parallel());
+    if (!st.make_partial())
+        return false;
+
+    const size_t num_workers = m_pool->num_workers();
+    std::vector<Query> workers;
+    workers.reserve(num_workers);
+    for (size_t i = 0; i < num_workers; ++i) {
+        // Initialization may touch shared accessors, so do it before the workers are started
+        workers.emplace_back(*this);
+        workers.back().init();
+    }
+
+    std::vector<std::vector<std::pair<size_t, std::unique_ptr<QueryStateBase>>>> partials(num_workers);
+    auto f = [&](const Cluster* cluster, size_t leaf_ndx, size_t worker_ndx) {
+        auto partial = st.make_partial();
+        partial->m_key_offset = cluster->get_offset();
+        partial->m_key_values = cluster->get_key_array();
+        ArrayPayload* payload = get_payload(cluster, worker_ndx);
+        size_t e = cluster->node_size();
+        if (auto node = workers[worker_ndx].root_node()) {
+            node->set_cluster(cluster);
+            aggregate_internal(node, partial.get(), 0, e, payload);
+        }
+        else if (payload) {
+            partial->set_payload_column(payload);
+            partial->match_range(0, e);
+        }
+        else {
+            for (size_t i = 0; i < e; i++)
+                partial->match(i, Mixed());
+        }
+        partials[worker_ndx].emplace_back(leaf_ndx, std::move(partial));
+    };
+    size_t num_leaves = m_table->traverse_clusters_parallel(*m_pool, f);
+
+    std::vector<const QueryStateBase*> ordered(num_leaves);
+    for (auto& worker_partials : partials) {
+        for (auto& [leaf_ndx, partial] : worker_partials)
+            ordered[leaf_ndx] = partial.get();
+    }
+    for (auto partial : ordered)
+        st.merge_partial(*partial);
+    return true;
+}
+
+bool Query::find_all_parallel(QueryStateBase& st) const
+{
+    // With a limit, the sequential scan can stop early, which is likely to beat a full parallel scan
+    if (st.limit() != size_t(-1) || !can_run_in_parallel())
+        return false;
+
+    QueryStateCollectKeys collected;
+    if (!aggregate_parallel(collected, no_payload))
+        return false;
+
+    st.m_key_values = nullptr;
+    for (ObjKey key : collected.get_keys()) {
+        st.m_key_offset = key.value;
+        if (!st.match(0, Mixed()))
+            break;
+    }
+    return true;
+}
+
+Query& Query::set_threads(unsigned int threadcount)
+{
+    if (threadcount == 1) {
+        m_pool.reset();
+    }
+    else if (threadcount == 0) {
+        // Share the process wide pool without owning it
+        m_pool = std::shared_ptr<util::WorkStealingPool>(std::shared_ptr<util::WorkStealingPool>(),
+                                                         &util::WorkStealingPool::get_default());
+    }
+    else if (!m_pool || m_pool->num_workers() != threadcount) {
+        m_pool = std::make_shared<util::WorkStealingPool>(threadcount);
+    }
+    return *this;
+}
+
+unsigned int Query::get_threads() const noexcept
+{
+    return m_pool ? unsigned(m_pool->num_workers()) : 1;
+}
+
 // Aggregates
 
 std::optional<Mixed> Query::sum(ColKey col_key) const
@@ -1468,7 +1630,7 @@ void Query::do_find_all(QueryStateBase& st) const
                     }
                 }
             }
-            else {
+            else if (!find_all_parallel(st)) {
                 // no index on best node (and likely no index at all), descend B+-tree
                 node = pn;
 
@@ -1587,17 +1749,19 @@ size_t Query::do_count(size_t limit) const
             node = pn;
             QueryStateCount st(limit);
 
-            auto f = [&node, &st, this](const Cluster* cluster) {
-                size_t e = cluster->node_size();
-                node->set_cluster(cluster);
-                st.m_key_offset = cluster->get_offset();
-                st.m_key_values = cluster->get_key_array();
-                aggregate_internal(node, &st, 0, e, nullptr);
-                // Stop if limit or end is reached
-                return st.match_count() == st.limit() ? IteratorControl::Stop : IteratorControl::AdvanceToNext;
-            };
+            if (limit != size_t(-1) || !can_run_in_parallel() || !aggregate_parallel(st, no_payload)) {
+                auto f = [&node, &st, this](const Cluster* cluster) {
+                    size_t e = cluster->node_size();
+                    node->set_cluster(cluster);
+                    st.m_key_offset = cluster->get_offset();
+                    st.m_key_values = cluster->get_key_array();
+                    aggregate_internal(node, &st, 0, e, nullptr);
+                    // Stop if limit or end is reached
+                    return st.match_count() == st.limit() ? IteratorControl::Stop : IteratorControl::AdvanceToNext;
+                };
 
-            m_table->traverse_clusters(f);
+                m_table->traverse_clusters(f);
+            }
 
             cnt = st.get_count();
         }
@@ -1681,136 +1845,6 @@ size_t Query::remove() const
     return rows;
 }
 
-#if REALM_MULTITHREAD_QUERY
-TableView Query::find_all_multi(size_t start, size_t end)
-{
-    static_cast<void>(start);
-    static_cast<void>(end);
-
-    // Initialization
-    init();
-    ts.next_job = start;
-    ts.end_job = end;
-    ts.done_job = 0;
-    ts.count = 0;
-    ts.table = &table;
-    ts.node = first[0];
-
-    // Signal all threads to start
-    pthread_mutex_unlock(&ts.jobs_mutex);
-    pthread_cond_broadcast(&ts.jobs_cond);
-
-    // Wait until all threads have completed
-    pthread_mutex_lock(&ts.completed_mutex);
-    while (ts.done_job < ts.end_job)
-        pthread_cond_wait(&ts.completed_cond, &ts.completed_mutex);
-    pthread_mutex_lock(&ts.jobs_mutex);
-    pthread_mutex_unlock(&ts.completed_mutex);
-
-    TableView tv(*m_table);
-
-    // Sort search results because user expects ascending order
-    sort(ts.chunks.begin(), ts.chunks.end(), &Query::comp);
-    for (size_t i = 0; i < ts.chunks.size(); ++i) {
-        const size_t from = ts.chunks[i].m_root_node;
-        const size_t upto = (i == ts.chunks.size() - 1) ? size_t(-1) : ts.chunks[i + 1].m_root_node;
-        size_t first = ts.chunks[i].second;
-
-        while (first < ts.results.size() && ts.results[first] < upto && ts.results[first] >= from) {
-            tv.get_ref_column().add(ts.results[first]);
-            ++first;
-        }
-    }
-
-    return move(tv);
-}
-
-int Query::set_threads(unsigned int threadcount)
-{
-#if defined(_WIN32) || defined(__WIN32__) || defined(_WIN64)
-    pthread_win32_process_attach_np();
-#endif
-    pthread_mutex_init(&ts.result_mutex, nullptr);
-    pthread_cond_init(&ts.completed_cond, nullptr);
-    pthread_mutex_init(&ts.jobs_mutex, nullptr);
-    pthread_mutex_init(&ts.completed_mutex, nullptr);
-    pthread_cond_init(&ts.jobs_cond, nullptr);
-
-    pthread_mutex_lock(&ts.jobs_mutex);
-
-    for (size_t i = 0; i < m_threadcount; ++i)
-        pthread_detach(threads[i]);
-
-    for (size_t i = 0; i < threadcount; ++i) {
-        int r = pthread_create(&threads[i], nullptr, query_thread, (void*)&ts);
-        if (r != 0)
-            REALM_ASSERT(false); // todo
-    }
-    m_threadcount = threadcount;
-    return 0;
-}
-
-
-void* Query::query_thread(void* arg)
-{
-    static_cast<void>(arg);
-    thread_state* ts = static_cast<thread_state*>(arg);
-
-    std::vector<size_t> res;
-    std::vector<pair<size_t, size_t>> chunks;
-
-    for (;;) {
-        // Main waiting loop that waits for a query to start
-        pthread_mutex_lock(&ts->jobs_mutex);
-        while (ts->next_job == ts->end_job)
-            pthread_cond_wait(&ts->jobs_cond, &ts->jobs_mutex);
-        pthread_mutex_unlock(&ts->jobs_mutex);
-
-        for (;;) {
-            // Pick a job
-            pthread_mutex_lock(&ts->jobs_mutex);
-            if (ts->next_job == ts->end_job)
-                break;
-            const size_t chunk = min(ts->end_job - ts->next_job, thread_chunk_size);
-            const size_t mine = ts->next_job;
-            ts->next_job += chunk;
-            size_t r = mine - 1;
-            const size_t end = mine + chunk;
-
-            pthread_mutex_unlock(&ts->jobs_mutex);
-
-            // Execute job
-            for (;;) {
-                r = ts->node->find_first(r + 1, end);
-                if (r == end)
-                    break;
-                res.push_back(r);
-            }
-
-            // Append result in common queue shared by all threads.
-            pthread_mutex_lock(&ts->result_mutex);
-            ts->done_job += chunk;
-            if (res.size() > 0) {
-                ts->chunks.push_back(std::pair<size_t, size_t>(mine, ts->results.size()));
-                ts->count += res.size();
-                for (size_t i = 0; i < res.size(); i++) {
-                    ts->results.push_back(res[i]);
-                }
-                res.clear();
-            }
-            pthread_mutex_unlock(&ts->result_mutex);
-
-            // Signal main thread that we might have compleeted
-            pthread_mutex_lock(&ts->completed_mutex);
-            pthread_cond_signal(&ts->completed_cond);
-            pthread_mutex_unlock(&ts->completed_mutex);
-        }
-    }
-    return 0;
-}
-
-#endif // REALM_MULTITHREADQUERY
-
 std::string Query::validate() const
 {
     if (!m_groups.size())
@@ -1845,6 +1879,55 @@ std::string Query::get_description(util::serializer::SerialisationState& state)
     return description;
 }
 
+std::string Query::explain() const
+{
+    if (!m_table)
+        return "Empty query";
+
+    const Table& table = *m_table;
+    util::serializer::SerialisationState state(table.get_parent_group());
+    std::string plan = util::format("Table '%1': %2 objects\n", table.get_name(), table.size());
+    if (m_view)
+        plan += util::format("Restricted to a view of %1 objects\n", m_view->size());
+    if (can_run_in_parallel())
+        plan += util::format("Run by %1 threads\n", m_pool->num_workers());
+
+    init();
+    if (ParentNode* root = root_node()) {
+        auto estimate = [&](const ParentNode* node) -> std::string {
+            if (auto selectivity = node->estimated_selectivity())
+                return util::format("estimated %1 matches", size_t(std::round(*selectivity * table.size())));
+            return "no estimate";
+        };
+        ParentNode* best = root->m_children[find_best_node(root)];
+        if (auto keys = best->index_based_keys()) {
+            plan += util::format("Search: %1 (index lookup, %2 matches)\n", best->describe(state), keys->size());
+        }
+        else {
+            plan += util::format("Search: %1 (scan, %2)\n", best->describe(state), estimate(best));
+        }
+        // The other conditions in the order they are tested in
+        for (size_t i = 1; i < best->m_children.size(); ++i) {
+            ParentNode* node = best->m_children[i];
+            plan += util::format("Filter: %1 (%2)\n", node->describe(state), estimate(node));
+        }
+    }
+    else {
+        plan += "Search: all objects\n";
+    }
+
+    size_t found;
+    if (m_ordering && !m_ordering->is_empty()) {
+        plan += util::format("Ordering: %1\n", m_ordering->get_description(m_table));
+        found = count(*m_ordering);
+    }
+    else {
+        found = count();
+    }
+    plan += util::format("Result: %1 objects", found);
+    return plan;
+}
+
 Query& Query::set_ordering(util::bind_ptr<DescriptorOrdering> ordering)
 {
     m_ordering = std::move(ordering);
@@ -1883,6 +1966,7 @@ void Query::init() const
         root->init(m_view == nullptr);
         std::vector<ParentNode*> vec;
         root->gather_children(vec);
+        root->plan();
     }
 }
 
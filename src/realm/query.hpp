@@ -23,17 +23,10 @@
 #include <cstdio>
 #include <climits>
 #include <algorithm>
+#include <memory>
 #include <string>
 #include <vector>
 
-#define REALM_MULTITHREAD_QUERY 0
-
-#if REALM_MULTITHREAD_QUERY
-// FIXME: Use our C++ thread abstraction API since it provides a much
-// higher level of encapsulation and safety.
-#include <pthread.h>
-#endif
-
 #include <realm/aggregate_ops.hpp>
 #include <realm/binary_data.hpp>
 #include <realm/column_type_traits.hpp>
@@ -41,13 +34,19 @@
 #include <realm/obj_list.hpp>
 #include <realm/table_ref.hpp>
 #include <realm/util/bind_ptr.hpp>
+#include <realm/util/function_ref.hpp>
 #include <realm/util/serializer.hpp>
 
 namespace realm {
 
+namespace util {
+class WorkStealingPool;
+}
 
 // Pre-declarations
 class Array;
+class ArrayPayload;
+class Cluster;
 class Expression;
 class Group;
 class LinkMap;
@@ -277,12 +276,24 @@ public:
     // Deletion
     size_t remove() const;
 
-#if REALM_MULTITHREAD_QUERY
     // Multi-threading
-    TableView find_all_multi(size_t start = 0, size_t end = size_t(-1));
-    TableView find_all_multi(size_t start = 0, size_t end = size_t(-1)) const;
-    int set_threads(unsigned int threadcount);
-#endif
+    //
+    // When more than one thread is requested, find_all(), count() and the
+    // sum/min/max/avg aggregates split the leaves of the table across a pool of
+    // worker threads, each evaluating its own copy of the query conditions.
+    // Results are merged in key order, so they are identical to those of a
+    // single threaded run (except for rounding in floating point sums).
+    //
+    // Only queries on frozen tables are run in parallel, as only frozen
+    // transactions may be read from several threads at once. Queries
+    // restricted by a view, and queries driven by a search index, always run
+    // on the calling thread.
+    //
+    // A thread count of 0 uses a process wide pool with one thread per
+    // hardware thread. A thread count of 1 (the default) disables parallel
+    // execution.
+    Query& set_threads(unsigned int threadcount);
+    unsigned int get_threads() const noexcept;
 
     const ConstTableRef& get_table() const noexcept
     {
@@ -323,6 +334,12 @@ public:
     std::string get_description() const;
     std::string get_description_safe() const noexcept;
 
+    /// Describe how the query is run: the condition driving the search and
+    /// whether it is looked up in an index, the conditions the objects it
+    /// finds are then tested against with their estimated number of matches,
+    /// and the number of objects found. The query is run to count them.
+    std::string explain() const;
+
     Query& set_ordering(util::bind_ptr<DescriptorOrdering> ordering);
     // This will remove the ordering from the Query object
     util::bind_ptr<DescriptorOrdering> get_ordering();
@@ -366,6 +383,11 @@ private:
     void aggregate_internal(ParentNode* pn, QueryStateBase* st, size_t start, size_t end,
                             ArrayPayload* source_column) const;
 
+    using PayloadFunction = util::FunctionRef<ArrayPayload*(const Cluster*, size_t worker_ndx)>;
+    bool can_run_in_parallel() const;
+    bool aggregate_parallel(QueryStateBase& st, PayloadFunction get_payload) const;
+    bool find_all_parallel(QueryStateBase& st) const;
+
     void do_find_all(QueryStateBase& st) const;
     size_t do_count(size_t limit = size_t(-1)) const;
     void delete_nodes() noexcept;
@@ -406,6 +428,9 @@ private:
     TableView* m_source_table_view = nullptr; // table views are not refcounted, and not owned by the query.
     std::unique_ptr<TableView> m_owned_source_table_view; // <--- except when indicated here
     util::bind_ptr<DescriptorOrdering> m_ordering;
+
+    // Set if parallel execution has been requested with set_threads()
+    std::shared_ptr<util::WorkStealingPool> m_pool;
 };
 
 // Implementation:
@@ -20,6 +20,9 @@
 #define REALM_QUERY_CONDITIONS_TPL_HPP
 
 #include <realm/aggregate_ops.hpp>
+#include <realm/array_basic.hpp>
+#include <realm/array_integer.hpp>
+#include <realm/array_timestamp.hpp>
 #include <realm/query_conditions.hpp>
 #include <realm/column_type_traits.hpp>
 
@@ -59,6 +62,37 @@ public:
         }
         return (m_limit > m_match_count);
     }
+    bool match_range(size_t begin, size_t end) noexcept final
+    {
+        if (m_limit != size_t(-1) || !m_source_column)
+            return QueryStateBase::match_range(begin, end);
+        if constexpr (std::is_same_v<T, int64_t>) {
+            if (auto leaf = dynamic_cast<const ArrayInteger*>(m_source_column)) {
+                m_state.accumulate_block(leaf->get_sum(begin, end), end - begin);
+                m_match_count += end - begin;
+                return true;
+            }
+            if (auto leaf = dynamic_cast<const ArrayIntNull*>(m_source_column)) {
+                size_t count;
+                int64_t sum = leaf->get_sum(begin, end, count);
+                m_state.accumulate_block(sum, count);
+                m_match_count += count;
+                return true;
+            }
+        }
+        else if constexpr (std::is_floating_point_v<T>) {
+            if (auto leaf = dynamic_cast<const BasicArray<T>*>(m_source_column)) {
+                // Floating point additions are kept in order, so that the
+                // result is exactly that of the one-by-one path
+                for (size_t i = begin; i < end; ++i) {
+                    if (m_state.accumulate(leaf->get(i)))
+                        ++m_match_count;
+                }
+                return true;
+            }
+        }
+        return QueryStateBase::match_range(begin, end);
+    }
     ResultType result_sum() const
     {
         return m_state.result();
@@ -67,6 +101,16 @@ public:
     {
         return m_state.items_counted();
     }
+    std::unique_ptr<QueryStateBase> make_partial() const final
+    {
+        return std::make_unique<QueryStateSum>();
+    }
+    void merge_partial(const QueryStateBase& other) final
+    {
+        auto& partial = static_cast<const QueryStateSum&>(other);
+        m_state.merge(partial.m_state);
+        m_match_count += partial.m_match_count;
+    }
 
 private:
     aggregate_operations::Sum<typename util::RemoveOptional<T>::type> m_state;
@@ -106,13 +150,69 @@ public:
         }
         return m_limit > m_match_count;
     }
+    bool match_range(size_t begin, size_t end) noexcept override
+    {
+        if (m_limit != size_t(-1) || !m_source_column)
+            return QueryStateBase::match_range(begin, end);
+        using Value = typename util::RemoveOptional<R>::type;
+        constexpr bool max = std::is_same_v<State<Value>, aggregate_operations::Maximum<Value>>;
+        Value v;
+        size_t ndx;
+        if constexpr (std::is_same_v<Value, int64_t>) {
+            if (auto leaf = dynamic_cast<const ArrayInteger*>(m_source_column)) {
+                if (max ? leaf->get_max(v, begin, end, &ndx) : leaf->get_min(v, begin, end, &ndx))
+                    accumulate_at(v, ndx);
+                return true;
+            }
+            if (auto leaf = dynamic_cast<const ArrayIntNull*>(m_source_column)) {
+                if (max ? leaf->get_max(v, begin, end, &ndx) : leaf->get_min(v, begin, end, &ndx))
+                    accumulate_at(v, ndx);
+                return true;
+            }
+        }
+        else if constexpr (std::is_floating_point_v<Value>) {
+            if (auto leaf = dynamic_cast<const BasicArray<Value>*>(m_source_column)) {
+                if (max ? leaf->get_max(v, begin, end, &ndx) : leaf->get_min(v, begin, end, &ndx))
+                    accumulate_at(v, ndx);
+                return true;
+            }
+        }
+        else if constexpr (std::is_same_v<Value, Timestamp>) {
+            if (auto leaf = dynamic_cast<const ArrayTimestamp*>(m_source_column)) {
+                for (size_t i = begin; i < end; ++i)
+                    accumulate_at(leaf->get(i), i);
+                return true;
+            }
+        }
+        return QueryStateBase::match_range(begin, end);
+    }
     Mixed get_result() const
     {
         return m_state.is_null() ? Mixed() : m_state.result();
     }
+    std::unique_ptr<QueryStateBase> make_partial() const override
+    {
+        return std::make_unique<QueryStateMinMax>();
+    }
+    void merge_partial(const QueryStateBase& other) override
+    {
+        auto& partial = static_cast<const QueryStateMinMax&>(other);
+        if (m_state.merge(partial.m_state))
+            m_minmax_key = partial.m_minmax_key;
+        m_match_count += partial.m_match_count;
+    }
 
 private:
     State<typename util::RemoveOptional<R>::type> m_state;
+
+    template <class V>
+    void accumulate_at(const V& value, size_t index)
+    {
+        if (m_state.accumulate(value)) {
+            ++m_match_count;
+            m_minmax_key = (m_key_values ? m_key_values->get(index) : index) + m_key_offset;
+        }
+    }
 };
 
 template <class R>
@@ -37,6 +37,55 @@ ParentNode::ParentNode(const ParentNode& from)
 }
 
 
+void ParentNode::plan()
+{
+    // With a single condition there is nothing to choose
+    if (m_children.size() < 2)
+        return;
+
+    size_t num_objects = m_table.unchecked_ptr()->size();
+    for (auto node : m_children) {
+        if (auto selectivity = node->estimated_selectivity())
+            node->m_dD = 1 / std::max(*selectivity, 1.0 / (num_objects + 1));
+    }
+
+    // After a match of a condition, the others are tested until one fails, so
+    // test those least likely to match and quickest to test first
+    auto by_cost = [](const ParentNode* a, const ParentNode* b) {
+        return a->cost() < b->cost();
+    };
+    for (auto node : m_children)
+        std::stable_sort(node->m_children.begin() + 1, node->m_children.end(), by_cost);
+}
+
+std::optional<double> ParentNode::estimated_chain_selectivity() const
+{
+    double selectivity = 1;
+    for (auto node : m_children) {
+        auto s = node->estimated_selectivity();
+        if (!s)
+            return {};
+        selectivity *= *s;
+    }
+    return selectivity;
+}
+
+std::optional<double> ParentNode::selectivity_from_index(size_t num_matches) const
+{
+    size_t num_objects = m_table.unchecked_ptr()->size();
+    return num_objects ? double(num_matches) / num_objects : 0;
+}
+
+std::optional<double> ParentNode::selectivity_from_statistics(Mixed value) const
+{
+    return m_table.unchecked_ptr()->get_column_statistics(m_condition_column_key).selectivity(value);
+}
+
+std::optional<double> ParentNode::selectivity_from_statistics(const SortedIndex::Range& range) const
+{
+    return m_table.unchecked_ptr()->get_column_statistics(m_condition_column_key).selectivity(range);
+}
+
 size_t ParentNode::find_first(size_t start, size_t end)
 {
     size_t sz = m_children.size();
@@ -382,6 +431,155 @@ size_t IndexEvaluator::do_search_index(const Cluster* cluster, size_t start, siz
     return not_found;
 }
 
+void SortedIndexRange::init(ParentNode& node, const Table& table, std::optional<Range> range)
+{
+    if (m_use_index)
+        node.m_dT = m_scan_dT;
+    m_use_index = false;
+    m_evaluator.reset();
+    m_matches.clear();
+
+    ColKey col = node.m_condition_column_key;
+    m_range = std::move(range);
+    m_index = nullptr;
+    if (!m_range || table.search_index_type(col) != IndexType::Sorted)
+        return;
+    m_index = static_cast<const SortedIndex*>(table.get_search_index(col));
+
+    // The conditions further down the chain have already been initialized
+    m_lookup = *m_range;
+    std::vector<ParentNode*> folded;
+    for (ParentNode* n = node.m_child.get(); n; n = n->m_child.get()) {
+        if (n->m_condition_column_key != col)
+            continue;
+        if (auto other = n->sorted_index_range()) {
+            m_lookup.intersect(*other);
+            folded.push_back(n);
+        }
+    }
+
+    // Collecting and sorting the keys of a match costs far more than testing
+    // an object in a scan, so only use the index for selective ranges
+    constexpr size_t selectivity = 16;
+    m_count = m_index->count(m_lookup);
+    if (m_count * selectivity > table.size())
+        return;
+
+    for (auto n : folded)
+        n->skip_sorted_index();
+    m_use_index = true;
+    m_scan_dT = node.m_dT;
+    node.m_dT = 0;
+}
+
+std::optional<double> SortedIndexRange::selectivity(const ParentNode& node) const
+{
+    if (m_use_index)
+        return node.selectivity_from_index(m_count);
+    if (m_range)
+        return node.selectivity_from_statistics(*m_range);
+    return {};
+}
+
+void SortedIndexRange::skip(ParentNode& node)
+{
+    if (m_use_index)
+        node.m_dT = m_scan_dT;
+    m_use_index = false;
+    m_evaluator.reset();
+    m_matches.clear();
+}
+
+IndexEvaluator* SortedIndexRange::evaluator()
+{
+    if (!m_use_index)
+        return nullptr;
+    if (!m_evaluator) {
+        // The evaluator needs the keys in the order of the objects
+        m_index->find_range(m_matches, m_lookup);
+        std::sort(m_matches.begin(), m_matches.end());
+        m_evaluator.emplace();
+        m_evaluator->init(&m_matches);
+    }
+    return &*m_evaluator;
+}
+
+void CompositeIndexLookup::init(ParentNode& node, const Table& table, std::optional<Mixed> value)
+{
+    skip(node);
+
+    auto& indexes = table.get_composite_indexes();
+    if (!value || indexes.empty())
+        return;
+
+    // The conditions further down the chain have already been initialized.
+    // The value of this condition comes first, as it will not be evaluated
+    // again if the index is used.
+    ColKey col = node.m_condition_column_key;
+    std::vector<std::pair<ParentNode*, Mixed>> conditions{{&node, *value}};
+    for (ParentNode* n = node.m_child.get(); n; n = n->m_child.get()) {
+        if (auto v = n->composite_index_value())
+            conditions.emplace_back(n, *v);
+    }
+
+    // A lookup in the index of a single column is just as good, so a prefix
+    // of a single column is only used if there is no such index
+    size_t min_prefix = table.search_index_type(col) == IndexType::None ? 1 : 2;
+    const CompositeIndex* best = nullptr;
+    std::vector<Mixed> best_values;
+    std::vector<ParentNode*> best_nodes;
+    for (auto& index : indexes) {
+        std::vector<Mixed> values;
+        std::vector<ParentNode*> nodes;
+        for (auto c : index->get_columns()) {
+            auto it = std::find_if(conditions.begin(), conditions.end(), [c](auto& cond) {
+                return cond.first->m_condition_column_key == c;
+            });
+            if (it == conditions.end())
+                break;
+            values.push_back(it->second);
+            nodes.push_back(it->first);
+        }
+        if (values.size() < min_prefix || values.size() <= best_values.size() ||
+            std::find(nodes.begin(), nodes.end(), &node) == nodes.end())
+            continue;
+        best = index.get();
+        best_values = std::move(values);
+        best_nodes = std::move(nodes);
+    }
+    if (!best)
+        return;
+
+    for (auto n : best_nodes) {
+        if (n != &node)
+            n->skip_composite_index();
+    }
+
+    // The evaluator needs the keys in the order of the objects
+    best->find_all(m_matches, best_values);
+    if (best_values.size() < best->get_columns().size())
+        std::sort(m_matches.begin(), m_matches.end());
+    m_evaluator.emplace();
+    m_evaluator->init(&m_matches);
+
+    // The lookup is at least as selective as a lookup in the index of any of
+    // the columns, which all have a match distance of 100
+    m_scan_dT = node.m_dT;
+    m_scan_dD = node.m_dD;
+    node.m_dT = 0;
+    node.m_dD = std::max(101.0, double(table.size()) / (m_matches.size() + 1));
+}
+
+void CompositeIndexLookup::skip(ParentNode& node)
+{
+    if (m_evaluator) {
+        node.m_dT = m_scan_dT;
+        node.m_dD = m_scan_dD;
+    }
+    m_evaluator.reset();
+    m_matches.clear();
+}
+
 StringNode<Equal>::StringNode(ColKey col, const Mixed* begin, const Mixed* end)
     : StringNodeEqualBase(StringData(), col)
 {
@@ -405,6 +603,30 @@ StringNode<Equal>::StringNode(ColKey col, const Mixed* begin, const Mixed* end)
     }
 }
 
+void StringNode<Equal>::init(bool will_query_ranges)
+{
+    StringNodeEqualBase::init(will_query_ranges);
+    m_composite_lookup.init(*this, *m_table.unchecked_ptr(), composite_index_value());
+}
+
+std::optional<double> StringNode<Equal>::estimated_selectivity() const
+{
+    if (auto num_matches = m_composite_lookup.num_matches())
+        return selectivity_from_index(*num_matches);
+    if (m_index_evaluator)
+        return selectivity_from_index(m_index_evaluator->size());
+    if (m_needles.empty())
+        return selectivity_from_statistics(m_string_value);
+    double selectivity = 0;
+    for (auto& needle : m_needles) {
+        auto s = selectivity_from_statistics(needle);
+        if (!s)
+            return {};
+        selectivity += *s;
+    }
+    return std::min(selectivity, 1.0);
+}
+
 void StringNode<Equal>::_search_index_init()
 {
     if (!m_needles.empty()) {
@@ -86,6 +86,7 @@ TConditionValue:    Type of values in condition column. That is, int64_t, float,
 #include <realm/array_timestamp.hpp>
 #include <realm/column_integer.hpp>
 #include <realm/column_type_traits.hpp>
+#include <realm/index_sorted.hpp>
 #include <realm/index_string.hpp>
 #include <realm/query_conditions.hpp>
 #include <realm/query_expression.hpp>
@@ -121,6 +122,41 @@ public:
     {
         return nullptr;
     }
+    /// The values accepted by a range condition which can be looked up in a sorted index
+    virtual const SortedIndex::Range* sorted_index_range() const
+    {
+        return nullptr;
+    }
+    /// The values accepted by this condition are looked up in a sorted index
+    /// by an earlier condition on the same column, so don't look them up again
+    virtual void skip_sorted_index() {}
+    /// The value of an equality condition which can be looked up in a composite index
+    virtual std::optional<Mixed> composite_index_value() const
+    {
+        return {};
+    }
+    /// This condition is part of a composite index lookup done by an earlier
+    /// condition, so don't do a lookup of its own
+    virtual void skip_composite_index() {}
+    /// The estimated share of the objects matching this condition, or none if
+    /// there is no estimate
+    virtual std::optional<double> estimated_selectivity() const
+    {
+        return {};
+    }
+    /// The estimated share of the objects matching all the conditions of the
+    /// chain, taking them to be independent
+    std::optional<double> estimated_chain_selectivity() const;
+
+    std::optional<double> selectivity_from_index(size_t num_matches) const;
+    std::optional<double> selectivity_from_statistics(Mixed value) const;
+    std::optional<double> selectivity_from_statistics(const SortedIndex::Range& range) const;
+
+    /// Start out with the match distances of the conditions of the chain
+    /// estimated from their selectivity instead of waiting for them to be
+    /// learned, and let every condition test the others in order of cost. To
+    /// be called on the first condition after gather_children().
+    void plan();
 
     void gather_children(std::vector<ParentNode*>& v)
     {
@@ -355,6 +391,106 @@ private:
     std::vector<ObjKey>* m_matching_keys = nullptr;
 };
 
+/// Looks up the objects matching a range condition (<, <=, >, >=, between) in
+/// a sorted index instead of scanning the column. Range conditions on the same
+/// column further down the chain of ANDed conditions are folded into the
+/// lookup, so `a > 5 && a < 10` becomes a single range of the index. The
+/// index is only used if the range is selective enough to beat a scan, and
+/// the matches are only collected when the condition is first evaluated.
+class SortedIndexRange {
+public:
+    using Range = SortedIndex::Range;
+
+    template <class TConditionFunction>
+    static std::optional<Range> make_range(Mixed value, bool include_nulls = false);
+
+    SortedIndexRange() = default;
+    // A copy finds its own matches when initialized
+    SortedIndexRange(const SortedIndexRange&) {}
+
+    void init(ParentNode& node, const Table& table, std::optional<Range> range);
+    void skip(ParentNode& node);
+
+    const Range* range() const
+    {
+        return m_index ? &*m_range : nullptr;
+    }
+    IndexEvaluator* evaluator();
+    /// The exact share of matches if the index is used, otherwise the share
+    /// estimated from the statistics of the column
+    std::optional<double> selectivity(const ParentNode& node) const;
+
+private:
+    std::optional<Range> m_range;
+    const SortedIndex* m_index = nullptr;
+    Range m_lookup;
+    size_t m_count = 0;
+    bool m_use_index = false;
+    double m_scan_dT = 0;
+    std::vector<ObjKey> m_matches;
+    std::optional<IndexEvaluator> m_evaluator;
+};
+
+/// Looks up the objects matching a chain of ANDed equality conditions in a
+/// composite index. The condition doing the lookup collects the values of the
+/// equality conditions further down the chain and uses the index covering the
+/// longest prefix of its columns. The other conditions of the prefix are still
+/// evaluated, but don't do lookups of their own.
+class CompositeIndexLookup {
+public:
+    CompositeIndexLookup() = default;
+    // A copy does its own lookup when initialized
+    CompositeIndexLookup(const CompositeIndexLookup&) {}
+
+    void init(ParentNode& node, const Table& table, std::optional<Mixed> value);
+    void skip(ParentNode& node);
+
+    IndexEvaluator* evaluator()
+    {
+        return m_evaluator ? &*m_evaluator : nullptr;
+    }
+    std::optional<size_t> num_matches() const
+    {
+        if (m_evaluator)
+            return m_matches.size();
+        return {};
+    }
+
+private:
+    double m_scan_dT = 0;
+    double m_scan_dD = 0;
+    std::vector<ObjKey> m_matches;
+    std::optional<IndexEvaluator> m_evaluator;
+};
+
+template <class TConditionFunction>
+std::optional<SortedIndex::Range> SortedIndexRange::make_range(Mixed value, bool include_nulls)
+{
+    if (SortedIndex::is_null_or_nan(value))
+        return {};
+    Range range;
+    if constexpr (std::is_same_v<TConditionFunction, Greater>) {
+        range.begin = value;
+        range.begin_inclusive = false;
+    }
+    else if constexpr (std::is_same_v<TConditionFunction, GreaterEqual>) {
+        range.begin = value;
+    }
+    else if constexpr (std::is_same_v<TConditionFunction, Less>) {
+        range.end = value;
+        range.end_inclusive = false;
+        range.include_nulls = include_nulls;
+    }
+    else if constexpr (std::is_same_v<TConditionFunction, LessEqual>) {
+        range.end = value;
+        range.include_nulls = include_nulls;
+    }
+    else {
+        return {};
+    }
+    return range;
+}
+
 template <class LeafType>
 class IntegerNodeBase : public ColumnNodeBase {
 public:
@@ -425,6 +561,7 @@ public:
         : ColumnNodeBase(from)
         , m_from(from.m_from)
         , m_to(from.m_to)
+        , m_index_range(from.m_index_range)
     {
     }
 
@@ -439,10 +576,36 @@ public:
         ColumnNodeBase::init(will_query_ranges);
 
         m_dT = .25;
+        SortedIndex::Range range;
+        range.begin = Mixed(m_from);
+        range.end = Mixed(m_to);
+        m_index_range.init(*this, *m_table.unchecked_ptr(), range);
+    }
+
+    const SortedIndex::Range* sorted_index_range() const override
+    {
+        return m_index_range.range();
+    }
+
+    void skip_sorted_index() override
+    {
+        m_index_range.skip(*this);
+    }
+
+    std::optional<double> estimated_selectivity() const override
+    {
+        return m_index_range.selectivity(*this);
+    }
+
+    const IndexEvaluator* index_based_keys() override
+    {
+        return m_index_range.evaluator();
     }
 
     size_t find_first_local(size_t start, size_t end) override
     {
+        if (auto index_evaluator = m_index_range.evaluator())
+            return index_evaluator->do_search_index(m_cluster, start, end);
         return m_leaf->find_first_in_range(m_from, m_to, start, end);
     }
 
@@ -464,6 +627,8 @@ private:
 
     // Leaf cache
     std::optional<LeafType> m_leaf;
+
+    SortedIndexRange m_index_range;
 };
 
 
@@ -481,16 +646,48 @@ public:
     }
     IntegerNode(const IntegerNode& from)
         : BaseType(from)
+        , m_index_range(from.m_index_range)
+    {
+    }
+
+    void init(bool will_query_ranges) override
+    {
+        BaseType::init(will_query_ranges);
+        m_index_range.init(*this, *this->m_table.unchecked_ptr(),
+                           SortedIndexRange::make_range<TConditionFunction>(this->m_value));
+    }
+
+    const SortedIndex::Range* sorted_index_range() const override
+    {
+        return m_index_range.range();
+    }
+
+    void skip_sorted_index() override
+    {
+        m_index_range.skip(*this);
+    }
+
+    std::optional<double> estimated_selectivity() const override
+    {
+        return m_index_range.selectivity(*this);
+    }
+
+    const IndexEvaluator* index_based_keys() override
     {
+        return m_index_range.evaluator();
     }
 
     size_t find_first_local(size_t start, size_t end) override
     {
+        if (auto index_evaluator = m_index_range.evaluator())
+            return index_evaluator->do_search_index(this->m_cluster, start, end);
         return this->m_leaf->template find_first<TConditionFunction>(this->m_value, start, end);
     }
 
     size_t find_all_local(size_t start, size_t end) override
     {
+        if (m_index_range.evaluator())
+            return ParentNode::find_all_local(start, end);
         return BaseType::template find_all_local<TConditionFunction>(start, end);
     }
 
@@ -503,6 +700,9 @@ public:
     {
         return std::unique_ptr<ParentNode>(new ThisType(*this));
     }
+
+private:
+    SortedIndexRange m_index_range;
 };
 
 template <size_t linear_search_threshold, class LeafType, class NeedleContainer>
@@ -594,6 +794,37 @@ public:
             m_index_evaluator->init(index, BaseType::m_value);
             IntegerNodeBase<LeafType>::m_dT = 0;
         }
+        m_composite_lookup.init(*this, *ParentNode::m_table.unchecked_ptr(), composite_index_value());
+    }
+
+    std::optional<Mixed> composite_index_value() const override
+    {
+        if (!m_needles.empty())
+            return {};
+        return Mixed(BaseType::m_value);
+    }
+
+    void skip_composite_index() override
+    {
+        m_composite_lookup.skip(*this);
+    }
+
+    std::optional<double> estimated_selectivity() const override
+    {
+        if (auto num_matches = m_composite_lookup.num_matches())
+            return this->selectivity_from_index(*num_matches);
+        if (m_index_evaluator)
+            return this->selectivity_from_index(m_index_evaluator->size());
+        if (m_needles.empty())
+            return this->selectivity_from_statistics(Mixed(BaseType::m_value));
+        double selectivity = 0;
+        for (auto& needle : m_needles) {
+            auto s = this->selectivity_from_statistics(Mixed(needle));
+            if (!s)
+                return {};
+            selectivity += *s;
+        }
+        return std::min(selectivity, 1.0);
     }
 
     bool do_consume_condition(ParentNode& node) override
@@ -616,12 +847,15 @@ public:
 
     bool has_search_index() const override
     {
-        return this->m_table->search_index_type(IntegerNodeBase<LeafType>::m_condition_column_key) ==
-               IndexType::General;
+        // Both the general and the sorted index can look up equal values
+        return this->m_table->search_index_type(IntegerNodeBase<LeafType>::m_condition_column_key) !=
+               IndexType::None;
     }
 
     const IndexEvaluator* index_based_keys() override
     {
+        if (auto index_evaluator = m_composite_lookup.evaluator())
+            return index_evaluator;
         return m_index_evaluator ? &(*m_index_evaluator) : nullptr;
     }
 
@@ -634,6 +868,9 @@ public:
             if (m_nb_needles) {
                 s = find_first_haystack<22>(*this->m_leaf, m_needles, start, end);
             }
+            else if (auto index_evaluator = m_composite_lookup.evaluator()) {
+                return index_evaluator->do_search_index(BaseType::m_cluster, start, end);
+            }
             else if (m_index_evaluator) {
                 return m_index_evaluator->do_search_index(BaseType::m_cluster, start, end);
             }
@@ -683,6 +920,7 @@ private:
     std::unordered_set<TConditionValue> m_needles;
     size_t m_nb_needles = 0;
     std::optional<IndexEvaluator> m_index_evaluator;
+    CompositeIndexLookup m_composite_lookup;
 
     IntegerNode(const IntegerNode<LeafType, Equal>& from)
         : BaseType(from)
@@ -718,8 +956,40 @@ public:
         m_cluster->init_leaf(this->m_condition_column_key, &*m_leaf);
     }
 
+    void init(bool will_query_ranges) override
+    {
+        ParentNode::init(will_query_ranges);
+        m_index_range.init(*this, *m_table.unchecked_ptr(), SortedIndexRange::make_range<TConditionFunction>(m_value));
+    }
+
+    const SortedIndex::Range* sorted_index_range() const override
+    {
+        return m_index_range.range();
+    }
+
+    void skip_sorted_index() override
+    {
+        m_index_range.skip(*this);
+    }
+
+    std::optional<double> estimated_selectivity() const override
+    {
+        if constexpr (std::is_same_v<TConditionFunction, Equal>) {
+            return selectivity_from_statistics(Mixed(m_value));
+        }
+        return m_index_range.selectivity(*this);
+    }
+
+    const IndexEvaluator* index_based_keys() override
+    {
+        return m_index_range.evaluator();
+    }
+
     size_t find_first_local(size_t start, size_t end) override
     {
+        if (auto index_evaluator = m_index_range.evaluator())
+            return index_evaluator->do_search_index(m_cluster, start, end);
+
         TConditionFunction cond;
 
         auto find = [&](bool nullability) {
@@ -759,12 +1029,14 @@ public:
     FloatDoubleNode(const FloatDoubleNode& from)
         : ParentNode(from)
         , m_value(from.m_value)
+        , m_index_range(from.m_index_range)
     {
     }
 
 protected:
     TConditionValue m_value;
     std::optional<LeafType> m_leaf;
+    SortedIndexRange m_index_range;
 };
 
 template <class T, class TConditionFunction>
@@ -964,9 +1236,35 @@ public:
                 m_index_evaluator->init(index, m_value);
                 this->m_dT = 0;
             }
+            m_composite_lookup.init(*this, *m_table.unchecked_ptr(), composite_index_value());
         }
     }
 
+    std::optional<Mixed> composite_index_value() const override
+    {
+        if constexpr (std::is_same_v<TConditionFunction, Equal>) {
+            return Mixed(m_value);
+        }
+        return {};
+    }
+
+    void skip_composite_index() override
+    {
+        m_composite_lookup.skip(*this);
+    }
+
+    std::optional<double> estimated_selectivity() const override
+    {
+        if constexpr (std::is_same_v<TConditionFunction, Equal>) {
+            if (auto num_matches = m_composite_lookup.num_matches())
+                return selectivity_from_index(*num_matches);
+            if (m_index_evaluator)
+                return selectivity_from_index(m_index_evaluator->size());
+            return selectivity_from_statistics(Mixed(m_value));
+        }
+        return {};
+    }
+
     void table_changed() override
     {
         if constexpr (std::is_same_v<TConditionFunction, Equal>) {
@@ -977,6 +1275,8 @@ public:
 
     const IndexEvaluator* index_based_keys() override
     {
+        if (auto index_evaluator = m_composite_lookup.evaluator())
+            return index_evaluator;
         return m_index_evaluator ? &(*m_index_evaluator) : nullptr;
     }
 
@@ -994,6 +1294,9 @@ public:
     size_t find_first_local(size_t start, size_t end) override
     {
         if constexpr (std::is_same_v<TConditionFunction, Equal>) {
+            if (auto index_evaluator = m_composite_lookup.evaluator()) {
+                return index_evaluator->do_search_index(m_cluster, start, end);
+            }
             if (m_index_evaluator) {
                 return m_index_evaluator->do_search_index(m_cluster, start, end);
             }
@@ -1024,6 +1327,7 @@ private:
     std::optional<bool> m_value;
     std::optional<ArrayBoolNull> m_leaf;
     std::optional<IndexEvaluator> m_index_evaluator;
+    CompositeIndexLookup m_composite_lookup;
 };
 
 class TimestampNodeBase : public ParentNode {
@@ -1076,6 +1380,11 @@ public:
                 m_index_evaluator->init(index, TimestampNodeBase::m_value);
                 this->m_dT = 0;
             }
+            m_composite_lookup.init(*this, *m_table.unchecked_ptr(), composite_index_value());
+        }
+        else {
+            m_index_range.init(*this, *m_table.unchecked_ptr(),
+                               SortedIndexRange::make_range<TConditionFunction>(m_value));
         }
     }
 
@@ -1083,14 +1392,53 @@ public:
     {
         if constexpr (std::is_same_v<TConditionFunction, Equal>) {
             const bool has_index =
-                this->m_table->search_index_type(TimestampNodeBase::m_condition_column_key) == IndexType::General;
+                this->m_table->search_index_type(TimestampNodeBase::m_condition_column_key) != IndexType::None;
             m_index_evaluator = has_index ? std::make_optional(IndexEvaluator{}) : std::nullopt;
         }
     }
 
+    const SortedIndex::Range* sorted_index_range() const override
+    {
+        return m_index_range.range();
+    }
+
+    void skip_sorted_index() override
+    {
+        m_index_range.skip(*this);
+    }
+
+    std::optional<double> estimated_selectivity() const override
+    {
+        if constexpr (std::is_same_v<TConditionFunction, Equal>) {
+            if (auto num_matches = m_composite_lookup.num_matches())
+                return selectivity_from_index(*num_matches);
+            if (m_index_evaluator)
+                return selectivity_from_index(m_index_evaluator->size());
+            return selectivity_from_statistics(Mixed(m_value));
+        }
+        return m_index_range.selectivity(*this);
+    }
+
+    std::optional<Mixed> composite_index_value() const override
+    {
+        if constexpr (std::is_same_v<TConditionFunction, Equal>) {
+            return Mixed(m_value);
+        }
+        return {};
+    }
+
+    void skip_composite_index() override
+    {
+        m_composite_lookup.skip(*this);
+    }
+
     const IndexEvaluator* index_based_keys() override
     {
-        return m_index_evaluator ? &*m_index_evaluator : nullptr;
+        if (auto index_evaluator = m_composite_lookup.evaluator())
+            return index_evaluator;
+        if (m_index_evaluator)
+            return &*m_index_evaluator;
+        return m_index_range.evaluator();
     }
 
     bool has_search_index() const override
@@ -1101,10 +1449,16 @@ public:
     size_t find_first_local(size_t start, size_t end) override
     {
         if constexpr (std::is_same_v<TConditionFunction, Equal>) {
+            if (auto index_evaluator = m_composite_lookup.evaluator()) {
+                return index_evaluator->do_search_index(this->m_cluster, start, end);
+            }
             if (m_index_evaluator) {
                 return m_index_evaluator->do_search_index(this->m_cluster, start, end);
             }
         }
+        else if (auto index_evaluator = m_index_range.evaluator()) {
+            return index_evaluator->do_search_index(this->m_cluster, start, end);
+        }
         return m_leaf->find_first<TConditionFunction>(m_value, start, end);
     }
 
@@ -1122,6 +1476,8 @@ public:
 
 protected:
     std::optional<IndexEvaluator> m_index_evaluator;
+    SortedIndexRange m_index_range;
+    CompositeIndexLookup m_composite_lookup;
 };
 
 class DecimalNodeBase : public ParentNode {
@@ -1315,10 +1671,43 @@ public:
             m_index_evaluator->init(index, m_optional_value);
             this->m_dT = 0;
         }
+        m_composite_lookup.init(*this, *BaseType::m_table.unchecked_ptr(), composite_index_value());
+    }
+
+    std::optional<Mixed> composite_index_value() const override
+    {
+        if (!m_needles.empty())
+            return {};
+        return Mixed(m_optional_value);
+    }
+
+    void skip_composite_index() override
+    {
+        m_composite_lookup.skip(*this);
+    }
+
+    std::optional<double> estimated_selectivity() const override
+    {
+        if (auto num_matches = m_composite_lookup.num_matches())
+            return this->selectivity_from_index(*num_matches);
+        if (m_index_evaluator)
+            return this->selectivity_from_index(m_index_evaluator->size());
+        if (m_needles.empty())
+            return this->selectivity_from_statistics(Mixed(m_optional_value));
+        double selectivity = 0;
+        for (auto& needle : m_needles) {
+            auto s = this->selectivity_from_statistics(Mixed(needle));
+            if (!s)
+                return {};
+            selectivity += *s;
+        }
+        return std::min(selectivity, 1.0);
     }
 
     const IndexEvaluator* index_based_keys() override
     {
+        if (auto index_evaluator = m_composite_lookup.evaluator())
+            return index_evaluator;
         return m_index_evaluator ? &(*m_index_evaluator) : nullptr;
     }
 
@@ -1336,6 +1725,9 @@ public:
             if (m_nb_needles) {
                 return find_first_haystack<22>(*this->m_leaf, m_needles, start, end);
             }
+            if (auto index_evaluator = m_composite_lookup.evaluator()) {
+                return index_evaluator->do_search_index(this->m_cluster, start, end);
+            }
             if (m_index_evaluator) {
                 return m_index_evaluator->do_search_index(this->m_cluster, start, end);
             }
@@ -1400,6 +1792,7 @@ protected:
     std::optional<IndexEvaluator> m_index_evaluator;
     std::unordered_set<std::optional<ObjectType>> m_needles;
     size_t m_nb_needles = 0;
+    CompositeIndexLookup m_composite_lookup;
 };
 
 
@@ -1732,10 +2125,39 @@ public:
     {
         StringNodeBase::init(will_query_ranges);
         clear_leaf_state();
+        if constexpr (case_sensitive_comparison) {
+            // Null strings are smaller than all other strings
+            constexpr bool include_nulls = true;
+            m_index_range.init(*this, *m_table.unchecked_ptr(),
+                               SortedIndexRange::make_range<TConditionFunction>(m_string_value, include_nulls));
+        }
+    }
+
+    const SortedIndex::Range* sorted_index_range() const override
+    {
+        return m_index_range.range();
+    }
+
+    void skip_sorted_index() override
+    {
+        m_index_range.skip(*this);
+    }
+
+    std::optional<double> estimated_selectivity() const override
+    {
+        return m_index_range.selectivity(*this);
+    }
+
+    const IndexEvaluator* index_based_keys() override
+    {
+        return m_index_range.evaluator();
     }
 
     size_t find_first_local(size_t start, size_t end) override
     {
+        if (auto index_evaluator = m_index_range.evaluator())
+            return index_evaluator->do_search_index(m_cluster, start, end);
+
         TConditionFunction cond;
 
         for (size_t s = start; s < end; ++s) {
@@ -1768,12 +2190,14 @@ public:
         : StringNodeBase(from)
         , m_ucase(from.m_ucase)
         , m_lcase(from.m_lcase)
+        , m_index_range(from.m_index_range)
     {
     }
 
 protected:
     std::string m_ucase;
     std::string m_lcase;
+    SortedIndexRange m_index_range;
 };
 
 // Specialization for Contains condition on Strings - we specialize because we can utilize Boyer-Moore
@@ -1989,8 +2413,37 @@ public:
     }
     StringNode(ColKey col, const Mixed* begin, const Mixed* end);
 
+    void init(bool will_query_ranges) override;
     void _search_index_init() override;
 
+    std::optional<Mixed> composite_index_value() const override
+    {
+        if (!m_needles.empty())
+            return {};
+        return Mixed(m_string_value);
+    }
+
+    void skip_composite_index() override
+    {
+        m_composite_lookup.skip(*this);
+    }
+
+    std::optional<double> estimated_selectivity() const override;
+
+    const IndexEvaluator* index_based_keys() override
+    {
+        if (auto index_evaluator = m_composite_lookup.evaluator())
+            return index_evaluator;
+        return StringNodeEqualBase::index_based_keys();
+    }
+
+    size_t find_first_local(size_t start, size_t end) override
+    {
+        if (auto index_evaluator = m_composite_lookup.evaluator())
+            return index_evaluator->do_search_index(m_cluster, start, end);
+        return StringNodeEqualBase::find_first_local(start, end);
+    }
+
     bool do_consume_condition(ParentNode& other) override;
 
     std::unique_ptr<ParentNode> clone() const override
@@ -2019,6 +2472,7 @@ private:
     size_t _find_first_local(size_t start, size_t end) override;
     std::unordered_set<StringData> m_needles;
     std::vector<std::unique_ptr<char[]>> m_needle_storage;
+    CompositeIndexLookup m_composite_lookup;
 };
 
 
@@ -2193,7 +2647,21 @@ public:
             condition->init(will_query_ranges);
             v.clear();
             condition->gather_children(v);
+            condition->plan();
+        }
+    }
+
+    std::optional<double> estimated_selectivity() const override
+    {
+        // One minus the share of the objects matching none of the alternatives
+        double none = 1;
+        for (auto& condition : m_conditions) {
+            auto s = condition->estimated_chain_selectivity();
+            if (!s)
+                return {};
+            none *= 1 - *s;
         }
+        return 1 - none;
     }
 
     size_t find_first_local(size_t start, size_t end) override
@@ -2367,6 +2835,14 @@ public:
         m_condition->init(false);
         v.clear();
         m_condition->gather_children(v);
+        m_condition->plan();
+    }
+
+    std::optional<double> estimated_selectivity() const override
+    {
+        if (auto s = m_condition->estimated_chain_selectivity())
+            return 1 - *s;
+        return {};
     }
 
     size_t find_first_local(size_t start, size_t end) override;
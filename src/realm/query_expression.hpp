@@ -2596,6 +2596,11 @@ public:
         m_expr->set_cluster(cluster);
     }
 
+    void collect_dependencies(std::vector<TableKey>& tables) const override
+    {
+        m_expr->collect_dependencies(tables);
+    }
+
     // Recursively fetch tables of columns in expression tree. Used when user first builds a stand-alone expression
     // and binds it to a Query at a later time
     ConstTableRef get_base_table() const override
@@ -2696,6 +2701,11 @@ public:
         m_expr->set_cluster(cluster);
     }
 
+    void collect_dependencies(std::vector<TableKey>& tables) const override
+    {
+        m_expr->collect_dependencies(tables);
+    }
+
     // Recursively fetch tables of columns in expression tree. Used when user first builds a stand-alone expression
     // and binds it to a Query at a later time
     ConstTableRef get_base_table() const override
@@ -4350,6 +4360,12 @@ public:
         m_right->set_cluster(cluster);
     }
 
+    void collect_dependencies(std::vector<TableKey>& tables) const override
+    {
+        m_left->collect_dependencies(tables);
+        m_right->collect_dependencies(tables);
+    }
+
     // Recursively fetch tables of columns in expression tree. Used when user first builds a stand-alone expression
     // and
     // binds it to a Query at a later time
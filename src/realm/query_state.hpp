@@ -21,6 +21,7 @@
 
 #include <cstdlib> // size_t
 #include <cstdint> // unint8_t etc
+#include <memory>
 
 #include <realm/node.hpp>
 
@@ -54,12 +55,34 @@ public:
     // from the leaf if needed. Some consumers may not need the value
     // such as when just counting the results in QueryStateCount.
     virtual bool match(size_t index) noexcept = 0;
+    // Called instead of match(index) for every index in [begin, end) when
+    // all of them are known to match, such as when the query has no
+    // conditions. Aggregating states override this to reduce the payload
+    // column a block at a time instead of a value at a time.
+    virtual bool match_range(size_t begin, size_t end) noexcept
+    {
+        for (; begin < end; ++begin) {
+            if (!match(begin))
+                return false;
+        }
+        return true;
+    }
 
     virtual bool match_pattern(size_t, uint64_t)
     {
         return false;
     }
 
+    // Support for parallel query execution. make_partial() returns an empty
+    // state of the same kind (or null if the state cannot be split), and
+    // merge_partial() folds the result of such a state into this one. Partial
+    // states are merged in key order.
+    virtual std::unique_ptr<QueryStateBase> make_partial() const
+    {
+        return nullptr;
+    }
+    virtual void merge_partial(const QueryStateBase&) {}
+
     inline size_t match_count() const noexcept
     {
         return m_match_count;
@@ -100,10 +123,19 @@ public:
     }
     bool match(size_t, Mixed) noexcept final;
     bool match(size_t index) noexcept final;
+    bool match_range(size_t begin, size_t end) noexcept final;
     size_t get_count() const noexcept
     {
         return m_match_count;
     }
+    std::unique_ptr<QueryStateBase> make_partial() const final
+    {
+        return std::make_unique<QueryStateCount>();
+    }
+    void merge_partial(const QueryStateBase& other) final
+    {
+        m_match_count += other.match_count();
+    }
 };
 
 } // namespace realm
@@ -20,6 +20,7 @@
 #include <realm/table.hpp>
 #include <realm/table_view.hpp>
 #include <realm/db.hpp>
+#include <realm/index_sorted.hpp>
 #include <realm/util/assert.hpp>
 #include <realm/list.hpp>
 #include <realm/dictionary.hpp>
@@ -348,6 +349,159 @@ void SortDescriptor::execute(IndexPairs& v, const Sorter& predicate, const BaseD
     }
 }
 
+bool SortDescriptor::execute_with_index(const Table& table, IndexPairs& v, const BaseDescriptor* next) const
+{
+    auto index = get_sorted_index(table);
+    if (!index)
+        return false;
+
+    size_t limit = size_t(-1);
+    if (next && next->get_type() == DescriptorType::Limit) {
+        limit = static_cast<const LimitDescriptor*>(next)->get_limit();
+    }
+
+    // The walk visits about limit * table_size / view_size entries of the
+    // index, which must not be much more than the objects of the view
+    const size_t sz = v.size();
+    const double table_size = double(table.size());
+    if (double(std::min(limit, sz)) * table_size > 4.0 * double(sz) * double(sz))
+        return false;
+    for (size_t i = 1; i < sz; ++i) {
+        if (!(v[i - 1].key_for_object < v[i].key_for_object && v[i - 1].index_in_view < v[i].index_in_view))
+            return false;
+    }
+
+    const size_t wanted = std::min(limit, sz);
+    std::vector<IndexPair> sorted;
+    sorted.reserve(wanted);
+    if (wanted > 0) {
+        index->for_each_sorted(is_ascending(0).value_or(true), [&](ObjKey key) {
+            auto it = std::lower_bound(v.begin(), v.end(), key, [](const IndexPair& pair, ObjKey k) {
+                return pair.key_for_object < k;
+            });
+            if (it != v.end() && it->key_for_object == key)
+                sorted.push_back(*it);
+            return sorted.size() < wanted ? IteratorControl::AdvanceToNext : IteratorControl::Stop;
+        });
+    }
+    REALM_ASSERT(sorted.size() == wanted);
+    v.m_removed_by_limit += sz - sorted.size();
+    v.assign(sorted.begin(), sorted.end());
+
+    // not doing this on the last step is an optimisation
+    if (next) {
+        for (size_t i = 0; i < v.size(); ++i) {
+            v[i].index_in_view = i;
+        }
+    }
+    return true;
+}
+
+const SortedIndex* SortDescriptor::get_sorted_index(const Table& table) const
+{
+    if (m_column_keys.size() != 1 || m_column_keys[0].size() != 1 || m_column_keys[0][0].has_index())
+        return nullptr;
+    ColKey col = m_column_keys[0][0];
+    if (!table.valid_column(col) || table.search_index_type(col) != IndexType::Sorted)
+        return nullptr;
+    return static_cast<const SortedIndex*>(table.get_search_index(col));
+}
+
+bool SortDescriptor::is_on_columns_of(const Table& table) const
+{
+    for (auto& columns : m_column_keys) {
+        if (columns.size() != 1 || columns[0].has_index() || columns[0].is_collection() ||
+            !table.valid_column(columns[0]))
+            return false;
+    }
+    return !m_column_keys.empty();
+}
+
+bool SortDescriptor::less(const Table& table, ObjKey a, ObjKey b) const
+{
+    REALM_ASSERT_DEBUG(is_on_columns_of(table));
+    const Obj obj_a = table.get_object(a);
+    const Obj obj_b = table.get_object(b);
+    for (size_t t = 0; t < m_column_keys.size(); ++t) {
+        ColKey col = m_column_keys[t][0];
+        if (int c = obj_a.get_any(col).compare(obj_b.get_any(col))) {
+            return is_ascending(t).value_or(true) ? c < 0 : c > 0;
+        }
+    }
+    return a < b;
+}
+
+std::unique_ptr<SortDescriptor::TopN> SortDescriptor::top_n(const Table& table, size_t limit) const
+{
+    if (!is_on_columns_of(table))
+        return nullptr;
+    return std::make_unique<TopN>(table, *this, limit);
+}
+
+SortDescriptor::TopN::TopN(const Table& table, const SortDescriptor& sort, size_t limit)
+    : m_table(table)
+    , m_limit(limit)
+{
+    REALM_ASSERT(!sort.m_column_keys.empty());
+    for (size_t i = 0; i < sort.m_column_keys.size(); ++i) {
+        m_columns.push_back(sort.m_column_keys[i][0]);
+        m_ascending.push_back(sort.is_ascending(i).value_or(true));
+    }
+    m_heap.reserve(std::min(limit, table.size()));
+}
+
+bool SortDescriptor::TopN::less(const Entry& a, const Entry& b) const
+{
+    for (size_t t = 0; t < m_columns.size(); ++t) {
+        int c;
+        if (t == 0) {
+            c = a.value.compare(b.value);
+        }
+        else {
+            c = m_table.get_object(a.key).get_any(m_columns[t]).compare(
+                m_table.get_object(b.key).get_any(m_columns[t]));
+        }
+        if (c) {
+            return m_ascending[t] ? c < 0 : c > 0;
+        }
+    }
+    return a.ordinal < b.ordinal;
+}
+
+void SortDescriptor::TopN::add(ObjKey key)
+{
+    if (m_limit == 0)
+        return;
+
+    // m_heap is a max-heap, so its front is the object to drop first
+    auto cmp = [this](const Entry& a, const Entry& b) {
+        return less(a, b);
+    };
+    Entry entry{m_table.get_object(key).get_any(m_columns[0]), key, m_num_added++};
+    if (m_heap.size() < m_limit) {
+        m_heap.push_back(entry);
+        std::push_heap(m_heap.begin(), m_heap.end(), cmp);
+    }
+    else if (less(entry, m_heap.front())) {
+        std::pop_heap(m_heap.begin(), m_heap.end(), cmp);
+        m_heap.back() = entry;
+        std::push_heap(m_heap.begin(), m_heap.end(), cmp);
+    }
+}
+
+std::vector<ObjKey> SortDescriptor::TopN::get_sorted_keys()
+{
+    std::sort_heap(m_heap.begin(), m_heap.end(), [this](const Entry& a, const Entry& b) {
+        return less(a, b);
+    });
+    std::vector<ObjKey> keys;
+    keys.reserve(m_heap.size());
+    for (auto& entry : m_heap)
+        keys.push_back(entry.key);
+    m_heap.clear();
+    return keys;
+}
+
 std::string LimitDescriptor::get_description(ConstTableRef) const
 {
     return "LIMIT(" + util::serializer::print_value(m_limit) + ")";
@@ -30,6 +30,7 @@
 namespace realm {
 
 class SortDescriptor;
+class SortedIndex;
 class ConstTableRef;
 class Group;
 class KeyValues;
@@ -243,6 +244,60 @@ public:
 
     void execute(IndexPairs& v, const Sorter& predicate, const BaseDescriptor* next) const override;
 
+    // Sort by walking a sorted index on the column instead of comparing values.
+    // Only done when sorting on a single column of `table` with a sorted index,
+    // and when the objects of `v` are in key order, so that the index orders
+    // objects with equal values the same way as a stable sort would. Returns
+    // false if `v` was left for execute() to sort.
+    bool execute_with_index(const Table& table, IndexPairs& v, const BaseDescriptor* next) const;
+
+    // If this is a sort on a single column of `table` with a sorted index,
+    // returns that index. It visits the objects in the order of this sort.
+    const SortedIndex* get_sorted_index(const Table& table) const;
+
+    // Selects the first `limit` objects in the order of this sort out of
+    // objects offered one at a time, keeping only the best of them in a
+    // bounded heap. This is used when the sort is followed by a limit, so that
+    // the matches of a query need not all be gathered and sorted. Objects
+    // which compare equal keep the order in which they were offered, like
+    // they would in a stable sort.
+    class TopN {
+    public:
+        TopN(const Table& table, const SortDescriptor& sort, size_t limit);
+
+        void add(ObjKey key);
+        // The selected objects in sort order
+        std::vector<ObjKey> get_sorted_keys();
+
+    private:
+        struct Entry {
+            Mixed value; // Value of the first sort column
+            ObjKey key;
+            size_t ordinal;
+        };
+        bool less(const Entry& a, const Entry& b) const;
+
+        const Table& m_table;
+        std::vector<ColKey> m_columns;
+        std::vector<bool> m_ascending;
+        size_t m_limit;
+        size_t m_num_added = 0;
+        std::vector<Entry> m_heap;
+    };
+
+    // Returns null if the sort is not on columns of `table` itself, such as
+    // when sorting through links. Those sorts need all objects of the view.
+    std::unique_ptr<TopN> top_n(const Table& table, size_t limit) const;
+
+    // Whether the sort is on columns of `table` itself, and not on columns
+    // reached through links, collections or dictionary keys
+    bool is_on_columns_of(const Table& table) const;
+    // Whether object `a` of `table` comes before object `b` in the order of
+    // this sort. Objects with equal values are ordered by key, which is the
+    // order a stable sort of a view in key order gives them. Only for sorts
+    // on columns of `table` itself.
+    bool less(const Table& table, ObjKey a, ObjKey b) const;
+
     std::string get_description(ConstTableRef attached_table) const override;
 
 private:
@@ -15,6 +15,7 @@ InternString Changeset::intern_string(StringData str)
     if (InternString interned = find_string(str))
         return interned;
 
+    own_strings(); // Throws
     REALM_ASSERT(m_string_buffer.size() < std::numeric_limits<uint32_t>::max());
     REALM_ASSERT(m_strings.size() < std::numeric_limits<uint32_t>::max());
     REALM_ASSERT(str.size() < std::numeric_limits<uint32_t>::max());
@@ -32,10 +33,11 @@ InternString Changeset::intern_string(StringData str)
 InternString Changeset::find_string(StringData string) const noexcept
 {
     // FIXME: Linear search can be very expensive as changesets can be very big
+    StringData strings = string_data();
     std::size_t n = m_strings.size();
     for (std::size_t i = 0; i < n; ++i) {
         const auto& range = m_strings[i];
-        StringData string_2{m_string_buffer.data() + range.offset, range.size};
+        StringData string_2{strings.data() + range.offset, range.size};
         if (string_2 == string)
             return InternString{std::uint_least32_t(i)};
     }
@@ -203,15 +205,16 @@ void Changeset::print() const
 
 void Changeset::verify() const
 {
+    size_t strings_size = string_data().size();
     for (size_t i = 0; i < m_strings.size(); ++i) {
         auto& range = m_strings.at(i);
-        REALM_ASSERT(range.offset <= m_string_buffer.size());
-        REALM_ASSERT(range.offset + range.size <= m_string_buffer.size());
+        REALM_ASSERT(range.offset <= strings_size);
+        REALM_ASSERT(range.offset + range.size <= strings_size);
     }
 
     auto verify_string_range = [&](StringBufferRange range) {
-        REALM_ASSERT(range.offset <= m_string_buffer.size());
-        REALM_ASSERT(range.offset + range.size <= m_string_buffer.size());
+        REALM_ASSERT(range.offset <= strings_size);
+        REALM_ASSERT(range.offset + range.size <= strings_size);
     };
 
     auto verify_intern_string = [&](InternString str) {
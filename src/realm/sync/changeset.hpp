@@ -29,8 +29,15 @@ struct Changeset {
     InternString find_string(StringData) const noexcept; // Slow!
     StringData string_data() const noexcept;
 
-    std::string& string_buffer() noexcept;
-    const std::string& string_buffer() const noexcept;
+    /// Let the string ranges of the changeset refer to \a data instead of the
+    /// string buffer of the changeset. Used to parse a changeset without
+    /// copying its strings, so \a data must outlive the changeset. Adding a
+    /// string, or accessing the string buffer, copies \a data into the string
+    /// buffer first.
+    void borrow_strings(StringData data) noexcept;
+    bool has_borrowed_strings() const noexcept;
+
+    std::string& string_buffer();
     const InternStrings& interned_strings() const noexcept;
     InternStrings& interned_strings() noexcept;
 
@@ -87,7 +94,7 @@ struct Changeset {
     iterator erase(const_iterator);
 
     /// Insert an instruction at the end, invalidating all iterators.
-    void push_back(const Instruction&);
+    void push_back(Instruction);
 
     //@{
     /// Insert instructions at \a position without invalidating other
@@ -122,6 +129,9 @@ struct Changeset {
     /// \a position exist in the program, they will either point to the
     /// subsequent element if that element was previously inserted with
     /// `insert_stable()`, or otherwise it will be turned into a tombstone.
+    ///
+    /// The returned iterator points to the instruction following the erased
+    /// one, which may be a tombstone.
     iterator erase_stable(const_iterator position);
 
 #if REALM_DEBUG
@@ -193,10 +203,12 @@ struct Changeset {
 private:
     std::vector<Instruction> m_instructions;
     std::string m_string_buffer;
+    StringData m_borrowed_strings;
     InternStrings m_strings;
     bool m_is_dirty = false;
 
     iterator const_iterator_to_iterator(const_iterator);
+    void own_strings();
 };
 
 std::ostream& operator<<(std::ostream&, const Changeset& changeset);
@@ -489,23 +501,39 @@ inline const InternStrings& Changeset::interned_strings() const noexcept
     return m_strings;
 }
 
-inline auto Changeset::string_buffer() noexcept -> std::string&
+inline auto Changeset::string_buffer() -> std::string&
 {
+    own_strings(); // Throws
     return m_string_buffer;
 }
 
-inline auto Changeset::string_buffer() const noexcept -> const std::string&
+inline void Changeset::borrow_strings(StringData data) noexcept
 {
-    return m_string_buffer;
+    m_string_buffer.clear();
+    m_borrowed_strings = data;
+}
+
+inline bool Changeset::has_borrowed_strings() const noexcept
+{
+    return !m_borrowed_strings.is_null();
+}
+
+inline void Changeset::own_strings()
+{
+    if (has_borrowed_strings()) {
+        m_string_buffer.assign(m_borrowed_strings.data(), m_borrowed_strings.size()); // Throws
+        m_borrowed_strings = StringData{};
+    }
 }
 
 inline util::Optional<StringData> Changeset::try_get_string(StringBufferRange range) const noexcept
 {
-    if (range.offset > m_string_buffer.size())
+    StringData strings = string_data();
+    if (range.offset > strings.size())
         return util::none;
-    if (range.offset + range.size > m_string_buffer.size())
+    if (range.offset + range.size > strings.size())
         return util::none;
-    return StringData{m_string_buffer.data() + range.offset, range.size};
+    return StringData{strings.data() + range.offset, range.size};
 }
 
 inline util::Optional<StringData> Changeset::try_get_string(InternString str) const noexcept
@@ -530,11 +558,14 @@ inline StringData Changeset::get_string(InternString string) const noexcept
 
 inline StringData Changeset::string_data() const noexcept
 {
+    if (has_borrowed_strings())
+        return m_borrowed_strings;
     return StringData{m_string_buffer.data(), m_string_buffer.size()};
 }
 
 inline StringBufferRange Changeset::append_string(StringData string)
 {
+    own_strings(); // Throws
     // We expect more strings. Only do this at the beginning because until C++20, reserve
     // will shrink_to_fit if the request is less than the current capacity.
     constexpr size_t small_string_buffer_size = 1024;
@@ -603,17 +634,18 @@ inline Changeset::iterator Changeset::erase_stable(const_iterator cpos)
     REALM_ASSERT(pos.m_inner < end);
     pos.m_inner->erase(pos.m_pos);
     if (pos.m_pos >= pos.m_inner->size()) {
-        do {
-            ++pos.m_inner;
-        } while (pos.m_inner != end && pos.m_inner->is_empty());
+        // The next instruction may be a tombstone, which callers skip. Not
+        // looking at it here keeps this from touching any instruction other
+        // than the erased one.
+        ++pos.m_inner;
         pos.m_pos = 0;
     }
     return pos;
 }
 
-inline void Changeset::push_back(const Instruction& instr)
+inline void Changeset::push_back(Instruction instr)
 {
-    m_instructions.emplace_back(instr);
+    m_instructions.emplace_back(std::move(instr));
 }
 
 inline auto Changeset::const_iterator_to_iterator(const_iterator cpos) -> iterator
@@ -9,6 +9,7 @@
 #include <realm/table.hpp>
 #include <realm/util/base64.hpp>
 
+#include <string_view>
 #include <unordered_set>
 
 using namespace realm;
@@ -23,6 +24,7 @@ struct State {
     explicit State(util::InputStream& input, InstructionHandler& handler)
         : m_input(input)
         , m_handler(handler)
+        , m_intern_strings(0, InternStringHash{m_intern_string_data}, InternStringEqual{m_intern_string_data})
     {
     }
 
@@ -36,9 +38,27 @@ struct State {
     const char* m_input_end = nullptr;
 
     std::string m_buffer;
+
     // Cannot use StringData as key type since m_input_begin may start pointing
-    // to a new chunk of memory.
-    std::unordered_set<std::string> m_intern_strings;
+    // to a new chunk of memory. The intern strings are copied into one buffer,
+    // rather than into a string each, and looked up by their range in it.
+    struct InternStringHash {
+        const std::string& data;
+        size_t operator()(StringBufferRange range) const noexcept
+        {
+            return std::hash<std::string_view>{}(std::string_view{data.data() + range.offset, range.size});
+        }
+    };
+    struct InternStringEqual {
+        const std::string& data;
+        bool operator()(StringBufferRange a, StringBufferRange b) const noexcept
+        {
+            return std::string_view{data.data() + a.offset, a.size} ==
+                   std::string_view{data.data() + b.offset, b.size};
+        }
+    };
+    std::string m_intern_string_data;
+    std::unordered_set<StringBufferRange, InternStringHash, InternStringEqual> m_intern_strings;
 
 
     void parse_one(); // Throws
@@ -101,7 +121,7 @@ struct UnreachableInstructionHandler : public InstructionHandler {
         REALM_UNREACHABLE();
     }
 
-    void operator()(const Instruction&) override
+    void operator()(Instruction) override
     {
         REALM_UNREACHABLE();
     }
@@ -115,12 +135,12 @@ struct InstructionBuilder : InstructionHandler {
     }
     Changeset& m_log;
 
-    void operator()(const Instruction& instr) final
+    void operator()(Instruction instr) final
     {
-        m_log.push_back(instr);
+        m_log.push_back(std::move(instr));
     }
 
-    StringBufferRange add_string_range(StringData string) final
+    StringBufferRange add_string_range(StringData string) override
     {
         return m_log.append_string(string);
     }
@@ -133,6 +153,26 @@ struct InstructionBuilder : InstructionHandler {
     }
 };
 
+// Builds a changeset whose strings refer to the input rather than being copied.
+// The input must be a single block of memory, so that every string read from
+// it is a range of the input.
+struct InPlaceInstructionBuilder : InstructionBuilder {
+    InPlaceInstructionBuilder(Changeset& log, BinaryData input)
+        : InstructionBuilder(log)
+        , m_input(input)
+    {
+        log.borrow_strings(StringData{input.data(), input.size()});
+    }
+    BinaryData m_input;
+
+    StringBufferRange add_string_range(StringData string) final
+    {
+        REALM_ASSERT(string.data() >= m_input.data());
+        REALM_ASSERT(string.data() + string.size() <= m_input.data() + m_input.size());
+        return StringBufferRange{uint32_t(string.data() - m_input.data()), uint32_t(string.size())};
+    }
+};
+
 Instruction::Payload::Type State::read_payload_type()
 {
     using Type = Instruction::Payload::Type;
@@ -307,9 +347,10 @@ Instruction::Path State::read_path()
     Instruction::Path path;
     size_t path_len = read_int<uint32_t>();
 
-    // Note: Not reserving `path_len`, because a corrupt changeset could cause std::bad_alloc to be thrown.
+    // Note: Not reserving more than 16 elements, because a corrupt changeset could cause std::bad_alloc to be
+    // thrown.
     if (path_len != 0)
-        path.reserve(16);
+        path.reserve(std::min(path_len, size_t(16)));
 
     for (size_t i = 0; i < path_len; ++i) {
         int64_t element = read_int();
@@ -344,7 +385,9 @@ void State::parse_one()
             parser_error(util::format("Unexpected intern index: %1", index));
         }
         StringData str = read_string();
-        if (!m_intern_strings.insert(str).second) {
+        StringBufferRange key{uint32_t(m_intern_string_data.size()), uint32_t(str.size())};
+        m_intern_string_data.append(str.data(), str.size());
+        if (!m_intern_strings.insert(key).second) {
             parser_error(util::format("Unexpected intern string: %1", str));
         }
         StringBufferRange range = m_handler.add_string_range(str);
@@ -379,27 +422,27 @@ void State::parse_one()
                 default:
                     parser_error(util::format("AddTable: unknown table type: %1", table_type));
             }
-            m_handler(instr);
+            m_handler(std::move(instr));
             return;
         }
         case Instruction::Type::EraseTable: {
             Instruction::EraseTable instr;
             instr.table = read_intern_string();
-            m_handler(instr);
+            m_handler(std::move(instr));
             return;
         }
         case Instruction::Type::CreateObject: {
             Instruction::CreateObject instr;
             instr.table = read_intern_string();
             instr.object = read_object_key();
-            m_handler(instr);
+            m_handler(std::move(instr));
             return;
         }
         case Instruction::Type::EraseObject: {
             Instruction::EraseObject instr;
             instr.table = read_intern_string();
             instr.object = read_object_key();
-            m_handler(instr);
+            m_handler(std::move(instr));
             return;
         }
         case Instruction::Type::Update: {
@@ -415,14 +458,14 @@ void State::parse_one()
             else {
                 instr.prior_size = read_int<uint32_t>();
             }
-            m_handler(instr);
+            m_handler(std::move(instr));
             return;
         }
         case Instruction::Type::AddInteger: {
             Instruction::AddInteger instr;
             read_path_instr(instr);
             instr.value = read_int();
-            m_handler(instr);
+            m_handler(std::move(instr));
             return;
         }
         case Instruction::Type::AddColumn: {
@@ -441,14 +484,14 @@ void State::parse_one()
             else {
                 instr.key_type = Instruction::Payload::Type::Null;
             }
-            m_handler(instr);
+            m_handler(std::move(instr));
             return;
         }
         case Instruction::Type::EraseColumn: {
             Instruction::EraseColumn instr;
             instr.table = read_intern_string();
             instr.field = read_intern_string();
-            m_handler(instr);
+            m_handler(std::move(instr));
             return;
         }
         case Instruction::Type::ArrayInsert: {
@@ -459,7 +502,7 @@ void State::parse_one()
             }
             instr.value = read_payload();
             instr.prior_size = read_int<uint32_t>();
-            m_handler(instr);
+            m_handler(std::move(instr));
             return;
         }
         case Instruction::Type::ArrayMove: {
@@ -470,7 +513,7 @@ void State::parse_one()
             }
             instr.ndx_2 = read_int<uint32_t>();
             instr.prior_size = read_int<uint32_t>();
-            m_handler(instr);
+            m_handler(std::move(instr));
             return;
         }
         case Instruction::Type::ArrayErase: {
@@ -480,28 +523,28 @@ void State::parse_one()
                 parser_error("ArrayErase without an index");
             }
             instr.prior_size = read_int<uint32_t>();
-            m_handler(instr);
+            m_handler(std::move(instr));
             return;
         }
         case Instruction::Type::Clear: {
             Instruction::Clear instr;
             read_path_instr(instr);
             instr.collection_type = read_collection_type();
-            m_handler(instr);
+            m_handler(std::move(instr));
             return;
         }
         case Instruction::Type::SetInsert: {
             Instruction::SetInsert instr;
             read_path_instr(instr);
             instr.value = read_payload();
-            m_handler(instr);
+            m_handler(std::move(instr));
             return;
         }
         case Instruction::Type::SetErase: {
             Instruction::SetErase instr;
             read_path_instr(instr);
             instr.value = read_payload();
-            m_handler(instr);
+            m_handler(std::move(instr));
             return;
         }
     }
@@ -689,6 +732,16 @@ void parse_changeset(util::InputStream& input, Changeset& out_log)
         state.parse_one();
 }
 
+void parse_changeset_in_place(BinaryData input, Changeset& out_log)
+{
+    util::SimpleInputStream stream{input};
+    InPlaceInstructionBuilder builder{out_log, input};
+    State state{stream, builder};
+
+    while (state.has_next())
+        state.parse_one();
+}
+
 OwnedMixed parse_base64_encoded_primary_key(std::string_view str)
 {
     auto bin_encoded = util::base64_decode_to_vector(str);
@@ -9,6 +9,10 @@
 namespace realm::sync {
 void parse_changeset(util::InputStream&, Changeset& out_log);
 
+// Parse a changeset without copying its strings. The strings of `out_log` refer
+// to `input`, which must outlive it, until a string is added to `out_log`.
+void parse_changeset_in_place(BinaryData input, Changeset& out_log);
+
 // The server may send us primary keys of objects in json-encoded error messages as base64-encoded changeset payloads.
 // This function takes such a base64-encoded payload and returns it parsed as an owned Mixed value. If it cannot
 // be decoded, this throws a BadChangeset exception.
@@ -9,6 +9,8 @@
 #include <realm/sync/subscriptions.hpp>
 #include <realm/util/bind_ptr.hpp>
 
+#include <future>
+
 namespace realm::sync {
 namespace {
 using namespace realm::util;
@@ -131,6 +133,7 @@ private:
     const std::optional<std::string> m_ssl_trust_certificate_path;
     const std::function<SyncConfig::SSLVerifyCallback> m_ssl_verify_callback;
     const size_t m_flx_bootstrap_batch_size_bytes;
+    const bool m_flx_bootstrap_pipelined;
     const std::string m_http_request_path_prefix;
     const std::string m_virt_path;
     const std::optional<ProxyConfig> m_proxy_config;
@@ -891,11 +894,37 @@ void SessionImpl::process_pending_flx_bootstrap()
     int64_t query_version = -1;
     size_t changesets_processed = 0;
 
+    // In pipelined mode, the next batch is read from the store and parsed on another thread while a batch is
+    // integrated. The batches are read from a frozen version in which the current batch is not yet integrated and
+    // removed from the store, so the next batch follows it. Only one batch is read ahead.
+    struct ParsedBatch {
+        PendingBootstrapStore::PendingBatch batch;
+        std::vector<Changeset> changesets;
+    };
+    auto read_and_parse_batch = [bootstrap_store, limit_in_bytes = m_wrapper.m_flx_bootstrap_batch_size_bytes](
+                                    TransactionRef frozen, size_t offset) {
+        ParsedBatch parsed;
+        parsed.batch = bootstrap_store->peek_pending(*frozen, offset, limit_in_bytes); // Throws
+        parsed.changesets = ClientHistory::parse_server_changesets(parsed.batch.changesets); // Throws
+        return parsed;
+    };
+    std::future<ParsedBatch> next_batch;
+
     // Used to commit each batch after it was transformed.
     TransactionRef transact = get_db()->start_write();
     while (bootstrap_store->has_pending()) {
         auto start_time = std::chrono::steady_clock::now();
-        auto pending_batch = bootstrap_store->peek_pending(m_wrapper.m_flx_bootstrap_batch_size_bytes);
+        ParsedBatch parsed_batch;
+        if (next_batch.valid()) {
+            parsed_batch = next_batch.get(); // Throws
+        }
+        else if (m_wrapper.m_flx_bootstrap_pipelined) {
+            parsed_batch = read_and_parse_batch(get_db()->start_frozen(), 0); // Throws
+        }
+        else {
+            parsed_batch.batch = bootstrap_store->peek_pending(m_wrapper.m_flx_bootstrap_batch_size_bytes);
+        }
+        auto& pending_batch = parsed_batch.batch;
         if (!pending_batch.progress) {
             logger.info("Incomplete pending bootstrap found for query version %1", pending_batch.query_version);
             // Close the write transation before clearing the bootstrap store to avoid a deadlock because the
@@ -918,12 +947,25 @@ void SessionImpl::process_pending_flx_bootstrap()
         call_debug_hook(SyncClientHookEvent::BootstrapBatchAboutToProcess, *pending_batch.progress, query_version,
                         batch_state, pending_batch.changesets.size());
 
-        history.integrate_server_changesets(
-            *pending_batch.progress, downloadable_bytes, pending_batch.changesets, new_version, batch_state, logger,
-            transact, [&](const TransactionRef& tr, util::Span<Changeset> changesets_applied) {
-                REALM_ASSERT_3(changesets_applied.size(), <=, pending_batch.changesets.size());
-                bootstrap_store->pop_front_pending(tr, changesets_applied.size());
-            });
+        if (m_wrapper.m_flx_bootstrap_pipelined && pending_batch.remaining_changesets > 0) {
+            next_batch = std::async(std::launch::async, read_and_parse_batch, get_db()->start_frozen(),
+                                    pending_batch.changesets.size()); // Throws
+        }
+
+        auto pop_front_pending = [&](const TransactionRef& tr, util::Span<Changeset> changesets_applied) {
+            REALM_ASSERT_3(changesets_applied.size(), <=, pending_batch.changesets.size());
+            bootstrap_store->pop_front_pending(tr, changesets_applied.size());
+        };
+        if (m_wrapper.m_flx_bootstrap_pipelined) {
+            history.integrate_server_changesets(*pending_batch.progress, downloadable_bytes, pending_batch.changesets,
+                                                std::move(parsed_batch.changesets), new_version, batch_state, logger,
+                                                transact, pop_front_pending); // Throws
+        }
+        else {
+            history.integrate_server_changesets(*pending_batch.progress, downloadable_bytes, pending_batch.changesets,
+                                                new_version, batch_state, logger, transact,
+                                                pop_front_pending); // Throws
+        }
         progress = *pending_batch.progress;
         changesets_processed += pending_batch.changesets.size();
         auto duration = std::chrono::steady_clock::now() - start_time;
@@ -1164,6 +1206,7 @@ SessionWrapper::SessionWrapper(ClientImpl& client, DBRef db, std::shared_ptr<Sub
     , m_ssl_trust_certificate_path{std::move(config.ssl_trust_certificate_path)}
     , m_ssl_verify_callback{std::move(config.ssl_verify_callback)}
     , m_flx_bootstrap_batch_size_bytes(config.flx_bootstrap_batch_size_bytes)
+    , m_flx_bootstrap_pipelined(config.flx_bootstrap_pipelined)
     , m_http_request_path_prefix{std::move(config.service_identifier)}
     , m_virt_path{std::move(config.realm_identifier)}
     , m_proxy_config{std::move(config.proxy_config)}
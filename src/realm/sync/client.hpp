@@ -324,6 +324,10 @@ public:
         /// changeset data in a single integration attempt.
         size_t flx_bootstrap_batch_size_bytes = 1024 * 1024;
 
+        /// When integrating a flexible sync bootstrap, read and parse the
+        /// next batch on a background thread while a batch is being applied.
+        bool flx_bootstrap_pipelined = false;
+
         /// Set to true to cause the integration of the first received changeset
         /// (in a DOWNLOAD message) to fail.
         ///
@@ -218,6 +218,24 @@ struct ClientConfig {
     /// requires pks for all tables, so this is now only applicable to old sync
     /// tests and so is disabled by default.
     bool fix_up_object_ids = false;
+
+    /// The number of threads used to transform downloaded changesets through
+    /// the local changesets which the server has not integrated yet. See
+    /// sync::Transformer::set_threads().
+    unsigned int transform_threads = 1;
+
+    /// A preset dictionary for compressing the bodies of UPLOAD and DOWNLOAD
+    /// messages, such as one built by util::compression::train_dictionary()
+    /// from recorded changesets. It is only used on connections to servers
+    /// which are configured with the same dictionary (see
+    /// sync::BodyCompression).
+    std::vector<char> compression_dictionary;
+
+    /// If set, connections made through the default socket provider offer the
+    /// permessage-deflate WebSocket extension (RFC 7692), which the server may
+    /// accept. Messages are then compressed with a context shared by all the
+    /// messages of the connection.
+    bool enable_permessage_deflate = false;
 };
 
 /// \brief Information about an error causing a session to be temporarily
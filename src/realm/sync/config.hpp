@@ -189,6 +189,10 @@ struct SyncConfig {
     // attempt. This many bytes of changesets will be uncompressed and held in memory while being applied.
     size_t flx_bootstrap_batch_size_bytes = 1024 * 1024;
 
+    // When integrating a flexible sync bootstrap, read and parse the next batch on a background thread while a batch
+    // is being applied. At most one batch is read ahead, so up to twice the batch size is held in memory.
+    bool flx_bootstrap_pipelined = false;
+
     // {@
     /// DEPRECATED - Will be removed in a future release
     // The following parameters are only used by the default SyncSocket implementation. Custom SyncSocket
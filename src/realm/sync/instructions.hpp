@@ -947,8 +947,9 @@ struct InstructionHandler {
     /// this function are assumed to refer to ranges in this buffer.
     virtual StringBufferRange add_string_range(StringData) = 0;
 
-    /// Handle an instruction.
-    virtual void operator()(const Instruction&) = 0;
+    /// Handle an instruction. The instruction is passed by value, so that a
+    /// handler that keeps it can move it into place.
+    virtual void operator()(Instruction) = 0;
 };
 
 
@@ -487,8 +487,8 @@ void DefaultWebSocketImpl::initiate_websocket_handshake()
                   std::ostream_iterator<std::string>(protocol_list, ", "));
     protocol_list << m_endpoint.protocols.back();
 
-    m_websocket.initiate_client_handshake(m_endpoint.path, std::move(host), protocol_list.str(),
-                                          std::move(headers)); // Throws
+    m_websocket.initiate_client_handshake(m_endpoint.path, std::move(host), protocol_list.str(), std::move(headers),
+                                          m_endpoint.offer_permessage_deflate); // Throws
 }
 } // namespace
 
@@ -5,6 +5,9 @@
 #include <realm/util/buffer.hpp>
 #include <realm/util/base64.hpp>
 #include <realm/util/sha_crypto.hpp>
+#include <realm/util/to_string.hpp>
+
+#include <zlib.h>
 
 using namespace realm;
 using namespace realm::sync;
@@ -129,8 +132,137 @@ bool find_sec_websocket_key(const HTTPHeaders& headers, std::string& sec_websock
     return true;
 }
 
+// The parameters of the permessage-deflate extension (RFC 7692). An
+// endpoint compresses with a window of at most 2^max_window_bits bytes, and
+// compresses every message independently if no_context_takeover is set.
+struct PerMessageDeflateParams {
+    bool server_no_context_takeover = false;
+    bool client_no_context_takeover = false;
+    util::Optional<int> server_max_window_bits;
+    util::Optional<int> client_max_window_bits;
+};
+
+const StringData sec_websocket_extensions = "Sec-WebSocket-Extensions";
+const StringData permessage_deflate = "permessage-deflate";
+
+std::string_view trim_whitespace(std::string_view str)
+{
+    while (!str.empty() && (str.front() == ' ' || str.front() == '\t'))
+        str.remove_prefix(1);
+    while (!str.empty() && (str.back() == ' ' || str.back() == '\t'))
+        str.remove_suffix(1);
+    return str;
+}
+
+// next_list_element() removes the first element of the \a delim separated
+// list \a list, and returns it without surrounding whitespace.
+std::string_view next_list_element(std::string_view& list, char delim)
+{
+    size_t pos = list.find(delim);
+    std::string_view element = trim_whitespace(list.substr(0, pos));
+    list = (pos == std::string_view::npos ? std::string_view{} : list.substr(pos + 1));
+    return element;
+}
+
+// parse_window_bits() parses the value of a max_window_bits parameter, which
+// is a number from 8 to 15 that may be quoted.
+util::Optional<int> parse_window_bits(std::string_view value)
+{
+    if (value.size() >= 2 && value.front() == '"' && value.back() == '"')
+        value = value.substr(1, value.size() - 2);
+    if (value.size() == 1 && value[0] >= '8' && value[0] <= '9')
+        return value[0] - '0';
+    if (value.size() == 2 && value[0] == '1' && value[1] >= '0' && value[1] <= '5')
+        return 10 + (value[1] - '0');
+    return none;
+}
+
+// parse_permessage_deflate() parses one element of a Sec-WebSocket-Extensions
+// header, such as "permessage-deflate; client_max_window_bits". None is
+// returned if the element is not the permessage-deflate extension, or if a
+// parameter is unknown, repeated, or has an invalid value. In an offer
+// (\a is_offer), client_max_window_bits may be given without a value to tell
+// that the client supports the parameter.
+util::Optional<PerMessageDeflateParams> parse_permessage_deflate(std::string_view element, bool is_offer)
+{
+    if (!case_insensitive_equal(next_list_element(element, ';'), permessage_deflate))
+        return none;
+
+    PerMessageDeflateParams params;
+    bool seen_client_max_window_bits = false;
+    while (!element.empty()) {
+        std::string_view param = next_list_element(element, ';');
+        size_t pos = param.find('=');
+        std::string_view name = trim_whitespace(param.substr(0, pos));
+        util::Optional<std::string_view> value;
+        if (pos != std::string_view::npos)
+            value = trim_whitespace(param.substr(pos + 1));
+
+        if (case_insensitive_equal(name, "server_no_context_takeover")) {
+            if (value || params.server_no_context_takeover)
+                return none;
+            params.server_no_context_takeover = true;
+        }
+        else if (case_insensitive_equal(name, "client_no_context_takeover")) {
+            if (value || params.client_no_context_takeover)
+                return none;
+            params.client_no_context_takeover = true;
+        }
+        else if (case_insensitive_equal(name, "server_max_window_bits")) {
+            if (!value || params.server_max_window_bits)
+                return none;
+            params.server_max_window_bits = parse_window_bits(*value);
+            if (!params.server_max_window_bits)
+                return none;
+        }
+        else if (case_insensitive_equal(name, "client_max_window_bits")) {
+            if (seen_client_max_window_bits || (!value && !is_offer))
+                return none;
+            seen_client_max_window_bits = true;
+            if (value) {
+                params.client_max_window_bits = parse_window_bits(*value);
+                if (!params.client_max_window_bits)
+                    return none;
+            }
+        }
+        else {
+            return none;
+        }
+    }
+    return params;
+}
+
+// select_permessage_deflate_offer() returns the parameters of the first
+// permessage-deflate offer in the Sec-WebSocket-Extensions header \a value
+// which the server supports. zlib cannot compress with a window of 2^8 bytes,
+// so offers that require it are declined.
+util::Optional<PerMessageDeflateParams> select_permessage_deflate_offer(std::string_view value)
+{
+    while (!value.empty()) {
+        auto params = parse_permessage_deflate(next_list_element(value, ','), true);
+        if (params && params->server_max_window_bits != 8)
+            return params;
+    }
+    return none;
+}
+
+// make_permessage_deflate_response() makes the value of the
+// Sec-WebSocket-Extensions header with which the server accepts an offer.
+std::string make_permessage_deflate_response(const PerMessageDeflateParams& offer)
+{
+    std::string value = permessage_deflate;
+    if (offer.server_no_context_takeover)
+        value += "; server_no_context_takeover";
+    if (offer.client_no_context_takeover)
+        value += "; client_no_context_takeover";
+    if (offer.server_max_window_bits)
+        value += "; server_max_window_bits=" + util::to_string(*offer.server_max_window_bits);
+    return value;
+}
+
 util::Optional<HTTPResponse> do_make_http_response(const HTTPRequest& request,
-                                                   const std::string& sec_websocket_protocol, std::error_code& ec)
+                                                   const std::string& sec_websocket_protocol, std::error_code& ec,
+                                                   bool accept_permessage_deflate)
 {
     std::string sec_websocket_key;
 
@@ -163,9 +295,153 @@ util::Optional<HTTPResponse> do_make_http_response(const HTTPRequest& request,
     response.headers["Sec-WebSocket-Accept"] = sec_websocket_accept;
     response.headers["Sec-WebSocket-Protocol"] = sec_websocket_protocol;
 
+    if (accept_permessage_deflate) {
+        if (auto value = find_http_header_value(request.headers, sec_websocket_extensions)) {
+            if (auto params = select_permessage_deflate_offer(std::string_view(*value)))
+                response.headers[sec_websocket_extensions] = make_permessage_deflate_response(*params);
+        }
+    }
+
     return response;
 }
 
+// class PerMessageDeflate holds the compression and decompression streams of
+// the permessage-deflate extension for one connection. Unless
+// no_context_takeover applies, the streams are kept across messages, so that
+// a message can refer back to the contents of earlier messages. Each message
+// is flushed with an empty stored block, and the four bytes 00 00 FF FF that
+// this block ends with are not sent.
+class PerMessageDeflate {
+public:
+    PerMessageDeflate(int window_bits, bool no_context_takeover)
+        : m_no_context_takeover(no_context_takeover)
+    {
+        m_deflate_stream.zalloc = Z_NULL;
+        m_deflate_stream.zfree = Z_NULL;
+        m_deflate_stream.opaque = Z_NULL;
+        // Many messages, such as DOWNLOAD messages with compressed bodies,
+        // hardly compress, so the fastest level is used
+        int rc = deflateInit2(&m_deflate_stream, Z_BEST_SPEED, Z_DEFLATED, -window_bits, 8, Z_DEFAULT_STRATEGY);
+        if (rc == Z_MEM_ERROR)
+            throw std::bad_alloc();
+        REALM_ASSERT(rc == Z_OK);
+
+        m_inflate_stream.zalloc = Z_NULL;
+        m_inflate_stream.zfree = Z_NULL;
+        m_inflate_stream.opaque = Z_NULL;
+        m_inflate_stream.next_in = Z_NULL;
+        m_inflate_stream.avail_in = 0;
+        // A window of 2^15 bytes can decompress streams with any smaller window
+        rc = inflateInit2(&m_inflate_stream, -15);
+        if (rc != Z_OK) {
+            deflateEnd(&m_deflate_stream);
+            if (rc == Z_MEM_ERROR)
+                throw std::bad_alloc();
+            REALM_ASSERT(rc == Z_OK);
+        }
+    }
+
+    PerMessageDeflate(const PerMessageDeflate&) = delete;
+
+    ~PerMessageDeflate() noexcept
+    {
+        deflateEnd(&m_deflate_stream);
+        inflateEnd(&m_inflate_stream);
+    }
+
+    // compress() compresses the message in \a data into \a out, and returns
+    // the compressed size.
+    size_t compress(const char* data, size_t size, std::vector<char>& out)
+    {
+        // The empty stored block takes at most 10 bytes with the bits before it
+        size_t min_size = size_t(deflateBound(&m_deflate_stream, uLong(size))) + 10;
+        if (out.size() < min_size)
+            out.resize(min_size);
+
+        m_deflate_stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+        m_deflate_stream.avail_in = uInt(size);
+        size_t out_size = 0;
+        do {
+            if (out_size == out.size())
+                out.resize(2 * out.size());
+            m_deflate_stream.next_out = reinterpret_cast<Bytef*>(out.data() + out_size);
+            m_deflate_stream.avail_out = uInt(out.size() - out_size);
+            int rc = deflate(&m_deflate_stream, Z_SYNC_FLUSH);
+            REALM_ASSERT(rc == Z_OK || rc == Z_BUF_ERROR);
+            out_size = out.size() - m_deflate_stream.avail_out;
+        } while (m_deflate_stream.avail_out == 0);
+        REALM_ASSERT(m_deflate_stream.avail_in == 0);
+
+        // zlib does not flush again if there is no input since the last
+        // flush, so for an empty message, the byte which starts an empty
+        // stored block is made here.
+        if (out_size == 0) {
+            out[0] = 0;
+            return 1;
+        }
+
+        REALM_ASSERT(out_size >= 4 && std::equal(out.data() + out_size - 4, out.data() + out_size, s_tail));
+        if (m_no_context_takeover)
+            deflateReset(&m_deflate_stream);
+        return out_size - 4;
+    }
+
+    // decompress() decompresses the message in \a data into \a out. It
+    // returns false if the message is not valid compressed data, or if it
+    // decompresses to more than \a max_size bytes.
+    bool decompress(const char* data, size_t size, std::vector<char>& out, size_t& out_size, size_t max_size)
+    {
+        out_size = 0;
+        bool stream_end = false;
+        if (!inflate_some(data, size, out, out_size, max_size, stream_end))
+            return false;
+        if (stream_end)
+            return true;
+        return inflate_some(s_tail, sizeof s_tail, out, out_size, max_size, stream_end);
+    }
+
+private:
+    static constexpr char s_tail[4] = {0, 0, char(0xFF), char(0xFF)};
+
+    const bool m_no_context_takeover;
+    z_stream m_deflate_stream;
+    z_stream m_inflate_stream;
+
+    bool inflate_some(const char* data, size_t size, std::vector<char>& out, size_t& out_size, size_t max_size,
+                      bool& stream_end)
+    {
+        m_inflate_stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+        m_inflate_stream.avail_in = uInt(size);
+        for (;;) {
+            if (out_size == out.size()) {
+                // One byte more than the limit is allowed, so that a message
+                // of exactly the maximum size can be told from a larger one
+                if (out_size > max_size)
+                    return false;
+                size_t limit = std::max(max_size, max_size + 1);
+                out.resize(std::min(std::max(2 * out.size(), size_t(1024)), limit));
+            }
+            m_inflate_stream.next_out = reinterpret_cast<Bytef*>(out.data() + out_size);
+            m_inflate_stream.avail_out = uInt(out.size() - out_size);
+            int rc = inflate(&m_inflate_stream, Z_SYNC_FLUSH);
+            out_size = out.size() - m_inflate_stream.avail_out;
+            if (rc == Z_STREAM_END) {
+                // The sender ended the stream with a final block. Anything
+                // after it is ignored, and the next message starts a new stream.
+                inflateReset(&m_inflate_stream);
+                stream_end = true;
+                return true;
+            }
+            if (rc == Z_BUF_ERROR && m_inflate_stream.avail_out != 0)
+                return true; // All input consumed
+            if (rc != Z_OK && rc != Z_BUF_ERROR)
+                return false;
+            if (m_inflate_stream.avail_in == 0 && m_inflate_stream.avail_out != 0)
+                return true;
+        }
+    }
+};
+
 // mask_payload masks (and demasks) the payload sent from the client to the server.
 void mask_payload(char* masking_key, const char* payload, size_t payload_len, char* output)
 {
@@ -187,6 +463,8 @@ void mask_payload(char* masking_key, const char* payload, size_t payload_len, ch
 // 10 = close frame.
 // Sync clients and server will only send the last four, but must be prepared to
 // receive all.
+// \param compressed sets the RSV1 bit, which marks the first frame of a
+// message compressed by the permessage-deflate extension.
 // \param mask indicates whether the payload of the frame should be masked. Frames
 // are masked if and only if they originate from the client.
 // The payload is located in the buffer \param payload, and has size \param payload_size.
@@ -194,14 +472,14 @@ void mask_payload(char* masking_key, const char* payload, size_t payload_len, ch
 // The frame size can at most be payload_size + 14.
 // \param random is used to create a random masking key.
 // The return value is the size of the frame.
-size_t make_frame(bool fin, int opcode, bool mask, const char* payload, size_t payload_size, char* output,
-                  std::mt19937_64& random)
+size_t make_frame(bool fin, int opcode, bool compressed, bool mask, const char* payload, size_t payload_size,
+                  char* output, std::mt19937_64& random)
 {
     int index = 0; // used to keep track of position within the header.
     using uchar = unsigned char;
-    output[0] = (fin ? char(uchar(128)) : 0) + opcode; // fin and opcode in the first byte.
-    output[1] = (mask ? char(uchar(128)) : 0);         // First bit of the second byte is mask.
-    if (payload_size <= 125) {                         // The payload length is contained in the second byte.
+    output[0] = (fin ? char(uchar(128)) : 0) + (compressed ? 64 : 0) + opcode; // fin, rsv1, and opcode.
+    output[1] = (mask ? char(uchar(128)) : 0); // First bit of the second byte is mask.
+    if (payload_size <= 125) {                 // The payload length is contained in the second byte.
         output[1] += static_cast<char>(payload_size);
         index = 2;
     }
@@ -286,11 +564,13 @@ public:
     char* read_buffer = nullptr;
     bool protocol_error = false;
     bool delivery_ready = false;
+    bool delivery_compressed = false;
     websocket::Opcode delivery_opcode = websocket::Opcode::continuation;
 
-    FrameReader(util::Logger& logger, bool& is_client)
+    FrameReader(util::Logger& logger, bool& is_client, bool& permessage_deflate)
         : logger(logger)
         , m_is_client(is_client)
+        , m_permessage_deflate(permessage_deflate)
     {
     }
 
@@ -328,6 +608,7 @@ public:
 
 private:
     bool& m_is_client;
+    bool& m_permessage_deflate;
 
     char header_buffer[14];
     char* m_masking_key;
@@ -346,6 +627,9 @@ private:
     // The opcode of the message.
     websocket::Opcode m_message_opcode = websocket::Opcode::continuation;
 
+    // Whether the message is compressed by the permessage-deflate extension.
+    bool m_message_compressed = false;
+
     // The size of the stored Websocket message.
     // This size is not the same as the size of the buffer.
     size_t m_message_size = 0;
@@ -386,6 +670,7 @@ private:
         if (m_message_buffer.size() != s_message_buffer_min_size)
             m_message_buffer.resize(s_message_buffer_min_size);
         m_message_opcode = websocket::Opcode::continuation;
+        m_message_compressed = false;
         m_message_size = 0;
     }
 
@@ -399,6 +684,7 @@ private:
         delivery_ready = false;
         delivery_buffer = nullptr;
         delivery_size = 0;
+        delivery_compressed = false;
         delivery_opcode = websocket::Opcode::continuation;
         m_stage = Stage::header_beginning;
         reset_message_buffer();
@@ -414,8 +700,13 @@ private:
         // bit 1.
         m_fin = ((header_buffer[0] & 128) == 128);
 
-        // bit 2,3, and 4.
-        char rsv = (header_buffer[0] & 112) >> 4;
+        // bit 2, which is only used by the permessage-deflate extension.
+        bool rsv1 = ((header_buffer[0] & 64) == 64);
+        if (rsv1 && !m_permessage_deflate)
+            return set_protocol_error();
+
+        // bit 3 and 4.
+        char rsv = (header_buffer[0] & 48) >> 4;
         if (rsv != 0)
             return set_protocol_error();
 
@@ -435,8 +726,9 @@ private:
         // Remainder of second byte.
         m_short_payload_size = (header_buffer[1] & 127);
 
+        // Only the first frame of a text or binary message can have RSV1 set.
         if (m_opcode == websocket::Opcode::continuation) {
-            if (m_message_opcode == websocket::Opcode::continuation)
+            if (m_message_opcode == websocket::Opcode::continuation || rsv1)
                 return set_protocol_error();
         }
         else if (m_opcode == websocket::Opcode::text || m_opcode == websocket::Opcode::binary) {
@@ -444,9 +736,10 @@ private:
                 return set_protocol_error();
 
             m_message_opcode = m_opcode;
+            m_message_compressed = rsv1;
         }
         else { // close, ping, pong.
-            if (!m_fin || m_short_payload_size > 125)
+            if (!m_fin || m_short_payload_size > 125 || rsv1)
                 return set_protocol_error();
         }
 
@@ -539,6 +832,7 @@ private:
                 delivery_opcode = m_message_opcode;
                 delivery_buffer = m_message_buffer.data();
                 delivery_size = m_message_size;
+                delivery_compressed = m_message_compressed;
             }
             else {
                 m_stage = Stage::header_beginning;
@@ -556,6 +850,7 @@ private:
         delivery_ready = false;
         delivery_buffer = nullptr;
         delivery_size = 0;
+        delivery_compressed = false;
         delivery_opcode = websocket::Opcode::continuation;
 
         if (m_opcode == websocket::Opcode::continuation || m_opcode == websocket::Opcode::text ||
@@ -571,18 +866,21 @@ public:
         : m_config(config)
         , m_logger_ptr(config.websocket_get_logger())
         , m_logger{*m_logger_ptr}
-        , m_frame_reader(m_logger, m_is_client)
+        , m_frame_reader(m_logger, m_is_client, m_permessage_deflate)
     {
         m_logger.debug(util::LogCategory::network, "WebSocket::Websocket()");
     }
 
     void initiate_client_handshake(const std::string& request_uri, const std::string& host,
-                                   const std::string& sec_websocket_protocol, HTTPHeaders headers)
+                                   const std::string& sec_websocket_protocol, HTTPHeaders headers,
+                                   bool offer_permessage_deflate)
     {
         m_logger.debug(util::LogCategory::network, "WebSocket::initiate_client_handshake()");
 
         m_stopped = false;
         m_is_client = true;
+        m_offer_permessage_deflate = offer_permessage_deflate;
+        stop_permessage_deflate();
 
         m_sec_websocket_key = make_random_sec_websocket_key(m_config.websocket_get_random());
 
@@ -609,6 +907,9 @@ public:
         req.headers["Sec-WebSocket-Key"] = m_sec_websocket_key;
         req.headers["Sec-WebSocket-Version"] = sec_websocket_version;
         req.headers["Sec-WebSocket-Protocol"] = sec_websocket_protocol;
+        // An offer with parameters may have been given in `headers`
+        if (offer_permessage_deflate)
+            req.headers.emplace(sec_websocket_extensions, permessage_deflate);
 
         m_logger.trace(util::LogCategory::network, "HTTP request =\n%1", req);
 
@@ -636,20 +937,28 @@ public:
         m_http_client->async_request(req, std::move(handler));
     }
 
-    void initiate_server_websocket_after_handshake()
+    void initiate_server_websocket_after_handshake(std::string_view sec_websocket_extensions)
     {
         m_stopped = false;
         m_is_client = false;
+        stop_permessage_deflate();
+        if (!sec_websocket_extensions.empty()) {
+            auto params = parse_permessage_deflate(sec_websocket_extensions, false);
+            REALM_ASSERT_RELEASE(params);
+            start_permessage_deflate(*params, sec_websocket_extensions); // Throws
+        }
         m_frame_reader.reset();
         frame_reader_loop(); // Throws
     }
 
-    void initiate_server_handshake()
+    void initiate_server_handshake(bool accept_permessage_deflate)
     {
         m_logger.debug(util::LogCategory::network, "WebSocket::initiate_server_handshake()");
 
         m_stopped = false;
         m_is_client = false;
+        m_accept_permessage_deflate = accept_permessage_deflate;
+        stop_permessage_deflate();
         m_http_server.reset(new HTTPServer<websocket::Config>(m_config, m_logger_ptr));
         m_frame_reader.reset();
 
@@ -680,13 +989,21 @@ public:
 
         bool mask = m_is_client;
 
+        // Only unfragmented messages are compressed.
+        bool compressed = (m_permessage_deflate && fin &&
+                           (opcode == int(websocket::Opcode::text) || opcode == int(websocket::Opcode::binary)));
+        if (compressed) {
+            size = m_permessage_deflate_streams->compress(data, size, m_deflate_buffer); // Throws
+            data = m_deflate_buffer.data();
+        }
+
         // 14 is the maximum header length of a Websocket frame.
         size_t required_size = size + 14;
         if (m_write_buffer.size() < required_size)
             m_write_buffer.resize(required_size);
 
-        size_t message_size =
-            make_frame(fin, opcode, mask, data, size, m_write_buffer.data(), m_config.websocket_get_random());
+        size_t message_size = make_frame(fin, opcode, compressed, mask, data, size, m_write_buffer.data(),
+                                         m_config.websocket_get_random());
 
         auto handler = [this, handler = std::move(write_completion_handler)](std::error_code ec, size_t) mutable {
             // If the operation is aborted, then the write operation was canceled and we should ignore this callback.
@@ -722,6 +1039,10 @@ public:
             m_write_buffer.resize(s_write_buffer_stable_size);
             m_write_buffer.shrink_to_fit();
         }
+        if (m_deflate_buffer.size() > s_write_buffer_stable_size) {
+            m_deflate_buffer.resize(s_write_buffer_stable_size);
+            m_deflate_buffer.shrink_to_fit();
+        }
 
         write_handler(std::error_code(), m_write_buffer.size());
     }
@@ -757,6 +1078,16 @@ private:
     std::vector<char> m_write_buffer;
     static const size_t s_write_buffer_stable_size = 2048;
 
+    // The permessage-deflate extension is in use if m_permessage_deflate is
+    // true. Outgoing messages are compressed into m_deflate_buffer, and
+    // incoming messages are decompressed into m_inflate_buffer.
+    bool m_offer_permessage_deflate = false;
+    bool m_accept_permessage_deflate = false;
+    bool m_permessage_deflate = false;
+    std::unique_ptr<PerMessageDeflate> m_permessage_deflate_streams;
+    std::vector<char> m_deflate_buffer;
+    std::vector<char> m_inflate_buffer;
+
     std::optional<int> m_test_handshake_response;
     std::string m_test_handshake_response_body;
 
@@ -861,6 +1192,43 @@ private:
         m_config.websocket_protocol_error_handler(ec);
     }
 
+    void start_permessage_deflate(const PerMessageDeflateParams& params, std::string_view sec_websocket_extensions)
+    {
+        int window_bits = (m_is_client ? params.client_max_window_bits : params.server_max_window_bits).value_or(15);
+        bool no_context_takeover =
+            (m_is_client ? params.client_no_context_takeover : params.server_no_context_takeover);
+        m_permessage_deflate_streams = std::make_unique<PerMessageDeflate>(window_bits, no_context_takeover);
+        m_permessage_deflate = true;
+        m_logger.debug(util::LogCategory::network, "WebSocket: Using extension '%1'", sec_websocket_extensions);
+    }
+
+    void stop_permessage_deflate() noexcept
+    {
+        m_permessage_deflate = false;
+        m_permessage_deflate_streams.reset();
+        m_deflate_buffer = {};
+        m_inflate_buffer = {};
+    }
+
+    // handle_sec_websocket_extensions_response() starts the permessage-deflate
+    // extension if the server accepted the offer of it. It returns false if
+    // the response has a Sec-WebSocket-Extensions header that does not
+    // accept an offer made by the client.
+    bool handle_sec_websocket_extensions_response(const HTTPHeaders& headers)
+    {
+        util::Optional<StringData> value = find_http_header_value(headers, sec_websocket_extensions);
+        if (!value)
+            return true;
+        if (!m_offer_permessage_deflate)
+            return false;
+
+        auto params = parse_permessage_deflate(std::string_view(*value), false);
+        if (!params || params->client_max_window_bits == 8)
+            return false;
+        start_permessage_deflate(*params, std::string_view(*value)); // Throws
+        return true;
+    }
+
     // The client receives the HTTP response.
     void handle_http_response_received(HTTPResponse response)
     {
@@ -874,7 +1242,7 @@ private:
 
         bool valid = (find_sec_websocket_accept(response.headers) &&
                       m_sec_websocket_accept == make_sec_websocket_accept(m_sec_websocket_key));
-        if (!valid) {
+        if (!valid || !handle_sec_websocket_extensions_response(response.headers)) {
             error_client_response_websocket_headers_invalid(response);
             return;
         }
@@ -895,7 +1263,8 @@ private:
 
         std::error_code ec;
         util::Optional<HTTPResponse> response =
-            do_make_http_response(request, sec_websocket_protocol ? *sec_websocket_protocol : "realm.io", ec);
+            do_make_http_response(request, sec_websocket_protocol ? *sec_websocket_protocol : "realm.io", ec,
+                                  m_accept_permessage_deflate);
 
         if (ec) {
             error_server_request_header_protocol_violation(ec, request);
@@ -903,6 +1272,12 @@ private:
         }
         REALM_ASSERT(response);
 
+        if (auto value = find_http_header_value(response->headers, sec_websocket_extensions)) {
+            auto params = parse_permessage_deflate(std::string_view(*value), false);
+            REALM_ASSERT(params);
+            start_permessage_deflate(*params, std::string_view(*value)); // Throws
+        }
+
         auto handler = [request, this](std::error_code ec) {
             // If the operation is aborted, the socket object may have been destroyed.
             if (ec != util::error::operation_aborted) {
@@ -1005,14 +1380,29 @@ private:
         if (m_frame_reader.delivery_ready) {
             bool should_continue = true;
 
+            const char* message_data = m_frame_reader.delivery_buffer;
+            size_t message_size = m_frame_reader.delivery_size;
+            if (m_frame_reader.delivery_compressed) {
+                size_t max_size = m_config.websocket_get_max_decompressed_message_size();
+                if (!m_permessage_deflate_streams->decompress(message_data, message_size, m_inflate_buffer,
+                                                              message_size, max_size) || // Throws
+                    message_size > max_size) {
+                    m_logger.error(util::LogCategory::network,
+                                   "WebSocket message is not valid compressed data or decompresses to more than "
+                                   "%1 bytes",
+                                   max_size);
+                    protocol_error(HttpError::bad_message);
+                    return;
+                }
+                message_data = m_inflate_buffer.data();
+            }
+
             switch (m_frame_reader.delivery_opcode) {
                 case websocket::Opcode::text:
-                    should_continue = m_config.websocket_text_message_received(m_frame_reader.delivery_buffer,
-                                                                               m_frame_reader.delivery_size);
+                    should_continue = m_config.websocket_text_message_received(message_data, message_size);
                     break;
                 case websocket::Opcode::binary:
-                    should_continue = m_config.websocket_binary_message_received(m_frame_reader.delivery_buffer,
-                                                                                 m_frame_reader.delivery_size);
+                    should_continue = m_config.websocket_binary_message_received(message_data, message_size);
                     break;
                 case websocket::Opcode::close: {
                     auto [error_code, error_message] =
@@ -1039,6 +1429,11 @@ private:
             if (m_stopped)
                 return;
 
+            if (m_inflate_buffer.size() > s_write_buffer_stable_size) {
+                m_inflate_buffer.resize(s_write_buffer_stable_size);
+                m_inflate_buffer.shrink_to_fit();
+            }
+
             // recursion is harmless, since the depth will be at most 2.
             frame_reader_loop();
             return;
@@ -1239,6 +1634,11 @@ bool websocket::Config::websocket_pong_message_received(const char*, size_t)
     return true;
 }
 
+size_t websocket::Config::websocket_get_max_decompressed_message_size() noexcept
+{
+    return 256 * 1024 * 1024;
+}
+
 
 class websocket::Socket::Impl : public WebSocket {
 public:
@@ -1261,19 +1661,21 @@ websocket::Socket::Socket(Socket&& socket) noexcept
 websocket::Socket::~Socket() noexcept {}
 
 void websocket::Socket::initiate_client_handshake(const std::string& request_uri, const std::string& host,
-                                                  const std::string& sec_websocket_protocol, HTTPHeaders headers)
+                                                  const std::string& sec_websocket_protocol, HTTPHeaders headers,
+                                                  bool offer_permessage_deflate)
 {
-    m_impl->initiate_client_handshake(request_uri, host, sec_websocket_protocol, std::move(headers));
+    m_impl->initiate_client_handshake(request_uri, host, sec_websocket_protocol, std::move(headers),
+                                      offer_permessage_deflate);
 }
 
-void websocket::Socket::initiate_server_handshake()
+void websocket::Socket::initiate_server_handshake(bool accept_permessage_deflate)
 {
-    m_impl->initiate_server_handshake();
+    m_impl->initiate_server_handshake(accept_permessage_deflate);
 }
 
-void websocket::Socket::initiate_server_websocket_after_handshake()
+void websocket::Socket::initiate_server_websocket_after_handshake(std::string_view sec_websocket_extensions)
 {
-    m_impl->initiate_server_websocket_after_handshake();
+    m_impl->initiate_server_websocket_after_handshake(sec_websocket_extensions);
 }
 
 void websocket::Socket::async_write_frame(bool fin, Opcode opcode, const char* data, size_t size,
@@ -1327,9 +1729,9 @@ util::Optional<std::string> websocket::read_sec_websocket_protocol(const HTTPReq
 
 util::Optional<HTTPResponse> websocket::make_http_response(const HTTPRequest& request,
                                                            const std::string& sec_websocket_protocol,
-                                                           std::error_code& ec)
+                                                           std::error_code& ec, bool accept_permessage_deflate)
 {
-    return do_make_http_response(request, sec_websocket_protocol, ec);
+    return do_make_http_response(request, sec_websocket_protocol, ec, accept_permessage_deflate);
 }
 
 const std::error_category& websocket::http_error_category() noexcept
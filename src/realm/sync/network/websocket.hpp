@@ -80,6 +80,11 @@ public:
     virtual bool websocket_ping_message_received(const char* data, size_t size);
     virtual bool websocket_pong_message_received(const char* data, size_t size);
     //@}
+
+    /// The largest size of a message compressed by the permessage-deflate
+    /// extension once it is decompressed. Decompressing a message which would
+    /// exceed it is a protocol error. The default is 256 MiB.
+    virtual size_t websocket_get_max_decompressed_message_size() noexcept;
 };
 
 
@@ -99,19 +104,24 @@ public:
     /// will be sent as the value in a HTTP Host header line.
     /// \param sec_websocket_protocol will be set as header value for
     /// Sec-WebSocket-Protocol. Extra HTTP headers can be provided in \a headers.
+    /// If \a offer_permessage_deflate is true, the request offers the
+    /// permessage-deflate extension (RFC 7692), and messages are compressed if
+    /// the server accepts it.
     ///
     /// When the server responds with a valid HTTP response, the callback
     /// function websocket_handshake_completion_handler() is called. Messages
     /// can only be sent and received after the handshake has completed.
     void initiate_client_handshake(const std::string& request_uri, const std::string& host,
-                                   const std::string& sec_websocket_protocol, HTTPHeaders headers = HTTPHeaders{});
+                                   const std::string& sec_websocket_protocol, HTTPHeaders headers = HTTPHeaders{},
+                                   bool offer_permessage_deflate = false);
 
     /// initiate_server_handshake() starts the Socket in server mode. It will
     /// wait for a HTTP request from a client and respond with a HTTP response.
     /// After sending a HTTP response, websocket_handshake_completion_handler()
     /// is called. Messages can only be sent and received after the handshake
-    /// has completed.
-    void initiate_server_handshake();
+    /// has completed. If \a accept_permessage_deflate is true, the
+    /// permessage-deflate extension is used if the client offers it.
+    void initiate_server_handshake(bool accept_permessage_deflate = false);
 
     /// initiate_server_websocket_after_handshake() starts the Socket in a state
     /// where it will read and write WebSocket messages but it will expect the
@@ -119,8 +129,9 @@ public:
     /// function is to perform HTTP routing externally and then start the
     /// WebSocket in case the HTTP request is an Upgrade to WebSocket.
     /// Typically, the caller will have used make_http_response() to send the
-    /// HTTP response itself.
-    void initiate_server_websocket_after_handshake();
+    /// HTTP response itself. \a sec_websocket_extensions must be the value of
+    /// the Sec-WebSocket-Extensions header of that response, if any.
+    void initiate_server_websocket_after_handshake(std::string_view sec_websocket_extensions = {});
 
     /// The async_write_* functions send frames. Only one frame should be sent at a time,
     /// meaning that the user must wait for the handler to be called before sending the next frame.
@@ -135,6 +146,9 @@ public:
     /// websocket_write_error_handler() in Config.
     /// This function is rather low level and should only be used with knowledge of the WebSocket protocol.
     /// The five utility functions below are recommended for message sending.
+    /// If the permessage-deflate extension is in use, unfragmented text and
+    /// binary messages are compressed, while fragmented messages are sent as
+    /// they are.
     ///
     /// FIXME: Guarantee no callback reentrance, i.e., that the completion
     /// handler, or the error handler in case an error occurs, is never called
@@ -185,9 +199,12 @@ util::Optional<std::string> read_sec_websocket_protocol(const HTTPRequest& reque
 
 /// make_http_response() takes \a request as a WebSocket handshake request,
 /// validates it, and makes a HTTP response. If the request is invalid, the
-/// return value is None, and ec is set to Error::bad_request_header_*.
+/// return value is None, and ec is set to Error::bad_request_header_*. If \a
+/// accept_permessage_deflate is true, and the request offers the
+/// permessage-deflate extension with parameters that are supported, the
+/// response accepts it in a Sec-WebSocket-Extensions header.
 util::Optional<HTTPResponse> make_http_response(const HTTPRequest& request, const std::string& sec_websocket_protocol,
-                                                std::error_code& ec);
+                                                std::error_code& ec, bool accept_permessage_deflate = false);
 
 enum class HttpError {
     bad_request_malformed_http,
@@ -429,14 +429,24 @@ void ClientHistory::integrate_server_changesets(
     REALM_ASSERT(
         (transact->get_transact_stage() == DB::transact_Writing && batch_state != DownloadBatchState::SteadyState) ||
         (transact->get_transact_stage() == DB::transact_Reading && batch_state == DownloadBatchState::SteadyState));
+
+    // Parse incoming changesets without holding the write lock unless 'transact' is specified.
+    auto changesets = parse_server_changesets(incoming_changesets); // Throws
+    integrate_server_changesets(progress, downloadable_bytes, incoming_changesets, std::move(changesets),
+                                version_info, batch_state, logger, transact, std::move(run_in_write_tr)); // Throws
+}
+
+
+std::vector<Changeset> ClientHistory::parse_server_changesets(util::Span<const RemoteChangeset> incoming_changesets)
+{
     std::vector<Changeset> changesets;
     changesets.resize(incoming_changesets.size()); // Throws
 
-    // Parse incoming changesets without holding the write lock unless 'transact' is specified.
     try {
         for (std::size_t i = 0; i < incoming_changesets.size(); ++i) {
             const RemoteChangeset& changeset = incoming_changesets[i];
-            parse_remote_changeset(changeset, changesets[i]); // Throws
+            // `incoming_changesets` outlives `changesets`, so the strings need not be copied
+            parse_remote_changeset_in_place(changeset, changesets[i]); // Throws
             changesets[i].transform_sequence = i;
         }
     }
@@ -445,6 +455,21 @@ void ClientHistory::integrate_server_changesets(
                                    util::format("Failed to parse received changeset: %1", e.what()),
                                    ProtocolError::bad_changeset);
     }
+    return changesets;
+}
+
+
+void ClientHistory::integrate_server_changesets(
+    const SyncProgress& progress, DownloadableProgress downloadable_bytes,
+    util::Span<const RemoteChangeset> incoming_changesets, std::vector<Changeset> changesets,
+    VersionInfo& version_info, DownloadBatchState batch_state, util::Logger& logger, const TransactionRef& transact,
+    util::UniqueFunction<void(const TransactionRef&, util::Span<Changeset>)> run_in_write_tr)
+{
+    REALM_ASSERT(incoming_changesets.size() != 0);
+    REALM_ASSERT_3(changesets.size(), ==, incoming_changesets.size());
+    REALM_ASSERT(
+        (transact->get_transact_stage() == DB::transact_Writing && batch_state != DownloadBatchState::SteadyState) ||
+        (transact->get_transact_stage() == DB::transact_Reading && batch_state == DownloadBatchState::SteadyState));
 
     VersionID new_version{0, 0};
     auto num_changesets = incoming_changesets.size();
@@ -593,6 +618,7 @@ size_t ClientHistory::transform_and_apply_server_changesets(util::Span<Changeset
                      transact->get_commit_size() >= commit_byte_size_limit);
         };
         sync::Transformer transformer;
+        transformer.set_pool(m_transform_pool);
         auto changesets_transformed_count = transformer.transform_remote_changesets(
             *this, sync_file_id, local_version, changesets_to_integrate, changeset_applier, logger); // Throws
         return changesets_transformed_count;
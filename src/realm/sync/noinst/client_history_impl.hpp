@@ -254,6 +254,29 @@ public:
         util::Logger&, const TransactionRef& transact,
         util::UniqueFunction<void(const TransactionRef&, util::Span<Changeset>)> run_in_write_tr = nullptr);
 
+    /// Same as above, but with \a changesets already parsed into \a
+    /// parsed_changesets by parse_server_changesets().
+    void integrate_server_changesets(
+        const SyncProgress& progress, DownloadableProgress downloadable_bytes,
+        util::Span<const RemoteChangeset> changesets, std::vector<Changeset> parsed_changesets,
+        VersionInfo& new_version, DownloadBatchState download_type, util::Logger&, const TransactionRef& transact,
+        util::UniqueFunction<void(const TransactionRef&, util::Span<Changeset>)> run_in_write_tr = nullptr);
+
+    /// Parse changesets received from the server for
+    /// integrate_server_changesets(). The parsed changesets refer to the data
+    /// of \a changesets, which must outlive them. Throws IntegrationException
+    /// if a changeset is bad. Does not access the history, so it may be called
+    /// on any thread.
+    static std::vector<Changeset> parse_server_changesets(util::Span<const RemoteChangeset> changesets);
+
+    /// Set the pool used by integrate_server_changesets() to transform the
+    /// server changesets, which is shared by the sessions of a client. See
+    /// sync::Transformer::set_pool().
+    void set_transform_pool(std::shared_ptr<util::WorkStealingPool> pool) noexcept
+    {
+        m_transform_pool = std::move(pool);
+    }
+
     static void get_upload_download_bytes(DB*, std::uint_fast64_t&, DownloadableProgress&, std::uint_fast64_t&,
                                           std::uint_fast64_t&, std::uint_fast64_t&);
     static void get_upload_download_bytes(DB*, std::uint_fast64_t&, std::uint_fast64_t&);
@@ -390,6 +413,8 @@ private:
 
     util::UniqueFunction<timestamp_type()> m_local_origin_timestamp_source = generate_changeset_timestamp;
 
+    std::shared_ptr<util::WorkStealingPool> m_transform_pool;
+
     void initialize(DB& db) noexcept
     {
         m_db = &db;
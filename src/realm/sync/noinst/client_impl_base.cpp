@@ -152,12 +152,15 @@ ClientImpl::ClientImpl(ClientConfig config)
     , m_enable_default_port_hack{config.enable_default_port_hack}
     , m_disable_upload_compaction{config.disable_upload_compaction}
     , m_fix_up_object_ids{config.fix_up_object_ids}
+    , m_transform_pool{sync::Transformer::make_pool(config.transform_threads)} // Throws
+    , m_enable_permessage_deflate{config.enable_permessage_deflate}
     , m_roundtrip_time_handler{std::move(config.roundtrip_time_handler)}
     , m_socket_provider{std::move(config.socket_provider)}
     , m_client_protocol{} // Throws
     , m_one_connection_per_session{config.one_connection_per_session}
     , m_random{}
 {
+    m_client_protocol.set_compression_dictionary(std::move(config.compression_dictionary));
     // FIXME: Would be better if seeding was up to the application.
     util::seed_prng_nondeterministically(m_random); // Throws
 
@@ -797,7 +800,14 @@ void Connection::initiate_reconnect()
     logger.info("Connecting to '%1%2:%3%4'", to_string(m_server_endpoint.envelope), m_server_endpoint.address,
                 m_server_endpoint.port, m_http_request_path_prefix);
 
+    std::map<std::string, std::string> http_headers{m_custom_http_headers.begin(), m_custom_http_headers.end()};
+    if (auto dictionary = get_client_protocol().get_compression_dictionary(); !dictionary.empty()) {
+        http_headers[std::string(get_compression_dictionary_header_name())] =
+            util::to_string(util::compression::dictionary_id(dictionary)); // Throws
+    }
+
     m_websocket_error_received = false;
+    m_server_has_compression_dictionary = false;
     m_websocket =
         m_client.m_socket_provider->connect(std::make_unique<WebSocketObserverShim>(this),
                                             WebSocketEndpoint{
@@ -807,11 +817,12 @@ void Connection::initiate_reconnect()
                                                 std::move(sec_websocket_protocol),
                                                 is_ssl(m_server_endpoint.envelope),
                                                 /// DEPRECATED - The following will be removed in a future release
-                                                {m_custom_http_headers.begin(), m_custom_http_headers.end()},
+                                                std::move(http_headers),
                                                 m_verify_servers_ssl_certificate,
                                                 m_ssl_trust_certificate_path,
                                                 m_ssl_verify_callback,
                                                 m_proxy_config,
+                                                m_client.m_enable_permessage_deflate,
                                             });
 }
 
@@ -1399,6 +1410,11 @@ void Connection::receive_download_message(session_ident_type session_ident, cons
         return;
     }
 
+    // The server only compresses with the dictionary if it has the one we
+    // announced, so from now on we can do the same
+    if (message.body_compression == sync::BodyCompression::deflate_with_dictionary)
+        m_server_has_compression_dictionary = true;
+
     if (auto status = sess->receive_download_message(message); !status.is_ok()) {
         close_due_to_protocol_error(std::move(status));
     }
@@ -1708,6 +1724,7 @@ void Session::activate()
         if (!m_performing_client_reset) {
             get_history().get_status(m_last_version_available, m_client_file_ident, m_progress); // Throws
         }
+        get_history().set_transform_pool(get_client().m_transform_pool);
     }
     logger.debug("client_file_ident = %1, client_file_ident_salt = %2", m_client_file_ident.ident,
                  m_client_file_ident.salt); // Throws
@@ -2076,7 +2093,8 @@ void Session::send_upload_message()
                  uploadable_changesets.size()); // Throws
 
     ClientProtocol& protocol = m_conn.get_client_protocol();
-    ClientProtocol::UploadMessageBuilder upload_message_builder = protocol.make_upload_message_builder(); // Throws
+    ClientProtocol::UploadMessageBuilder upload_message_builder =
+        protocol.make_upload_message_builder(m_conn.m_server_has_compression_dictionary); // Throws
 
     for (const UploadChangeset& uc : uploadable_changesets) {
         logger.debug(util::LogCategory::changeset,
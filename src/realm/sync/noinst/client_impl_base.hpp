@@ -248,6 +248,10 @@ private:
     const bool m_enable_default_port_hack;
     const bool m_disable_upload_compaction;
     const bool m_fix_up_object_ids;
+    // The pool on which the sessions transform downloaded changesets, if
+    // more than one thread is used
+    const std::shared_ptr<util::WorkStealingPool> m_transform_pool;
+    const bool m_enable_permessage_deflate;
     const std::function<RoundtripTimeHandler> m_roundtrip_time_handler;
     const std::string m_user_agent_string;
     std::shared_ptr<SyncSocketProvider> m_socket_provider;
@@ -631,6 +635,10 @@ private:
 
     bool m_websocket_error_received = false;
 
+    // A DOWNLOAD message compressed with the compression dictionary was
+    // received since the connection was established
+    bool m_server_has_compression_dictionary = false;
+
     bool m_force_closed = false;
 
     // The timer will be constructed on demand, and will only be destroyed when
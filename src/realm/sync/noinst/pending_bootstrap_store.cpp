@@ -219,7 +219,13 @@ void PendingBootstrapStore::clear(Transaction& wt)
 PendingBootstrapStore::PendingBatch PendingBootstrapStore::peek_pending(size_t limit_in_bytes)
 {
     auto tr = m_db->start_read();
-    auto bootstrap_table = tr->get_table(m_table);
+    return peek_pending(*tr, 0, limit_in_bytes);
+}
+
+PendingBootstrapStore::PendingBatch PendingBootstrapStore::peek_pending(Transaction& tr, size_t offset,
+                                                                        size_t limit_in_bytes) const
+{
+    auto bootstrap_table = tr.get_table(m_table);
     if (bootstrap_table->is_empty()) {
         return {};
     }
@@ -245,8 +251,9 @@ PendingBootstrapStore::PendingBatch PendingBootstrapStore::peek_pending(size_t l
     }
 
     auto changeset_list = bootstrap_obj.get_linklist(m_changesets);
+    REALM_ASSERT_3(offset, <=, changeset_list.size());
     size_t bytes_so_far = 0;
-    for (size_t idx = 0; idx < changeset_list.size() && bytes_so_far < limit_in_bytes; ++idx) {
+    for (size_t idx = offset; idx < changeset_list.size() && bytes_so_far < limit_in_bytes; ++idx) {
         auto cur_changeset = changeset_list.get_object(idx);
         ret.changeset_data.push_back(util::AppendBuffer<char>());
         auto& uncompressed_buffer = ret.changeset_data.back();
@@ -272,7 +279,7 @@ PendingBootstrapStore::PendingBatch PendingBootstrapStore::peek_pending(size_t l
         bytes_so_far += parsed_changeset.data.size();
         ret.changesets.push_back(std::move(parsed_changeset));
     }
-    ret.remaining_changesets = changeset_list.size() - ret.changesets.size();
+    ret.remaining_changesets = changeset_list.size() - offset - ret.changesets.size();
 
     return ret;
 }
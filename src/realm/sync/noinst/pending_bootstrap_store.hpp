@@ -66,6 +66,12 @@ public:
     // state.
     PendingBatch peek_pending(size_t limit_in_bytes);
 
+    // Returns the batch following the first `offset` changesets of the pending bootstrap as of `tr`, which must be
+    // a read or frozen transaction. This does not change the state of the store, so with a frozen transaction it
+    // may be called on another thread than the one using the store, e.g. to read the next batch while a batch is
+    // being integrated.
+    PendingBatch peek_pending(Transaction& tr, size_t offset, size_t limit_in_bytes) const;
+
     struct PendingBatchStats {
         int64_t query_version = 0;
         size_t pending_changesets = 0;
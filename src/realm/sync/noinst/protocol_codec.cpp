@@ -85,10 +85,11 @@ void ClientProtocol::make_test_command_message(OutputBuffer& out, session_ident_
 
 ClientProtocol::UploadMessageBuilder::UploadMessageBuilder(
     OutputBuffer& body_buffer, std::vector<char>& compression_buffer,
-    util::compression::CompressMemoryArena& compress_memory_arena)
+    util::compression::CompressMemoryArena& compress_memory_arena, util::Span<const char> compression_dictionary)
     : m_body_buffer{body_buffer}
     , m_compression_buffer{compression_buffer}
     , m_compress_memory_arena{compress_memory_arena}
+    , m_compression_dictionary{compression_dictionary}
 {
     m_body_buffer.reset();
 }
@@ -119,16 +120,21 @@ void ClientProtocol::UploadMessageBuilder::make_upload_message(int protocol_vers
 
     bool is_body_compressed = false;
     if (body.size() > g_max_uncompressed) {
-        util::compression::allocate_and_compress(m_compress_memory_arena, body,
-                                                 m_compression_buffer); // Throws
+        util::compression::allocate_and_compress(m_compress_memory_arena, body, m_compression_buffer,
+                                                 m_compression_dictionary); // Throws
         is_body_compressed = m_compression_buffer.size() < body.size();
     }
 
     // The compressed body is only sent if it is smaller than the uncompressed body.
     std::size_t compressed_body_size = is_body_compressed ? m_compression_buffer.size() : 0;
+    auto body_compression = BodyCompression::none;
+    if (is_body_compressed) {
+        body_compression = m_compression_dictionary.empty() ? BodyCompression::deflate
+                                                            : BodyCompression::deflate_with_dictionary;
+    }
 
     // The header of the upload message.
-    out << "upload " << session_ident << " " << int(is_body_compressed) << " " << body.size() << " "
+    out << "upload " << session_ident << " " << int(body_compression) << " " << body.size() << " "
         << compressed_body_size;
     out << " " << progress_client_version << " " << progress_server_version << " " << locked_server_version; // Throws
     out << "\n";                                                                                             // Throws
@@ -141,9 +147,12 @@ void ClientProtocol::UploadMessageBuilder::make_upload_message(int protocol_vers
     REALM_ASSERT(!out.fail());
 }
 
-ClientProtocol::UploadMessageBuilder ClientProtocol::make_upload_message_builder()
+ClientProtocol::UploadMessageBuilder ClientProtocol::make_upload_message_builder(bool use_compression_dictionary)
 {
-    return UploadMessageBuilder{m_output_buffer, m_buffer, m_compress_memory_arena};
+    util::Span<const char> dictionary;
+    if (use_compression_dictionary)
+        dictionary = m_compression_dictionary;
+    return UploadMessageBuilder{m_output_buffer, m_buffer, m_compress_memory_arena, dictionary};
 }
 
 void ClientProtocol::make_unbind_message(OutputBuffer& out, session_ident_type session_ident)
@@ -232,27 +241,28 @@ void ServerProtocol::make_download_message(int protocol_version, OutputBuffer& o
                                            version_type upload_client_version, version_type upload_server_version,
                                            std::uint_fast64_t downloadable_bytes, std::size_t num_changesets,
                                            const char* body, std::size_t uncompressed_body_size,
-                                           std::size_t compressed_body_size, bool body_is_compressed,
+                                           std::size_t compressed_body_size, BodyCompression body_compression,
                                            util::Logger& logger)
 {
     static_cast<void>(protocol_version);
     // The header of the download message.
     out << "download " << session_ident << " " << download_server_version << " " << download_client_version << " "
         << latest_server_version << " " << latest_server_version_salt << " " << upload_client_version << " "
-        << upload_server_version << " " << downloadable_bytes << " " << int(body_is_compressed) << " "
+        << upload_server_version << " " << downloadable_bytes << " " << int(body_compression) << " "
         << uncompressed_body_size << " " << compressed_body_size << "\n"; // Throws
 
-    std::size_t body_size = (body_is_compressed ? compressed_body_size : uncompressed_body_size);
+    std::size_t body_size =
+        (body_compression != BodyCompression::none ? compressed_body_size : uncompressed_body_size);
     out.write(body, body_size);
 
     logger.detail(util::LogCategory::changeset,
                   "Sending: DOWNLOAD(download_server_version=%1, download_client_version=%2, "
                   "latest_server_version=%3, latest_server_version_salt=%4, "
                   "upload_client_version=%5, upload_server_version=%6, "
-                  "num_changesets=%7, is_body_compressed=%8, body_size=%9, "
+                  "num_changesets=%7, body_compression=%8, body_size=%9, "
                   "compressed_body_size=%10)",
                   download_server_version, download_client_version, latest_server_version, latest_server_version_salt,
-                  upload_client_version, upload_server_version, num_changesets, body_is_compressed,
+                  upload_client_version, upload_server_version, num_changesets, int(body_compression),
                   uncompressed_body_size, compressed_body_size); // Throws
 }
 
@@ -171,6 +171,19 @@ public:
     using OutputBuffer = util::ResettableExpandableBufferOutputStream;
     using RemoteChangeset = sync::RemoteChangeset;
     using ReceivedChangesets = std::vector<RemoteChangeset>;
+    using BodyCompression = sync::BodyCompression;
+
+    /// Set the dictionary for message bodies sent with
+    /// BodyCompression::deflate_with_dictionary.
+    void set_compression_dictionary(std::vector<char> dictionary) noexcept
+    {
+        m_compression_dictionary = std::move(dictionary);
+    }
+
+    util::Span<const char> get_compression_dictionary() const noexcept
+    {
+        return m_compression_dictionary;
+    }
 
     /// Messages sent by the client.
 
@@ -198,7 +211,8 @@ public:
     class UploadMessageBuilder {
     public:
         UploadMessageBuilder(OutputBuffer& body_buffer, std::vector<char>& compression_buffer,
-                             util::compression::CompressMemoryArena& compress_memory_arena);
+                             util::compression::CompressMemoryArena& compress_memory_arena,
+                             util::Span<const char> compression_dictionary = {});
 
         void add_changeset(version_type client_version, version_type server_version, timestamp_type origin_timestamp,
                            file_ident_type origin_file_ident, ChunkedBinaryData changeset);
@@ -212,9 +226,13 @@ public:
         OutputBuffer& m_body_buffer;
         std::vector<char>& m_compression_buffer;
         util::compression::CompressMemoryArena& m_compress_memory_arena;
+        util::Span<const char> m_compression_dictionary;
     };
 
-    UploadMessageBuilder make_upload_message_builder();
+    /// If `use_compression_dictionary` is true, the body of the message is
+    /// compressed with the compression dictionary. This must only be done once
+    /// the server has shown that it has the same dictionary.
+    UploadMessageBuilder make_upload_message_builder(bool use_compression_dictionary = false);
 
     void make_unbind_message(OutputBuffer&, session_ident_type session_ident);
 
@@ -406,6 +424,7 @@ public:
         std::optional<int64_t> query_version;
         std::optional<bool> last_in_batch;
         sync::DownloadableProgress downloadable;
+        BodyCompression body_compression = BodyCompression::none;
         ReceivedChangesets changesets;
     };
 
@@ -450,7 +469,7 @@ private:
         else
             message.downloadable = uint64_t(msg.read_next<int64_t>());
 
-        auto is_body_compressed = msg.read_next<bool>();
+        auto body_compression = msg.read_next<int>();
         auto uncompressed_body_size = msg.read_next<size_t>();
         auto compressed_body_size = msg.read_next<size_t>('\n');
 
@@ -458,14 +477,27 @@ private:
             auto header = msg_with_header.substr(0, msg_with_header.size() - msg.remaining().size());
             return report_error(ErrorCodes::LimitExceeded, "Limits exceeded in input message '%1'", header);
         }
+        if (body_compression < 0 || body_compression > int(BodyCompression::deflate_with_dictionary)) {
+            return report_error(ErrorCodes::SyncProtocolInvariantFailed, "Bad body compression %1",
+                                body_compression);
+        }
+        message.body_compression = BodyCompression(body_compression);
+        if (message.body_compression == BodyCompression::deflate_with_dictionary &&
+            m_compression_dictionary.empty()) {
+            return report_error(ErrorCodes::SyncProtocolInvariantFailed,
+                                "Body compressed with a dictionary, but no compression dictionary is configured");
+        }
 
         std::unique_ptr<char[]> uncompressed_body_buffer;
-        // if is_body_compressed == true, we must decompress the received body.
-        if (is_body_compressed) {
+        // if the body is compressed, we must decompress the received body.
+        if (message.body_compression != BodyCompression::none) {
+            util::Span<const char> dictionary;
+            if (message.body_compression == BodyCompression::deflate_with_dictionary)
+                dictionary = m_compression_dictionary;
             uncompressed_body_buffer = std::make_unique<char[]>(uncompressed_body_size);
             std::error_code ec =
                 util::compression::decompress({msg.remaining().data(), compressed_body_size},
-                                              {uncompressed_body_buffer.get(), uncompressed_body_size});
+                                              {uncompressed_body_buffer.get(), uncompressed_body_size}, dictionary);
 
             if (ec) {
                 return report_error(ErrorCodes::RuntimeError, "compression::inflate: %1", ec.message());
@@ -475,9 +507,9 @@ private:
         }
 
         logger.debug(util::LogCategory::changeset,
-                     "Download message compression: session_ident=%1, is_body_compressed=%2, "
+                     "Download message compression: session_ident=%1, body_compression=%2, "
                      "compressed_body_size=%3, uncompressed_body_size=%4",
-                     session_ident, is_body_compressed, compressed_body_size, uncompressed_body_size);
+                     session_ident, body_compression, compressed_body_size, uncompressed_body_size);
 
         // Loop through the body and find the changesets.
         while (!msg.at_end()) {
@@ -625,6 +657,8 @@ private:
     std::vector<char> m_buffer;
 
     util::compression::CompressMemoryArena m_compress_memory_arena;
+
+    std::vector<char> m_compression_dictionary;
 };
 
 
@@ -644,6 +678,19 @@ public:
     // clang-format on
 
     using OutputBuffer = util::ResettableExpandableBufferOutputStream;
+    using BodyCompression = sync::BodyCompression;
+
+    /// Set the dictionary for message bodies sent with
+    /// BodyCompression::deflate_with_dictionary.
+    void set_compression_dictionary(std::vector<char> dictionary) noexcept
+    {
+        m_compression_dictionary = std::move(dictionary);
+    }
+
+    util::Span<const char> get_compression_dictionary() const noexcept
+    {
+        return m_compression_dictionary;
+    }
 
     // Messages sent by the server to the client
 
@@ -668,7 +715,7 @@ public:
                                version_type upload_client_version, version_type upload_server_version,
                                std::uint_fast64_t downloadable_bytes, std::size_t num_changesets, const char* body,
                                std::size_t uncompressed_body_size, std::size_t compressed_body_size,
-                               bool body_is_compressed, util::Logger&);
+                               BodyCompression body_compression, util::Logger&);
 
     void make_mark_message(OutputBuffer&, session_ident_type session_ident, request_ident_type request_ident);
 
@@ -737,13 +784,25 @@ public:
             if (message_type == "upload") {
                 auto msg_with_header = msg.remaining();
                 auto session_ident = msg.read_next<session_ident_type>();
-                auto is_body_compressed = msg.read_next<bool>();
+                auto body_compression = msg.read_next<int>();
                 auto uncompressed_body_size = msg.read_next<size_t>();
                 auto compressed_body_size = msg.read_next<size_t>();
                 auto progress_client_version = msg.read_next<version_type>();
                 auto progress_server_version = msg.read_next<version_type>();
                 auto locked_server_version = msg.read_next<version_type>('\n');
 
+                if (body_compression < 0 || body_compression > int(BodyCompression::deflate_with_dictionary)) {
+                    return report_error(ErrorCodes::SyncProtocolInvariantFailed, "Bad body compression %1",
+                                        body_compression);
+                }
+                bool is_body_compressed = (body_compression != int(BodyCompression::none));
+                bool use_dictionary = (body_compression == int(BodyCompression::deflate_with_dictionary));
+                if (use_dictionary && m_compression_dictionary.empty()) {
+                    return report_error(ErrorCodes::SyncProtocolInvariantFailed,
+                                        "Body compressed with a dictionary, but no compression dictionary is "
+                                        "configured");
+                }
+
                 std::size_t body_size = (is_body_compressed ? compressed_body_size : uncompressed_body_size);
                 if (body_size > s_max_body_size) {
                     auto header = msg_with_header.substr(0, msg_with_header.size() - msg.bytes_remaining());
@@ -758,9 +817,12 @@ public:
                 if (is_body_compressed) {
                     uncompressed_body_buffer = std::make_unique<char[]>(uncompressed_body_size);
                     auto compressed_body = msg.read_sized_data<BinaryData>(compressed_body_size);
+                    util::Span<const char> dictionary;
+                    if (use_dictionary)
+                        dictionary = m_compression_dictionary;
 
                     std::error_code ec = util::compression::decompress(
-                        compressed_body, {uncompressed_body_buffer.get(), uncompressed_body_size});
+                        compressed_body, {uncompressed_body_buffer.get(), uncompressed_body_size}, dictionary);
 
                     if (ec) {
                         return report_error(ErrorCodes::RuntimeError, "compression::inflate: %1", ec.message());
@@ -770,11 +832,11 @@ public:
                 }
 
                 logger.debug(util::LogCategory::changeset,
-                             "Upload message compression: is_body_compressed = %1, "
+                             "Upload message compression: body_compression=%1, "
                              "compressed_body_size=%2, uncompressed_body_size=%3, "
                              "progress_client_version=%4, progress_server_version=%5, "
                              "locked_server_version=%6",
-                             is_body_compressed, compressed_body_size, uncompressed_body_size,
+                             body_compression, compressed_body_size, uncompressed_body_size,
                              progress_client_version, progress_server_version, locked_server_version); // Throws
 
 
@@ -904,6 +966,8 @@ private:
     static constexpr std::size_t s_max_changeset_size         = std::numeric_limits<std::size_t>::max(); // FIXME: What is a reasonable value here?
     static constexpr std::size_t s_max_body_size              = std::numeric_limits<std::size_t>::max();
     // clang-format on
+
+    std::vector<char> m_compression_dictionary;
 };
 
 // make_authorization_header() makes the value of the Authorization header used in the
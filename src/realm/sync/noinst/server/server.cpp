@@ -222,7 +222,7 @@ struct DownloadCache {
     std::unique_ptr<char[]> body;
     std::size_t uncompressed_body_size;
     std::size_t compressed_body_size;
-    bool body_is_compressed;
+    BodyCompression body_compression;
     version_type end_version;
     DownloadCursor download_progress;
     std::uint_fast64_t downloadable_bytes;
@@ -1079,7 +1079,8 @@ public:
     SyncConnection(ServerImpl& serv, std::int_fast64_t id, std::unique_ptr<network::Socket>&& socket,
                    std::unique_ptr<network::ssl::Stream>&& ssl_stream,
                    std::unique_ptr<network::ReadAheadBuffer>&& read_ahead_buffer, int client_protocol_version,
-                   std::string client_user_agent, std::string remote_endpoint, std::string appservices_request_id)
+                   std::string client_user_agent, std::string remote_endpoint, std::string appservices_request_id,
+                   bool use_compression_dictionary)
         : logger_ptr{std::make_shared<util::PrefixLogger>(util::LogCategory::server, make_logger_prefix(id),
                                                           serv.logger_ptr)} // Throws
         , logger{*logger_ptr}
@@ -1093,6 +1094,7 @@ public:
         , m_client_user_agent{std::move(client_user_agent)}
         , m_remote_endpoint{std::move(remote_endpoint)}
         , m_appservices_request_id{std::move(appservices_request_id)}
+        , m_use_compression_dictionary{use_compression_dictionary}
     {
         // Make the output buffer stream throw std::bad_alloc if it fails to
         // expand the buffer
@@ -1130,6 +1132,11 @@ public:
         return m_client_user_agent;
     }
 
+    bool use_compression_dictionary() const noexcept
+    {
+        return m_use_compression_dictionary;
+    }
+
     const std::string& get_remote_endpoint() const noexcept
     {
         return m_remote_endpoint;
@@ -1244,7 +1251,7 @@ public:
         return *m_socket;
     }
 
-    void initiate();
+    void initiate(std::string_view sec_websocket_extensions);
 
     // Commits suicide
     template <class... Params>
@@ -1325,6 +1332,9 @@ private:
 
     const std::string m_appservices_request_id;
 
+    // The client has the same compression dictionary as the server
+    const bool m_use_compression_dictionary;
+
     // A queue of sessions that have enlisted for an opportunity to send a
     // message. Sessions will be served in the order that they enlist. A session
     // can only occur once in this queue (linked list). If the queue is not
@@ -1852,8 +1862,9 @@ private:
         }
 
         std::error_code ec;
-        util::Optional<HTTPResponse> response =
-            websocket::make_http_response(request, sec_websocket_protocol_2, ec); // Throws
+        bool accept_permessage_deflate = !m_server.get_config().disable_permessage_deflate;
+        util::Optional<HTTPResponse> response = websocket::make_http_response(
+            request, sec_websocket_protocol_2, ec, accept_permessage_deflate); // Throws
 
         if (ec) {
             if (ec == websocket::HttpError::bad_request_header_upgrade) {
@@ -1885,7 +1896,24 @@ private:
                 user_agent = i->second; // Throws (copy)
         }
 
+        // The client announces the identifier of its compression dictionary,
+        // and the server only uses its own if it is the same one
+        bool use_compression_dictionary = false;
+        if (auto dictionary = m_server.get_server_protocol().get_compression_dictionary(); !dictionary.empty()) {
+            auto i = request.headers.find(get_compression_dictionary_header_name());
+            if (i != request.headers.end())
+                use_compression_dictionary = (i->second == util::to_string(compression::dictionary_id(dictionary)));
+        }
+
+        std::string sec_websocket_extensions;
+        {
+            auto i = response->headers.find("Sec-WebSocket-Extensions");
+            if (i != response->headers.end())
+                sec_websocket_extensions = i->second; // Throws (copy)
+        }
+
         auto handler = [protocol_version = m_negotiated_protocol_version, user_agent = std::move(user_agent),
+                        use_compression_dictionary, sec_websocket_extensions = std::move(sec_websocket_extensions),
                         this](std::error_code ec) {
             // If the operation is aborted, the socket object may have been destroyed.
             if (ec != util::error::operation_aborted) {
@@ -1897,11 +1925,11 @@ private:
                 std::unique_ptr<SyncConnection> sync_conn = std::make_unique<SyncConnection>(
                     m_server, m_id, std::move(m_socket), std::move(m_ssl_stream), std::move(m_read_ahead_buffer),
                     protocol_version, std::move(user_agent), std::move(m_remote_endpoint),
-                    get_appservices_request_id()); // Throws
+                    get_appservices_request_id(), use_compression_dictionary); // Throws
                 SyncConnection& sync_conn_ref = *sync_conn;
                 m_server.add_sync_connection(m_id, std::move(sync_conn));
                 m_server.remove_http_connection(m_id);
-                sync_conn_ref.initiate();
+                sync_conn_ref.initiate(sec_websocket_extensions);
             }
         };
         m_http_server.async_send_response(*response, std::move(handler));
@@ -2875,7 +2903,8 @@ private:
             const char* body;
             std::size_t uncompressed_body_size;
             std::size_t compressed_body_size = 0;
-            bool body_is_compressed = false;
+            BodyCompression body_compression = BodyCompression::none;
+            bool use_compression_dictionary = m_connection.use_compression_dictionary();
             version_type end_version = last_server_version.version;
             DownloadCursor download_progress;
             UploadCursor upload_progress = {0, 0};
@@ -2888,12 +2917,16 @@ private:
             bool enable_cache = (config.enable_download_bootstrap_cache && m_download_progress.server_version == 0 &&
                                  m_upload_progress.client_version == 0 && m_upload_threshold.client_version == 0);
             DownloadCache& cache = m_server_file->get_download_cache();
-            bool fetch_from_cache = (enable_cache && cache.body && end_version == cache.end_version);
+            // A body compressed with the dictionary can only be sent to
+            // clients which have it
+            bool fetch_from_cache =
+                (enable_cache && cache.body && end_version == cache.end_version &&
+                 (cache.body_compression != BodyCompression::deflate_with_dictionary || use_compression_dictionary));
             if (fetch_from_cache) {
                 body = cache.body.get();
                 uncompressed_body_size = cache.uncompressed_body_size;
                 compressed_body_size = cache.compressed_body_size;
-                body_is_compressed = cache.body_is_compressed;
+                body_compression = cache.body_compression;
                 download_progress = cache.download_progress;
                 downloadable_bytes = cache.downloadable_bytes;
                 num_changesets = cache.num_changesets;
@@ -2938,11 +2971,15 @@ private:
                     if (uncompressed.size() > max_uncompressed) {
                         compression::CompressMemoryArena& arena = server.get_compress_memory_arena();
                         std::vector<char>& buffer = server.get_misc_buffers().compress;
-                        compression::allocate_and_compress(arena, uncompressed, buffer); // Throws
+                        util::Span<const char> dictionary;
+                        if (use_compression_dictionary)
+                            dictionary = protocol.get_compression_dictionary();
+                        compression::allocate_and_compress(arena, uncompressed, buffer, dictionary); // Throws
                         if (buffer.size() < uncompressed.size()) {
                             body = buffer.data();
                             compressed_body_size = buffer.size();
-                            body_is_compressed = true;
+                            body_compression = use_compression_dictionary ? BodyCompression::deflate_with_dictionary
+                                                                          : BodyCompression::deflate;
                         }
                     }
                     num_changesets = handler.num_changesets;
@@ -2958,12 +2995,13 @@ private:
                         return;
                     }
                     REALM_ASSERT(upload_progress.client_version == 0);
-                    std::size_t body_size = (body_is_compressed ? compressed_body_size : uncompressed_body_size);
+                    std::size_t body_size =
+                        (body_compression != BodyCompression::none ? compressed_body_size : uncompressed_body_size);
                     cache.body = std::make_unique<char[]>(body_size); // Throws
                     std::copy(body, body + body_size, cache.body.get());
                     cache.uncompressed_body_size = uncompressed_body_size;
                     cache.compressed_body_size = compressed_body_size;
-                    cache.body_is_compressed = body_is_compressed;
+                    cache.body_compression = body_compression;
                     cache.end_version = end_version;
                     cache.download_progress = download_progress;
                     cache.downloadable_bytes = downloadable_bytes;
@@ -2987,7 +3025,7 @@ private:
                 download_progress.last_integrated_client_version, last_server_version.version,
                 last_server_version.salt, upload_progress.client_version,
                 upload_progress.last_integrated_server_version, downloadable_bytes, num_changesets, body,
-                uncompressed_body_size, compressed_body_size, body_is_compressed, logger); // Throws
+                uncompressed_body_size, compressed_body_size, body_compression, logger); // Throws
 
             if (!disable_download_compaction) {
                 std::size_t saved = accum_original_size - accum_compacted_size;
@@ -3822,6 +3860,7 @@ ServerImpl::ServerImpl(const std::string& root_dir, util::Optional<sync::PKey> p
         m_ssl_context->use_certificate_chain_file(m_config.ssl_certificate_path); // Throws
         m_ssl_context->use_private_key_file(m_config.ssl_certificate_key_path);   // Throws
     }
+    m_server_protocol.set_compression_dictionary(m_config.compression_dictionary); // Throws
 }
 
 
@@ -3887,6 +3926,9 @@ void ServerImpl::start()
     logger.info("Download bootstrap caching: %1",
                 (m_config.enable_download_bootstrap_cache ? "Yes" : "No"));                // Throws
     logger.info("Max download size: %1 bytes", m_config.max_download_size);                // Throws
+    logger.info("Compression dictionary: %1 bytes", m_config.compression_dictionary.size()); // Throws
+    logger.info("WebSocket permessage-deflate: %1",
+                (m_config.disable_permessage_deflate ? "No" : "Yes")); // Throws
     logger.info("Max upload backlog: %1 bytes", m_max_upload_backlog);                     // Throws
     logger.info("HTTP request timeout: %1 ms", m_config.http_request_timeout);             // Throws
     logger.info("HTTP response timeout: %1 ms", m_config.http_response_timeout);           // Throws
@@ -4206,11 +4248,11 @@ SyncConnection::~SyncConnection() noexcept
 }
 
 
-void SyncConnection::initiate()
+void SyncConnection::initiate(std::string_view sec_websocket_extensions)
 {
     m_last_activity_at = steady_clock_now();
     logger.debug("Sync Connection initiated");
-    m_websocket.initiate_server_websocket_after_handshake();
+    m_websocket.initiate_server_websocket_after_handshake(sec_websocket_extensions);
     send_log_message(util::Logger::Level::info, "Client connection established with server", 0,
                      m_appservices_request_id);
 }
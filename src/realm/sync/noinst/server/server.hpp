@@ -171,6 +171,18 @@ public:
         /// message(s) used for client bootstrapping.
         bool enable_download_bootstrap_cache = false;
 
+        /// A preset dictionary for compressing the bodies of UPLOAD and
+        /// DOWNLOAD messages. It is only used on connections from clients
+        /// which announce the same dictionary (see sync::BodyCompression).
+        std::vector<char> compression_dictionary;
+
+        /// Unless disabled, the server accepts the permessage-deflate
+        /// WebSocket extension (RFC 7692) when clients offer it. Messages are
+        /// then compressed with a deflate stream that spans the whole
+        /// connection, at the expense of about 400 KiB of memory per
+        /// connection.
+        bool disable_permessage_deflate = false;
+
         /// The accumulated size of changesets that are included in download
         /// messages. The size of the changesets is calculated before log
         /// compaction (if enabled). A larger value leads to more efficient
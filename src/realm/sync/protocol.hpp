@@ -82,6 +82,24 @@ constexpr std::string_view get_flx_websocket_protocol_prefix() noexcept
 
 enum class SyncServerMode { PBS, FLX };
 
+/// Encoding of the body of UPLOAD and DOWNLOAD messages. A body is only sent
+/// with `deflate_with_dictionary` when both peers have the same compression
+/// dictionary: the client announces the identifier of its dictionary in the
+/// HTTP header named by get_compression_dictionary_header_name(), the server
+/// only uses the dictionary for DOWNLOAD messages if the identifier matches its
+/// own, and the client only uses it for UPLOAD messages once it has received a
+/// DOWNLOAD message which used it.
+enum class BodyCompression {
+    none = 0,
+    deflate = 1,
+    deflate_with_dictionary = 2,
+};
+
+constexpr std::string_view get_compression_dictionary_header_name() noexcept
+{
+    return "X-Realm-Sync-Compression-Dictionary";
+}
+
 /// Supported protocol envelopes:
 ///
 ///                                                             Alternative (*)
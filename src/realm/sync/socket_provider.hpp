@@ -166,6 +166,10 @@ struct WebSocketEndpoint {
     util::Optional<std::string> ssl_trust_certificate_path;
     std::function<SyncConfig::SSLVerifyCallback> ssl_verify_callback;
     util::Optional<SyncConfig::ProxyConfig> proxy;
+
+    /// Offer the permessage-deflate extension in the handshake. Only
+    /// supported by the default socket provider.
+    bool offer_permessage_deflate = false;
 };
 
 
@@ -44,7 +44,8 @@ struct DownloadMessage {
     Buffer<char> uncompressed_body_buffer;
     std::vector<realm::sync::RemoteChangeset> changesets;
 
-    static DownloadMessage parse(HeaderLineParser& msg, Logger& logger, bool is_flx_sync);
+    static DownloadMessage parse(HeaderLineParser& msg, Logger& logger, bool is_flx_sync,
+                                 Span<const char> compression_dictionary);
 };
 
 struct UploadMessage {
@@ -55,19 +56,33 @@ struct UploadMessage {
     Buffer<char> uncompressed_body_buffer;
     std::vector<realm::sync::Changeset> changesets;
 
-    static UploadMessage parse(HeaderLineParser& msg, Logger& logger);
+    static UploadMessage parse(HeaderLineParser& msg, Logger& logger, Span<const char> compression_dictionary);
 };
 
 using Message = mpark::variant<ServerIdentMessage, DownloadMessage, UploadMessage>;
 
-Message parse_message(HeaderLineParser& msg, Logger& logger, bool is_flx_sync)
+// The compression of a message body, which may use the compression dictionary
+Span<const char> read_body_compression(HeaderLineParser& msg, Span<const char> compression_dictionary,
+                                       bool& is_body_compressed)
+{
+    auto body_compression = sync::BodyCompression(msg.read_next<int>());
+    is_body_compressed = (body_compression != sync::BodyCompression::none);
+    if (body_compression != sync::BodyCompression::deflate_with_dictionary)
+        return {};
+    if (compression_dictionary.empty())
+        throw ProtocolCodecException("message compressed with a dictionary, but no dictionary was given");
+    return compression_dictionary;
+}
+
+Message parse_message(HeaderLineParser& msg, Logger& logger, bool is_flx_sync,
+                      Span<const char> compression_dictionary)
 {
     auto message_type = msg.read_next<std::string_view>();
     if (message_type == "download") {
-        return DownloadMessage::parse(msg, logger, is_flx_sync);
+        return DownloadMessage::parse(msg, logger, is_flx_sync, compression_dictionary);
     }
     else if (message_type == "upload") {
-        return UploadMessage::parse(msg, logger);
+        return UploadMessage::parse(msg, logger, compression_dictionary);
     }
     else if (message_type == "ident") {
         return ServerIdentMessage::parse(msg);
@@ -85,7 +100,8 @@ ServerIdentMessage ServerIdentMessage::parse(HeaderLineParser& msg)
     return ret;
 }
 
-DownloadMessage DownloadMessage::parse(HeaderLineParser& msg, Logger& logger, bool is_flx_sync)
+DownloadMessage DownloadMessage::parse(HeaderLineParser& msg, Logger& logger, bool is_flx_sync,
+                                       Span<const char> compression_dictionary)
 {
     DownloadMessage ret;
 
@@ -107,7 +123,8 @@ DownloadMessage DownloadMessage::parse(HeaderLineParser& msg, Logger& logger, bo
         ret.batch_state = sync::DownloadBatchState::SteadyState;
     }
     ret.downloadable_bytes = msg.read_next<int64_t>();
-    auto is_body_compressed = msg.read_next<bool>();
+    bool is_body_compressed;
+    auto dictionary = read_body_compression(msg, compression_dictionary, is_body_compressed);
     auto uncompressed_body_size = msg.read_next<size_t>();
     auto compressed_body_size = msg.read_next<size_t>('\n');
 
@@ -122,7 +139,8 @@ DownloadMessage DownloadMessage::parse(HeaderLineParser& msg, Logger& logger, bo
     if (is_body_compressed) {
         ret.uncompressed_body_buffer.set_size(uncompressed_body_size);
         auto compressed_body = msg.read_sized_data<BinaryData>(compressed_body_size);
-        std::error_code ec = util::compression::decompress(compressed_body, ret.uncompressed_body_buffer);
+        std::error_code ec =
+            util::compression::decompress(compressed_body, ret.uncompressed_body_buffer, dictionary);
 
         if (ec) {
             throw ProtocolCodecException("error decompressing download message");
@@ -159,12 +177,13 @@ DownloadMessage DownloadMessage::parse(HeaderLineParser& msg, Logger& logger, bo
     return ret;
 }
 
-UploadMessage UploadMessage::parse(HeaderLineParser& msg, Logger& logger)
+UploadMessage UploadMessage::parse(HeaderLineParser& msg, Logger& logger, Span<const char> compression_dictionary)
 {
     UploadMessage ret;
 
     ret.session_ident = msg.read_next<sync::session_ident_type>();
-    auto is_body_compressed = msg.read_next<bool>();
+    bool is_body_compressed;
+    auto dictionary = read_body_compression(msg, compression_dictionary, is_body_compressed);
     auto uncompressed_body_size = msg.read_next<size_t>();
     auto compressed_body_size = msg.read_next<size_t>();
     ret.upload_progress.client_version = msg.read_next<sync::version_type>();
@@ -176,7 +195,8 @@ UploadMessage UploadMessage::parse(HeaderLineParser& msg, Logger& logger)
     if (is_body_compressed) {
         ret.uncompressed_body_buffer.set_size(uncompressed_body_size);
         auto compressed_body = msg.read_sized_data<BinaryData>(compressed_body_size);
-        std::error_code ec = util::compression::decompress(compressed_body, ret.uncompressed_body_buffer);
+        std::error_code ec =
+            util::compression::decompress(compressed_body, ret.uncompressed_body_buffer, dictionary);
 
         if (ec) {
             throw ProtocolCodecException("error decompressing upload message");
@@ -232,6 +252,8 @@ void print_usage(std::string_view program_name)
                  "  -i, --input          The file-system path a file containing UPLOAD, DOWNLOAD,\n"
                  "                       and IDENT messages to apply to the realm state\n"
                  "  -f, --flx-sync       Flexible sync session\n"
+                 "  -d, --compression-dictionary  The file-system path of the compression\n"
+                 "                       dictionary used by the sync client and server, if any.\n"
                  "  --verbose            Print all messages including trace messages to stderr\n"
                  "  -v, --version        Show the version of the Realm Sync release that this\n"
                  "                       command belongs to."
@@ -249,6 +271,7 @@ int main(int argc, const char** argv)
     CliArgument input_arg(arg_parser, "input", 'i');
     CliFlag verbose_arg(arg_parser, "verbose");
     CliFlag flx_sync_arg(arg_parser, "flx-sync", 'f');
+    CliArgument compression_dictionary_arg(arg_parser, "compression-dictionary", 'd');
     auto arg_results = arg_parser.parse(argc, argv);
 
     std::unique_ptr<Logger> logger =
@@ -281,12 +304,17 @@ int main(int argc, const char** argv)
     auto local_db = realm::DB::create(repl, realm_path, db_opts);
     auto& history = repl.get_history();
 
+    std::string compression_dictionary;
+    if (compression_dictionary_arg) {
+        compression_dictionary = load_file(compression_dictionary_arg.as<std::string>());
+    }
+
     auto input_contents = load_file(input_arg.as<std::string>());
     HeaderLineParser msg(input_contents);
     while (!msg.at_end()) {
         Message message;
         try {
-            message = parse_message(msg, *logger, bool(flx_sync_arg));
+            message = parse_message(msg, *logger, bool(flx_sync_arg), compression_dictionary);
         }
         catch (const ProtocolCodecException& e) {
             logger->error("Error parsing input message file: %1", e.what());
@@ -3,6 +3,7 @@
 #include <realm/sync/changeset_encoder.hpp>
 #include <realm/sync/noinst/changeset_index.hpp>
 #include <realm/sync/noinst/protocol_codec.hpp>
+#include <realm/util/work_stealing_pool.hpp>
 
 #if REALM_DEBUG
 #include <sstream>
@@ -554,6 +555,12 @@ struct TransformerImpl {
     MinorSide::Position m_minor_end;
     bool m_trace;
 
+    // When the changesets are shared with other threads, the changesets
+    // modified by this transformer are collected here instead of being
+    // marked as dirty right away.
+    bool m_defer_dirty = false;
+    std::vector<Changeset*> m_dirty_changesets;
+
     TransformerImpl(bool trace)
         : m_major_side{*this}
         , m_minor_side{*this}
@@ -581,6 +588,41 @@ struct TransformerImpl {
         }
     }
 
+    // Transform the instructions in the slot of the major changeset at
+    // `slot`. Unlike transform(), this does not look at the instructions in
+    // any other slot, so other slots may be transformed concurrently.
+    void transform_slot(Changeset* changeset, Changeset::iterator slot)
+    {
+        m_major_side.m_changeset = changeset;
+        auto& position = m_major_side.m_position;
+        position = slot;
+        while (position.m_inner == slot.m_inner) {
+            if (*position) {
+                m_major_side.init_with_instruction(position);
+
+                set_conflict_ranges();
+                m_minor_end = m_minor_side.end();
+                m_minor_side.m_position = m_minor_side.begin();
+                transform_major();
+
+                if (m_major_side.was_discarded)
+                    // Discarding the instruction moves to the next one.
+                    continue;
+            }
+            ++position;
+        }
+    }
+
+    void set_dirty(Changeset* changeset)
+    {
+        if (!m_defer_dirty) {
+            changeset->set_dirty(true);
+        }
+        else if (m_dirty_changesets.empty() || m_dirty_changesets.back() != changeset) {
+            m_dirty_changesets.push_back(changeset);
+        }
+    }
+
     _impl::ChangesetIndex::Ranges* get_conflict_ranges_for_instruction(const Instruction& instr)
     {
         _impl::ChangesetIndex& index = *m_minor_side.m_changeset_index;
@@ -650,14 +692,14 @@ struct TransformerImpl {
     {
         m_major_side.m_position = m_major_side.m_changeset->erase_stable(m_major_side.m_position);
         m_major_side.was_discarded = true; // This terminates the loop in transform_major();
-        m_major_side.m_changeset->set_dirty(true);
+        set_dirty(m_major_side.m_changeset);
     }
 
     void discard_minor()
     {
         m_minor_side.was_discarded = true;
         m_minor_side.m_position = m_minor_side.m_changeset_index->erase_instruction(m_minor_side.m_position);
-        m_minor_side.m_changeset->set_dirty(true);
+        set_dirty(m_minor_side.m_changeset);
         m_minor_side.update_changeset_pointer();
     }
 
@@ -667,7 +709,7 @@ struct TransformerImpl {
         REALM_ASSERT(*m_major_side.m_position); // cannot prepend a tombstone
         auto insert_position = m_major_side.m_position;
         m_major_side.m_position = m_major_side.m_changeset->insert_stable(insert_position, instr_begin, instr_end);
-        m_major_side.m_changeset->set_dirty(true);
+        set_dirty(m_major_side.m_changeset);
         size_t num_prepended = instr_end - instr_begin;
         transform_prepended_major(num_prepended);
     }
@@ -686,7 +728,7 @@ struct TransformerImpl {
         auto insert_position = m_minor_side.m_position.m_pos;
         m_minor_side.m_position.m_pos =
             m_minor_side.m_changeset->insert_stable(insert_position, instr_begin, instr_end);
-        m_minor_side.m_changeset->set_dirty(true);
+        set_dirty(m_minor_side.m_changeset);
         size_t num_prepended = instr_end - instr_begin;
         // Go back to the instruction that initiated this prepend
         for (size_t i = 0; i < num_prepended; ++i) {
@@ -2364,21 +2406,133 @@ void TransformerImpl::merge_instructions(MajorSide& their_side, MinorSide& our_s
     if (!their_side.was_discarded && !their_side.was_replaced) {
         const auto& their_after = their_side.get();
         if (!(their_after == their_before)) {
-            their_side.m_changeset->set_dirty(true);
+            set_dirty(their_side.m_changeset);
         }
     }
 
     if (!our_side.was_discarded && !our_side.was_replaced) {
         const auto& our_after = our_side.get();
         if (!(our_after == our_before)) {
-            our_side.m_changeset->set_dirty(true);
+            set_dirty(our_side.m_changeset);
+        }
+    }
+}
+
+// Transform the local changesets on a thread pool. Each slot of the local
+// changesets is transformed by a worker owning the conflict group of the
+// incoming instructions it is merged with, and the slots of a group are
+// transformed in the order of the local history, which gives the same result
+// as TransformerImpl::transform(). A slot with a schema change, or with
+// instructions in more than one group, is transformed alone after all slots
+// preceding it.
+void transform_in_parallel(util::WorkStealingPool& pool, _impl::ChangesetIndex& their_index,
+                           util::Span<Changeset*> our_changesets)
+{
+    using Ranges = _impl::ChangesetIndex::Ranges;
+    struct Slot {
+        Changeset* changeset;
+        Changeset::iterator position;
+    };
+
+    TransformerImpl serial_transformer{false};
+    serial_transformer.m_minor_side.m_changeset_index = &their_index;
+    std::vector<std::unique_ptr<TransformerImpl>> transformers(pool.num_workers());
+    for (auto& transformer : transformers) {
+        transformer = std::make_unique<TransformerImpl>(false);
+        transformer->m_minor_side.m_changeset_index = &their_index;
+        transformer->m_defer_dirty = true;
+    }
+
+    std::vector<std::vector<Slot>> groups;
+    std::map<const Ranges*, size_t> group_ndx;
+    auto transform_groups = [&] {
+        if (groups.empty())
+            return;
+        pool.parallel_for(groups.size(), [&](size_t task_ndx, size_t worker_ndx) {
+            TransformerImpl& transformer = *transformers[worker_ndx];
+            for (const Slot& slot : groups[task_ndx])
+                transformer.transform_slot(slot.changeset, slot.position); // Throws
+        });
+        for (auto& transformer : transformers) {
+            for (Changeset* changeset : transformer->m_dirty_changesets)
+                changeset->set_dirty(true);
+            transformer->m_dirty_changesets.clear();
+        }
+        groups.clear();
+        group_ndx.clear();
+    };
+
+    for (Changeset* changeset : our_changesets) {
+        auto it = changeset->begin();
+        while (it != changeset->end()) {
+            Changeset::iterator slot{it.m_inner};
+            const Ranges* ranges = nullptr;
+            bool conflicts_with_all = false;
+            for (; it != changeset->end() && it.m_inner == slot.m_inner; ++it) {
+                if (!*it)
+                    continue;
+                const Instruction& instr = **it;
+                if (_impl::is_schema_change(instr)) {
+                    conflicts_with_all = true;
+                    continue;
+                }
+                _impl::ChangesetIndex::GlobalID ids[2];
+                _impl::get_object_ids_in_instruction(*changeset, instr, ids, 2);
+                const Ranges* instr_ranges = their_index.get_modifications_for_object(ids[0]);
+                if (instr_ranges->empty())
+                    continue; // Nothing to merge with
+                if (ranges && ranges != instr_ranges)
+                    conflicts_with_all = true;
+                ranges = instr_ranges;
+            }
+
+            if (conflicts_with_all) {
+                transform_groups();                                  // Throws
+                serial_transformer.transform_slot(changeset, slot); // Throws
+            }
+            else if (ranges) {
+                auto entry = group_ndx.emplace(ranges, groups.size()).first;
+                if (entry->second == groups.size())
+                    groups.emplace_back();
+                groups[entry->second].push_back({changeset, slot});
+            }
         }
     }
+    transform_groups(); // Throws
 }
 
 } // anonymous namespace
 
 namespace realm::sync {
+void Transformer::set_threads(unsigned int threadcount)
+{
+    if (threadcount != 0 && m_pool && m_pool->num_workers() == threadcount)
+        return;
+    m_pool = make_pool(threadcount); // Throws
+}
+
+void Transformer::set_pool(std::shared_ptr<util::WorkStealingPool> pool) noexcept
+{
+    m_pool = std::move(pool);
+}
+
+std::shared_ptr<util::WorkStealingPool> Transformer::make_pool(unsigned int threadcount)
+{
+    if (threadcount == 1)
+        return nullptr;
+    if (threadcount == 0) {
+        // Share the process wide pool without owning it
+        return std::shared_ptr<util::WorkStealingPool>(std::shared_ptr<util::WorkStealingPool>(),
+                                                       &util::WorkStealingPool::get_default());
+    }
+    return std::make_shared<util::WorkStealingPool>(threadcount); // Throws
+}
+
+unsigned int Transformer::get_threads() const noexcept
+{
+    return m_pool ? unsigned(m_pool->num_workers()) : 1;
+}
+
 void Transformer::merge_changesets(file_ident_type local_file_ident, util::Span<Changeset> their_changesets,
                                    util::Span<Changeset*> our_changesets, util::Logger& logger)
 {
@@ -2477,17 +2631,27 @@ void Transformer::merge_changesets(file_ident_type local_file_ident, util::Span<
     static_cast<void>(local_file_ident);
 #endif // REALM_DEBUG LCOV_EXCL_STOP
 
-    for (size_t i = 0; i < our_changesets.size(); ++i) {
-        logger.trace(
-            util::LogCategory::changeset,
-            "Transforming local changeset [%1/%2] through %3 incoming changeset(s) with %4 conflict group(s)", i + 1,
-            our_changesets.size(), their_changesets.size(), their_index.get_num_conflict_groups());
-        Changeset* our_changeset = our_changesets[i];
+    if (m_pool && !trace) {
+        logger.trace(util::LogCategory::changeset,
+                     "Transforming %1 local changeset(s) through %2 incoming changeset(s) with %3 conflict "
+                     "group(s) on %4 threads",
+                     our_changesets.size(), their_changesets.size(), their_index.get_num_conflict_groups(),
+                     m_pool->num_workers());
+        transform_in_parallel(*m_pool, their_index, our_changesets); // Throws
+    }
+    else {
+        for (size_t i = 0; i < our_changesets.size(); ++i) {
+            logger.trace(
+                util::LogCategory::changeset,
+                "Transforming local changeset [%1/%2] through %3 incoming changeset(s) with %4 conflict group(s)",
+                i + 1, our_changesets.size(), their_changesets.size(), their_index.get_num_conflict_groups());
+            Changeset* our_changeset = our_changesets[i];
 
-        transformer.m_major_side.set_next_changeset(our_changeset);
-        // MinorSide uses the index to find the Changeset.
-        transformer.m_minor_side.m_changeset_index = &their_index;
-        transformer.transform(); // Throws
+            transformer.m_major_side.set_next_changeset(our_changeset);
+            // MinorSide uses the index to find the Changeset.
+            transformer.m_minor_side.m_changeset_index = &their_index;
+            transformer.transform(); // Throws
+        }
     }
 
     logger.debug(util::LogCategory::changeset,
@@ -2632,6 +2796,19 @@ void Transformer::flush_reciprocal_transform_cache(TransformHistory& history)
     }
 }
 
+namespace {
+
+void set_remote_changeset_info(const RemoteChangeset& remote_changeset, Changeset& parsed_changeset) noexcept
+{
+    parsed_changeset.version = remote_changeset.remote_version;
+    parsed_changeset.last_integrated_remote_version = remote_changeset.last_integrated_local_version;
+    parsed_changeset.origin_timestamp = remote_changeset.origin_timestamp;
+    parsed_changeset.origin_file_ident = remote_changeset.origin_file_ident;
+    parsed_changeset.original_changeset_size = remote_changeset.original_changeset_size;
+}
+
+} // anonymous namespace
+
 void parse_remote_changeset(const RemoteChangeset& remote_changeset, Changeset& parsed_changeset)
 {
     // origin_file_ident = 0 is currently used to indicate an entry of local
@@ -2641,12 +2818,23 @@ void parse_remote_changeset(const RemoteChangeset& remote_changeset, Changeset&
 
     ChunkedBinaryInputStream remote_in{remote_changeset.data};
     parse_changeset(remote_in, parsed_changeset); // Throws
+    set_remote_changeset_info(remote_changeset, parsed_changeset);
+}
 
-    parsed_changeset.version = remote_changeset.remote_version;
-    parsed_changeset.last_integrated_remote_version = remote_changeset.last_integrated_local_version;
-    parsed_changeset.origin_timestamp = remote_changeset.origin_timestamp;
-    parsed_changeset.origin_file_ident = remote_changeset.origin_file_ident;
-    parsed_changeset.original_changeset_size = remote_changeset.original_changeset_size;
+void parse_remote_changeset_in_place(const RemoteChangeset& remote_changeset, Changeset& parsed_changeset)
+{
+    REALM_ASSERT(remote_changeset.origin_file_ident != 0);
+    REALM_ASSERT(remote_changeset.remote_version != 0);
+
+    // Only a changeset held in a single chunk can be referenced in place
+    BinaryIterator chunks = remote_changeset.data.iterator();
+    BinaryData first_chunk = chunks.get_next();
+    if (chunks.get_next().is_null()) {
+        parse_changeset_in_place(first_chunk, parsed_changeset); // Throws
+        set_remote_changeset_info(remote_changeset, parsed_changeset);
+        return;
+    }
+    parse_remote_changeset(remote_changeset, parsed_changeset); // Throws
 }
 
 } // namespace realm::sync
@@ -6,7 +6,12 @@
 #include <realm/sync/instructions.hpp>
 #include <realm/sync/protocol.hpp>
 
+#include <memory>
+
 namespace realm {
+namespace util {
+class WorkStealingPool;
+}
 namespace sync {
 
 struct Changeset;
@@ -177,8 +182,33 @@ public:
                                        util::Span<Changeset>,
                                        util::FunctionRef<bool(const Changeset*)> changeset_applier, util::Logger&);
 
+    /// Set the number of threads used to transform local changesets.
+    ///
+    /// When more than one thread is used, the local instructions are split by
+    /// the conflict group of the incoming instructions they must be merged
+    /// with. Groups that share no instructions are transformed concurrently,
+    /// each in the order of the local history, so the result is identical to
+    /// a single threaded transform. Local schema changes conflict with every
+    /// group and are transformed alone, after all instructions preceding them.
+    ///
+    /// A thread count of 0 uses a process wide pool with one thread per
+    /// hardware thread. A thread count of 1 (the default) disables parallel
+    /// transformation.
+    void set_threads(unsigned int threadcount);
+    unsigned int get_threads() const noexcept;
+
+    /// Transform local changesets on \a pool, which may be shared with other
+    /// transformers, like a pool made by make_pool(). A null pool disables
+    /// parallel transformation.
+    void set_pool(std::shared_ptr<util::WorkStealingPool> pool) noexcept;
+
+    /// The pool used by set_threads() for \a threadcount threads. Null for a
+    /// thread count of 1.
+    static std::shared_ptr<util::WorkStealingPool> make_pool(unsigned int threadcount);
+
 private:
     std::map<version_type, Changeset> m_reciprocal_transform_cache;
+    std::shared_ptr<util::WorkStealingPool> m_pool;
 
     Changeset& get_reciprocal_transform(TransformHistory&, file_ident_type local_file_ident, version_type version,
                                         const HistoryEntry&);
@@ -238,6 +268,12 @@ public:
 
 void parse_remote_changeset(const RemoteChangeset&, Changeset&);
 
+/// Like parse_remote_changeset(), but when the changeset is held in a single
+/// chunk, the strings of the parsed changeset refer to it rather than being
+/// copied. The data of the remote changeset must then outlive the parsed
+/// changeset.
+void parse_remote_changeset_in_place(const RemoteChangeset&, Changeset&);
+
 
 // Implementation
 
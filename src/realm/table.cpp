@@ -29,6 +29,7 @@
 #include <realm/dictionary.hpp>
 #include <realm/exceptions.hpp>
 #include <realm/impl/destroy_guard.hpp>
+#include <realm/index_sorted.hpp>
 #include <realm/index_string.hpp>
 #include <realm/query_conditions_tpl.hpp>
 #include <realm/replication.hpp>
@@ -356,6 +357,7 @@ Table::Table(Allocator& alloc)
     , m_index_refs(m_alloc)
     , m_opposite_table(m_alloc)
     , m_opposite_column(m_alloc)
+    , m_composite_index_refs(m_alloc)
     , m_repl(&g_dummy_replication)
     , m_own_ref(this, alloc.get_instance_version())
 {
@@ -363,6 +365,7 @@ Table::Table(Allocator& alloc)
     m_index_refs.set_parent(&m_top, top_position_for_search_indexes);
     m_opposite_table.set_parent(&m_top, top_position_for_opposite_table);
     m_opposite_column.set_parent(&m_top, top_position_for_opposite_column);
+    m_composite_index_refs.set_parent(&m_top, top_position_for_composite_indexes);
 
     ref_type ref = create_empty_table(m_alloc); // Throws
     ArrayParent* parent = nullptr;
@@ -378,6 +381,7 @@ Table::Table(Replication* const* repl, Allocator& alloc)
     , m_index_refs(m_alloc)
     , m_opposite_table(m_alloc)
     , m_opposite_column(m_alloc)
+    , m_composite_index_refs(m_alloc)
     , m_repl(repl)
     , m_own_ref(this, alloc.get_instance_version())
 {
@@ -385,6 +389,7 @@ Table::Table(Replication* const* repl, Allocator& alloc)
     m_index_refs.set_parent(&m_top, top_position_for_search_indexes);
     m_opposite_table.set_parent(&m_top, top_position_for_opposite_table);
     m_opposite_column.set_parent(&m_top, top_position_for_opposite_column);
+    m_composite_index_refs.set_parent(&m_top, top_position_for_composite_indexes);
     m_cookie = cookie_created;
 }
 
@@ -567,6 +572,17 @@ TableKey Table::get_key_direct(Allocator& alloc, ref_type top_ref)
     }
 }
 
+ref_type Table::get_cluster_tree_ref() const noexcept
+{
+    return m_top.get_as_ref(top_position_for_cluster_tree);
+}
+
+ref_type Table::get_search_index_ref(ColKey col_key) const noexcept
+{
+    size_t ndx = col_key.get_index().val;
+    return ndx < m_index_refs.size() ? m_index_refs.get_as_ref(ndx) : 0;
+}
+
 
 void Table::init(ref_type top_ref, ArrayParent* parent, size_t ndx_in_parent, bool is_writable, bool is_frzn)
 {
@@ -737,6 +753,22 @@ void Table::populate_search_index(ColKey col_key)
             do_bulk_insert_index<StringData>(this, index, col_key, get_alloc());
         }
     }
+    else if (type == type_Float) {
+        if (is_nullable(col_key)) {
+            do_bulk_insert_index<Optional<float>>(this, index, col_key, get_alloc());
+        }
+        else {
+            do_bulk_insert_index<float>(this, index, col_key, get_alloc());
+        }
+    }
+    else if (type == type_Double) {
+        if (is_nullable(col_key)) {
+            do_bulk_insert_index<Optional<double>>(this, index, col_key, get_alloc());
+        }
+        else {
+            do_bulk_insert_index<double>(this, index, col_key, get_alloc());
+        }
+    }
     else if (type == type_Timestamp) {
         do_bulk_insert_index<Timestamp>(this, index, col_key, get_alloc());
     }
@@ -773,6 +805,12 @@ void Table::erase_from_search_indexes(ObjKey key)
                 index->erase(key);
             }
         }
+        if (!m_composite_indexes.empty()) {
+            Obj obj = get_object(key);
+            for (auto&& index : m_composite_indexes) {
+                index->erase(obj);
+            }
+        }
     }
 }
 
@@ -828,6 +866,22 @@ void Table::update_indexes(ObjKey key, const FieldValues& values)
                         index->insert(key, init_value.get<String>());
                     }
                     break;
+                case col_type_Float:
+                    if (init_value.is_null()) {
+                        index->insert(key, ArrayFloatNull::default_value(nullable));
+                    }
+                    else {
+                        index->insert(key, init_value.get<float>());
+                    }
+                    break;
+                case col_type_Double:
+                    if (init_value.is_null()) {
+                        index->insert(key, ArrayDoubleNull::default_value(nullable));
+                    }
+                    else {
+                        index->insert(key, init_value.get<double>());
+                    }
+                    break;
                 case col_type_Timestamp:
                     if (init_value.is_null()) {
                         index->insert(key, ArrayTimestamp::default_value(nullable));
@@ -860,6 +914,14 @@ void Table::update_indexes(ObjKey key, const FieldValues& values)
             }
         }
     }
+
+    if (!m_composite_indexes.empty()) {
+        // The values have been stored in the cluster already
+        Obj obj = get_object(key);
+        for (auto&& index : m_composite_indexes) {
+            index->insert(obj);
+        }
+    }
 }
 
 void Table::clear_indexes()
@@ -869,6 +931,9 @@ void Table::clear_indexes()
             index->clear();
         }
     }
+    for (auto&& index : m_composite_indexes) {
+        index->clear();
+    }
 }
 
 void Table::do_add_search_index(ColKey col_key, IndexType type)
@@ -879,9 +944,13 @@ void Table::do_add_search_index(ColKey col_key, IndexType type)
     if (m_index_accessors[column_ndx] != nullptr)
         return;
 
-    if (!StringIndex::type_supported(DataType(col_key.get_type())) ||
-        (col_key.is_collection() && !(col_key.is_list() && col_key.get_type() == col_type_String)) ||
-        (type == IndexType::Fulltext && col_key.get_type() != col_type_String)) {
+    bool supported = (type == IndexType::Sorted)
+                         ? SortedIndex::type_supported(DataType(col_key.get_type())) && !col_key.is_collection()
+                         : StringIndex::type_supported(DataType(col_key.get_type())) &&
+                               (!col_key.is_collection() ||
+                                (col_key.is_list() && col_key.get_type() == col_type_String)) &&
+                               (type != IndexType::Fulltext || col_key.get_type() == col_type_String);
+    if (!supported) {
         // Not ideal, but this is what we used to throw, so keep throwing that for compatibility reasons, even though
         // it should probably be a type mismatch exception instead.
         throw IllegalOperation(util::format("Index not supported for this property: %1", get_column_name(col_key)));
@@ -893,8 +962,13 @@ void Table::do_add_search_index(ColKey col_key, IndexType type)
     REALM_ASSERT(m_index_accessors[column_ndx] == nullptr);
 
     // Create the index
-    m_index_accessors[column_ndx] =
-        std::make_unique<StringIndex>(ClusterColumn(&m_clusters, col_key, type), get_alloc()); // Throws
+    ClusterColumn target_column(&m_clusters, col_key, type);
+    if (type == IndexType::Sorted) {
+        m_index_accessors[column_ndx] = std::make_unique<SortedIndex>(target_column, get_alloc()); // Throws
+    }
+    else {
+        m_index_accessors[column_ndx] = std::make_unique<StringIndex>(target_column, get_alloc()); // Throws
+    }
     SearchIndex* index = m_index_accessors[column_ndx].get();
     // Insert ref to index
     index->set_parent(&m_index_refs, column_ndx);
@@ -914,36 +988,39 @@ void Table::add_search_index(ColKey col_key, IndexType type)
 
     if (col_key == m_primary_key_col && type == IndexType::Fulltext)
         throw InvalidColumnKey("primary key cannot have a full text index");
+    if (col_key == m_primary_key_col && type == IndexType::Sorted)
+        throw InvalidColumnKey("primary key cannot have a sorted index");
+
+    // Any other kind of index on the column is replaced
+    auto index_attr = [](IndexType type) {
+        switch (type) {
+            case IndexType::Fulltext:
+                return col_attr_FullText_Indexed;
+            case IndexType::Sorted:
+                return col_attr_Sorted_Indexed;
+            default:
+                return col_attr_Indexed;
+        }
+    };
 
-    switch (type) {
-        case IndexType::None:
-            remove_search_index(col_key);
-            return;
-        case IndexType::Fulltext:
-            // Early-out if already indexed
-            if (attr.test(col_attr_FullText_Indexed)) {
-                REALM_ASSERT(search_index_type(col_key) == IndexType::Fulltext);
-                return;
-            }
-            if (attr.test(col_attr_Indexed)) {
-                this->remove_search_index(col_key);
-            }
-            break;
-        case IndexType::General:
-            if (attr.test(col_attr_Indexed)) {
-                REALM_ASSERT(search_index_type(col_key) == IndexType::General);
-                return;
-            }
-            if (attr.test(col_attr_FullText_Indexed)) {
-                this->remove_search_index(col_key);
-            }
-            break;
+    if (type == IndexType::None) {
+        remove_search_index(col_key);
+        return;
+    }
+    // Early-out if already indexed
+    if (attr.test(index_attr(type))) {
+        REALM_ASSERT(search_index_type(col_key) == type);
+        return;
+    }
+    if (attr.test(col_attr_Indexed) || attr.test(col_attr_FullText_Indexed) || attr.test(col_attr_Sorted_Indexed)) {
+        this->remove_search_index(col_key);
+        attr = m_spec.get_column_attr(spec_ndx);
     }
 
     do_add_search_index(col_key, type);
 
     // Update spec
-    attr.set(type == IndexType::Fulltext ? col_attr_FullText_Indexed : col_attr_Indexed);
+    attr.set(index_attr(type));
     m_spec.set_column_attr(spec_ndx, attr); // Throws
 }
 
@@ -969,9 +1046,113 @@ void Table::remove_search_index(ColKey col_key)
     auto attr = m_spec.get_column_attr(spec_ndx);
     attr.reset(col_attr_Indexed);
     attr.reset(col_attr_FullText_Indexed);
+    attr.reset(col_attr_Sorted_Indexed);
     m_spec.set_column_attr(spec_ndx, attr); // Throws
 }
 
+ColumnStatistics Table::get_column_statistics(ColKey col_key) const
+{
+    check_column(col_key);
+    std::lock_guard lock(m_statistics_mutex);
+    // Each commit which changed the table changed at least one object
+    uint64_t commits = m_in_file_version_at_transaction_boundary;
+    auto is_stale = [&](uint64_t sampled_commits, const ColumnStatistics& stats) {
+        if (commits < sampled_commits)
+            return true;
+        size_t num_objects = size();
+        size_t added_or_removed = std::max(num_objects, stats.num_objects) - std::min(num_objects, stats.num_objects);
+        uint64_t changed = std::max(uint64_t(added_or_removed), commits - sampled_commits);
+        return changed * 10 > stats.num_objects;
+    };
+    auto it = m_column_statistics.find(col_key);
+    if (it == m_column_statistics.end() || is_stale(it->second.first, it->second.second)) {
+        auto stats = ColumnStatistics::compute(*this, col_key); // Throws
+        it = m_column_statistics.insert_or_assign(col_key, std::make_pair(commits, std::move(stats))).first;
+    }
+    return it->second.second;
+}
+
+void Table::add_composite_index(const std::vector<ColKey>& columns)
+{
+    if (columns.empty())
+        throw InvalidArgument("A composite index needs at least one property");
+    for (auto it = columns.begin(); it != columns.end(); ++it) {
+        check_column(*it);
+        if (!CompositeIndex::type_supported(*it))
+            throw IllegalOperation(util::format("Index not supported for this property: %1", get_column_name(*it)));
+        if (std::find(columns.begin(), it, *it) != it)
+            throw InvalidArgument(util::format("Property '%1' is part of the index twice", get_column_name(*it)));
+    }
+
+    // Early-out if already indexed
+    if (has_composite_index(columns))
+        return;
+
+    if (!m_composite_index_refs.is_attached()) {
+        while (m_top.size() <= top_position_for_composite_indexes)
+            m_top.add(0); // Throws
+        REALM_ASSERT(!m_top.get_as_ref(top_position_for_composite_indexes));
+        m_composite_index_refs.create(Array::type_HasRefs); // Throws
+        m_composite_index_refs.update_parent();             // Throws
+    }
+
+    auto index = std::make_unique<CompositeIndex>(columns, get_alloc()); // Throws
+    size_t ndx = m_composite_index_refs.size();
+    index->set_parent(&m_composite_index_refs, ndx);
+    m_composite_index_refs.add(from_ref(index->get_ref())); // Throws
+    for (auto obj : *this)
+        index->insert(obj); // Throws
+    m_composite_indexes.push_back(std::move(index));
+}
+
+void Table::remove_composite_index(const std::vector<ColKey>& columns)
+{
+    for (size_t ndx = 0; ndx < m_composite_indexes.size(); ++ndx) {
+        if (m_composite_indexes[ndx]->get_columns() == columns) {
+            do_remove_composite_index(ndx);
+            return;
+        }
+    }
+}
+
+bool Table::has_composite_index(const std::vector<ColKey>& columns) const noexcept
+{
+    return std::any_of(m_composite_indexes.begin(), m_composite_indexes.end(), [&](auto& index) {
+        return index->get_columns() == columns;
+    });
+}
+
+void Table::do_remove_composite_index(size_t ndx)
+{
+    m_composite_indexes[ndx]->destroy();
+    m_composite_indexes.erase(m_composite_indexes.begin() + ndx);
+    m_composite_index_refs.erase(ndx); // Throws
+    for (size_t i = ndx; i < m_composite_indexes.size(); ++i)
+        m_composite_indexes[i]->set_parent(&m_composite_index_refs, i);
+}
+
+void Table::set_in_composite_indexes(const Obj& obj, ColKey col_key, Mixed new_value)
+{
+    for (auto&& index : m_composite_indexes) {
+        if (index->covers(col_key))
+            index->set(obj, col_key, new_value); // Throws
+    }
+}
+
+void Table::refresh_composite_index_accessors()
+{
+    m_composite_indexes.clear();
+    if (m_top.size() <= top_position_for_composite_indexes || !m_top.get_as_ref(top_position_for_composite_indexes)) {
+        m_composite_index_refs.detach();
+        return;
+    }
+    m_composite_index_refs.init_from_parent();
+    for (size_t ndx = 0; ndx < m_composite_index_refs.size(); ++ndx) {
+        m_composite_indexes.push_back(std::make_unique<CompositeIndex>(m_composite_index_refs.get_as_ref(ndx),
+                                                                       &m_composite_index_refs, ndx, get_alloc()));
+    }
+}
+
 void Table::enumerate_string_column(ColKey col_key)
 {
     check_column(col_key);
@@ -1063,6 +1244,11 @@ ColKey Table::do_insert_root_column(ColKey col_key, ColumnType type, StringData
 
 void Table::do_erase_root_column(ColKey col_key)
 {
+    for (size_t ndx = m_composite_indexes.size(); ndx > 0; --ndx) {
+        if (m_composite_indexes[ndx - 1]->covers(col_key))
+            do_remove_composite_index(ndx - 1);
+    }
+
     size_t col_ndx = col_key.get_index().val;
     // If the column had a source index we have to remove and destroy that as well
     ref_type index_ref = m_index_refs.get_as_ref(col_ndx);
@@ -1249,6 +1435,8 @@ void Table::fully_detach() noexcept
     m_opposite_table.detach();
     m_opposite_column.detach();
     m_index_accessors.clear();
+    m_composite_index_refs.detach();
+    m_composite_indexes.clear();
 }
 
 
@@ -1272,8 +1460,11 @@ IndexType Table::search_index_type(ColKey col_key) const noexcept
 {
     if (m_index_accessors[col_key.get_index().val].get()) {
         auto attr = m_spec.get_column_attr(m_leaf_ndx2spec_ndx[col_key.get_index().val]);
-        bool fulltext = attr.test(col_attr_FullText_Indexed);
-        return fulltext ? IndexType::Fulltext : IndexType::General;
+        if (attr.test(col_attr_FullText_Indexed))
+            return IndexType::Fulltext;
+        if (attr.test(col_attr_Sorted_Indexed))
+            return IndexType::Sorted;
+        return IndexType::General;
     }
     return IndexType::None;
 }
@@ -1465,6 +1656,7 @@ ref_type Table::create_empty_table(Allocator& alloc, TableKey key)
     top.add(0); // pk col key
     top.add(0); // flags
     top.add(0); // tombstones
+    top.add(0); // composite indexes
 
     REALM_ASSERT(top.size() == top_array_size);
 
@@ -1646,11 +1838,7 @@ void Table::aggregate(QueryStateBase& st, ColKey column_key) const
         st.m_key_offset = cluster->get_offset();
         st.m_key_values = cluster->get_key_array();
         st.set_payload_column(&leaf);
-        bool cont = true;
-        size_t sz = leaf.size();
-        for (size_t local_index = 0; cont && local_index < sz; local_index++) {
-            cont = st.match(local_index);
-        }
+        st.match_range(0, leaf.size());
         return IteratorControl::AdvanceToNext;
     };
 
@@ -1964,6 +2152,12 @@ void Table::update_from_parent() noexcept
 
         m_opposite_table.update_from_parent();
         m_opposite_column.update_from_parent();
+        if (m_composite_index_refs.is_attached()) {
+            m_composite_index_refs.update_from_parent();
+            for (auto&& index : m_composite_indexes) {
+                index->update_from_parent();
+            }
+        }
         if (m_top.size() > top_position_for_flags) {
             uint64_t flags = m_top.get_as_ref_or_tagged(top_position_for_flags).get_as_int();
             m_table_type = Type(flags & table_type_mask);
@@ -2028,6 +2222,9 @@ void Table::schema_to_json(std::ostream& out) const
         if (index_type == IndexType::Fulltext) {
             out << ",\"isFulltextIndexed\":true";
         }
+        if (index_type == IndexType::Sorted) {
+            out << ",\"isSortedIndexed\":true";
+        }
         out << "}";
         if (i < sz - 1) {
             out << ",";
@@ -2161,18 +2358,31 @@ void Table::refresh_index_accessors()
         else {
             auto attr = m_spec.get_column_attr(m_leaf_ndx2spec_ndx[col_ndx]);
             bool fulltext = attr.test(col_attr_FullText_Indexed);
+            bool sorted = attr.test(col_attr_Sorted_Indexed);
             auto col_key = m_leaf_ndx2colkey[col_ndx];
-            ClusterColumn virtual_col(&m_clusters, col_key, fulltext ? IndexType::Fulltext : IndexType::General);
+            ClusterColumn virtual_col(&m_clusters, col_key,
+                                      fulltext ? IndexType::Fulltext
+                                               : (sorted ? IndexType::Sorted : IndexType::General));
+
+            // An index of another kind may have replaced the one we have an accessor for
+            auto& index = m_index_accessors[col_ndx];
+            if (index && sorted != bool(dynamic_cast<SortedIndex*>(index.get())))
+                index.reset();
 
             if (m_index_accessors[col_ndx]) { // still there, refresh:
                 m_index_accessors[col_ndx]->refresh_accessor_tree(virtual_col);
             }
-            else { // new index!
+            else if (sorted) { // new index!
+                m_index_accessors[col_ndx] =
+                    std::make_unique<SortedIndex>(ref, &m_index_refs, col_ndx, virtual_col, get_alloc());
+            }
+            else {
                 m_index_accessors[col_ndx] =
                     std::make_unique<StringIndex>(ref, &m_index_refs, col_ndx, virtual_col, get_alloc());
             }
         }
     }
+    refresh_composite_index_accessors();
 }
 
 bool Table::is_cross_table_link_target() const noexcept
@@ -2198,9 +2408,26 @@ void Table::verify() const
     m_clusters.verify();
     if (nb_unresolved())
         m_tombstones->verify();
+    for (auto&& index : m_composite_indexes)
+        index->verify();
 #endif
 }
 
+ref_type Table::typed_write(ref_type ref, _impl::ArrayWriterBase& out) const
+{
+    REALM_ASSERT_DEBUG(ref == m_top.get_ref());
+    if (m_alloc.is_read_only(ref))
+        return ref;
+
+    return m_top.write_deep(out, [&](size_t ndx, ref_type child_ref) {
+        if (ndx == size_t(top_position_for_cluster_tree))
+            return m_clusters.typed_write(child_ref, out); // Throws
+        if (ndx == size_t(top_position_for_tombstones) && m_tombstones)
+            return m_tombstones->typed_write(child_ref, out); // Throws
+        return Array::write(child_ref, m_alloc, out, true);   // Throws
+    });
+}
+
 #ifdef REALM_DEBUG
 MemStats Table::stats() const
 {
@@ -2930,6 +3157,9 @@ void Table::do_set_primary_key_column(ColKey col_key)
         if (attr.test(col_attr_FullText_Indexed)) {
             throw InvalidColumnKey("primary key cannot have a full text index");
         }
+        if (attr.test(col_attr_Sorted_Indexed)) {
+            throw InvalidColumnKey("primary key cannot have a sorted index");
+        }
     }
 
     if (m_primary_key_col) {
@@ -3238,6 +3468,12 @@ ColKey Table::set_nullability(ColKey col_key, bool nullable, bool throw_on_null)
         attr.reset(col_attr_Nullable);
     }
 
+    std::vector<std::vector<ColKey>> composite_indexes;
+    for (auto&& index : m_composite_indexes) {
+        if (index->covers(col_key))
+            composite_indexes.push_back(index->get_columns());
+    }
+
     ColKey new_col = generate_col_key(type, attr);
     do_insert_root_column(new_col, type, "__temporary");
 
@@ -3260,8 +3496,20 @@ ColKey Table::set_nullability(ColKey col_key, bool nullable, bool throw_on_null)
     erase_root_column(col_key);
     m_spec.rename_column(colkey2spec_ndx(new_col), column_name);
 
-    if (index_type != IndexType::None)
+    if (index_type != IndexType::None) {
         do_add_search_index(new_col, index_type);
+        if (index_type != IndexType::General) {
+            // Only the general index is part of the attributes carried by the column key
+            auto spec_ndx = colkey2spec_ndx(new_col);
+            auto new_attr = m_spec.get_column_attr(spec_ndx);
+            new_attr.set(index_type == IndexType::Fulltext ? col_attr_FullText_Indexed : col_attr_Sorted_Indexed);
+            m_spec.set_column_attr(spec_ndx, new_attr); // Throws
+        }
+    }
+    for (auto& columns : composite_indexes) {
+        std::replace(columns.begin(), columns.end(), col_key, new_col);
+        add_composite_index(columns);
+    }
 
     return new_col;
 }
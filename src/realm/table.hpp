@@ -36,6 +36,8 @@
 #include <realm/cluster_tree.hpp>
 #include <realm/keys.hpp>
 #include <realm/global_key.hpp>
+#include <realm/index_composite.hpp>
+#include <realm/column_statistics.hpp>
 
 // Only set this to one when testing the code paths that exercise object ID
 // hash collisions. It artificially limits the "optimistic" local ID to use
@@ -248,6 +250,31 @@ public:
     }
     void remove_search_index(ColKey col_key);
 
+    /// A composite index covers an ordered list of columns. A query with
+    /// equality conditions on the first columns of the list, ANDed together,
+    /// then finds the matching objects with one lookup instead of testing the
+    /// objects matching one of the conditions against the others.
+    ///
+    /// add_composite_index() has no effect if there is a composite index on
+    /// the same columns already. remove_composite_index() has no effect if
+    /// there is none. A composite index is removed when one of its columns is
+    /// removed.
+    void add_composite_index(const std::vector<ColKey>& columns);
+    void remove_composite_index(const std::vector<ColKey>& columns);
+    bool has_composite_index(const std::vector<ColKey>& columns) const noexcept;
+    const std::vector<std::unique_ptr<CompositeIndex>>& get_composite_indexes() const noexcept
+    {
+        return m_composite_indexes;
+    }
+
+    /// Statistics of the values in a column, used for planning queries. They
+    /// are computed on first use and kept until about a tenth of the objects
+    /// of the table may have changed. The changed objects are estimated from
+    /// the change in the number of objects and the number of commits which
+    /// changed the table, so updates of many objects in few commits are only
+    /// noticed after a while.
+    ColumnStatistics get_column_statistics(ColKey col_key) const;
+
     void enumerate_string_column(ColKey col_key);
     bool is_enumerated(ColKey col_key) const noexcept;
     bool contains_unique_values(ColKey col_key) const;
@@ -359,6 +386,12 @@ public:
         return m_clusters.traverse(func);
     }
 
+    size_t traverse_clusters_parallel(util::WorkStealingPool& pool,
+                                      ClusterTree::ParallelTraverseFunction func) const
+    {
+        return m_clusters.traverse_parallel(pool, func);
+    }
+
     /// remove_object() removes the specified object from the table.
     /// Any links from the specified object into objects residing in an embedded
     /// table will cause those objects to be deleted as well, and so on recursively.
@@ -421,6 +454,11 @@ public:
     // Get the key of this table directly, without needing a Table accessor.
     static TableKey get_key_direct(Allocator& alloc, ref_type top_ref);
 
+    // The root of the cluster tree, and of the search index of a column (zero
+    // if it has none). Used by DB::prefetch() to read them ahead of use.
+    ref_type get_cluster_tree_ref() const noexcept;
+    ref_type get_search_index_ref(ColKey col_key) const noexcept;
+
     // Aggregate functions
     size_t count_int(ColKey col_key, int64_t value) const;
     size_t count_string(ColKey col_key, StringData value) const;
@@ -724,6 +762,9 @@ private:
     {
         m_alloc.refresh_ref_translation();
     }
+    // Write the modified parts of the table, compressing integer column leaves.
+    // Used by Group::typed_write_tables().
+    ref_type typed_write(ref_type ref, _impl::ArrayWriterBase& out) const;
     Spec m_spec;                               // 1st slot in m_top
     ClusterTree m_clusters;                    // 3rd slot in m_top
     std::unique_ptr<ClusterTree> m_tombstones; // 13th slot in m_top
@@ -732,6 +773,12 @@ private:
     Array m_opposite_table;                    // 7th slot in m_top
     Array m_opposite_column;                   // 8th slot in m_top
     std::vector<std::unique_ptr<SearchIndex>> m_index_accessors;
+    Array m_composite_index_refs; // 15th slot in m_top
+    std::vector<std::unique_ptr<CompositeIndex>> m_composite_indexes;
+    // Column statistics and the number of commits to the table when they were
+    // computed
+    mutable std::mutex m_statistics_mutex;
+    mutable std::map<ColKey, std::pair<uint64_t, ColumnStatistics>> m_column_statistics;
     ColKey m_primary_key_col;
     Replication* const* m_repl;
     static Replication* g_dummy_replication;
@@ -746,6 +793,14 @@ private:
     void erase_from_search_indexes(ObjKey key);
     void update_indexes(ObjKey key, const FieldValues& values);
     void clear_indexes();
+    bool has_composite_indexes() const noexcept
+    {
+        return !m_composite_indexes.empty();
+    }
+    // Must be called before the value of `col_key` in `obj` is changed
+    void set_in_composite_indexes(const Obj& obj, ColKey col_key, Mixed new_value);
+    void do_remove_composite_index(size_t ndx);
+    void refresh_composite_index_accessors();
     template <typename T>
     void do_populate_index(StringIndex* index, ColKey::Idx col_ndx);
 
@@ -874,7 +929,9 @@ private:
     static constexpr int top_position_for_flags = 12;
     // flags contents: bit 0-1 - table type
     static constexpr int top_position_for_tombstones = 13;
-    static constexpr int top_array_size = 14;
+    // Older versions ignore this slot, so it requires file format 25
+    static constexpr int top_position_for_composite_indexes = 14;
+    static constexpr int top_array_size = 15;
 
     enum { s_collision_map_lo = 0, s_collision_map_hi = 1, s_collision_map_local_id = 2, s_collision_map_num_slots };
 
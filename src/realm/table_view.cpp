@@ -19,12 +19,41 @@
 #include <realm/table_view.hpp>
 #include <realm/column_integer.hpp>
 #include <realm/index_string.hpp>
+#include <realm/index_sorted.hpp>
+#include <realm/query_engine.hpp>
 #include <realm/transaction.hpp>
 
 #include <unordered_set>
 
 using namespace realm;
 
+namespace {
+
+// Feeds the matches of a query to a top-N selection
+class QueryStateTopN : public QueryStateBase {
+public:
+    QueryStateTopN(SortDescriptor::TopN& top_n)
+        : m_top_n(top_n)
+    {
+    }
+    bool match(size_t index, Mixed) noexcept final
+    {
+        return match(index);
+    }
+    bool match(size_t index) noexcept final
+    {
+        ++m_match_count;
+        int64_t key_value = (m_key_values ? m_key_values->get(index) : index) + m_key_offset;
+        m_top_n.add(ObjKey(key_value));
+        return true;
+    }
+
+private:
+    SortDescriptor::TopN& m_top_n;
+};
+
+} // anonymous namespace
+
 TableView::TableView(TableView& src, Transaction* tr, PayloadPolicy policy_mode)
     : m_source_column_key(src.m_source_column_key)
 {
@@ -404,6 +433,87 @@ void TableView::apply_descriptor_ordering(const DescriptorOrdering& new_ordering
     do_sync();
 }
 
+bool TableView::apply_descriptor_ordering(const DescriptorOrdering& new_ordering,
+                                          const std::vector<ObjKey>& previous_keys,
+                                          const std::unordered_set<ObjKey>& changed_keys)
+{
+    if (!m_query || m_query->m_view || m_limit != size_t(-1) || new_ordering.size() > 1)
+        return false;
+    const SortDescriptor* sort = nullptr;
+    if (new_ordering.size() == 1) {
+        if (new_ordering.get_type(0) != DescriptorType::Sort)
+            return false;
+        sort = static_cast<const SortDescriptor*>(new_ordering[0]);
+        if (!sort->is_on_columns_of(*m_table))
+            return false;
+    }
+    if (auto root = m_query->root_node()) {
+        // Following a link makes the result depend on other objects than the
+        // matching one. The tables of the expressions include the table they
+        // start from, so links within the table can't be told apart from
+        // expressions on its own columns, and both fall back to a full run if
+        // the table links to itself.
+        std::vector<TableKey> linked_tables;
+        root->get_link_dependencies(linked_tables);
+        for (TableKey key : linked_tables) {
+            if (key != m_table->get_key())
+                return false;
+        }
+        if (!linked_tables.empty()) {
+            for (auto col : m_table->get_column_keys()) {
+                if (Table::is_link_type(col.get_type()) && m_table->get_opposite_table_key(col) == m_table->get_key())
+                    return false;
+            }
+        }
+    }
+
+    util::CriticalSection cs(m_race_detector);
+    m_query->m_table.check();
+    m_descriptor_ordering = new_ordering;
+    m_descriptor_ordering.collect_dependencies(m_table.unchecked_ptr());
+
+    auto less = [&](ObjKey a, ObjKey b) {
+        return sort ? sort->less(*m_table, a, b) : a < b;
+    };
+
+    // The changed objects which match now, in result order
+    std::vector<ObjKey> matches;
+    if (m_query->has_conditions())
+        m_query->init();
+    for (ObjKey key : changed_keys) {
+        if (auto obj = m_table->try_get_object(key); obj && m_query->eval_object(obj))
+            matches.push_back(key);
+    }
+    std::sort(matches.begin(), matches.end(), less);
+
+    // Merge them into the unchanged objects of the previous result, which
+    // keep their relative order. Each match is placed by a binary search, so
+    // that values are only read for the changed objects and a few others.
+    std::vector<ObjKey> kept;
+    kept.reserve(previous_keys.size());
+    for (ObjKey key : previous_keys) {
+        if (!changed_keys.count(key))
+            kept.push_back(key);
+    }
+    if (m_key_values.is_attached())
+        m_key_values.clear();
+    else
+        m_key_values.create();
+    m_key_values.reserve(kept.size() + matches.size());
+    auto begin = kept.begin();
+    for (ObjKey key : matches) {
+        auto pos = std::upper_bound(begin, kept.end(), key, less);
+        m_key_values.insert(m_key_values.end(), begin, pos);
+        m_key_values.add(key);
+        begin = pos;
+    }
+    m_key_values.insert(m_key_values.end(), begin, kept.end());
+
+    m_last_seen_versions.clear();
+    get_dependencies(m_last_seen_versions);
+    return true;
+}
+
 std::string TableView::get_descriptor_ordering_description() const
 {
     return m_descriptor_ordering.get_description(m_table);
@@ -469,6 +579,13 @@ void TableView::do_sync()
 
         if (m_query->m_view)
             m_query->m_view->sync_if_needed();
+        if (find_top_n()) {
+            // The leading sort and limit have been applied
+            apply_descriptors(m_descriptor_ordering, 2);
+            get_dependencies(m_last_seen_versions);
+            return;
+        }
+
         size_t limit = m_limit;
         if (!m_descriptor_ordering.is_empty()) {
             auto type = m_descriptor_ordering[0]->get_type();
@@ -487,9 +604,54 @@ void TableView::do_sync()
     get_dependencies(m_last_seen_versions);
 }
 
-void TableView::apply_descriptors(const DescriptorOrdering& ordering)
+bool TableView::find_top_n()
 {
-    if (ordering.is_empty())
+    // Only a sort directly followed by a limit, applied to the full result of
+    // the query, can be done without gathering all matches first
+    if (m_descriptor_ordering.size() < 2 || m_descriptor_ordering.get_type(0) != DescriptorType::Sort ||
+        m_descriptor_ordering.get_type(1) != DescriptorType::Limit || m_limit != size_t(-1) || m_query->m_view)
+        return false;
+    auto& sort = static_cast<const SortDescriptor&>(*m_descriptor_ordering[0]);
+    size_t limit = static_cast<const LimitDescriptor*>(m_descriptor_ordering[1])->get_limit();
+    if (limit == 0)
+        return true;
+
+    if (auto index = sort.get_sorted_index(*m_table)) {
+        // Walk the index in sort order until enough objects have matched. If
+        // the query rejects too many objects on the way, scanning the table
+        // is cheaper, so give up after a while.
+        size_t budget = limit + m_table->size() / 16;
+        bool has_cond = m_query->has_conditions();
+        if (has_cond)
+            m_query->init();
+        bool completed = true;
+        index->for_each_sorted(sort.is_ascending(0).value_or(true), [&](ObjKey key) {
+            if (budget-- == 0) {
+                completed = false;
+                return IteratorControl::Stop;
+            }
+            if (!has_cond || m_query->eval_object(m_table->get_object(key)))
+                m_key_values.add(key);
+            return m_key_values.size() < limit ? IteratorControl::AdvanceToNext : IteratorControl::Stop;
+        });
+        if (completed)
+            return true;
+        m_key_values.clear();
+    }
+
+    auto top_n = sort.top_n(*m_table, limit);
+    if (!top_n)
+        return false;
+    QueryStateTopN st(*top_n);
+    m_query->do_find_all(st);
+    for (ObjKey key : top_n->get_sorted_keys())
+        m_key_values.add(key);
+    return true;
+}
+
+void TableView::apply_descriptors(const DescriptorOrdering& ordering, size_t first_descriptor)
+{
+    if (ordering.size() <= first_descriptor)
         return;
     size_t sz = size();
     if (sz == 0)
@@ -529,7 +691,7 @@ void TableView::apply_descriptors(const DescriptorOrdering& ordering)
     };
 
     const int num_descriptors = int(ordering.size());
-    for (int desc_ndx = 0; desc_ndx < num_descriptors; ++desc_ndx) {
+    for (int desc_ndx = int(first_descriptor); desc_ndx < num_descriptors; ++desc_ndx) {
         const BaseDescriptor* base_descr = ordering[desc_ndx];
         const BaseDescriptor* next = ((desc_ndx + 1) < num_descriptors) ? ordering[desc_ndx + 1] : nullptr;
 
@@ -540,6 +702,11 @@ void TableView::apply_descriptors(const DescriptorOrdering& ordering)
                 use_indexpairs();
             }
 
+            if (base_descr->get_type() == DescriptorType::Sort &&
+                static_cast<const SortDescriptor*>(base_descr)->execute_with_index(*m_table, index_pairs, next)) {
+                continue;
+            }
+
             BaseDescriptor::Sorter predicate = base_descr->sorter(*m_table, index_pairs);
 
             // Sorting can be specified by multiple columns, so that if two entries in the first column are
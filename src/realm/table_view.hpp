@@ -26,6 +26,8 @@
 #include <realm/list.hpp>
 #include <realm/set.hpp>
 
+#include <unordered_set>
+
 namespace realm {
 
 // Views, tables and synchronization between them:
@@ -375,6 +377,19 @@ public:
     // calling sort and distinct. This is a convenience method for bindings.
     void apply_descriptor_ordering(const DescriptorOrdering& new_ordering);
 
+    // Same as apply_descriptor_ordering(), but for a view which held
+    // `previous_keys` before the objects `changed_keys` of its table were
+    // inserted, modified or removed. Only the changed objects are evaluated
+    // against the query and merged into the previous result, instead of
+    // rerunning the query. This requires that the result depends on nothing
+    // but the objects themselves: the query must be on the whole table,
+    // follow no links and have no limit, and the ordering must be at most a
+    // sort on columns of the table. Returns false, leaving the view
+    // unchanged, otherwise. The caller must ensure that no other changes
+    // happened to the table since `previous_keys` was the result.
+    bool apply_descriptor_ordering(const DescriptorOrdering& new_ordering, const std::vector<ObjKey>& previous_keys,
+                                   const std::unordered_set<ObjKey>& changed_keys);
+
     // Gets a readable and parsable string which completely describes the sort and
     // distinct operations applied to this view.
     std::string get_descriptor_ordering_description() const;
@@ -400,7 +415,11 @@ protected:
     void get_dependencies(TableVersions&) const final;
 
     void do_sync();
-    void apply_descriptors(const DescriptorOrdering&);
+    // Select the first objects of a sort which is directly followed by a limit,
+    // without gathering and sorting all matches of the query. Returns false
+    // if the ordering does not allow it.
+    bool find_top_n();
+    void apply_descriptors(const DescriptorOrdering&, size_t first_descriptor = 0);
 
     mutable ConstTableRef m_table;
     // The source column index that this view contain backlinks for.
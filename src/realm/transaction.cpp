@@ -23,6 +23,7 @@
 #include <realm/dictionary.hpp>
 #include <realm/table_view.hpp>
 #include <realm/group_writer.hpp>
+#include <realm/write_ahead_log.hpp>
 
 namespace {
 
@@ -171,8 +172,15 @@ Transaction::Transaction(DBRef _db, SlabAlloc* alloc, DB::ReadLockInfo& rli, DB:
     bool writable = stage == DB::transact_Writing;
     m_transact_stage = DB::transact_Ready;
     set_transact_stage(stage);
-    attach_shared(m_read_lock.m_top_ref, m_read_lock.m_file_size, writable,
-                  VersionID{rli.m_version, rli.m_reader_idx});
+    m_reader_token = m_alloc.note_reader_start(); // Throws
+    try {
+        attach_shared(m_read_lock.m_top_ref, m_read_lock.m_file_size, writable,
+                      VersionID{rli.m_version, rli.m_reader_idx});
+    }
+    catch (...) {
+        m_alloc.note_reader_end(m_reader_token);
+        throw;
+    }
     if (db->m_logger) {
         db->m_logger->log(util::LogCategory::transaction, util::Logger::Level::trace, "Start %1 %2: %3 ref %4",
                           log_stage[stage], m_log_id, rli.m_version, m_read_lock.m_top_ref);
@@ -216,7 +224,8 @@ DB::version_type Transaction::commit()
     // before committing, allow any accessors at group level or below to sync
     flush_accessors_for_commit();
 
-    DB::version_type new_version = db->do_commit(*this); // Throws
+    bool group_commit = db->uses_group_commit();
+    DB::version_type new_version = db->do_commit(*this, true, group_commit); // Throws
 
     // We need to set m_read_lock in order for wait_for_change to work.
     // To set it, we grab a readlock on the latest available snapshot
@@ -225,9 +234,20 @@ DB::version_type Transaction::commit()
     db->release_read_lock(lock_after_commit);
 
     db->end_write_on_correct_thread();
+    std::exception_ptr sync_error;
+    if (group_commit) {
+        try {
+            db->wait_for_group_commit(*this, new_version); // Throws
+        }
+        catch (...) {
+            sync_error = std::current_exception();
+        }
+    }
 
     do_end_read();
     m_read_lock = lock_after_commit;
+    if (sync_error)
+        std::rethrow_exception(sync_error);
 
     return new_version;
 }
@@ -533,7 +553,7 @@ void Transaction::upgrade_file_format(int target_file_format_version)
     // Be sure to revisit the following upgrade logic when a new file format
     // version is introduced. The following assert attempt to help you not
     // forget it.
-    REALM_ASSERT_EX(target_file_format_version == 24, target_file_format_version);
+    REALM_ASSERT_EX(target_file_format_version == 25, target_file_format_version);
 
     // DB::do_open() must ensure that only supported version are allowed.
     // It does that by asking backup if the current file format version is
@@ -584,6 +604,9 @@ void Transaction::upgrade_file_format(int target_file_format_version)
             t->migrate_col_keys();
         }
     }
+    // Version 25 only adds new encodings and structures, so version 24 files
+    // need no changes.
+
     // NOTE: Additional future upgrade steps go here.
 }
 
@@ -675,8 +698,14 @@ void Transaction::complete_async_commit()
             db->m_logger->log(util::LogCategory::transaction, util::Logger::Level::trace,
                               "Tr %1: Committing ref %2 to disk", m_log_id, read_lock.m_top_ref);
         }
-        GroupCommitter out(*this);
-        out.commit(read_lock.m_top_ref); // Throws
+        if (db->m_write_ahead_log) {
+            // The commits are durable once their records are
+            db->m_write_ahead_log->sync(); // Throws
+        }
+        else {
+            GroupCommitter out(*this);
+            out.commit(read_lock.m_top_ref); // Throws
+        }
         // we must release the write mutex before the callback, because the callback
         // is allowed to re-request it.
         db->release_read_lock(read_lock);
@@ -812,6 +841,7 @@ void Transaction::do_end_read() noexcept
 
     prepare_for_close();
     detach();
+    m_alloc.note_reader_end(m_reader_token);
 
     // We should always be ensuring that async commits finish before we get here,
     // but if the fsync() failed or we failed to update the top pointer then
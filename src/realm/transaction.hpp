@@ -200,6 +200,9 @@ private:
     mutable _impl::History* m_history = nullptr;
 
     DB::ReadLockInfo m_read_lock;
+    // Keeps the decrypted pages of an encrypted file which this transaction
+    // may access in memory until it ends
+    uint64_t m_reader_token = 0;
     util::Optional<DB::ReadLockInfo> m_oldest_version_not_persisted;
     std::exception_ptr m_commit_exception GUARDED_BY(m_async_mutex);
     bool m_async_commit_has_failed = false;
@@ -21,6 +21,7 @@
 
 #include <realm/util/features.h>
 #include <realm/util/file.hpp>
+#include <realm/util/function_ref.hpp>
 
 #include <array>
 #include <cstddef>
@@ -77,6 +78,26 @@ public:
     ReadResult read(FileDesc fd, File::SizeType pos, char* dst, WriteObserver* observer = nullptr);
     void try_read_block(FileDesc fd, File::SizeType pos, char* dst) noexcept;
     void write(FileDesc fd, File::SizeType pos, const char* src, WriteMarker* marker = nullptr) noexcept;
+
+    // Most pages read or written by a batch
+    static constexpr size_t max_batch_pages = 64;
+
+    // A page of a batch read or written by read_pages() and write_pages()
+    struct Page {
+        File::SizeType pos;
+        char* addr;
+        bool done = false;
+    };
+    // Read and decrypt a batch of pages, sorted by position, with the
+    // decryption spread over the crypto worker threads. `done` is set for the
+    // pages which were decrypted. The others (pages which are not written yet,
+    // past the end of the file or fail the HMAC check) are left untouched and
+    // must be read with read(), which knows how to handle them. Must only be
+    // used if no other process may be writing to the file.
+    void read_pages(FileDesc fd, Page* pages, size_t count);
+    // Encrypt and write a batch of pages like write() does for a single page,
+    // with the encryption spread over the crypto worker threads
+    void write_pages(FileDesc fd, Page* pages, size_t count, WriteMarker* marker = nullptr) noexcept;
     bool refresh_iv(FileDesc fd, size_t page_ndx);
     void invalidate_ivs() noexcept;
 
@@ -102,27 +123,48 @@ private:
     enum class IVLookupMode { UseCache, Refetch };
     using Hmac = std::array<uint8_t, 28>;
 
+    // The cipher state, which can only be used by one thread at a time
+    class Cipher {
+    public:
+        Cipher(const uint8_t* key);
+        ~Cipher() noexcept;
+        Cipher(const Cipher&) = delete;
+        Cipher& operator=(const Cipher&) = delete;
+
+        void crypt(EncryptionMode mode, File::SizeType pos, char* dst, const char* src,
+                   const char* stored_iv) noexcept;
+
+    private:
 #if REALM_PLATFORM_APPLE
-    CCCryptorRef m_encr;
-    CCCryptorRef m_decr;
+        CCCryptorRef m_encr;
+        CCCryptorRef m_decr;
 #elif defined(_WIN32)
-    BCRYPT_KEY_HANDLE m_aes_key_handle;
+        BCRYPT_KEY_HANDLE m_aes_key_handle;
 #else
-    EVP_CIPHER_CTX* m_ctx;
+        const uint8_t* m_key;
+        EVP_CIPHER_CTX* m_ctx;
 #endif
+    };
 
     const std::array<uint8_t, 64> m_key;
+    Cipher m_cipher;
+    // One cipher per crypto worker, and the encrypted pages and IV tables of a
+    // batch. These are allocated up front, as write_pages() must not fail.
+    std::vector<std::unique_ptr<Cipher>> m_worker_ciphers;
+    std::unique_ptr<char[]> m_batch_buffer;
+    std::vector<IVTable> m_batch_ivs;
     std::vector<IVTable> m_iv_buffer;
     std::vector<IVTable> m_iv_buffer_cache;
     std::vector<bool> m_iv_blocks_read;
     std::unique_ptr<char[]> m_rw_buffer;
     std::unique_ptr<char[]> m_dst_buffer;
 
-    bool constant_time_equals(const Hmac&, const Hmac&) const;
+    static bool constant_time_equals(const Hmac&, const Hmac&);
     void calculate_hmac(Hmac&) const;
     void crypt(EncryptionMode mode, File::SizeType pos, char* dst, const char* src, const char* stored_iv) noexcept;
+    void for_each_page_in_parallel(size_t count, util::FunctionRef<void(size_t page, Cipher& cipher)> func);
     IVTable& get_iv_table(FileDesc fd, File::SizeType data_pos, IVLookupMode mode = IVLookupMode::UseCache) noexcept;
-    void handle_error();
+    static void handle_error();
     void read_iv_block(FileDesc fd, File::SizeType data_pos);
     ReadResult attempt_read(FileDesc fd, File::SizeType pos, char* dst, IVLookupMode iv_mode, uint32_t& iv,
                             Hmac& hmac);
@@ -23,6 +23,9 @@
 #include <cstring>
 #include <limits>
 #include <map>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
 #include <zlib.h>
 #include <zconf.h> // for zlib
 
@@ -397,7 +400,7 @@ std::error_code decompress_none(InputStream& compressed, Span<const char> compre
 }
 
 std::error_code decompress_zlib(InputStream& compressed, Span<const char> compressed_buf, Span<char> decompressed_buf,
-                                bool has_header)
+                                bool has_header, Span<const char> dictionary)
 {
     using namespace compression;
 
@@ -449,8 +452,16 @@ std::error_code decompress_zlib(InputStream& compressed, Span<const char> compre
                 return std::error_code{};
             }
             if (rc == Z_NEED_DICT) {
-                // We don't support custom dictionaries
-                return error::decompress_unsupported;
+                // The data was compressed with a preset dictionary, which must
+                // be the one we were given
+                if (dictionary.empty() || strm.adler != dictionary_id(dictionary))
+                    return error::decompress_unsupported;
+                rc = inflateSetDictionary(&strm, to_bytef(dictionary.data()), uInt(dictionary.size()));
+                REALM_ASSERT(rc == Z_OK);
+                // inflate() does not update total_in when it stops for the
+                // dictionary
+                in_offset = reinterpret_cast<const char*>(strm.next_in) - compressed_buf.data();
+                continue;
             }
             if (rc == Z_DATA_ERROR) {
                 return error::corrupt_input;
@@ -581,7 +592,7 @@ API_AVAILABLE_END
 #endif
 
 std::error_code decompress(InputStream& compressed, Span<const char> compressed_buf, Span<char> decompressed_buf,
-                           Algorithm algorithm, bool has_header)
+                           Algorithm algorithm, bool has_header, Span<const char> dictionary = {})
 {
     using namespace compression;
 
@@ -593,7 +604,8 @@ std::error_code decompress(InputStream& compressed, Span<const char> compressed_
     }
 
 #if REALM_USE_LIBCOMPRESSION
-    if (algorithm != Algorithm::None)
+    // libcompression does not support preset dictionaries
+    if (algorithm != Algorithm::None && dictionary.empty())
         return decompress_libcompression(compressed, compressed_buf, decompressed_buf, algorithm, has_header);
 #endif
 
@@ -601,7 +613,7 @@ std::error_code decompress(InputStream& compressed, Span<const char> compressed_
         case Algorithm::None:
             return decompress_none(compressed, compressed_buf, decompressed_buf);
         case Algorithm::Deflate:
-            return decompress_zlib(compressed, compressed_buf, decompressed_buf, has_header);
+            return decompress_zlib(compressed, compressed_buf, decompressed_buf, has_header, dictionary);
         default:
             return error::decompress_unsupported;
     }
@@ -722,9 +734,10 @@ std::error_code compression::make_error_code(error error_code) noexcept
 // zlib deflateBound()
 std::size_t compression::compress_bound(std::size_t size) noexcept
 {
-    // DEFLATE's worst-case size is a 6 byte zlib header, plus the uncompressed
+    // DEFLATE's worst-case size is a 6 byte zlib header and trailer, plus 4
+    // bytes for the identifier of a preset dictionary, plus the uncompressed
     // data, plus a 5 byte header for every 16383 byte block.
-    size_t overhead = 6 + 5 * (size / 16383 + 1);
+    size_t overhead = 10 + 5 * (size / 16383 + 1);
     if (std::numeric_limits<size_t>::max() - overhead < size)
         return 0;
     return size + overhead;
@@ -733,7 +746,8 @@ std::size_t compression::compress_bound(std::size_t size) noexcept
 
 // zlib deflate()
 std::error_code compression::compress(Span<const char> uncompressed_buf, Span<char> compressed_buf,
-                                      std::size_t& compressed_size, int compression_level, Alloc* custom_allocator)
+                                      std::size_t& compressed_size, int compression_level, Alloc* custom_allocator,
+                                      Span<const char> dictionary)
 {
     auto uncompressed_ptr = to_bytef(uncompressed_buf.data());
     auto uncompressed_size = uncompressed_buf.size();
@@ -754,6 +768,14 @@ std::error_code compression::compress(Span<const char> uncompressed_buf, Span<ch
     if (rc != Z_OK)
         return error::compress_error;
 
+    if (!dictionary.empty()) {
+        rc = deflateSetDictionary(&strm, to_bytef(dictionary.data()), uInt(dictionary.size()));
+        if (rc != Z_OK) {
+            deflateEnd(&strm);
+            return error::compress_error;
+        }
+    }
+
     strm.next_in = uncompressed_ptr;
     strm.avail_in = 0;
     strm.next_out = compressed_ptr;
@@ -807,15 +829,104 @@ std::error_code compression::compress(Span<const char> uncompressed_buf, Span<ch
     return std::error_code{};
 }
 
-std::error_code compression::decompress(InputStream& compressed, Span<char> decompressed_buf)
+std::error_code compression::decompress(InputStream& compressed, Span<char> decompressed_buf,
+                                        Span<const char> dictionary)
 {
-    return ::decompress(compressed, compressed.next_block(), decompressed_buf, Algorithm::Deflate, true);
+    return ::decompress(compressed, compressed.next_block(), decompressed_buf, Algorithm::Deflate, true,
+                        dictionary);
 }
 
-std::error_code compression::decompress(Span<const char> compressed_buf, Span<char> decompressed_buf)
+std::error_code compression::decompress(Span<const char> compressed_buf, Span<char> decompressed_buf,
+                                        Span<const char> dictionary)
 {
     SimpleInputStream adapter(compressed_buf);
-    return ::decompress(adapter, adapter.next_block(), decompressed_buf, Algorithm::Deflate, true);
+    return ::decompress(adapter, adapter.next_block(), decompressed_buf, Algorithm::Deflate, true, dictionary);
+}
+
+uint32_t compression::dictionary_id(Span<const char> dictionary) noexcept
+{
+    uLong id = adler32(0, nullptr, 0);
+    return uint32_t(adler32(id, to_bytef(dictionary.data()), uInt(dictionary.size())));
+}
+
+std::vector<char> compression::train_dictionary(const std::vector<Span<const char>>& samples, size_t max_size)
+{
+    // A preset dictionary pays off by holding strings which recur across
+    // messages, so that their first occurrence in a message can refer to it.
+    // Each sample is split into segments, which are scored by the number of
+    // samples containing each of their 8 byte substrings. The best segments
+    // are picked one at a time, and the substrings of a picked segment no
+    // longer count for the others, so that the dictionary does not repeat
+    // itself. Scores only decrease, so a segment whose score is still the best
+    // after being updated is the best one.
+    constexpr size_t substring_size = 8;
+    constexpr size_t segment_size = 64;
+    auto substring_at = [](const char* data) {
+        uint64_t substring;
+        std::memcpy(&substring, data, substring_size);
+        return substring;
+    };
+
+    std::unordered_map<uint64_t, uint32_t> sample_counts;
+    std::unordered_set<uint64_t> in_sample;
+    for (auto sample : samples) {
+        in_sample.clear();
+        for (size_t i = 0; i + substring_size <= sample.size(); ++i) {
+            uint64_t substring = substring_at(sample.data() + i);
+            if (in_sample.insert(substring).second)
+                ++sample_counts[substring];
+        }
+    }
+
+    auto score = [&](Span<const char> segment) {
+        uint64_t score = 0;
+        for (size_t i = 0; i + substring_size <= segment.size(); ++i) {
+            auto it = sample_counts.find(substring_at(segment.data() + i));
+            if (it != sample_counts.end() && it->second > 1)
+                score += it->second;
+        }
+        return score;
+    };
+
+    using Candidate = std::pair<uint64_t, Span<const char>>;
+    auto compare = [](const Candidate& a, const Candidate& b) {
+        return a.first < b.first;
+    };
+    std::priority_queue<Candidate, std::vector<Candidate>, decltype(compare)> candidates(compare);
+    for (auto sample : samples) {
+        for (size_t offset = 0; offset + substring_size <= sample.size(); offset += segment_size) {
+            auto segment = sample.sub_span(offset, std::min(segment_size, sample.size() - offset));
+            if (uint64_t s = score(segment))
+                candidates.emplace(s, segment);
+        }
+    }
+
+    std::vector<Span<const char>> picked;
+    size_t size = 0;
+    while (!candidates.empty() && size < max_size) {
+        auto [old_score, segment] = candidates.top();
+        candidates.pop();
+        uint64_t new_score = score(segment);
+        if (new_score == 0)
+            continue;
+        if (new_score < old_score && !candidates.empty() && new_score < candidates.top().first) {
+            candidates.emplace(new_score, segment);
+            continue;
+        }
+        segment = segment.first(std::min(segment.size(), max_size - size));
+        picked.push_back(segment);
+        size += segment.size();
+        for (size_t i = 0; i + substring_size <= segment.size(); ++i)
+            sample_counts.erase(substring_at(segment.data() + i));
+    }
+
+    // deflate() refers to the end of the dictionary with the shortest
+    // distances, so the best segments go last
+    std::vector<char> dictionary;
+    dictionary.reserve(size);
+    for (auto it = picked.rbegin(); it != picked.rend(); ++it)
+        dictionary.insert(dictionary.end(), it->begin(), it->end());
+    return dictionary;
 }
 
 std::error_code compression::decompress_nonportable(InputStream& compressed, AppendBuffer<char>& decompressed)
@@ -832,7 +943,7 @@ std::error_code compression::decompress_nonportable(InputStream& compressed, App
 
 std::error_code compression::allocate_and_compress(CompressMemoryArena& compress_memory_arena,
                                                    Span<const char> uncompressed_buf,
-                                                   std::vector<char>& compressed_buf)
+                                                   std::vector<char>& compressed_buf, Span<const char> dictionary)
 {
     const int compression_level = 1;
     std::size_t compressed_size = 0;
@@ -843,7 +954,7 @@ std::error_code compression::allocate_and_compress(CompressMemoryArena& compress
     for (;;) {
         init_arena(compress_memory_arena);
         std::error_code ec = compression::compress(uncompressed_buf, compressed_buf, compressed_size,
-                                                   compression_level, &compress_memory_arena);
+                                                   compression_level, &compress_memory_arena, dictionary);
 
         if (REALM_UNLIKELY(ec)) {
             if (ec == compression::error::compress_buffer_too_small) {
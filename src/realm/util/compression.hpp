@@ -133,22 +133,27 @@ size_t compress_bound(size_t uncompressed_size) noexcept;
 /// [1-9] with 1 the fastest for the current zlib implementation. The returned
 /// error code is of category compression::error_category. If \a Alloc is
 /// non-null, it is used for all memory allocations inside compress() and
-/// compress() will not throw any exceptions.
+/// compress() will not throw any exceptions. If \a dictionary is non-empty, it
+/// is used as a preset dictionary, and the same dictionary must be passed to
+/// decompress().
 std::error_code compress(Span<const char> uncompressed_buf, Span<char> compressed_buf, size_t& compressed_size,
-                         int compression_level = 1, Alloc* custom_allocator = nullptr);
+                         int compression_level = 1, Alloc* custom_allocator = nullptr,
+                         Span<const char> dictionary = {});
 
 /// decompress() decompresses zlib-compressed the data in \a compressed_buf into \a decompressed_buf.
 /// decompress may throw std::bad_alloc, but all other errors (including the
 /// target buffer being too small) are reported by returning an error code of
-/// category compression::error_code.
-std::error_code decompress(Span<const char> compressed_buf, Span<char> decompressed_buf);
+/// category compression::error_code. Data compressed with a preset dictionary
+/// other than \a dictionary fails with error::decompress_unsupported.
+std::error_code decompress(Span<const char> compressed_buf, Span<char> decompressed_buf,
+                           Span<const char> dictionary = {});
 
 /// decompress() decompresses zlib-compressed data in \a compressed into \a
 /// decompressed_buf. decompress may throw std::bad_alloc or any exceptions
 /// thrown by \a compressed, but all other errors (including the target buffer
 /// being too small) are reported by returning an error code of category
 /// compression::error_code.
-std::error_code decompress(InputStream& compressed, Span<char> decompressed_buf);
+std::error_code decompress(InputStream& compressed, Span<char> decompressed_buf, Span<const char> dictionary = {});
 
 /// allocate_and_compress() compresses the data in \a uncompressed_buf using
 /// zlib, storing the result in \a compressed_buf. \a compressed_buf is resized
@@ -156,7 +161,17 @@ std::error_code decompress(InputStream& compressed, Span<char> decompressed_buf)
 /// compressed size. All errors other than std::bad_alloc are returned as an
 /// error code of categrory compression::error_code.
 std::error_code allocate_and_compress(CompressMemoryArena& compress_memory_arena, Span<const char> uncompressed_buf,
-                                      std::vector<char>& compressed_buf);
+                                      std::vector<char>& compressed_buf, Span<const char> dictionary = {});
+
+/// dictionary_id() returns the identifier zlib stores in data compressed with
+/// \a dictionary as preset dictionary (its Adler-32 checksum).
+uint32_t dictionary_id(Span<const char> dictionary) noexcept;
+
+/// train_dictionary() builds a preset dictionary of at most \a max_size bytes
+/// from the strings which occur in several of \a samples. Samples should be
+/// representative of the data to be compressed, such as a set of recorded
+/// messages. Only the last 32 KiB of a dictionary are used by zlib.
+std::vector<char> train_dictionary(const std::vector<Span<const char>>& samples, size_t max_size = 32 * 1024);
 
 /// decompress() decompresses data produced by
 /// allocate_and_compress_nonportable() in \a compressed into \a decompressed.
@@ -28,6 +28,7 @@
 #include <realm/util/errno.hpp>
 #include <realm/util/sha_crypto.hpp>
 #include <realm/util/terminate.hpp>
+#include <realm/util/work_stealing_pool.hpp>
 #include <realm/utilities.hpp>
 
 #include <algorithm>
@@ -151,6 +152,7 @@ static_assert(sizeof(IVTable) == 64);
 namespace {
 constexpr uint8_t aes_block_size = 16;
 constexpr uint16_t encryption_page_size = 4096;
+static_assert(encryption_page_size == EncryptedFile::page_size);
 constexpr uint8_t metadata_size = sizeof(IVTable);
 constexpr uint8_t pages_per_block = encryption_page_size / metadata_size;
 static_assert(metadata_size == 64,
@@ -245,6 +247,22 @@ size_t check_read(FileDesc fd, SizeType pos, void* dst)
     return File::read_static(fd, pos, static_cast<char*>(dst), encryption_page_size);
 }
 
+// Batches of fewer pages are encrypted and decrypted on the calling thread,
+// as handing them to the worker threads costs more than it saves
+constexpr size_t min_parallel_pages = 8;
+
+// Number of pages following a sequential read which are decrypted with it
+constexpr size_t read_ahead_pages = 16;
+
+// The worker threads of the batched encryption and decryption. These are not
+// the threads of the default pool, as tasks of parallel queries running there
+// read pages and would then have to wait for a pool running their own loop.
+WorkStealingPool& crypto_pool()
+{
+    static WorkStealingPool pool;
+    return pool;
+}
+
 // first block is iv data, second page is data
 static_assert(c_min_encrypted_file_size == 2 * encryption_page_size,
               "chaging the block size breaks encrypted file portability");
@@ -285,8 +303,24 @@ void memcpy_if_changed(void* dst, const void* src, size_t n)
 
 AESCryptor::AESCryptor(const char* key)
     : m_key(to_array<uint8_t, 64>(reinterpret_cast<const uint8_t*>(key)))
+    , m_cipher(m_key.data())
+    , m_batch_buffer(new char[2 * max_batch_pages * encryption_page_size])
+    , m_batch_ivs(max_batch_pages)
     , m_rw_buffer(new char[encryption_page_size])
     , m_dst_buffer(new char[encryption_page_size])
+{
+    WorkStealingPool& pool = crypto_pool();
+    if (pool.num_workers() > 1) {
+        pool.start_threads(); // Throws
+        m_worker_ciphers.reserve(pool.num_workers());
+        for (size_t i = 0; i < pool.num_workers(); ++i)
+            m_worker_ciphers.push_back(std::make_unique<Cipher>(m_key.data()));
+    }
+}
+
+AESCryptor::~AESCryptor() noexcept = default;
+
+AESCryptor::Cipher::Cipher(const uint8_t* key)
 {
 #if REALM_PLATFORM_APPLE
     // A random iv is passed to CCCryptorReset. This iv is *not used* by Realm; we set it manually prior to
@@ -310,13 +344,14 @@ AESCryptor::AESCryptor(const char* key)
     ret = BCryptGenerateSymmetricKey(hAesAlg, &m_aes_key_handle, nullptr, 0, (PBYTE)key, 32, 0);
     REALM_ASSERT_RELEASE_EX(ret == 0 && "BCryptGenerateSymmetricKey()", ret);
 #else
+    m_key = key;
     m_ctx = EVP_CIPHER_CTX_new();
     if (!m_ctx)
         handle_error();
 #endif
 }
 
-AESCryptor::~AESCryptor() noexcept
+AESCryptor::Cipher::~Cipher() noexcept
 {
 #if REALM_PLATFORM_APPLE
     CCCryptorRelease(m_encr);
@@ -373,7 +408,7 @@ void AESCryptor::calculate_hmac(Hmac& hmac) const
                 Span(m_key).sub_span<32>());
 }
 
-bool AESCryptor::constant_time_equals(const Hmac& a, const Hmac& b) const
+bool AESCryptor::constant_time_equals(const Hmac& a, const Hmac& b)
 {
     // Constant-time memcmp to avoid timing attacks
     uint8_t result = 0;
@@ -595,7 +630,112 @@ void AESCryptor::write(FileDesc fd, SizeType pos, const char* src, WriteMarker*
     m_iv_buffer_cache[page_index(pos)] = iv;
 }
 
+void AESCryptor::for_each_page_in_parallel(size_t count, FunctionRef<void(size_t page, Cipher& cipher)> func)
+{
+    WorkStealingPool& pool = crypto_pool();
+    if (count < min_parallel_pages || pool.num_workers() == 1) {
+        for (size_t i = 0; i < count; ++i)
+            func(i, m_cipher);
+        return;
+    }
+    pool.parallel_for(count, [&](size_t page, size_t worker) {
+        func(page, *m_worker_ciphers[worker]);
+    });
+}
+
+void AESCryptor::read_pages(FileDesc fd, Page* pages, size_t count)
+{
+    REALM_ASSERT(count <= max_batch_pages);
+    char* encrypted = m_batch_buffer.get();
+    char* decrypted = encrypted + max_batch_pages * encryption_page_size;
+
+    for (size_t i = 0; i < count; ++i)
+        m_batch_ivs[i] = get_iv_table(fd, pages[i].pos);
+
+    // Pages which are adjacent in the file are read together. `done` is set
+    // for the pages which were written and read completely.
+    for (size_t i = 0; i < count;) {
+        SizeType file_pos = data_pos_to_file_pos(pages[i].pos);
+        size_t j = i + 1;
+        while (j < count && data_pos_to_file_pos(pages[j].pos) == file_pos + SizeType(j - i) * encryption_page_size)
+            ++j;
+        size_t actual = File::read_static(fd, file_pos, encrypted + i * encryption_page_size,
+                                          (j - i) * encryption_page_size);
+        for (size_t k = i; k < j; ++k)
+            pages[k].done = actual >= (k - i + 1) * encryption_page_size && m_batch_ivs[k].iv1 != 0;
+        i = j;
+    }
+
+    for_each_page_in_parallel(count, [&](size_t i, Cipher& cipher) {
+        if (!pages[i].done)
+            return;
+        const char* src = encrypted + i * encryption_page_size;
+        Hmac hmac;
+        hmac_sha224(Span(reinterpret_cast<const uint8_t*>(src), encryption_page_size), hmac,
+                    Span(m_key).sub_span<32>());
+        if (!constant_time_equals(hmac, m_batch_ivs[i].hmac1)) {
+            pages[i].done = false;
+            return;
+        }
+        cipher.crypt(mode_Decrypt, pages[i].pos, decrypted + i * encryption_page_size, src,
+                     reinterpret_cast<const char*>(&m_batch_ivs[i].iv1));
+    });
+
+    // See attempt_read() for why the pages are not decrypted in place
+    for (size_t i = 0; i < count; ++i) {
+        if (pages[i].done)
+            memcpy_if_changed(pages[i].addr, decrypted + i * encryption_page_size, encryption_page_size);
+    }
+}
+
+void AESCryptor::write_pages(FileDesc fd, Page* pages, size_t count, WriteMarker* marker) noexcept
+{
+    REALM_ASSERT(count <= max_batch_pages);
+    char* encrypted = m_batch_buffer.get();
+
+    for (size_t i = 0; i < count; ++i) {
+        IVTable& iv = m_batch_ivs[i];
+        iv = get_iv_table(fd, pages[i].pos);
+        memcpy(&iv.iv2, &iv.iv1, 32); // this is also copying the hmac
+    }
+
+    for_each_page_in_parallel(count, [&](size_t i, Cipher& cipher) {
+        IVTable& iv = m_batch_ivs[i];
+        char* dst = encrypted + i * encryption_page_size;
+        // See write()
+        do {
+            ++iv.iv1;
+            if (iv.iv1 == 0)
+                ++iv.iv1;
+            cipher.crypt(mode_Encrypt, pages[i].pos, dst, pages[i].addr, reinterpret_cast<const char*>(&iv.iv1));
+            hmac_sha224(Span(reinterpret_cast<uint8_t*>(dst), encryption_page_size), iv.hmac1,
+                        Span(m_key).sub_span<32>());
+        } while (REALM_UNLIKELY(iv.hmac1 == iv.hmac2));
+    });
+
+    // The IV table of each page is still written before its data
+    for (size_t i = 0; i < count; ++i) {
+        SizeType pos = pages[i].pos;
+        IVTable& iv = m_iv_buffer[page_index(pos)];
+        iv = m_batch_ivs[i];
+        if (marker)
+            marker->mark(pos);
+        File::write_static(fd, iv_table_pos(pos), reinterpret_cast<const char*>(&iv), sizeof(iv));
+        File::write_static(fd, data_pos_to_file_pos(pos), encrypted + i * encryption_page_size,
+                           encryption_page_size);
+        if (marker)
+            marker->unmark();
+        m_iv_buffer_cache[page_index(pos)] = iv;
+    }
+}
+
 void AESCryptor::crypt(EncryptionMode mode, SizeType pos, char* dst, const char* src, const char* stored_iv) noexcept
+{
+    m_cipher.crypt(mode, pos, dst, src, stored_iv);
+}
+
+void AESCryptor::Cipher::crypt(EncryptionMode mode, SizeType pos, char* dst, const char* src,
+                               const char* stored_iv) noexcept
 {
     uint8_t iv[aes_block_size] = {0};
     memcpy(iv, stored_iv, 4);
@@ -631,7 +771,7 @@ void AESCryptor::crypt(EncryptionMode mode, SizeType pos, char* dst, const char*
     }
 
 #else
-    if (!EVP_CipherInit_ex(m_ctx, EVP_aes_256_cbc(), NULL, m_key.data(), iv, mode))
+    if (!EVP_CipherInit_ex(m_ctx, EVP_aes_256_cbc(), NULL, m_key, iv, mode))
         handle_error();
 
     int len;
@@ -652,6 +792,8 @@ EncryptedFile::EncryptedFile(const char* key, FileDesc fd)
     : fd(fd)
     , cryptor(key)
 {
+    // Flushing is noexcept, so it must not allocate
+    batch.reserve(AESCryptor::max_batch_pages);
 }
 
 std::unique_ptr<EncryptedFileMapping> EncryptedFile::add_mapping(SizeType file_offset, void* addr, size_t size,
@@ -686,6 +828,7 @@ EncryptedFileMapping::~EncryptedFileMapping()
     if (m_access == File::access_ReadWrite) {
         do_flush();
     }
+    m_file.stats.pages -= count_resident_pages();
 
     auto it = std::find(m_file.mappings.begin(), m_file.mappings.end(), this);
     REALM_ASSERT(it != m_file.mappings.end());
@@ -743,7 +886,7 @@ bool EncryptedFileMapping::copy_up_to_date_page(size_t local_ndx) noexcept
             continue;
 
         memcpy_if_changed(page_addr(local_ndx), m->page_addr(other_mapping_ndx), encryption_page_size);
-        set(m_page_state[local_ndx], UpToDate);
+        set_up_to_date(local_ndx);
         clear(m_page_state[local_ndx], StaleIV);
         return true;
     }
@@ -774,6 +917,8 @@ bool EncryptedFileMapping::check_possibly_stale_page(size_t local_ndx) noexcept
             clear(state, StaleIV);
             if (!did_change)
                 set(state, UpToDate);
+            else
+                --m_file.stats.pages;
         }
     }
     return !did_change;
@@ -818,7 +963,213 @@ void EncryptedFileMapping::refresh_page(size_t local_ndx, bool to_modify)
         case AESCryptor::ReadResult::Success:
             break;
     }
-    set(m_page_state[local_ndx], UpToDate);
+    set_up_to_date(local_ndx);
+}
+
+// Decrypt the pages in [begin, end] which are not up to date in batches. If
+// `read_ahead` is set and any of them had to be read, the pages following
+// `end` are decrypted with them. Pages which can't be decrypted here are left
+// to refresh_page().
+void EncryptedFileMapping::refresh_pages(size_t begin, size_t end, bool read_ahead)
+{
+    auto& batch = m_file.batch;
+    batch.clear();
+    bool any_read = false;
+    for (size_t local_ndx = begin; local_ndx <= end; ++local_ndx) {
+        if (is(m_page_state[local_ndx], UpToDate) || copy_up_to_date_page(local_ndx) ||
+            check_possibly_stale_page(local_ndx))
+            continue;
+        batch.push_back({page_pos(local_ndx), page_addr(local_ndx)});
+        any_read = true;
+        if (batch.size() == AESCryptor::max_batch_pages)
+            read_batch();
+    }
+
+    if (any_read && read_ahead) {
+        // The pages read ahead are not stamped with the reader epoch, as they
+        // can only be accessed after a read barrier
+        size_t read_ahead_end = std::min(end + 1 + read_ahead_pages, m_page_state.size());
+        for (size_t local_ndx = end + 1; local_ndx < read_ahead_end; ++local_ndx) {
+            // Pages which were ever touched by this mapping are skipped, as
+            // are pages with changes which may not be on disk yet
+            if (m_page_state[local_ndx] != Clean || copy_up_to_date_page(local_ndx) ||
+                is_modified_in_other_mapping(local_ndx))
+                continue;
+            batch.push_back({page_pos(local_ndx), page_addr(local_ndx)});
+            if (batch.size() == AESCryptor::max_batch_pages)
+                break;
+        }
+    }
+    read_batch(end + 1);
+}
+
+// A single page is left to refresh_page(). Pages from `read_ahead_begin` on
+// were not asked for.
+void EncryptedFileMapping::read_batch(size_t read_ahead_begin)
+{
+    auto& batch = m_file.batch;
+    if (batch.size() > 1) {
+        m_file.cryptor.read_pages(m_file.fd, batch.data(), batch.size());
+        for (auto& page : batch) {
+            if (!page.done)
+                continue;
+            size_t local_ndx = get_local_index_of_address(page.addr);
+            set_up_to_date(local_ndx);
+            if (local_ndx >= read_ahead_begin) {
+                set(m_page_state[local_ndx], Touched);
+                ++m_file.stats.read_ahead;
+            }
+        }
+    }
+    batch.clear();
+}
+
+void EncryptedFileMapping::set_up_to_date(size_t local_ndx) noexcept
+{
+    PageState& ps = m_page_state[local_ndx];
+    if (!is_resident(ps))
+        ++m_file.stats.pages;
+    set(ps, UpToDate);
+}
+
+size_t EncryptedFileMapping::count_resident_pages() noexcept
+{
+    return size_t(std::count_if(m_page_state.begin(), m_page_state.end(), [](PageState& ps) {
+        return is_resident(ps);
+    }));
+}
+
+// Release the memory of the pages sharing a system page with `local_ndx`, if
+// none of them can be accessed without a read barrier first, and none were
+// touched since the clock hand last passed them. Returns the number of
+// decrypted pages released.
+size_t EncryptedFileMapping::evict(size_t local_ndx, uint64_t oldest_reader_epoch) noexcept
+{
+#ifdef _WIN32
+    // The decrypted pages are a view of an anonymous file mapping, whose memory
+    // can't be released page by page
+    static_cast<void>(local_ndx);
+    static_cast<void>(oldest_reader_epoch);
+    return 0;
+#else
+    size_t end = local_ndx + util::page_size() / encryption_page_size;
+    if (end > m_page_state.size())
+        return 0;
+    bool evictable = true;
+    size_t resident = 0;
+    for (size_t i = local_ndx; i < end; ++i) {
+        PageState& ps = m_page_state[i];
+        if (is(ps, Touched)) {
+            clear(ps, Touched);
+            evictable = false;
+        }
+        if (!is_resident(ps))
+            continue;
+        if (is(ps, Writable | Dirty) || m_page_epoch[i] >= oldest_reader_epoch)
+            evictable = false;
+        ++resident;
+    }
+    if (!evictable || resident == 0)
+        return 0;
+
+    // Replacing the pages with new anonymous memory releases the old memory
+    size_t size = (end - local_ndx) * encryption_page_size;
+    void* addr = ::mmap(page_addr(local_ndx), size, PROT_READ | PROT_WRITE, MAP_ANON | MAP_PRIVATE | MAP_FIXED, -1, 0);
+    if (addr == MAP_FAILED)
+        return 0;
+    REALM_ASSERT(addr == page_addr(local_ndx));
+    for (size_t i = local_ndx; i < end; ++i)
+        m_page_state[i] = Clean;
+    return resident;
+#endif
+}
+
+void EncryptedFile::evict_pages() noexcept
+{
+    if (stats.page_budget == 0 || stats.pages <= std::max(stats.page_budget, sweep_threshold))
+        return;
+    // Release pages down to 7/8 of the budget, so that a sweep isn't needed
+    // for every page decrypted once the budget is reached
+    size_t target = stats.page_budget - stats.page_budget / 8;
+    uint64_t oldest_reader_epoch = reader_epochs.empty() ? epoch : *reader_epochs.begin();
+    size_t total_pages = 0;
+    for (auto& m : mappings) {
+        m->assert_locked();
+        total_pages += m->m_page_state.size();
+    }
+
+    // Each page is visited at most twice, as the first visit clears its
+    // Touched flag
+    const size_t pages_per_system_page = util::page_size() / encryption_page_size;
+    for (size_t visited = 0; stats.pages > target && visited < 2 * total_pages;) {
+        if (clock_mapping >= mappings.size()) {
+            clock_mapping = 0;
+            clock_page = 0;
+        }
+        EncryptedFileMapping* m = mappings[clock_mapping];
+        m->assert_locked();
+        if (clock_page >= m->m_page_state.size()) {
+            ++clock_mapping;
+            clock_page = 0;
+            continue;
+        }
+        size_t evicted = m->evict(clock_page, oldest_reader_epoch);
+        stats.pages -= evicted;
+        stats.evictions += evicted;
+        clock_page += pages_per_system_page;
+        visited += pages_per_system_page;
+    }
+    // If too many pages are in use by readers, don't sweep again on every
+    // read barrier
+    sweep_threshold = stats.pages > target ? stats.pages + stats.page_budget / 8 : 0;
+}
+
+void EncryptedFile::set_page_budget(size_t pages)
+{
+    CheckedLockGuard lock(mutex);
+    stats.page_budget = pages;
+    evict_pages();
+}
+
+uint64_t EncryptedFile::note_reader_start()
+{
+    CheckedLockGuard lock(mutex);
+    reader_epochs.insert(++epoch);
+    return epoch;
+}
+
+void EncryptedFile::note_reader_end(uint64_t token) noexcept
+{
+    CheckedLockGuard lock(mutex);
+    auto it = reader_epochs.find(token);
+    if (it != reader_epochs.end())
+        reader_epochs.erase(it);
+    sweep_threshold = 0;
+}
+
+EncryptedFile::PageStats EncryptedFile::get_page_stats() const
+{
+    CheckedLockGuard lock(mutex);
+    return stats;
+}
+
+void EncryptedFileMapping::write_batch() noexcept
+{
+    auto& batch = m_file.batch;
+    m_file.cryptor.write_pages(m_file.fd, batch.data(), batch.size(), m_marker);
+    batch.clear();
+}
+
+bool EncryptedFileMapping::is_modified_in_other_mapping(size_t local_ndx) noexcept
+{
+    size_t ndx_in_file = local_ndx + m_first_page;
+    for (auto& m : m_file.mappings) {
+        m->assert_locked();
+        if (m != this && m->contains_page(ndx_in_file) &&
+            is(m->m_page_state[ndx_in_file - m->m_first_page], Writable | Dirty))
+            return true;
+    }
+    return false;
 }
 
 void EncryptedFile::mark_data_as_possibly_stale()
@@ -923,6 +1274,9 @@ void EncryptedFileMapping::validate() noexcept
 
 void EncryptedFileMapping::do_flush(bool skip_validate) noexcept
 {
+    // The dirty pages are encrypted and written in batches
+    auto& batch = m_file.batch;
+    batch.clear();
     for (size_t i = 0; i < m_page_state.size(); ++i) {
         if (is_not(m_page_state[i], Dirty)) {
             if (!skip_validate) {
@@ -930,9 +1284,13 @@ void EncryptedFileMapping::do_flush(bool skip_validate) noexcept
             }
             continue;
         }
-        m_file.cryptor.write(m_file.fd, page_pos(i), page_addr(i), m_marker);
+        batch.push_back({page_pos(i), page_addr(i)});
         clear(m_page_state[i], Dirty);
+        if (batch.size() == AESCryptor::max_batch_pages)
+            write_batch();
     }
+    if (!batch.empty())
+        write_batch();
 
     // some of the tests call flush() on very small writes which results in
     // validating on every flush being unreasonably slow
@@ -1000,13 +1358,28 @@ void EncryptedFileMapping::read_barrier(const void* addr, size_t size, bool to_m
     REALM_ASSERT(size > 0);
     size_t begin = get_local_index_of_address(addr);
     size_t end = get_local_index_of_address(addr, size - 1);
+    bool sequential = begin == m_last_read_page || begin == m_last_read_page + 1;
+    m_last_read_page = end;
+    for (size_t local_ndx = begin; local_ndx <= end; ++local_ndx) {
+        if (is(m_page_state[local_ndx], UpToDate))
+            ++m_file.stats.hits;
+        else
+            ++m_file.stats.misses;
+    }
+    // Pages which may be written by another process are read one at a time,
+    // as their reads may need to be retried
+    if (!m_observer || m_observer->no_concurrent_writer_seen())
+        refresh_pages(begin, end, sequential && !to_modify);
     for (size_t local_ndx = begin; local_ndx <= end; ++local_ndx) {
         PageState& ps = m_page_state[local_ndx];
         if (is_not(ps, UpToDate))
             refresh_page(local_ndx, to_modify);
         if (to_modify)
             set(ps, Writable);
+        set(ps, Touched);
+        m_page_epoch[local_ndx] = m_file.epoch;
     }
+    m_file.evict_pages();
 }
 
 void EncryptedFileMapping::extend_to(SizeType offset, size_t new_size)
@@ -1014,6 +1387,7 @@ void EncryptedFileMapping::extend_to(SizeType offset, size_t new_size)
     CheckedLockGuard lock(m_file.mutex);
     REALM_ASSERT_EX(new_size % encryption_page_size == 0, new_size, encryption_page_size);
     m_page_state.resize(page_count(new_size), PageState::Clean);
+    m_page_epoch.resize(m_page_state.size());
     m_file.cryptor.set_data_size(offset + SizeType(new_size));
 }
 
@@ -1034,8 +1408,11 @@ void EncryptedFileMapping::set(void* new_addr, size_t new_size, SizeType new_fil
 
     // set_data_size() would have thrown if this cast would overflow
     m_first_page = size_t(new_file_offset / encryption_page_size);
+    m_file.stats.pages -= count_resident_pages();
     m_page_state.clear();
     m_page_state.resize(new_size / encryption_page_size, PageState::Clean);
+    m_page_epoch.assign(m_page_state.size(), 0);
+    m_last_read_page = m_page_state.size();
 }
 
 SizeType encrypted_size_to_data_size(SizeType size) noexcept
@@ -23,6 +23,7 @@
 #include <realm/util/checked_mutex.hpp>
 #include <realm/util/file.hpp>
 
+#include <set>
 #include <vector>
 
 namespace realm::util {
@@ -49,13 +50,61 @@ public:
 
     void mark_data_as_possibly_stale() REQUIRES(!mutex);
 
+    // Limit the number of decrypted pages kept in memory by all mappings of the
+    // file. Zero means no limit. When the limit is exceeded, pages which were
+    // not accessed recently are released. Pages which a reader may still
+    // access without a read barrier, and pages with changes, are never
+    // released. Has no effect on Windows.
+    void set_page_budget(size_t pages) REQUIRES(!mutex);
+
+    // A reader, such as a transaction, may keep accessing the pages it has
+    // passed to read_barrier() until it ends. Pages accessed while a noted
+    // reader exists are not released before it ends. Returns the token to
+    // pass to note_reader_end().
+    uint64_t note_reader_start() REQUIRES(!mutex);
+    void note_reader_end(uint64_t token) noexcept REQUIRES(!mutex);
+
+    // Size of the decrypted pages counted by set_page_budget() and PageStats
+    static constexpr size_t page_size = 4096;
+
+    struct PageStats {
+        // Decrypted pages held in memory, and the limit on them
+        size_t pages = 0;
+        size_t page_budget = 0;
+        // Pages passed to read_barrier() which were decrypted already and
+        // which had to be decrypted
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        // Pages decrypted ahead of sequential reads
+        uint64_t read_ahead = 0;
+        // Pages released to stay within the budget
+        uint64_t evictions = 0;
+    };
+    PageStats get_page_stats() const REQUIRES(!mutex);
+
 private:
     friend class EncryptedFileMapping;
 
-    CheckedMutex mutex;
+    mutable CheckedMutex mutex;
     FileDesc fd;
     AESCryptor cryptor GUARDED_BY(mutex);
     std::vector<EncryptedFileMapping*> mappings GUARDED_BY(mutex);
+    // The pages of the batch being read or written by a mapping
+    std::vector<AESCryptor::Page> batch GUARDED_BY(mutex);
+
+    PageStats stats GUARDED_BY(mutex);
+    // Incremented when a reader starts. Pages are stamped with the epoch they
+    // were last accessed in, and can be released once that is older than the
+    // epochs of all readers.
+    uint64_t epoch GUARDED_BY(mutex) = 0;
+    std::multiset<uint64_t> reader_epochs GUARDED_BY(mutex);
+    // Position of the eviction clock hand
+    size_t clock_mapping GUARDED_BY(mutex) = 0;
+    size_t clock_page GUARDED_BY(mutex) = 0;
+    // Number of pages above which the next sweep is made
+    size_t sweep_threshold GUARDED_BY(mutex) = 0;
+
+    void evict_pages() noexcept REQUIRES(mutex);
 };
 
 class EncryptedFileMapping {
@@ -120,9 +169,14 @@ private:
         UpToDate = 1, // the page is fully up to date
         StaleIV = 2,  // the page needs to check the on disk IV for changes by other processes
         Writable = 4, // the page is open for writing
-        Dirty = 8     // the page has been modified with respect to what's on file.
+        Dirty = 8,    // the page has been modified with respect to what's on file.
+        Touched = 16  // the page was accessed since the eviction clock last passed it
     };
     std::vector<PageState> m_page_state GUARDED_BY(m_file.mutex);
+    // The reader epoch each page was last accessed in
+    std::vector<uint64_t> m_page_epoch GUARDED_BY(m_file.mutex);
+    // The last page passed to read_barrier(), for detecting sequential reads
+    size_t m_last_read_page GUARDED_BY(m_file.mutex) = 0;
     // little helpers:
     static constexpr void clear(PageState& ps, int p)
     {
@@ -140,6 +194,11 @@ private:
     {
         ps = PageState(ps | p);
     }
+    // the page holds decrypted data in memory
+    static constexpr bool is_resident(PageState& ps)
+    {
+        return is(ps, UpToDate | StaleIV | Writable | Dirty);
+    }
 
     const File::AccessMode m_access;
     util::WriteObserver* m_observer = nullptr;
@@ -153,6 +212,13 @@ private:
     bool copy_up_to_date_page(size_t local_ndx) noexcept REQUIRES(m_file.mutex);
     bool check_possibly_stale_page(size_t local_ndx) noexcept REQUIRES(m_file.mutex);
     void refresh_page(size_t local_ndx, bool to_modify) REQUIRES(m_file.mutex);
+    void refresh_pages(size_t begin, size_t end, bool read_ahead) REQUIRES(m_file.mutex);
+    void read_batch(size_t read_ahead_begin = size_t(-1)) REQUIRES(m_file.mutex);
+    void write_batch() noexcept REQUIRES(m_file.mutex);
+    bool is_modified_in_other_mapping(size_t local_ndx) noexcept REQUIRES(m_file.mutex);
+    void set_up_to_date(size_t local_ndx) noexcept REQUIRES(m_file.mutex);
+    size_t count_resident_pages() noexcept REQUIRES(m_file.mutex);
+    size_t evict(size_t local_ndx, uint64_t oldest_reader_epoch) noexcept REQUIRES(m_file.mutex);
     void write_and_update_all(size_t local_ndx, uint16_t offset, uint16_t size) noexcept REQUIRES(m_file.mutex);
     void validate_page(size_t local_ndx) noexcept REQUIRES(m_file.mutex);
     void validate() noexcept REQUIRES(m_file.mutex);
@@ -191,6 +257,9 @@ inline std::string EncryptedFileMapping::print_debug()
         if (s & PageState::Dirty) {
             state += "Dirty";
         }
+        if (s & PageState::Touched) {
+            state += "Touched";
+        }
         state += "}";
         return state;
     };
@@ -248,6 +248,34 @@ void msync(FileDesc fd, void* addr, size_t size)
 #endif
 }
 
+void madvise(void* addr, size_t size, MemoryAdvice advice) noexcept
+{
+#ifdef _WIN32
+    static_cast<void>(addr);
+    static_cast<void>(size);
+    static_cast<void>(advice);
+#else
+    auto shift = reinterpret_cast<uintptr_t>(addr) & (page_size() - 1);
+    addr = static_cast<char*>(addr) - shift;
+    size += shift;
+    int flag = MADV_NORMAL;
+    switch (advice) {
+        case MemoryAdvice::Normal:
+            break;
+        case MemoryAdvice::Random:
+            flag = MADV_RANDOM;
+            break;
+        case MemoryAdvice::WillNeed:
+            flag = MADV_WILLNEED;
+            break;
+        case MemoryAdvice::DontNeed:
+            flag = MADV_DONTNEED;
+            break;
+    }
+    ::madvise(addr, size, flag);
+#endif
+}
+
 #if REALM_ENABLE_ENCRYPTION
 void do_encryption_read_barrier(const void* addr, size_t size, EncryptedFileMapping* mapping, bool to_modify)
 {
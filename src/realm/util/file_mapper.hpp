@@ -37,6 +37,17 @@ void munmap(void* addr, size_t size);
 void msync(FileDesc fd, void* addr, size_t size);
 void* mmap_anon(size_t size);
 
+enum class MemoryAdvice {
+    Normal,   // the default read-around on page faults
+    Random,   // read only the faulting page
+    WillNeed, // start reading the range into the page cache
+    DontNeed, // release the pages of the range from the mapping
+};
+/// Tell the kernel how a file mapping will be accessed. DontNeed must only be
+/// used on shared file mappings, whose pages are read back from the file when
+/// accessed again. A best effort hint, which does nothing where unsupported.
+void madvise(void* addr, size_t size, MemoryAdvice advice) noexcept;
+
 #if REALM_ENABLE_ENCRYPTION
 
 void* mmap_fixed(FileDesc fd, void* address_request, size_t size, File::AccessMode access, uint64_t offset);
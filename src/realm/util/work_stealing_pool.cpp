@@ -0,0 +1,209 @@
+/*************************************************************************
+ *
+ * Copyright 2024 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/util/work_stealing_pool.hpp>
+
+#include <realm/util/assert.hpp>
+#include <realm/util/thread.hpp>
+
+#include <algorithm>
+#include <string>
+
+using namespace realm;
+using namespace realm::util;
+
+struct WorkStealingPool::Slice {
+    std::mutex mutex;
+    size_t begin = 0;
+    size_t end = 0;
+    // Read without the lock when looking for a victim, so only a hint
+    std::atomic<size_t> remaining{0};
+};
+
+WorkStealingPool::WorkStealingPool(size_t num_workers)
+    : m_num_workers(num_workers ? num_workers : std::max(1u, std::thread::hardware_concurrency()))
+    , m_slices(new Slice[m_num_workers])
+{
+}
+
+WorkStealingPool::~WorkStealingPool() noexcept
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+    m_work_cv.notify_all();
+    for (auto& thread : m_threads)
+        thread.join();
+}
+
+WorkStealingPool& WorkStealingPool::get_default()
+{
+    static WorkStealingPool pool;
+    return pool;
+}
+
+void WorkStealingPool::parallel_for(size_t num_tasks, TaskFunction func)
+{
+    if (num_tasks == 0)
+        return;
+
+    std::lock_guard run_lock(m_run_mutex);
+
+    size_t num_workers = std::min(m_num_workers, num_tasks);
+    if (num_workers == 1) {
+        for (size_t i = 0; i < num_tasks; ++i)
+            func(i, 0);
+        return;
+    }
+
+    // Give every worker a contiguous slice of the task range
+    for (size_t i = 0; i < m_num_workers; ++i) {
+        Slice& slice = m_slices[i];
+        std::lock_guard lock(slice.mutex);
+        slice.begin = i < num_workers ? num_tasks * i / num_workers : 0;
+        slice.end = i < num_workers ? num_tasks * (i + 1) / num_workers : 0;
+        slice.remaining.store(slice.end - slice.begin, std::memory_order_relaxed);
+    }
+
+    {
+        std::lock_guard lock(m_mutex);
+        // Threads are started on first use so that an unused pool costs nothing
+        do_start_threads(); // Throws
+        m_func = &func;
+        m_exception = nullptr;
+        m_aborted.store(false, std::memory_order_relaxed);
+        m_active = m_num_workers - 1;
+        ++m_generation;
+    }
+    m_work_cv.notify_all();
+
+    run_worker(0, func);
+
+    std::unique_lock lock(m_mutex);
+    m_done_cv.wait(lock, [this] {
+        return m_active == 0;
+    });
+    m_func = nullptr;
+    if (auto e = std::exchange(m_exception, nullptr))
+        std::rethrow_exception(e);
+}
+
+void WorkStealingPool::start_threads()
+{
+    std::lock_guard lock(m_mutex);
+    do_start_threads(); // Throws
+}
+
+void WorkStealingPool::do_start_threads()
+{
+    while (m_threads.size() + 1 < m_num_workers) {
+        size_t worker_ndx = m_threads.size() + 1;
+        m_threads.emplace_back([this, worker_ndx] {
+            worker_main(worker_ndx);
+        }); // Throws
+    }
+}
+
+void WorkStealingPool::worker_main(size_t worker_ndx)
+{
+    Thread::set_name("realm-worker-" + std::to_string(worker_ndx));
+    uint64_t seen_generation = 0;
+    std::unique_lock lock(m_mutex);
+    for (;;) {
+        m_work_cv.wait(lock, [&] {
+            return m_stop || m_generation != seen_generation;
+        });
+        if (m_stop)
+            return;
+        seen_generation = m_generation;
+        const TaskFunction& func = *m_func;
+        lock.unlock();
+        run_worker(worker_ndx, func);
+        lock.lock();
+        if (--m_active == 0)
+            m_done_cv.notify_one();
+    }
+}
+
+void WorkStealingPool::run_worker(size_t worker_ndx, const TaskFunction& func) noexcept
+{
+    size_t task_ndx;
+    while (take_task(worker_ndx, task_ndx)) {
+        try {
+            func(task_ndx, worker_ndx);
+        }
+        catch (...) {
+            std::lock_guard lock(m_mutex);
+            if (!m_exception)
+                m_exception = std::current_exception();
+            // Make every worker stop at its next task
+            m_aborted.store(true, std::memory_order_relaxed);
+            return;
+        }
+    }
+}
+
+bool WorkStealingPool::take_task(size_t worker_ndx, size_t& task_ndx) noexcept
+{
+    Slice& own = m_slices[worker_ndx];
+    for (;;) {
+        if (m_aborted.load(std::memory_order_relaxed))
+            return false;
+        {
+            std::lock_guard lock(own.mutex);
+            if (own.begin < own.end) {
+                task_ndx = own.begin++;
+                own.remaining.store(own.end - own.begin, std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        // Out of work - pick the worker with the most remaining tasks
+        size_t victim = m_num_workers;
+        size_t most = 0;
+        for (size_t i = 0; i < m_num_workers; ++i) {
+            size_t remaining = m_slices[i].remaining.load(std::memory_order_relaxed);
+            if (i != worker_ndx && remaining > most) {
+                most = remaining;
+                victim = i;
+            }
+        }
+        if (victim == m_num_workers)
+            return false;
+
+        size_t begin, end;
+        {
+            Slice& other = m_slices[victim];
+            std::lock_guard lock(other.mutex);
+            if (other.begin == other.end)
+                continue; // Someone else got there first
+            // Take the back half, rounding up so that a single task can be stolen
+            end = other.end;
+            begin = other.end - (other.end - other.begin + 1) / 2;
+            other.end = begin;
+            other.remaining.store(other.end - other.begin, std::memory_order_relaxed);
+        }
+        std::lock_guard lock(own.mutex);
+        task_ndx = begin;
+        own.begin = begin + 1;
+        own.end = end;
+        own.remaining.store(own.end - own.begin, std::memory_order_relaxed);
+        return true;
+    }
+}
@@ -0,0 +1,107 @@
+/*************************************************************************
+ *
+ * Copyright 2024 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_UTIL_WORK_STEALING_POOL_HPP
+#define REALM_UTIL_WORK_STEALING_POOL_HPP
+
+#include <realm/util/function_ref.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace realm::util {
+
+/// A fixed size pool of worker threads executing data parallel loops.
+///
+/// `parallel_for(n, func)` calls `func(task_ndx, worker_ndx)` once for every
+/// task index in `[0, n)`. The task range is initially split into one
+/// contiguous slice per worker. A worker consumes its own slice from the front
+/// and, when it runs dry, steals the back half of the largest remaining slice
+/// of another worker. This keeps neighbouring tasks on the same thread (good
+/// for locality) while still balancing tasks of uneven cost.
+///
+/// The calling thread participates as worker 0, so a pool of size N runs N-1
+/// background threads. `worker_ndx` is always less than `num_workers()` and can
+/// be used to index per-worker state. Only one loop runs on a pool at a time;
+/// concurrent callers are serialized. Calling `parallel_for()` from inside a
+/// task of the same pool is not allowed.
+///
+/// If a task throws, the remaining tasks are abandoned and the first exception
+/// is rethrown from `parallel_for()` once all workers have stopped.
+class WorkStealingPool {
+public:
+    using TaskFunction = util::FunctionRef<void(size_t task_ndx, size_t worker_ndx)>;
+
+    /// A pool with `num_workers` workers including the calling thread. Zero
+    /// means one worker per hardware thread.
+    explicit WorkStealingPool(size_t num_workers = 0);
+    ~WorkStealingPool() noexcept;
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    size_t num_workers() const noexcept
+    {
+        return m_num_workers;
+    }
+
+    void parallel_for(size_t num_tasks, TaskFunction func);
+
+    /// Start the background threads, which are otherwise started by the first
+    /// `parallel_for()`. Once started, `parallel_for()` only throws what the
+    /// tasks throw.
+    void start_threads();
+
+    /// A process wide pool sized to the hardware concurrency. The background
+    /// threads are started lazily on first use.
+    static WorkStealingPool& get_default();
+
+private:
+    struct Slice;
+
+    const size_t m_num_workers;
+    std::unique_ptr<Slice[]> m_slices;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_run_mutex; // serializes parallel_for() callers
+    std::mutex m_mutex;     // protects the members below
+    std::condition_variable m_work_cv;
+    std::condition_variable m_done_cv;
+    const TaskFunction* m_func = nullptr;
+    uint64_t m_generation = 0;
+    size_t m_active = 0;
+    bool m_stop = false;
+    std::exception_ptr m_exception;
+    std::atomic<bool> m_aborted{false};
+
+    void do_start_threads();
+    void worker_main(size_t worker_ndx);
+    void run_worker(size_t worker_ndx, const TaskFunction& func) noexcept;
+    bool take_task(size_t worker_ndx, size_t& task_ndx) noexcept;
+};
+
+} // namespace realm::util
+
+#endif // REALM_UTIL_WORK_STEALING_POOL_HPP
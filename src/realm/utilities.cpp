@@ -62,6 +62,29 @@ inline unsigned long long _xgetbv(unsigned index)
 
 #endif
 #endif
+
+// Returns the EBX register of CPUID leaf 7 (structured extended features), or
+// 0 if the CPU does not have that leaf.
+int cpuid_extended_features()
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return 0;
+    __cpuidex(info, 7, 0);
+    return info[1];
+#else
+    unsigned int eax = 0, ebx, ecx = 0, edx;
+    __asm__ __volatile__("cpuid" : "+a"(eax), "=b"(ebx), "+c"(ecx), "=d"(edx));
+    if (eax < 7)
+        return 0;
+    eax = 7;
+    ecx = 0;
+    __asm__ __volatile__("cpuid" : "+a"(eax), "=b"(ebx), "+c"(ecx), "=d"(edx));
+    return int(ebx);
+#endif
+}
 #endif
 
 } // anonymous namespace
@@ -118,13 +141,25 @@ void cpuid_init()
 
     if (avxSupported) {
         avx_support = 0; // AVX1 supported
+
+        int features = cpuid_extended_features();
+        if (features & (1 << 5)) {
+            avx_support = 1; // AVX2 supported
+
+            // AVX-512 also requires the OS to save the opmask and ZMM registers
+            bool avx512_supported = (features & (1 << 16)) && (features & (1 << 30)); // F and BW
+#if !defined __clang__ && ((defined(_MSC_FULL_VER) && _MSC_FULL_VER >= 160040219) || defined __GNUC__)
+            unsigned long long xcrFeatureMask = _xgetbv(_XCR_XFEATURE_ENABLED_MASK);
+            avx512_supported = avx512_supported && (xcrFeatureMask & 0xe6) == 0xe6;
+#endif
+            if (avx512_supported)
+                avx_support = 2; // AVX-512 supported
+        }
     }
     else {
         avx_support = -1; // No AVX supported
     }
 
-    // 1 is reserved for AVX2
-
 #endif
 }
 } // namespace realm
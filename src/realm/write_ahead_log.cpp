@@ -0,0 +1,216 @@
+/*************************************************************************
+ *
+ * Copyright 2024 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include <realm/write_ahead_log.hpp>
+#include <realm/disable_sync_to_disk.hpp>
+
+#include <cstddef>
+#include <cstring>
+
+using namespace realm;
+
+namespace {
+
+constexpr uint64_t s_log_magic = 0x484c41576d6c6552;    // "RelmWALH"
+constexpr uint64_t s_record_magic = 0x314c41576d6c6552; // "RelmWAL1"
+
+struct LogHeader {
+    uint64_t magic;
+    uint64_t checksum;
+    uint64_t base_version;
+    uint64_t base_top_ref;
+    uint64_t file_id;
+};
+static_assert(sizeof(LogHeader) % 8 == 0);
+
+struct RecordHeader {
+    uint64_t magic;
+    uint64_t checksum;
+    uint64_t payload_size;
+    uint64_t version;
+    uint64_t top_ref;
+    uint64_t logical_file_size;
+};
+static_assert(sizeof(RecordHeader) % 8 == 0);
+
+// Checksum of everything in a record following the checksum field. Records
+// are made of 8 byte words.
+uint64_t checksum(const char* data, size_t size)
+{
+    REALM_ASSERT(size % 8 == 0);
+    uint64_t hash = 0xcbf29ce484222325;
+    for (size_t i = 0; i < size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        hash = (hash ^ word) * 0x100000001b3;
+        hash ^= hash >> 29;
+    }
+    return hash;
+}
+
+size_t round_up_to_word(size_t size)
+{
+    return (size + 7) & ~size_t(7);
+}
+
+// The inode of the Realm file, which differs when the file is replaced by
+// another one, for instance by a copy restored from a backup
+uint64_t get_file_id(const util::File& file)
+{
+#ifdef _WIN32
+    static_cast<void>(file);
+    return 0;
+#else
+    return uint64_t(util::File::get_unique_id(file.get_descriptor(), file.get_path()).inode); // Throws
+#endif
+}
+
+} // anonymous namespace
+
+WriteAheadLog::WriteAheadLog(const std::string& path, const util::File& realm_file)
+    : m_file_id(get_file_id(realm_file)) // Throws
+{
+    m_file.open(path, util::File::access_ReadWrite, util::File::create_Auto, 0); // Throws
+}
+
+void WriteAheadLog::begin_commit()
+{
+    m_buffer.assign(sizeof(RecordHeader), 0);
+}
+
+void WriteAheadLog::add(ref_type ref, const char* data, size_t size)
+{
+    REALM_ASSERT(m_buffer.size() >= sizeof(RecordHeader));
+    uint64_t entry[2] = {uint64_t(ref), uint64_t(size)};
+    const char* entry_data = reinterpret_cast<const char*>(entry);
+    m_buffer.insert(m_buffer.end(), entry_data, entry_data + sizeof entry);
+    m_buffer.insert(m_buffer.end(), data, data + size);
+    m_buffer.resize(round_up_to_word(m_buffer.size()));
+}
+
+void WriteAheadLog::end_commit(uint64_t version, ref_type top_ref, size_t logical_file_size, bool sync)
+{
+    REALM_ASSERT(m_buffer.size() >= sizeof(RecordHeader));
+    RecordHeader header;
+    header.magic = s_record_magic;
+    header.checksum = 0;
+    header.payload_size = m_buffer.size() - sizeof(RecordHeader);
+    header.version = version;
+    header.top_ref = top_ref;
+    header.logical_file_size = logical_file_size;
+    std::memcpy(m_buffer.data(), &header, sizeof header);
+    constexpr size_t checked_offset = offsetof(RecordHeader, payload_size);
+    header.checksum = checksum(m_buffer.data() + checked_offset, m_buffer.size() - checked_offset);
+    std::memcpy(m_buffer.data(), &header, sizeof header);
+
+    // All writers append under the write mutex, so the end of the file is
+    // the end of the last record. The log header is written when the log is
+    // started by a checkpoint.
+    auto end = m_file.get_size();
+    REALM_ASSERT(end >= util::File::SizeType(sizeof(LogHeader)));
+    try {
+        m_file.write(end, m_buffer.data(), m_buffer.size()); // Throws
+        if (sync)
+            this->sync(); // Throws
+    }
+    catch (...) {
+        // The commit fails, so its record must not be replayed
+        try {
+            m_file.resize(end);
+        }
+        catch (...) {
+        }
+        m_buffer.clear();
+        throw;
+    }
+    m_buffer.clear();
+}
+
+void WriteAheadLog::sync()
+{
+    if (!get_disable_sync_to_disk())
+        m_file.sync(); // Throws
+}
+
+size_t WriteAheadLog::size() const
+{
+    size_t size = size_t(m_file.get_size());
+    return size > sizeof(LogHeader) ? size - sizeof(LogHeader) : 0;
+}
+
+void WriteAheadLog::clear(uint64_t base_version, ref_type base_top_ref)
+{
+    LogHeader header;
+    header.magic = s_log_magic;
+    header.checksum = 0;
+    header.base_version = base_version;
+    header.base_top_ref = base_top_ref;
+    header.file_id = m_file_id;
+    constexpr size_t checked_offset = offsetof(LogHeader, base_version);
+    header.checksum = checksum(reinterpret_cast<const char*>(&header) + checked_offset, sizeof header - checked_offset);
+    m_file.resize(0);                                                       // Throws
+    m_file.write(0, reinterpret_cast<const char*>(&header), sizeof header); // Throws
+    sync();                                                                 // Throws
+}
+
+bool WriteAheadLog::belongs_to(uint64_t version, ref_type top_ref)
+{
+    LogHeader header;
+    if (m_file.read(0, reinterpret_cast<char*>(&header), sizeof header) != sizeof header) // Throws
+        return false;
+    constexpr size_t checked_offset = offsetof(LogHeader, base_version);
+    if (header.magic != s_log_magic ||
+        checksum(reinterpret_cast<const char*>(&header) + checked_offset, sizeof header - checked_offset) !=
+            header.checksum)
+        return false;
+    return header.base_version == version && header.base_top_ref == top_ref && header.file_id == m_file_id;
+}
+
+std::optional<WriteAheadLog::Commit>
+WriteAheadLog::replay(uint64_t version, util::FunctionRef<void(ref_type, const char*, size_t)> write)
+{
+    std::vector<char> log(size_t(m_file.get_size()));
+    size_t log_size = m_file.read(0, log.data(), log.size()); // Throws
+    std::optional<Commit> newest;
+    size_t pos = sizeof(LogHeader);
+    while (log_size >= pos && log_size - pos >= sizeof(RecordHeader)) {
+        RecordHeader header;
+        std::memcpy(&header, log.data() + pos, sizeof header);
+        if (header.magic != s_record_magic || header.payload_size > log_size - pos - sizeof(RecordHeader))
+            break;
+        constexpr size_t checked_offset = offsetof(RecordHeader, payload_size);
+        size_t record_size = sizeof(RecordHeader) + size_t(header.payload_size);
+        if (checksum(log.data() + pos + checked_offset, record_size - checked_offset) != header.checksum)
+            break;
+
+        if (header.version > version) {
+            const char* entry = log.data() + pos + sizeof(RecordHeader);
+            const char* end = log.data() + pos + record_size;
+            while (entry < end) {
+                uint64_t ref_and_size[2];
+                std::memcpy(ref_and_size, entry, sizeof ref_and_size);
+                entry += sizeof ref_and_size;
+                write(ref_type(ref_and_size[0]), entry, size_t(ref_and_size[1]));
+                entry += round_up_to_word(size_t(ref_and_size[1]));
+            }
+            newest = Commit{header.version, ref_type(header.top_ref), size_t(header.logical_file_size)};
+        }
+        pos += record_size;
+    }
+    return newest;
+}
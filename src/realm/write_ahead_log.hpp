@@ -0,0 +1,97 @@
+/*************************************************************************
+ *
+ * Copyright 2024 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#ifndef REALM_WRITE_AHEAD_LOG_HPP
+#define REALM_WRITE_AHEAD_LOG_HPP
+
+#include <realm/alloc.hpp>
+#include <realm/util/file.hpp>
+#include <realm/util/function_ref.hpp>
+
+#include <optional>
+#include <vector>
+
+/*
+The write-ahead log of a file opened with Durability::WriteAheadLog holds the commits made since the file header was
+last updated (a checkpoint). It starts with a header identifying the file and the version the file header referenced
+when the log was started, followed by a record for each commit, holding the arrays written by the commit, including
+the free lists and the top array, and the top ref of the new version:
+
+       log header:  magic | checksum | base version | base top ref | file id
+       record:      magic | checksum | payload size | version | top ref | logical file size
+       payload:     ref | size | bytes   ref | size | bytes   ...
+
+The commit is durable once its record is synced, so a commit needs a single sync of a sequential write instead of a
+sync of the pages it changed and two syncs of the file header. The arrays are still written to the Realm file, but not
+synced until the next checkpoint, which syncs the file, writes the newest top ref to the file header and starts a new
+log based on that version. Replaying the records on top of the base version restores the arrays written since, in the
+order they were written. A record with a wrong checksum was not completely written, and ends the log.
+
+The records are only valid on top of the base version of the file they were written for. A log whose base version or
+top ref differs from the version referenced by the file header, because the file was checkpointed after the log was
+started or was replaced by another file, or whose file id differs from that of the file, is discarded.
+*/
+
+namespace realm {
+
+class WriteAheadLog {
+public:
+    /// Open the log at `path` for the Realm file `realm_file`, creating it if
+    /// it does not exist
+    WriteAheadLog(const std::string& path, const util::File& realm_file);
+
+    /// Start a record of a commit
+    void begin_commit();
+    /// Add the bytes written at `ref` by the commit to the record
+    void add(ref_type ref, const char* data, size_t size);
+    /// Append the record to the log. If `sync` is set, the record and all
+    /// records appended before it are durable when this returns.
+    void end_commit(uint64_t version, ref_type top_ref, size_t logical_file_size, bool sync);
+    /// Make all records appended so far durable
+    void sync();
+
+    /// Size of the records in the log in bytes
+    size_t size() const;
+    /// Remove all records, and start a log of the commits made on top of the
+    /// version `base_version` with top ref `base_top_ref`, which the file
+    /// header must reference
+    void clear(uint64_t base_version, ref_type base_top_ref);
+
+    /// True if the log was started on top of the version `version` with top
+    /// ref `top_ref` of the Realm file it was opened for
+    bool belongs_to(uint64_t version, ref_type top_ref);
+
+    struct Commit {
+        uint64_t version;
+        ref_type top_ref;
+        size_t logical_file_size;
+    };
+    /// Pass the arrays written by the commits newer than `version` to `write`,
+    /// in the order they were written, and return the newest of those commits.
+    /// The log must belong to `version`.
+    std::optional<Commit> replay(uint64_t version, util::FunctionRef<void(ref_type, const char*, size_t)> write);
+
+private:
+    util::File m_file;
+    uint64_t m_file_id;
+    std::vector<char> m_buffer;
+};
+
+} // namespace realm
+
+#endif // REALM_WRITE_AHEAD_LOG_HPP
@@ -22,6 +22,7 @@
 #include <set>
 #include <sstream>
 #include <set>
+#include <thread>
 
 #include <realm.hpp>
 #if REALM_ENABLE_GEOSPATIAL
@@ -2162,6 +2163,52 @@ struct BenchmarkInitiatorOpen : public BenchmarkNonInitiatorOpen {
     }
 };
 
+// Scan of a table in a newly opened file, so all of its pages are read, and
+// decrypted when the file is encrypted
+struct BenchmarkColdScan : Benchmark {
+    const char* name() const
+    {
+        return "ColdScan";
+    }
+
+    static const int row_count = 200'000;
+    std::unique_ptr<realm::test_util::DBTestPathGuard> path;
+
+    void before_all(DBRef)
+    {
+        std::string ident = util::format("BenchmarkCommonTasks_%1_%2_%3", name(), to_ident_cstr(m_durability),
+                                         m_encryption_key ? "EncryptionOn" : "EncryptionOff");
+        path = std::make_unique<DBTestPathGuard>(get_test_path(ident, ".realm"));
+        DBRef db = DB::create(*path, DBOptions(m_durability, m_encryption_key));
+        WriteTransaction tr(db);
+        TableRef t = tr.add_table(name());
+        ColKey col_int = t->add_column(type_Int, "int");
+        ColKey col_str = t->add_column(type_String, "str");
+        for (int i = 0; i < row_count; ++i)
+            t->create_object().set(col_int, i).set(col_str, util::to_string(i));
+        tr.commit();
+    }
+    void after_all(DBRef)
+    {
+        path.reset();
+    }
+    void before_each(DBRef) {}
+    void after_each(DBRef) {}
+
+    void operator()(DBRef)
+    {
+        DBRef db = DB::create(*path, DBOptions(m_durability, m_encryption_key));
+        auto tr = db->start_read();
+        ConstTableRef t = tr->get_table(name());
+        ColKey col_int = t->get_column_key("int");
+        ColKey col_str = t->get_column_key("str");
+        int64_t sum = 0;
+        for (auto& obj : *t)
+            sum += obj.get<Int>(col_int) + obj.get<String>(col_str).size();
+        REALM_ASSERT(sum > 0);
+    }
+};
+
 struct IterateTableByIterator : Benchmark {
     const char* name() const override
     {
@@ -2320,6 +2367,34 @@ struct TransactionDuplicate : Benchmark {
     void after_each(DBRef) {}
 };
 
+// Short read transactions started and ended concurrently by many threads,
+// which all lock the newest version
+template <size_t num_threads>
+struct BenchmarkStartReadContended : Benchmark {
+    const char* name() const
+    {
+        static std::string name = "StartReadContended" + util::to_string(num_threads);
+        return name.c_str();
+    }
+
+    void operator()(DBRef db)
+    {
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < num_threads; ++i) {
+            threads.emplace_back([&] {
+                for (int j = 0; j < 20'000 / int(num_threads); ++j) {
+                    auto tr = db->start_read();
+                    auto frozen = db->start_frozen();
+                }
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+    }
+    void before_each(DBRef) {}
+    void after_each(DBRef) {}
+};
+
 #if REALM_ENABLE_GEOSPATIAL
 
 struct BenchmarkWithGeospatial : Benchmark {
@@ -2654,6 +2729,7 @@ int benchmark_common_tasks_main()
     BENCH2(BenchmarkEmptyCommit, false);
     BENCH2(BenchmarkNonInitiatorOpen, true);
     BENCH2(BenchmarkInitiatorOpen, true);
+    BENCH2(BenchmarkColdScan, true);
     BENCH2(AddTable, true);
     BENCH2(AddTable, false);
 
@@ -2777,6 +2853,8 @@ int benchmark_common_tasks_main()
     BENCH(BenchmarkWithIntUIDsRandomOrderRandomCreate);
 
     BENCH(TransactionDuplicate);
+    BENCH(BenchmarkStartReadContended<1>);
+    BENCH(BenchmarkStartReadContended<32>);
 
 #if REALM_ENABLE_GEOSPATIAL
     BENCH(BenchmarkAssignGeoPoints);
@@ -0,0 +1,146 @@
+#include "../util/benchmark_results.hpp"
+#include "../util/timer.hpp"
+#include "../util/test_path.hpp"
+#include "../util/unit_test.hpp"
+#include "../sync_fixtures.hpp"
+
+#include <realm/util/compression.hpp>
+#include <realm/util/load_file.hpp>
+
+#include <cstdlib>
+
+using namespace realm;
+using namespace realm::test_util::unit_test;
+using namespace realm::fixtures;
+
+namespace bench {
+
+extern std::unique_ptr<BenchmarkResults> results;
+
+namespace {
+
+// Changesets of `num_transactions` transactions which each create or update a
+// few objects with string and integer properties.
+std::vector<std::string> make_changesets(TestContext& test_context, size_t num_transactions)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    auto db = DB::create(make_client_replication(), path);
+    {
+        WriteTransaction wt(db);
+        TableRef t = wt.get_group().add_table_with_primary_key("class_Person", type_Int, "_id");
+        t->add_column(type_String, "firstName");
+        t->add_column(type_String, "lastName");
+        t->add_column(type_String, "email");
+        t->add_column(type_Int, "age");
+        wt.commit();
+    }
+    const char* names[] = {"Alice", "Bob", "Carol", "Dave", "Erin", "Frank", "Grace", "Heidi"};
+    for (size_t i = 0; i < num_transactions; ++i) {
+        WriteTransaction wt(db);
+        TableRef t = wt.get_table("class_Person");
+        for (size_t j = 0; j < 4; ++j) {
+            int64_t id = int64_t((i * 7 + j * 251) % 1000);
+            std::string first_name = names[(i + j) % 8];
+            std::string last_name = names[(i * 3 + j) % 8];
+            t->create_object_with_primary_key(id)
+                .set("firstName", first_name)
+                .set("lastName", last_name)
+                .set("email", first_name + "." + last_name + "@example.com")
+                .set("age", int64_t(20 + (i + j) % 50));
+        }
+        wt.commit();
+    }
+
+    auto rt = db->start_read();
+    auto& history = static_cast<ClientReplication*>(db->get_replication())->get_history();
+    std::vector<std::string> changesets;
+    for (auto& change : history.get_local_changes(rt->get_version())) {
+        util::AppendBuffer<char> buffer;
+        change.changeset.copy_to(buffer);
+        changesets.emplace_back(buffer.data(), buffer.size());
+    }
+    return changesets;
+}
+
+// Every file in the directory named by UNITTEST_RECORDED_CHANGESETS is taken
+// as one changeset (or message body), such as ones recorded from a production
+// application. Generated changesets are used if it is not set.
+std::vector<std::string> get_changesets(TestContext& test_context)
+{
+    const char* dir = std::getenv("UNITTEST_RECORDED_CHANGESETS");
+    if (!dir || !*dir)
+        return make_changesets(test_context, 2000);
+
+    std::vector<std::string> changesets;
+    util::DirScanner scanner{dir};
+    std::string name;
+    while (scanner.next(name))
+        changesets.push_back(util::load_file(util::File::resolve(name, dir)));
+    return changesets;
+}
+
+// Compress and decompress each changeset in the second half of the changesets
+// separately, as UPLOAD and DOWNLOAD messages are compressed separately. If
+// `use_dictionary` is true, the compression dictionary is trained on the first
+// half.
+void compress_changesets(TestContext& test_context, int compression_level, bool use_dictionary)
+{
+    std::string ident = test_context.test_details.test_name;
+    auto changesets = get_changesets(test_context);
+    auto training_end = changesets.begin() + changesets.size() / 2;
+
+    std::vector<char> dictionary;
+    if (use_dictionary) {
+        std::vector<util::Span<const char>> samples(changesets.begin(), training_end);
+        dictionary = util::compression::train_dictionary(samples);
+    }
+
+    size_t uncompressed_size = 0;
+    size_t compressed_size = 0;
+    std::vector<char> compressed;
+    std::vector<char> decompressed;
+    for (size_t i = 0; i < 3; ++i) {
+        uncompressed_size = 0;
+        compressed_size = 0;
+        Timer t{Timer::type_RealTime};
+        for (auto it = training_end; it != changesets.end(); ++it) {
+            compressed.resize(util::compression::compress_bound(it->size()));
+            size_t size;
+            CHECK_NOT(util::compression::compress(*it, compressed, size, compression_level, nullptr, dictionary));
+            decompressed.resize(it->size());
+            CHECK_NOT(util::compression::decompress({compressed.data(), size}, decompressed, dictionary));
+            uncompressed_size += it->size();
+            compressed_size += size;
+        }
+        results->submit(ident.c_str(), t.get_elapsed_time());
+    }
+
+    results->finish(ident, ident, "runtime_secs");
+    test_context.logger->info("%1: %2 changesets of %3 bytes compressed to %4 bytes (%5 byte dictionary)", ident,
+                              changesets.end() - training_end, uncompressed_size, compressed_size,
+                              dictionary.size());
+}
+
+} // anonymous namespace
+
+} // namespace bench
+
+TEST(BenchCompressChangesetsDeflate1)
+{
+    bench::compress_changesets(test_context, 1, false);
+}
+
+TEST(BenchCompressChangesetsDeflate6)
+{
+    bench::compress_changesets(test_context, 6, false);
+}
+
+TEST(BenchCompressChangesetsDeflate1Dictionary)
+{
+    bench::compress_changesets(test_context, 1, true);
+}
+
+TEST(BenchCompressChangesetsDeflate6Dictionary)
+{
+    bench::compress_changesets(test_context, 6, true);
+}
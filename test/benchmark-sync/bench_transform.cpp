@@ -11,7 +11,7 @@ using namespace realm::fixtures;
 
 namespace bench {
 
-static std::unique_ptr<BenchmarkResults> results;
+std::unique_ptr<BenchmarkResults> results;
 
 #define TEST_CLIENT_DB(name)                                                                                         \
     SHARED_GROUP_TEST_PATH(name##_path);                                                                             \
@@ -184,6 +184,90 @@ void transform_instructions(TestContext& test_context)
     results->finish(ident, ident, "runtime_secs");
 }
 
+// Two peers have `num_transactions` transactions each, every one of which
+// updates a few out of 1000 objects. One peer receives and merges all
+// transactions from the other on `num_threads` threads. The objects are not
+// linked, so most of them form a conflict group of their own.
+template <size_t num_transactions, unsigned int num_threads>
+void transform_disjoint_objects(TestContext& test_context)
+{
+    std::string ident = test_context.test_details.test_name;
+    const size_t num_objects = 1000;
+
+    for (size_t i = 0; i < 3; ++i) {
+        TEST_CLIENT_DB(db_1);
+        TEST_CLIENT_DB(db_2);
+
+        auto make_transactions = [](DBRef& db, int64_t value) {
+            ColKey col_ndx;
+            {
+                WriteTransaction wt(db);
+                TableRef t = wt.get_group().add_table_with_primary_key("class_t", type_Int, "pk");
+                col_ndx = t->add_column(type_Int, "i");
+                wt.commit();
+            }
+
+            for (size_t j = 0; j < num_transactions; ++j) {
+                WriteTransaction wt(db);
+                TableRef t = wt.get_table("class_t");
+                for (size_t k = 0; k < 4; ++k) {
+                    int64_t pk = int64_t((j * 7 + k * 251) % num_objects);
+                    t->create_object_with_primary_key(pk).set(col_ndx, value + int64_t(j));
+                }
+                wt.commit();
+            }
+        };
+
+        make_transactions(db_1, 0);
+        make_transactions(db_2, 1000000);
+
+        TEST_DIR(dir);
+
+        MultiClientServerFixture::Config config;
+        config.server_public_key_path = "";
+        config.client_transform_threads = num_threads;
+        MultiClientServerFixture fixture(2, 1, dir, test_context, config);
+        Timer t{Timer::type_RealTime};
+
+        Session::Config session_config;
+        session_config.on_sync_client_event_hook = [&](const SyncClientHookData& data) {
+            if (data.num_changesets == 0) {
+                return SyncClientHookAction::NoAction;
+            }
+
+            switch (data.event) {
+                case realm::SyncClientHookEvent::DownloadMessageReceived:
+                    t.reset();
+                    break;
+                case realm::SyncClientHookEvent::DownloadMessageIntegrated:
+                    results->submit(ident.c_str(), t.get_elapsed_time());
+                    break;
+                default:
+                    break;
+            }
+
+            return SyncClientHookAction::NoAction;
+        };
+        Session session_1 = fixture.make_session(0, 0, db_1, "/test", std::move(session_config));
+        Session session_2 = fixture.make_session(1, 0, db_2, "/test");
+
+        // Start server and upload changes of second client.
+        fixture.start_server(0);
+        fixture.start_client(1);
+        session_2.wait_for_upload_complete_or_client_stopped();
+        session_2.wait_for_download_complete_or_client_stopped();
+        session_2.detach();
+        fixture.stop_client(1);
+
+        // Upload changes of first client and wait to integrate changes from second client.
+        fixture.start_client(0);
+        session_1.wait_for_upload_complete_or_client_stopped();
+        session_1.wait_for_download_complete_or_client_stopped();
+    }
+
+    results->finish(ident, ident, "runtime_secs");
+}
+
 template <size_t num_iterations>
 void connected_objects(TestContext& test_context)
 {
@@ -330,6 +414,26 @@ TEST(BenchMergeManyConnectedObjects)
     bench::connected_objects<1000>(test_context);
 }
 
+TEST(BenchMerge2000x2000DisjointObjects1Thread)
+{
+    bench::transform_disjoint_objects<2000, 1>(test_context);
+}
+
+TEST(BenchMerge2000x2000DisjointObjects2Threads)
+{
+    bench::transform_disjoint_objects<2000, 2>(test_context);
+}
+
+TEST(BenchMerge2000x2000DisjointObjects4Threads)
+{
+    bench::transform_disjoint_objects<2000, 4>(test_context);
+}
+
+TEST(BenchMerge2000x2000DisjointObjects8Threads)
+{
+    bench::transform_disjoint_objects<2000, 8>(test_context);
+}
+
 #if !REALM_IOS
 int main()
 {
@@ -3347,6 +3347,174 @@ TEST_CASE("results: notifier with no callbacks", "[notifications][results]") {
     }
 }
 
+TEST_CASE("results: notifier updates results from the changed objects", "[notifications][results]") {
+    _impl::RealmCoordinator::assert_no_open_realms();
+    InMemoryTestFile config;
+    config.automatic_change_notifications = false;
+
+    auto r = Realm::get_shared_realm(config);
+    r->update_schema({
+        {"object",
+         {
+             {"value", PropertyType::Int},
+             {"link", PropertyType::Object | PropertyType::Nullable, "target"},
+         }},
+        {"target",
+         {
+             {"value", PropertyType::Int},
+         }},
+    });
+
+    auto table = r->read_group().get_table("class_object");
+    auto target = r->read_group().get_table("class_target");
+    auto col_value = table->get_column_key("value");
+    auto col_link = table->get_column_key("link");
+    auto col_target_value = target->get_column_key("value");
+
+    // Values 0, 7, 4, 1, 8, 5, 2, 9, 6, 3
+    std::vector<ObjKey> keys;
+    std::vector<ObjKey> target_keys;
+    r->begin_transaction();
+    for (int i = 0; i < 10; ++i) {
+        target_keys.push_back(target->create_object().set(col_target_value, i).get_key());
+        keys.push_back(table->create_object().set(col_value, i * 7 % 10).set(col_link, target_keys[i]).get_key());
+    }
+    r->commit_transaction();
+
+    auto write = [&](auto&& f) {
+        r->begin_transaction();
+        f();
+        r->commit_transaction();
+        advance_and_notify(*r);
+    };
+
+    // The results must be the same as those of running the query again
+    auto check_results = [&](Results& results) {
+        auto expected = results.get_query().find_all(results.get_descriptor_ordering());
+        REQUIRE(results.size() == expected.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            REQUIRE(results.get(i).get_key() == expected.get_key(i));
+        }
+    };
+
+    // Matches 9, 8, 7, 6, 5, 4, 3
+    Results results = Results(r, table->where().greater(col_value, 2)).sort({{"value", false}});
+    int notification_calls = 0;
+    CollectionChangeSet change;
+    auto token = results.add_notification_callback([&](CollectionChangeSet c) {
+        change = c;
+        ++notification_calls;
+    });
+    advance_and_notify(*r);
+    REQUIRE(notification_calls == 1);
+    check_results(results);
+
+    SECTION("insertions, modifications and deletions are merged into sorted results") {
+        write([&] {
+            table->create_object().set(col_value, 10);
+        });
+        REQUIRE(notification_calls == 2);
+        REQUIRE_INDICES(change.insertions, 0);
+        REQUIRE(change.deletions.empty());
+        check_results(results);
+
+        // 10, 9, 8, 7, 6, 5, 4, 3
+        write([&] {
+            table->get_object(keys[2]).set(col_value, 0);
+        });
+        REQUIRE(notification_calls == 3);
+        REQUIRE_INDICES(change.deletions, 6);
+        REQUIRE(change.insertions.empty());
+        check_results(results);
+
+        // 10, 9, 8, 7, 6, 5, 3
+        write([&] {
+            table->get_object(keys[9]).set(col_value, 4);
+        });
+        REQUIRE(notification_calls == 4);
+        REQUIRE_INDICES(change.modifications, 6);
+        REQUIRE_INDICES(change.modifications_new, 6);
+        check_results(results);
+
+        // 10, 9, 8, 7, 6, 5, 4
+        write([&] {
+            table->remove_object(keys[7]);
+        });
+        REQUIRE(notification_calls == 5);
+        REQUIRE_INDICES(change.deletions, 1);
+        check_results(results);
+
+        // Objects with equal values are in key order
+        write([&] {
+            table->get_object(keys[4]).set(col_value, 7);
+            table->create_object().set(col_value, 7);
+            table->get_object(keys[0]).set(col_value, 7);
+        });
+        REQUIRE(notification_calls == 6);
+        check_results(results);
+        REQUIRE(results.size() == 8);
+        REQUIRE(results.get(1).get_key() == keys[0]);
+        REQUIRE(results.get(2).get_key() == keys[1]);
+        REQUIRE(results.get(3).get_key() == keys[4]);
+    }
+
+    SECTION("changes to other tables rerun queries which follow links") {
+        Results linked(r, table->where().and_query(table->link(col_link).column<Int>(col_target_value) > 5));
+        auto linked_token = linked.add_notification_callback([](CollectionChangeSet) {});
+        advance_and_notify(*r);
+        REQUIRE(linked.size() == 4);
+
+        write([&] {
+            target->get_object(target_keys[0]).set(col_target_value, 10);
+            table->get_object(keys[3]).set(col_value, 20);
+        });
+        REQUIRE(linked.size() == 5);
+        check_results(linked);
+        check_results(results);
+    }
+
+    SECTION("results which were not used are not updated from the changes") {
+        // Without callbacks, the notifier skips running once the results it
+        // delivered were not used, and doesn't gather the changes meanwhile
+        token = {};
+        write([&] {
+            table->create_object().set(col_value, 10);
+        });
+        write([&] {
+            table->remove_object(keys[1]);
+        });
+        write([&] {
+            table->get_object(keys[5]).set(col_value, 0);
+        });
+
+        token = results.add_notification_callback([&](CollectionChangeSet c) {
+            change = c;
+            ++notification_calls;
+        });
+        advance_and_notify(*r);
+        check_results(results);
+
+        write([&] {
+            table->get_object(keys[3]).set(col_value, 11);
+        });
+        check_results(results);
+        REQUIRE(results.size() == 7);
+        REQUIRE(results.get(0).get_key() == keys[3]);
+    }
+
+    SECTION("a notifier without callbacks keeps updating results which are used") {
+        token = {};
+        for (int i = 0; i < 5; ++i) {
+            write([&] {
+                table->create_object().set(col_value, 10 + i);
+                table->get_object(keys[i]).set(col_value, i % 2 ? 0 : 5);
+            });
+            check_results(results);
+        }
+        REQUIRE(results.size() == 12);
+    }
+}
+
 TEST_CASE("results: snapshots", "[results]") {
     InMemoryTestFile config;
     config.automatic_change_notifications = false;
@@ -4908,6 +5076,41 @@ TEST_CASE("results: limit", "[results][limit]") {
     }
 }
 
+TEST_CASE("results: explain", "[results]") {
+    InMemoryTestFile config;
+    config.automatic_change_notifications = false;
+    config.schema = Schema{
+        {"object",
+         {
+             {"value", PropertyType::Int, Property::IsPrimary{false}, Property::IsIndexed{true}},
+             {"other", PropertyType::Int},
+         }},
+    };
+
+    auto realm = Realm::get_shared_realm(config);
+    auto table = realm->read_group().get_table("class_object");
+    auto value = table->get_column_key("value");
+    auto other = table->get_column_key("other");
+
+    realm->begin_transaction();
+    for (int i = 0; i < 100; ++i) {
+        table->create_object().set(value, i % 10).set(other, i);
+    }
+    realm->commit_transaction();
+
+    Results r(realm, table->where().greater(other, 50).equal(value, 3));
+    auto plan = r.explain();
+    REQUIRE_THAT(plan, Catch::Matchers::ContainsSubstring("Search: value == 3 (index lookup, 10 matches)"));
+    REQUIRE_THAT(plan, Catch::Matchers::ContainsSubstring("Filter: other > 50 (estimated 49 matches)"));
+    REQUIRE_THAT(plan, Catch::Matchers::ContainsSubstring("Result: 5 objects"));
+
+    plan = r.sort({{"other", false}}).limit(2).explain();
+    REQUIRE_THAT(plan, Catch::Matchers::ContainsSubstring("Ordering: SORT(other DESC) LIMIT(2)"));
+    REQUIRE_THAT(plan, Catch::Matchers::ContainsSubstring("Result after ordering: 2 objects"));
+
+    REQUIRE_THAT(Results(realm, table).explain(), Catch::Matchers::ContainsSubstring("Search: all objects"));
+}
+
 TEST_CASE("results: filter", "[results]") {
     InMemoryTestFile config;
     config.automatic_change_notifications = false;
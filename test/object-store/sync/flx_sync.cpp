@@ -3164,6 +3164,142 @@ TEST_CASE("flx: bootstrap batching prevents orphan documents", "[sync][flx][boot
     }
 }
 
+TEST_CASE("flx: pipelined bootstrap batching", "[sync][flx][bootstrap][baas]") {
+    FLXSyncTestHarness harness("flx_pipelined_bootstrap", {g_large_array_schema, {"queryable_int_field"}});
+
+    std::vector<ObjectId> obj_ids_at_end = fill_large_array_schema(harness);
+    SyncTestFile config(harness.app()->current_user(), harness.schema(), SyncConfig::FLXSyncEnabled{});
+    // One changeset per batch, so that each batch but the last is applied while the next one is read ahead
+    config.sync_config->flx_bootstrap_pipelined = true;
+    config.sync_config->flx_bootstrap_batch_size_bytes = 1;
+
+    auto subscribe_to_all = [](const SharedRealm& realm) {
+        auto mut_subs = realm->get_latest_subscription_set().make_mutable_copy();
+        auto table = realm->read_group().get_table("class_TopLevel");
+        mut_subs.insert_or_assign(Query(table));
+        return mut_subs.commit();
+    };
+
+    auto check_all_objects = [&](const SharedRealm& realm) {
+        auto table = realm->read_group().get_table("class_TopLevel");
+        REQUIRE(table->size() == obj_ids_at_end.size());
+        for (auto& id : obj_ids_at_end) {
+            REQUIRE(table->find_primary_key(Mixed{id}));
+        }
+    };
+
+    SECTION("all batches are applied in order") {
+        std::mutex mutex;
+        std::vector<SyncClientHookData> events;
+        bool bootstrap_processed = false;
+        config.sync_config->on_sync_client_event_hook = [&](std::weak_ptr<SyncSession>,
+                                                            const SyncClientHookData& data) {
+            if (data.query_version != 1) {
+                return SyncClientHookAction::NoAction;
+            }
+            if (data.event == SyncClientHookEvent::BootstrapBatchAboutToProcess ||
+                data.event == SyncClientHookEvent::DownloadMessageIntegrated ||
+                data.event == SyncClientHookEvent::BootstrapProcessed) {
+                std::lock_guard lock(mutex);
+                // Downloads after the bootstrap are integrated too
+                if (!bootstrap_processed) {
+                    events.push_back(data);
+                    bootstrap_processed = data.event == SyncClientHookEvent::BootstrapProcessed;
+                }
+            }
+            return SyncClientHookAction::NoAction;
+        };
+
+        auto realm = Realm::get_shared_realm(config);
+        subscribe_to_all(realm).get_state_change_notification(sync::SubscriptionSet::State::Complete).get();
+        wait_for_advance(*realm);
+        check_all_objects(realm);
+
+        std::lock_guard lock(mutex);
+        REQUIRE(bootstrap_processed);
+        // Each batch is reported before and after it is integrated, followed by the end of the bootstrap
+        REQUIRE(events.size() >= 5);
+        REQUIRE(events.size() % 2 == 1);
+        size_t num_batches = events.size() / 2;
+        REQUIRE(num_batches > 1);
+        for (size_t i = 0; i < num_batches; ++i) {
+            auto& about_to_process = events[2 * i];
+            auto& integrated = events[2 * i + 1];
+            REQUIRE(about_to_process.event == SyncClientHookEvent::BootstrapBatchAboutToProcess);
+            REQUIRE(integrated.event == SyncClientHookEvent::DownloadMessageIntegrated);
+            REQUIRE(about_to_process.num_changesets == 1);
+            REQUIRE(integrated.num_changesets == 1);
+            auto expected_state =
+                i + 1 < num_batches ? sync::DownloadBatchState::MoreToCome : sync::DownloadBatchState::LastInBatch;
+            REQUIRE(about_to_process.batch_state == expected_state);
+            REQUIRE(integrated.batch_state == expected_state);
+        }
+        REQUIRE(events.back().event == SyncClientHookEvent::BootstrapProcessed);
+        REQUIRE(events.back().num_changesets == num_batches);
+    }
+
+    SECTION("exception occurs while the next batch is read ahead") {
+        Status error_status(ErrorCodes::OutOfMemory, "no more memory!");
+        {
+            Realm::Config interrupted_config = config;
+            interrupted_config.sync_config = std::make_shared<SyncConfig>(*config.sync_config);
+            // The next batch is read ahead once a batch which is not the last one is about to be integrated, so
+            // it is still being read or parsed when the integration of the batch fails.
+            interrupted_config.sync_config->on_sync_client_event_hook =
+                [&](std::weak_ptr<SyncSession>, const SyncClientHookData& data) {
+                    if (data.event != SyncClientHookEvent::DownloadMessageIntegrated) {
+                        return SyncClientHookAction::NoAction;
+                    }
+                    if (data.query_version == 1 && data.batch_state == sync::DownloadBatchState::MoreToCome) {
+                        throw sync::IntegrationException(error_status);
+                    }
+                    return SyncClientHookAction::NoAction;
+                };
+            auto error_pf = util::make_promise_future<SyncError>();
+            interrupted_config.sync_config->error_handler =
+                [promise = std::make_shared<util::Promise<SyncError>>(std::move(error_pf.promise))](
+                    std::shared_ptr<SyncSession>, SyncError error) {
+                    promise->emplace_value(std::move(error));
+                };
+
+            auto realm = Realm::get_shared_realm(interrupted_config);
+            subscribe_to_all(realm);
+
+            auto error = error_pf.future.get();
+            REQUIRE(error.status == error_status);
+            realm->sync_session()->shutdown_and_wait();
+            realm->close();
+        }
+
+        _impl::RealmCoordinator::assert_no_open_realms();
+
+        // The batches which were not integrated are still pending, and the subscription is not complete.
+        {
+            DBOptions options;
+            options.encryption_key = test_util::crypt_key();
+            auto db = DB::create(sync::make_client_replication(), config.path, options);
+            auto logger = util::Logger::get_default_logger();
+            sync::PendingBootstrapStore bootstrap_store(db, *logger);
+            REQUIRE(bootstrap_store.has_pending());
+            auto pending_batch = bootstrap_store.peek_pending(1024 * 1024 * 16);
+            REQUIRE(pending_batch.query_version == 1);
+            REQUIRE(pending_batch.progress);
+            REQUIRE(!pending_batch.changesets.empty());
+
+            auto sub_store = sync::SubscriptionStore::create(db);
+            REQUIRE(sub_store->get_latest().state() == sync::SubscriptionSet::State::Bootstrapping);
+        }
+
+        // Opening the Realm again applies the remaining batches.
+        auto realm = Realm::get_shared_realm(config);
+        realm->get_latest_subscription_set()
+            .get_state_change_notification(sync::SubscriptionSet::State::Complete)
+            .get();
+        wait_for_advance(*realm);
+        check_all_objects(realm);
+    }
+}
+
 // Check that a document with the given id is present and has the expected fields
 static void check_document(const std::vector<bson::BsonDocument>& documents, ObjectId id,
                            std::initializer_list<std::pair<const char*, bson::Bson>> fields)
@@ -230,6 +230,8 @@ public:
         m_disable_compaction = b;
     }
 
+    void set_transform_pool(std::shared_ptr<util::WorkStealingPool> pool);
+
     std::map<TableKey, std::unordered_map<GlobalKey, ObjKey>> m_optimistic_object_id_collisions;
 
     ShortCircuitHistory(file_ident_type local_file_ident, TestDirNameGenerator* changeset_dump_dir_gen);
@@ -426,8 +428,8 @@ private:
         m_protocol.make_download_message(sync::get_current_protocol_version(), m_download_message_buffer,
                                          file_ident_type(0), version_type(0), version_type(0), version_type(0), 0,
                                          version_type(0), version_type(0), 0, m_history_entry_count,
-                                         m_history_entries_buffer.data(), m_history_entries_buffer.size(), 0, false,
-                                         logger); // Throws
+                                         m_history_entries_buffer.data(), m_history_entries_buffer.size(), 0,
+                                         sync::BodyCompression::none, logger); // Throws
 
         m_history_entries_buffer.reset();
         m_history_entry_count = 0;
@@ -445,6 +447,11 @@ private:
     OutputBuffer m_download_message_buffer;
 };
 
+inline void ShortCircuitHistory::set_transform_pool(std::shared_ptr<util::WorkStealingPool> pool)
+{
+    m_transformer->set_pool(std::move(pool));
+}
+
 inline ShortCircuitHistory::ShortCircuitHistory(file_ident_type local_file_ident,
                                                 TestDirNameGenerator* changeset_dump_dir_gen)
     : m_write_history(std::make_unique<History>(*this)) // Throws
@@ -448,6 +448,14 @@ public:
 
         bool disable_upload_activation_delay = false;
 
+        unsigned int client_transform_threads = 1;
+
+        std::vector<char> server_compression_dictionary;
+        // One per client, if any
+        std::vector<std::vector<char>> client_compression_dictionaries;
+        // One per client, if any
+        std::vector<bool> client_enable_permessage_deflate;
+
         ClusterTopology cluster_topology = ClusterTopology::separate_nodes;
 
         std::string authorization_header_name = "Authorization";
@@ -532,6 +540,7 @@ public:
             config_2.max_protocol_version = config.server_max_protocol_version;
             config_2.disable_download_for = std::move(config.server_disable_download_for);
             config_2.session_bootstrap_callback = std::move(config.server_session_bootstrap_callback);
+            config_2.compression_dictionary = config.server_compression_dictionary;
             m_servers[i] = std::make_unique<Server>(std::move(dir), std::move(public_key), std::move(config_2));
             m_servers[i]->start(listen_address, listen_port);
             m_server_ports[i] = m_servers[i]->listen_endpoint().port();
@@ -553,6 +562,11 @@ public:
             config_2.one_connection_per_session = config.one_connection_per_session;
             config_2.disable_upload_activation_delay = config.disable_upload_activation_delay;
             config_2.fix_up_object_ids = true;
+            config_2.transform_threads = config.client_transform_threads;
+            if (std::size_t(i) < config.client_compression_dictionaries.size())
+                config_2.compression_dictionary = config.client_compression_dictionaries[i];
+            if (std::size_t(i) < config.client_enable_permessage_deflate.size())
+                config_2.enable_permessage_deflate = config.client_enable_permessage_deflate[i];
             m_clients[i] = std::make_unique<Client>(std::move(config_2));
         }
 
@@ -27,6 +27,7 @@
 
 #include <realm/array_with_find.hpp>
 #include <realm/array_unsigned.hpp>
+#include <realm/integer_compressor.hpp>
 #include <realm/column_integer.hpp>
 #include <realm/query_conditions.hpp>
 
@@ -1494,6 +1495,102 @@ TEST(Array_get_sum)
     c.destroy();
 }
 
+TEST(Array_get_min_max)
+{
+    Array c(Allocator::get_default());
+    c.create(Array::type_Normal);
+
+    int64_t result = 0;
+    size_t ndx = 0;
+    CHECK_NOT(c.get_min(result));
+    CHECK_NOT(c.get_max(result));
+
+    // Long enough for the vectorized kernels, with the extremes placed away
+    // from the vector boundaries
+    const int64_t bounds[] = {1, 3, 15, 127, 32767, 2147483647, 9223372036854775807LL};
+    for (int64_t bound : bounds) {
+        c.clear();
+        for (size_t i = 0; i < 1000; ++i)
+            c.add(int64_t(i % 2) - 1);
+        c.set(613, bound);
+        c.set(871, bound);
+        c.set(77, bound > 1 ? -bound : 0);
+
+        CHECK(c.get_max(result, 0, size_t(-1), &ndx));
+        CHECK_EQUAL(result, bound);
+        CHECK_EQUAL(ndx, 613);
+        CHECK(c.get_min(result, 0, size_t(-1), &ndx));
+        CHECK_EQUAL(result, bound > 1 ? -bound : -1);
+        CHECK_EQUAL(ndx, bound > 1 ? 77 : 0);
+
+        // Sub ranges
+        CHECK(c.get_max(result, 614, 1000, &ndx));
+        CHECK_EQUAL(result, bound);
+        CHECK_EQUAL(ndx, 871);
+        CHECK(c.get_max(result, 614, 871));
+        CHECK_EQUAL(result, 0);
+        CHECK(c.get_min(result, 78, 81, &ndx));
+        CHECK_EQUAL(result, -1);
+        CHECK_EQUAL(ndx, 78);
+        CHECK_NOT(c.get_min(result, 500, 500));
+    }
+
+    c.destroy();
+}
+
+TEST(Array_FindAndSumAllWidths)
+{
+    // Compare find and sum against naive loops for every width, with unaligned
+    // ranges of all lengths around the vector sizes
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    Array c(Allocator::get_default());
+    c.create(Array::type_Normal);
+
+    const int64_t bounds[] = {1, 3, 15, 127, 32767, 2147483647, 9223372036854775807LL};
+    for (int64_t bound : bounds) {
+        c.clear();
+        for (size_t i = 0; i < 300; ++i) {
+            // Few distinct values, so that every condition gets some matches
+            int64_t v = random.draw_int_mod(5) - 2;
+            if (bound > 2 && random.draw_int_mod(10) == 0)
+                v = random.draw_int_mod(2) ? bound : -bound;
+            c.add(v);
+        }
+        for (size_t start = 0; start < 80; start += 7) {
+            for (size_t end = start; end <= c.size(); end += 13) {
+                int64_t needle = c.get(start + (end - start) / 2 < c.size() ? start + (end - start) / 2 : 0);
+                size_t eq = 0, ne = 0, lt = 0, gt = 0;
+                int64_t sum = 0;
+                size_t first = realm::not_found;
+                for (size_t i = start; i < end; ++i) {
+                    int64_t v = c.get(i);
+                    eq += v == needle;
+                    ne += v != needle;
+                    lt += v < needle;
+                    gt += v > needle;
+                    sum += v;
+                    if (v == needle && first == realm::not_found)
+                        first = i;
+                }
+                ArrayWithFind finder(c);
+                QueryStateCount count_eq, count_ne, count_lt, count_gt;
+                finder.find<Equal>(needle, start, end, 0, &count_eq);
+                finder.find<NotEqual>(needle, start, end, 0, &count_ne);
+                finder.find<Less>(needle, start, end, 0, &count_lt);
+                finder.find<Greater>(needle, start, end, 0, &count_gt);
+                CHECK_EQUAL(count_eq.match_count(), eq);
+                CHECK_EQUAL(count_ne.match_count(), ne);
+                CHECK_EQUAL(count_lt.match_count(), lt);
+                CHECK_EQUAL(count_gt.match_count(), gt);
+                CHECK_EQUAL(c.get_sum(start, end), sum);
+                CHECK_EQUAL(c.find_first(needle, start, end), first);
+            }
+        }
+    }
+
+    c.destroy();
+}
+
 // NONCONCURRENT because if run in parallel with other tests which request large amounts of
 // memory, there may be a std::bad_alloc on low memory machines
 NONCONCURRENT_TEST(Array_count)
@@ -1559,4 +1656,97 @@ NONCONCURRENT_TEST(Array_count)
     c.destroy();
 }
 
+TEST(Array_Compressed)
+{
+    Allocator& alloc = Allocator::get_default();
+    Array a(alloc);
+    a.create(Array::type_Normal);
+
+    auto check_compressed = [&](NodeHeader::Encoding expected_encoding) {
+        std::vector<uint64_t> buffer;
+        CHECK(IntegerCompressor::compress(a, buffer));
+        char* header = reinterpret_cast<char*>(buffer.data());
+        CHECK_EQUAL(NodeHeader::get_encoding_from_descriptor(NodeHeader::get_descriptor_from_header(header)),
+                    expected_encoding);
+        CHECK_LESS(buffer.size() * 8, a.get_byte_size());
+        CHECK_EQUAL(NodeHeader::get_byte_size_from_header(header), buffer.size() * 8);
+
+        // The compressed array is read in place
+        Array c(alloc);
+        c.init_from_mem(MemRef(header, 0, alloc));
+        CHECK(c.is_compressed());
+        CHECK_EQUAL(c.size(), a.size());
+        int64_t sum = 0;
+        for (size_t i = 0; i < a.size(); ++i) {
+            CHECK_EQUAL(c.get(i), a.get(i));
+            CHECK_EQUAL(Array::get(header, i), a.get(i));
+            sum += a.get(i);
+        }
+        CHECK_EQUAL(c.get_sum(), sum);
+
+        // Search kernels compare the codes, so probe values at and between
+        // the stored ones
+        for (size_t i = 0; i < a.size(); i += 7) {
+            for (int64_t delta : {-1, 0, 1}) {
+                int64_t v = a.get(i) + delta;
+                CHECK_EQUAL(c.find_first<Equal>(v), a.find_first<Equal>(v));
+                CHECK_EQUAL(c.find_first<NotEqual>(v), a.find_first<NotEqual>(v));
+                CHECK_EQUAL(c.find_first<Greater>(v), a.find_first<Greater>(v));
+                CHECK_EQUAL(c.find_first<Less>(v), a.find_first<Less>(v));
+                for (int cond : {cond_Equal, cond_NotEqual, cond_Greater, cond_Less}) {
+                    QueryStateCount compressed_count;
+                    QueryStateCount plain_count;
+                    ArrayWithFind(c).find(cond, v, 0, c.size(), 0, &compressed_count);
+                    ArrayWithFind(a).find(cond, v, 0, a.size(), 0, &plain_count);
+                    CHECK_EQUAL(compressed_count.match_count(), plain_count.match_count());
+                }
+            }
+        }
+
+        // Cloning expands the array again
+        MemRef clone_mem = Array::clone(c.get_mem(), alloc, alloc);
+        Array clone(alloc);
+        clone.init_from_mem(clone_mem);
+        CHECK_NOT(clone.is_compressed());
+        CHECK_EQUAL(clone.get_width(), a.get_width());
+        for (size_t i = 0; i < a.size(); ++i)
+            CHECK_EQUAL(clone.get(i), a.get(i));
+        clone.destroy();
+    };
+
+    // Timestamp like values in a narrow range: frame of reference
+    for (int64_t i = 0; i < 256; ++i)
+        a.add(1700000000000 + i * 37);
+    check_compressed(NodeHeader::encoding_Packed);
+
+    // Negative values in a narrow range
+    a.clear();
+    for (int64_t i = 0; i < 256; ++i)
+        a.add(-100000 + (i * 7919) % 1000);
+    check_compressed(NodeHeader::encoding_Packed);
+
+    // Few distinct values with a wide range: dictionary
+    a.clear();
+    const int64_t distinct[] = {std::numeric_limits<int64_t>::min(), -5, 0, 1000000007,
+                                std::numeric_limits<int64_t>::max()};
+    for (size_t i = 0; i < 256; ++i)
+        a.add(distinct[(i * 3) % 5]);
+    check_compressed(NodeHeader::encoding_Dict);
+
+    // A single value needs no code bits at all
+    a.clear();
+    for (size_t i = 0; i < 100; ++i)
+        a.add(123456789);
+    check_compressed(NodeHeader::encoding_Packed);
+
+    // Nothing to gain for small values
+    a.clear();
+    for (int64_t i = 0; i < 100; ++i)
+        a.add(i % 2);
+    std::vector<uint64_t> buffer;
+    CHECK_NOT(IntegerCompressor::compress(a, buffer));
+
+    a.destroy();
+}
+
 #endif // TEST_ARRAY
@@ -298,6 +298,58 @@ TEST(ChangesetEncoding_AccentWords)
     CHECK_NOTHROW(parse_changeset(stream, parsed));
 }
 
+TEST(ChangesetEncoding_ParseInPlace)
+{
+    Changeset changeset;
+    auto table = changeset.intern_string("Foo");
+    sync::instr::Update update;
+    update.table = table;
+    update.object = changeset.intern_string("pk");
+    update.field = changeset.intern_string("bar");
+    update.value = Payload{changeset.append_string("value")};
+    changeset.push_back(update);
+    ArrayInsert insert;
+    insert.table = table;
+    insert.object = PrimaryKey{123};
+    insert.field = changeset.intern_string("baz");
+    insert.path.push_back(changeset.intern_string("lol"));
+    insert.path.push_back(5);
+    insert.value = Payload{changeset.append_string("binary"), true};
+    insert.prior_size = 6;
+    changeset.push_back(insert);
+
+    sync::ChangesetEncoder::Buffer buffer;
+    encode_changeset(changeset, buffer);
+    Changeset parsed;
+    parse_changeset_in_place(BinaryData{buffer.data(), buffer.size()}, parsed);
+
+    // The strings are not copied out of the input
+    CHECK(parsed.has_borrowed_strings());
+    CHECK_EQUAL(parsed.string_data().data(), buffer.data());
+    CHECK_EQUAL(parsed.size(), 2);
+    // String values are ranges of the input, so they are compared by contents
+    auto parsed_update = parsed.begin()->get_if<sync::instr::Update>();
+    auto parsed_insert = std::next(parsed.begin())->get_if<ArrayInsert>();
+    CHECK(parsed_update && parsed_insert);
+    CHECK(parsed_update->table == update.table && parsed_update->field == update.field);
+    CHECK(parsed_insert->path == insert.path);
+    CHECK_EQUAL(parsed.get_string(table), "Foo");
+    CHECK_EQUAL(parsed.get_string(parsed_update->value.data.str), "value");
+    CHECK_EQUAL(parsed.get_string(parsed_insert->value.data.binary), "binary");
+
+    sync::ChangesetEncoder::Buffer buffer_2;
+    encode_changeset(parsed, buffer_2);
+    CHECK_EQUAL(std::string_view(buffer.data(), buffer.size()), std::string_view(buffer_2.data(), buffer_2.size()));
+
+    // Adding a string copies the strings into the changeset
+    auto added = parsed.intern_string("added");
+    CHECK_NOT(parsed.has_borrowed_strings());
+    CHECK_EQUAL(parsed.get_string(added), "added");
+    buffer.clear();
+    CHECK_EQUAL(parsed.get_string(table), "Foo");
+    CHECK_EQUAL(parsed.get_string(parsed_update->value.data.str), "value");
+}
+
 void encode_instruction(util::AppendBuffer<char>& buffer, char instr)
 {
     buffer.append(&instr, 1);
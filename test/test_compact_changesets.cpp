@@ -18,9 +18,9 @@ struct InstructionBuilder : InstructionHandler {
     }
     Changeset& m_log;
 
-    void operator()(const Instruction& instr) final
+    void operator()(Instruction instr) final
     {
-        m_log.push_back(instr);
+        m_log.push_back(std::move(instr));
     }
 
     StringBufferRange add_string_range(StringData string) final
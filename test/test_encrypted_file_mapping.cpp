@@ -124,6 +124,57 @@ TEST(EncryptedFile_SeparateCryptors)
     CHECK(memcmp(buffer, data, strlen(data)) == 0);
 }
 
+TEST(EncryptedFile_CryptorBatches)
+{
+    TEST_PATH(path);
+    constexpr size_t page_count = 100; // spans two blocks of IV tables
+    constexpr size_t page_size = 4096;
+
+    std::vector<char> data(page_count * page_size);
+    for (size_t i = 0; i < page_count; ++i)
+        std::fill(data.begin() + i * page_size, data.begin() + (i + 1) * page_size, char(i));
+
+    File file(path, realm::util::File::mode_Write);
+    AESCryptor cryptor(test_key);
+    cryptor.set_data_size(page_count * page_size);
+    std::vector<AESCryptor::Page> pages;
+    for (size_t i = 0; i < page_count; ++i)
+        pages.push_back({File::SizeType(i * page_size), data.data() + i * page_size});
+    cryptor.write_pages(file.get_descriptor(), pages.data(), AESCryptor::max_batch_pages);
+    cryptor.write_pages(file.get_descriptor(), pages.data() + AESCryptor::max_batch_pages,
+                        page_count - AESCryptor::max_batch_pages);
+
+    // The batches can be read back by another cryptor, one page at a time
+    {
+        AESCryptor reader(test_key);
+        reader.set_data_size(page_count * page_size);
+        char buffer[page_size];
+        for (size_t i = 0; i < page_count; i += 7) {
+            CHECK(reader.read(file.get_descriptor(), i * page_size, buffer) == AESCryptor::ReadResult::Success);
+            CHECK(memcmp(buffer, data.data() + i * page_size, page_size) == 0);
+        }
+    }
+
+    // or in batches, which leave the pages which were never written alone
+    {
+        AESCryptor reader(test_key);
+        reader.set_data_size((page_count + 2) * page_size);
+        std::vector<char> buffer((page_count + 2) * page_size, 'x');
+        std::vector<AESCryptor::Page> read_pages;
+        for (size_t i = page_count - 20; i < page_count + 2; ++i)
+            read_pages.push_back({File::SizeType(i * page_size), buffer.data() + i * page_size});
+        reader.read_pages(file.get_descriptor(), read_pages.data(), read_pages.size());
+        for (size_t i = 0; i < 20; ++i) {
+            CHECK(read_pages[i].done);
+            size_t pos = (page_count - 20 + i) * page_size;
+            CHECK(memcmp(buffer.data() + pos, data.data() + pos, page_size) == 0);
+        }
+        CHECK_NOT(read_pages[20].done);
+        CHECK_NOT(read_pages[21].done);
+        CHECK_EQUAL(buffer[page_count * page_size], 'x');
+    }
+}
+
 TEST(EncryptedFile_InterruptedWrite)
 {
     TEST_PATH(path);
@@ -324,6 +375,95 @@ TEST(EncryptedFile_GapsOfNeverWrittenPages)
     }
 }
 
+TEST(EncryptedFile_SequentialReads)
+{
+    constexpr size_t page_count = 200;
+    TEST_PATH(path);
+    {
+        File f(path, File::mode_Write);
+        f.set_encryption_key(test_util::crypt_key(true));
+        f.resize(page_size() * page_count);
+        File::Map<char> map(f, 0, File::access_ReadWrite, page_count * page_size());
+        util::encryption_read_barrier(map, 0, map.get_size());
+        for (size_t i = 0; i < page_count; ++i)
+            std::fill(map.get_addr() + i * page_size(), map.get_addr() + (i + 1) * page_size(), char(i));
+        util::encryption_write_barrier(map, 0, map.get_size());
+    }
+
+    File f(path, File::mode_Read);
+    f.set_encryption_key(test_util::crypt_key(true));
+    // Large reads are decrypted in batches
+    {
+        File::Map<char> map(f, 0, File::access_ReadOnly, page_count * page_size());
+        util::encryption_read_barrier(map, 0, map.get_size());
+        for (size_t i = 0; i < page_count; ++i)
+            CHECK_EQUAL(map.get_addr()[i * page_size() + 17], char(i));
+    }
+    // and small sequential reads decrypt the following pages ahead of them
+    {
+        File::Map<char> map(f, 0, File::access_ReadOnly, page_count * page_size());
+        for (size_t pos = 0; pos < map.get_size(); pos += 1000) {
+            util::encryption_read_barrier(map, pos, 8);
+            CHECK_EQUAL(map.get_addr()[pos], char(pos / page_size()));
+        }
+    }
+}
+
+TEST(EncryptedFile_PageBudget)
+{
+    constexpr size_t page_count = 200;
+    constexpr size_t budget = 32;
+    TEST_PATH(path);
+    {
+        File f(path, File::mode_Write);
+        f.set_encryption_key(test_util::crypt_key(true));
+        f.resize(page_size() * page_count);
+        File::Map<char> map(f, 0, File::access_ReadWrite, page_count * page_size());
+        util::encryption_read_barrier(map, 0, map.get_size());
+        for (size_t i = 0; i < page_count; ++i)
+            std::fill(map.get_addr() + i * page_size(), map.get_addr() + (i + 1) * page_size(), char(i + 1));
+        util::encryption_write_barrier(map, 0, map.get_size());
+    }
+
+    File f(path, File::mode_Read);
+    f.set_encryption_key(test_util::crypt_key(true));
+    File::Map<char> map(f, 0, File::access_ReadOnly, page_count * page_size());
+    EncryptedFile* encryption = f.get_encryption();
+    encryption->set_page_budget(budget * page_size() / EncryptedFile::page_size);
+
+    auto read = [&](size_t begin) {
+        uint64_t reader = encryption->note_reader_start();
+        util::encryption_read_barrier(map, begin * page_size(), 4 * page_size());
+        for (size_t i = begin; i < begin + 4; ++i)
+            CHECK_EQUAL(map.get_addr()[i * page_size() + 17], char(i + 1));
+        encryption->note_reader_end(reader);
+    };
+    for (size_t pass = 0; pass < 2; ++pass) {
+        for (size_t i = 0; i < page_count; i += 4)
+            read(i);
+    }
+    auto stats = encryption->get_page_stats();
+    CHECK_GREATER(stats.evictions, 0);
+    // Released pages are decrypted again when read again
+    CHECK_GREATER(stats.misses + stats.read_ahead, page_count);
+    // The budget may be exceeded by the pages in use and those read ahead
+    CHECK_LESS_EQUAL(stats.pages * EncryptedFile::page_size, (budget + 4 + 16) * page_size());
+
+    // Pages accessed after a reader started are not released until it ends
+    uint64_t reader = encryption->note_reader_start();
+    util::encryption_read_barrier(map, 0, 4 * page_size());
+    for (size_t i = 4; i < page_count; i += 4)
+        read(i);
+    for (size_t i = 0; i < 4; ++i)
+        CHECK_EQUAL(map.get_addr()[i * page_size() + 17], char(i + 1));
+    CHECK_GREATER(encryption->get_page_stats().pages, budget);
+    encryption->note_reader_end(reader);
+
+    // Lowering the budget releases pages right away
+    encryption->set_page_budget(8 * page_size() / EncryptedFile::page_size);
+    CHECK_LESS_EQUAL(encryption->get_page_stats().pages * EncryptedFile::page_size, 8 * page_size());
+}
+
 TEST(EncryptedFile_MultipleWriterMappings)
 {
     const size_t count = 4096 * 64 * 2; // i.e. two metablocks of data
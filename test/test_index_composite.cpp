@@ -0,0 +1,397 @@
+/*************************************************************************
+ *
+ * Copyright 2024 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include "testsettings.hpp"
+#ifdef TEST_INDEX_COMPOSITE
+
+#include <realm.hpp>
+#include <realm/index_composite.hpp>
+
+#include <set>
+
+#include "test.hpp"
+#include "util/random.hpp"
+
+using namespace realm;
+using namespace realm::test_util;
+
+// Test independence and thread-safety
+// -----------------------------------
+//
+// All tests must be thread safe and independent of each other. This
+// is required because it allows for both shuffling of the execution
+// order and for parallelized testing.
+//
+// In particular, avoid using std::rand() since it is not guaranteed
+// to be thread safe. Instead use the API offered in
+// `test/util/random.hpp`.
+//
+// All files created in tests must use the TEST_PATH macro (or one of
+// its friends) to obtain a suitable file system path. See
+// `test/util/test_path.hpp`.
+
+
+namespace {
+
+// Query::equal() with a Mixed only handles some types of columns
+Query& equal(Query& q, ColKey col, Mixed value)
+{
+    if (value.is_null())
+        return q.equal(col, null());
+    if (value.is_type(type_String))
+        return q.equal(col, value.get_string());
+    if (value.is_type(type_Int))
+        return q.equal(col, value.get_int());
+    return q.equal(col, value);
+}
+
+std::vector<ObjKey> keys_of(const TableView& tv)
+{
+    std::vector<ObjKey> keys;
+    for (size_t i = 0; i < tv.size(); ++i)
+        keys.push_back(tv.get_key(i));
+    return keys;
+}
+
+// A table with pairs of columns holding the same values, the first of each
+// pair covered by a composite index and the second not
+struct IndexedTable {
+    Table table;
+    ColKey int_col, int_ref;
+    ColKey str_col, str_ref;
+    ColKey ts_col, ts_ref;
+    ColKey bool_col, bool_ref;
+    ColKey oid_col, oid_ref;
+
+    IndexedTable()
+    {
+        int_col = table.add_column(type_Int, "int", true);
+        int_ref = table.add_column(type_Int, "int_ref", true);
+        str_col = table.add_column(type_String, "str", true);
+        str_ref = table.add_column(type_String, "str_ref", true);
+        ts_col = table.add_column(type_Timestamp, "ts", true);
+        ts_ref = table.add_column(type_Timestamp, "ts_ref", true);
+        bool_col = table.add_column(type_Bool, "bool", true);
+        bool_ref = table.add_column(type_Bool, "bool_ref", true);
+        oid_col = table.add_column(type_ObjectId, "oid", true);
+        oid_ref = table.add_column(type_ObjectId, "oid_ref", true);
+    }
+
+    void add_indexes()
+    {
+        table.add_composite_index({int_col, str_col, ts_col});
+        table.add_composite_index({bool_col, oid_col});
+    }
+
+    static std::string str(int64_t v)
+    {
+        return util::format("s%1", v);
+    }
+    static ObjectId oid(int64_t v)
+    {
+        std::string hex = util::format("%1", 1000 + v);
+        return ObjectId((std::string(24 - hex.size(), '0') + hex).c_str());
+    }
+
+    void set(Obj obj, int64_t v)
+    {
+        auto set_pair = [&](ColKey col, ColKey ref, Mixed value) {
+            obj.set_any(col, value);
+            obj.set_any(ref, value);
+        };
+        set_pair(int_col, int_ref, v % 11 == 0 ? Mixed() : Mixed(v % 7));
+        std::string s = str(v % 5);
+        set_pair(str_col, str_ref, v % 13 == 0 ? Mixed() : Mixed(StringData(s)));
+        set_pair(ts_col, ts_ref, Timestamp(v % 3, 0));
+        set_pair(bool_col, bool_ref, v % 17 == 0 ? Mixed() : Mixed(v % 2 == 0));
+        set_pair(oid_col, oid_ref, oid(v % 9));
+    }
+
+    // Check the lookups in the composite indexes against queries on the
+    // reference columns, for all value combinations in the table
+    void check_lookups(unit_test::TestContext& test_context)
+    {
+        for (auto& index : table.get_composite_indexes())
+            index->verify();
+        std::set<std::vector<Mixed>> tuples;
+        for (auto& obj : table)
+            tuples.insert({obj.get_any(int_col), obj.get_any(str_col), obj.get_any(ts_col)});
+        std::vector<ColKey> refs = {int_ref, str_ref, ts_ref};
+        const CompositeIndex& index = *table.get_composite_indexes()[0];
+        for (auto& tuple : tuples) {
+            for (size_t len = 1; len <= tuple.size(); ++len) {
+                std::vector<Mixed> values(tuple.begin(), tuple.begin() + len);
+                Query q = table.where();
+                for (size_t i = 0; i < len; ++i)
+                    equal(q, refs[i], values[i]);
+                std::vector<ObjKey> expected = keys_of(q.find_all());
+                std::vector<ObjKey> found;
+                index.find_all(found, values);
+                std::sort(found.begin(), found.end());
+                CHECK(found == expected);
+                CHECK_EQUAL(index.count(values), expected.size());
+            }
+        }
+        CHECK_EQUAL(index.count({}), table.size());
+    }
+};
+
+} // anonymous namespace
+
+
+TEST(IndexComposite_Maintenance)
+{
+    IndexedTable t;
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    for (int i = 0; i < 300; ++i)
+        t.set(t.table.create_object(), random.draw_int<int64_t>(0, 100));
+
+    // Populate from existing objects
+    t.add_indexes();
+    CHECK(t.table.has_composite_index({t.int_col, t.str_col, t.ts_col}));
+    CHECK(!t.table.has_composite_index({t.int_col, t.str_col}));
+    CHECK(!t.table.has_composite_index({t.str_col, t.int_col, t.ts_col}));
+    t.check_lookups(test_context);
+
+    // Insert, modify and remove
+    for (int i = 0; i < 300; ++i)
+        t.set(t.table.create_object(), random.draw_int<int64_t>(0, 100));
+    for (int i = 0; i < 300; ++i)
+        t.set(t.table.get_object(random.draw_int<size_t>(0, t.table.size() - 1)),
+              random.draw_int<int64_t>(0, 100));
+    for (int i = 0; i < 50; ++i) {
+        auto obj = t.table.get_object(random.draw_int<size_t>(0, t.table.size() - 1));
+        if (!obj.is_null(t.int_col)) {
+            obj.add_int(t.int_col, 3);
+            obj.add_int(t.int_ref, 3);
+        }
+        obj.set_null(t.str_col);
+        obj.set_null(t.str_ref);
+    }
+    for (int i = 0; i < 100; ++i)
+        t.table.remove_object(t.table.get_object(random.draw_int<size_t>(0, t.table.size() - 1)).get_key());
+    t.table.add_column(type_Int, "other");
+    t.table.create_object();
+    t.check_lookups(test_context);
+
+    // Adding an index again has no effect, removing it removes it
+    t.table.add_composite_index({t.bool_col, t.oid_col});
+    CHECK_EQUAL(t.table.get_composite_indexes().size(), 2);
+    t.table.remove_composite_index({t.bool_col, t.oid_col});
+    CHECK_EQUAL(t.table.get_composite_indexes().size(), 1);
+    CHECK(!t.table.has_composite_index({t.bool_col, t.oid_col}));
+    t.table.remove_composite_index({t.bool_col, t.oid_col});
+    t.set(t.table.create_object(), 1);
+    t.check_lookups(test_context);
+
+    // Unsupported columns
+    auto double_col = t.table.add_column(type_Double, "double");
+    auto list_col = t.table.add_column_list(type_Int, "list");
+    CHECK_THROW(t.table.add_composite_index({}), InvalidArgument);
+    CHECK_THROW(t.table.add_composite_index({t.int_col, t.int_col}), InvalidArgument);
+    CHECK_THROW(t.table.add_composite_index({t.int_col, double_col}), IllegalOperation);
+    CHECK_THROW(t.table.add_composite_index({list_col}), IllegalOperation);
+    CHECK_THROW(t.table.add_composite_index({t.int_col, ColKey()}), InvalidColumnKey);
+
+    t.table.clear();
+    CHECK_EQUAL(t.table.get_composite_indexes()[0]->count({}), 0);
+}
+
+TEST(IndexComposite_Queries)
+{
+    IndexedTable t;
+    for (int64_t i = 0; i < 2000; ++i)
+        t.set(t.table.create_object(), (i * 7919) % 1000);
+    t.add_indexes();
+
+    auto check = [&](Query indexed, Query reference) {
+        auto expected = keys_of(reference.find_all());
+        CHECK(keys_of(indexed.find_all()) == expected);
+        CHECK_EQUAL(indexed.count(), expected.size());
+        CHECK_EQUAL(indexed.find(), expected.empty() ? ObjKey() : expected.front());
+        CHECK_EQUAL(indexed.sum(t.int_ref), reference.sum(t.int_ref));
+    };
+
+    for (int64_t i = 0; i < 8; ++i) {
+        std::string str = IndexedTable::str(i % 5);
+        StringData s(str);
+        Timestamp ts(i % 3, 0);
+        std::vector<Mixed> list = {i, 4};
+
+        // Full and partial prefixes, in any order of the conditions
+        check(t.table.where().equal(t.int_col, i), t.table.where().equal(t.int_ref, i));
+        check(t.table.where().equal(t.int_col, i).equal(t.str_col, s),
+              t.table.where().equal(t.int_ref, i).equal(t.str_ref, s));
+        check(t.table.where().equal(t.str_col, s).equal(t.int_col, i),
+              t.table.where().equal(t.str_ref, s).equal(t.int_ref, i));
+        check(t.table.where().equal(t.ts_col, ts).equal(t.int_col, i).equal(t.str_col, s),
+              t.table.where().equal(t.ts_ref, ts).equal(t.int_ref, i).equal(t.str_ref, s));
+        check(t.table.where().equal(t.bool_col, i % 2 == 0).equal(t.oid_col, IndexedTable::oid(i)),
+              t.table.where().equal(t.bool_ref, i % 2 == 0).equal(t.oid_ref, IndexedTable::oid(i)));
+
+        // Columns which are not a prefix of the index, and other conditions
+        check(t.table.where().equal(t.str_col, s).equal(t.ts_col, ts),
+              t.table.where().equal(t.str_ref, s).equal(t.ts_ref, ts));
+        check(t.table.where().equal(t.int_col, i).equal(t.str_col, s).greater(t.ts_ref, Timestamp(0, 0)),
+              t.table.where().equal(t.int_ref, i).equal(t.str_ref, s).greater(t.ts_ref, Timestamp(0, 0)));
+        check(t.table.where().equal(t.int_col, i).equal(t.int_col, i + 1).equal(t.str_col, s),
+              t.table.where().equal(t.int_ref, i).equal(t.int_ref, i + 1).equal(t.str_ref, s));
+        check(t.table.where().equal(t.int_col, i).equal(t.str_col, s).Or().equal(t.int_col, 3),
+              t.table.where().equal(t.int_ref, i).equal(t.str_ref, s).Or().equal(t.int_ref, 3));
+        check(t.table.where().Not().equal(t.int_col, i).equal(t.str_col, s),
+              t.table.where().Not().equal(t.int_ref, i).equal(t.str_ref, s));
+        check(t.table.where().equal(t.str_col, s).in(t.int_col, list.data(), list.data() + list.size()),
+              t.table.where().equal(t.str_ref, s).equal(t.int_ref, i).Or().equal(t.str_ref, s).equal(t.int_ref, 4));
+    }
+
+    // Nulls are indexed too
+    check(t.table.where().equal(t.int_col, null()).equal(t.str_col, null()),
+          t.table.where().equal(t.int_ref, null()).equal(t.str_ref, null()));
+    check(t.table.where().equal(t.int_col, null()).equal(t.str_col, "s1"),
+          t.table.where().equal(t.int_ref, null()).equal(t.str_ref, "s1"));
+    check(t.table.where().equal(t.bool_col, null()).equal(t.oid_col, IndexedTable::oid(0)),
+          t.table.where().equal(t.bool_ref, null()).equal(t.oid_ref, IndexedTable::oid(0)));
+
+    // With indexes on the single columns as well
+    t.table.add_search_index(t.int_col);
+    t.table.add_search_index(t.str_col);
+    check(t.table.where().equal(t.int_col, 2), t.table.where().equal(t.int_ref, 2));
+    check(t.table.where().equal(t.int_col, 2).equal(t.str_col, "s2"),
+          t.table.where().equal(t.int_ref, 2).equal(t.str_ref, "s2"));
+    check(t.table.where().equal(t.str_col, "s1").equal(t.ts_col, Timestamp(1, 0)).equal(t.int_col, 1),
+          t.table.where().equal(t.str_ref, "s1").equal(t.ts_ref, Timestamp(1, 0)).equal(t.int_ref, 1));
+
+    // Modifications after the query was built are seen by the next run
+    auto q = t.table.where().equal(t.int_col, 2).equal(t.str_col, "s2");
+    auto ref = t.table.where().equal(t.int_ref, 2).equal(t.str_ref, "s2");
+    size_t before = q.count();
+    auto tv = t.table.where().equal(t.int_ref, 2).find_all();
+    for (size_t ndx = 0; ndx < tv.size(); ++ndx) {
+        auto obj = tv.get_object(ndx);
+        obj.set(t.str_col, "s2");
+        obj.set(t.str_ref, "s2");
+    }
+    CHECK_EQUAL(q.count(), ref.count());
+    CHECK_GREATER_EQUAL(q.count(), before);
+}
+
+TEST(IndexComposite_SchemaChanges)
+{
+    IndexedTable t;
+    for (int64_t i = 0; i < 200; ++i)
+        t.set(t.table.create_object(), i);
+    t.add_indexes();
+
+    // Changing the nullability of a column keeps the indexes covering it
+    auto str_col = t.table.set_nullability(t.str_col, false, false);
+    CHECK(t.table.has_composite_index({t.int_col, str_col, t.ts_col}));
+    CHECK_EQUAL(t.table.where().equal(t.int_col, 3).equal(str_col, "").count(),
+                t.table.where().equal(t.int_ref, 3).equal(t.str_ref, null()).count());
+    t.table.get_composite_indexes()[0]->verify();
+
+    // Removing a column removes the indexes covering it
+    t.table.remove_column(t.ts_col);
+    CHECK_EQUAL(t.table.get_composite_indexes().size(), 1);
+    CHECK(t.table.has_composite_index({t.bool_col, t.oid_col}));
+    CHECK_EQUAL(t.table.where().equal(t.bool_col, true).equal(t.oid_col, IndexedTable::oid(4)).count(),
+                t.table.where().equal(t.bool_ref, true).equal(t.oid_ref, IndexedTable::oid(4)).count());
+}
+
+TEST(IndexComposite_Transactions)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    auto db = DB::create(make_in_realm_history(), path);
+    ColKey a, b;
+    {
+        auto wt = db->start_write();
+        auto table = wt->add_table("table");
+        a = table->add_column(type_Int, "a");
+        b = table->add_column(type_String, "b");
+        for (int64_t i = 0; i < 100; ++i)
+            table->create_object().set(a, i % 10).set(b, util::format("%1", i % 7));
+        table->add_composite_index({a, b});
+        wt->commit();
+    }
+    auto rt = db->start_read();
+    auto table = rt->get_table("table");
+    CHECK(table->has_composite_index({a, b}));
+    CHECK_EQUAL(table->where().equal(a, 3).equal(b, "3").count(), 2);
+    {
+        auto wt = db->start_write();
+        auto table = wt->get_table("table");
+        for (int64_t i = 0; i < 10; ++i)
+            table->create_object().set(a, 3).set(b, "3");
+        table->get_object(3).set(b, "4");
+        wt->commit();
+    }
+    rt->advance_read();
+    CHECK_EQUAL(table->where().equal(a, 3).equal(b, "3").count(), 11);
+    table->get_composite_indexes()[0]->verify();
+
+    // Changes which are rolled back leave the index as it was
+    {
+        auto wt = db->start_write();
+        auto table = wt->get_table("table");
+        table->add_composite_index({b});
+        table->clear();
+        wt->rollback();
+    }
+    {
+        auto wt = db->start_write();
+        auto table = wt->get_table("table");
+        CHECK_EQUAL(table->get_composite_indexes().size(), 1);
+        table->remove_composite_index({a, b});
+        wt->commit();
+    }
+    rt->advance_read();
+    CHECK(!table->has_composite_index({a, b}));
+    CHECK_EQUAL(table->where().equal(a, 3).equal(b, "3").count(), 11);
+}
+
+TEST(IndexComposite_FileFormat)
+{
+    // Older versions would leave a composite index stale, so a file holding
+    // one must have a file format which they refuse to open
+    SHARED_GROUP_TEST_PATH(path);
+    _impl::GroupFriend::fake_target_file_format(24);
+    {
+        auto db = DB::create(make_in_realm_history(), path);
+        auto wt = db->start_write();
+        auto table = wt->add_table("table");
+        table->add_column(type_Int, "a");
+        table->add_column(type_String, "b");
+        wt->commit();
+    }
+    _impl::GroupFriend::fake_target_file_format({});
+    {
+        auto db = DB::create(make_in_realm_history(), path);
+        auto wt = db->start_write();
+        auto table = wt->get_table("table");
+        table->add_composite_index({table->get_column_key("a"), table->get_column_key("b")});
+        wt->commit();
+    }
+    {
+        Group g(path);
+        CHECK_EQUAL(_impl::GroupFriend::get_file_format_version(g), 25);
+        auto table = g.get_table("table");
+        CHECK(table->has_composite_index({table->get_column_key("a"), table->get_column_key("b")}));
+    }
+    util::File::try_remove(BackupHandler::get_prefix_from_path(path) + "v24.backup.realm");
+}
+
+#endif // TEST_INDEX_COMPOSITE
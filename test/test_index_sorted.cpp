@@ -0,0 +1,348 @@
+/*************************************************************************
+ *
+ * Copyright 2024 Realm Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ **************************************************************************/
+
+#include "testsettings.hpp"
+#ifdef TEST_INDEX_SORTED
+
+#include <realm.hpp>
+#include <realm/index_sorted.hpp>
+
+#include "test.hpp"
+#include "util/random.hpp"
+
+using namespace realm;
+using namespace realm::test_util;
+
+// Test independence and thread-safety
+// -----------------------------------
+//
+// All tests must be thread safe and independent of each other. This
+// is required because it allows for both shuffling of the execution
+// order and for parallelized testing.
+//
+// In particular, avoid using std::rand() since it is not guaranteed
+// to be thread safe. Instead use the API offered in
+// `test/util/random.hpp`.
+//
+// All files created in tests must use the TEST_PATH macro (or one of
+// its friends) to obtain a suitable file system path. See
+// `test/util/test_path.hpp`.
+
+
+namespace {
+
+std::vector<ObjKey> keys_of(const TableView& tv)
+{
+    std::vector<ObjKey> keys;
+    for (size_t i = 0; i < tv.size(); ++i)
+        keys.push_back(tv.get_key(i));
+    return keys;
+}
+
+// A table with pairs of columns holding the same values, the first of each
+// pair with a sorted index and the second without
+struct IndexedTable {
+    Table table;
+    ColKey int_col, int_ref;
+    ColKey double_col, double_ref;
+    ColKey ts_col, ts_ref;
+    ColKey str_col, str_ref;
+
+    IndexedTable()
+    {
+        int_col = table.add_column(type_Int, "int", true);
+        int_ref = table.add_column(type_Int, "int_ref", true);
+        double_col = table.add_column(type_Double, "double");
+        double_ref = table.add_column(type_Double, "double_ref");
+        ts_col = table.add_column(type_Timestamp, "ts", true);
+        ts_ref = table.add_column(type_Timestamp, "ts_ref", true);
+        str_col = table.add_column(type_String, "str", true);
+        str_ref = table.add_column(type_String, "str_ref", true);
+    }
+
+    void add_indexes()
+    {
+        for (auto col : {int_col, double_col, ts_col, str_col})
+            table.add_search_index(col, IndexType::Sorted);
+    }
+
+    void set(Obj obj, int64_t v)
+    {
+        if (v % 13 == 0) {
+            obj.set_null(int_col);
+            obj.set_null(int_ref);
+            obj.set_null(ts_col);
+            obj.set_null(ts_ref);
+            obj.set_null(str_col);
+            obj.set_null(str_ref);
+        }
+        else {
+            obj.set(int_col, v);
+            obj.set(int_ref, v);
+            obj.set(ts_col, Timestamp(v, 0));
+            obj.set(ts_ref, Timestamp(v, 0));
+            std::string s = util::format("s%1", 10000 + v);
+            obj.set(str_col, StringData(s));
+            obj.set(str_ref, StringData(s));
+        }
+        double d = (v % 17 == 0) ? std::numeric_limits<double>::quiet_NaN() : double(v) / 2;
+        obj.set(double_col, d);
+        obj.set(double_ref, d);
+    }
+};
+
+} // anonymous namespace
+
+
+TEST(IndexSorted_Maintenance)
+{
+    IndexedTable t;
+    Random random(random_int<unsigned long>()); // Seed from slow global generator
+    for (int64_t i = 0; i < 300; ++i)
+        t.set(t.table.create_object(), random.draw_int<int64_t>(0, 100));
+
+    // Populate from existing objects
+    t.add_indexes();
+    CHECK_EQUAL(t.table.search_index_type(t.int_col), IndexType::Sorted);
+    CHECK_EQUAL(t.table.search_index_type(t.int_ref), IndexType::None);
+
+    // Insert, modify and remove
+    for (int64_t i = 0; i < 300; ++i)
+        t.set(t.table.create_object(), random.draw_int<int64_t>(0, 100));
+    for (int i = 0; i < 300; ++i)
+        t.set(t.table.get_object(random.draw_int<size_t>(0, t.table.size() - 1)),
+              random.draw_int<int64_t>(0, 100));
+    for (int i = 0; i < 100; ++i)
+        t.table.remove_object(t.table.get_object(random.draw_int<size_t>(0, t.table.size() - 1)).get_key());
+    t.table.add_column(type_Int, "other");
+    t.table.create_object();
+
+    for (auto col : {t.int_col, t.double_col, t.ts_col, t.str_col}) {
+        auto index = static_cast<const SortedIndex*>(t.table.get_search_index(col));
+        index->verify();
+        // An open range holds all values but nulls and NaNs
+        size_t expected = 0;
+        for (auto& obj : t.table)
+            expected += SortedIndex::is_null_or_nan(obj.get_any(col)) ? 0 : 1;
+        CHECK_EQUAL(index->count(SortedIndex::Range{}), expected);
+    }
+
+    // Equality lookups
+    auto index = t.table.get_search_index(t.int_col);
+    for (int64_t v = 0; v <= 100; ++v) {
+        std::vector<ObjKey> found;
+        index->find_all(found, v);
+        std::vector<ObjKey> expected = keys_of(t.table.where().equal(t.int_ref, v).find_all());
+        CHECK(found == expected);
+        CHECK_EQUAL(index->count(v), expected.size());
+        CHECK_EQUAL(t.table.find_first_int(t.int_col, v), expected.empty() ? ObjKey() : expected.front());
+    }
+    CHECK_EQUAL(index->count(Mixed()), t.table.where().equal(t.int_ref, null()).count());
+
+    // Replacing the index by another kind
+    t.table.add_search_index(t.int_col, IndexType::General);
+    CHECK_EQUAL(t.table.search_index_type(t.int_col), IndexType::General);
+    CHECK_EQUAL(t.table.count_int(t.int_col, 5), t.table.count_int(t.int_ref, 5));
+    t.table.remove_search_index(t.int_col);
+    CHECK_EQUAL(t.table.search_index_type(t.int_col), IndexType::None);
+
+    // Unsupported columns
+    auto bool_col = t.table.add_column(type_Bool, "bool");
+    auto list_col = t.table.add_column_list(type_Int, "list");
+    CHECK_THROW(t.table.add_search_index(bool_col, IndexType::Sorted), IllegalOperation);
+    CHECK_THROW(t.table.add_search_index(list_col, IndexType::Sorted), IllegalOperation);
+
+    t.table.clear();
+    CHECK(t.table.get_search_index(t.str_col)->is_empty());
+}
+
+TEST(IndexSorted_RangeQueries)
+{
+    IndexedTable t;
+    for (int64_t i = 0; i < 2000; ++i)
+        t.set(t.table.create_object(), (i * 7919) % 1000);
+    t.add_indexes();
+
+    auto check = [&](Query indexed, Query reference) {
+        auto expected = keys_of(reference.find_all());
+        CHECK(keys_of(indexed.find_all()) == expected);
+        CHECK_EQUAL(indexed.count(), expected.size());
+        CHECK_EQUAL(indexed.find(), expected.empty() ? ObjKey() : expected.front());
+    };
+
+    for (int64_t v : {-1, 0, 13, 500, 980, 999, 1000}) {
+        check(t.table.where().greater(t.int_col, v), t.table.where().greater(t.int_ref, v));
+        check(t.table.where().greater_equal(t.int_col, v), t.table.where().greater_equal(t.int_ref, v));
+        check(t.table.where().less(t.int_col, v), t.table.where().less(t.int_ref, v));
+        check(t.table.where().less_equal(t.int_col, v), t.table.where().less_equal(t.int_ref, v));
+        check(t.table.where().between(t.int_col, v, v + 20), t.table.where().between(t.int_ref, v, v + 20));
+
+        double d = double(v) / 2;
+        check(t.table.where().greater(t.double_col, d), t.table.where().greater(t.double_ref, d));
+        check(t.table.where().less_equal(t.double_col, d), t.table.where().less_equal(t.double_ref, d));
+
+        Timestamp ts(v, 0);
+        check(t.table.where().greater_equal(t.ts_col, ts), t.table.where().greater_equal(t.ts_ref, ts));
+        check(t.table.where().less(t.ts_col, ts), t.table.where().less(t.ts_ref, ts));
+        check(t.table.where().between(t.ts_col, ts, Timestamp(v + 10, 0)),
+              t.table.where().between(t.ts_ref, ts, Timestamp(v + 10, 0)));
+
+        std::string str = util::format("s%1", 10000 + v);
+        StringData s(str);
+        check(t.table.where().greater(t.str_col, s), t.table.where().greater(t.str_ref, s));
+        check(t.table.where().less(t.str_col, s), t.table.where().less(t.str_ref, s));
+        check(t.table.where().less_equal(t.str_col, s), t.table.where().less_equal(t.str_ref, s));
+
+        // Ranges combined from several conditions, and combined with conditions on other columns
+        check(t.table.where().greater(t.int_col, v).less(t.int_col, v + 30),
+              t.table.where().greater(t.int_ref, v).less(t.int_ref, v + 30));
+        check(t.table.where().less_equal(t.ts_col, Timestamp(v + 5, 0)).greater_equal(t.ts_col, ts),
+              t.table.where().less_equal(t.ts_ref, Timestamp(v + 5, 0)).greater_equal(t.ts_ref, ts));
+        check(t.table.where().greater(t.double_col, d).less(t.double_col, d + 10).greater(t.int_ref, 3),
+              t.table.where().greater(t.double_ref, d).less(t.double_ref, d + 10).greater(t.int_ref, 3));
+        check(t.table.where().greater(t.int_col, v).less(t.ts_col, Timestamp(v + 50, 0)),
+              t.table.where().greater(t.int_ref, v).less(t.ts_ref, Timestamp(v + 50, 0)));
+        check(t.table.where().equal(t.int_col, v), t.table.where().equal(t.int_ref, v));
+        check(t.table.where().Not().between(t.int_col, v, v + 5),
+              t.table.where().Not().between(t.int_ref, v, v + 5));
+        check(t.table.where().greater(t.int_col, v).Or().less(t.int_col, 3),
+              t.table.where().greater(t.int_ref, v).Or().less(t.int_ref, 3));
+    }
+
+    // Aggregates over an index range
+    auto q = t.table.where().between(t.int_col, 100, 120);
+    auto ref = t.table.where().between(t.int_ref, 100, 120);
+    CHECK_EQUAL(q.sum(t.double_ref), ref.sum(t.double_ref));
+    CHECK_EQUAL(q.max(t.int_ref), ref.max(t.int_ref));
+
+    // Modifications after the query was built are seen by the next run
+    size_t before = q.count();
+    t.table.get_object(0).set(t.int_col, 110);
+    t.table.get_object(0).set(t.int_ref, 110);
+    CHECK_EQUAL(q.count(), ref.count());
+    CHECK_GREATER_EQUAL(q.count(), before);
+}
+
+TEST(IndexSorted_SortAndLimit)
+{
+    IndexedTable t;
+    for (int64_t i = 0; i < 1000; ++i)
+        t.set(t.table.create_object(), (i * 7919) % 300);
+    t.add_indexes();
+
+    std::vector<std::pair<ColKey, ColKey>> columns = {
+        {t.int_col, t.int_ref}, {t.double_col, t.double_ref}, {t.ts_col, t.ts_ref}, {t.str_col, t.str_ref}};
+    for (auto [col, ref_col] : columns) {
+        for (bool ascending : {true, false}) {
+            for (size_t limit : {size_t(0), size_t(1), size_t(10), size_t(500), size_t(2000)}) {
+                // Sorting the whole table and filtered views. The most selective
+                // filter rejects too many objects for the index walk to finish.
+                for (int64_t filter : {-1, 20, 295}) {
+                    Query q = filter < 0 ? t.table.where() : t.table.where().greater(t.int_ref, filter);
+                    DescriptorOrdering indexed;
+                    indexed.append_sort(SortDescriptor({{col}}, {ascending}));
+                    indexed.append_limit(limit);
+                    DescriptorOrdering reference;
+                    reference.append_sort(SortDescriptor({{ref_col}}, {ascending}));
+                    reference.append_limit(limit);
+                    CHECK(keys_of(q.find_all(indexed)) == keys_of(q.find_all(reference)));
+                }
+            }
+            // A sort followed by another descriptor
+            DescriptorOrdering indexed;
+            indexed.append_sort(SortDescriptor({{col}}, {ascending}));
+            indexed.append_distinct(DistinctDescriptor({{t.int_ref}}));
+            DescriptorOrdering reference;
+            reference.append_sort(SortDescriptor({{ref_col}}, {ascending}));
+            reference.append_distinct(DistinctDescriptor({{t.int_ref}}));
+            CHECK(keys_of(t.table.where().find_all(indexed)) == keys_of(t.table.where().find_all(reference)));
+        }
+    }
+}
+
+TEST(IndexSorted_Transactions)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    auto db = DB::create(make_in_realm_history(), path);
+    ColKey col;
+    {
+        auto wt = db->start_write();
+        auto table = wt->add_table("table");
+        col = table->add_column(type_Int, "value");
+        for (int64_t i = 0; i < 100; ++i)
+            table->create_object().set(col, 100 - i);
+        table->add_search_index(col, IndexType::Sorted);
+        wt->commit();
+    }
+    auto rt = db->start_read();
+    auto table = rt->get_table("table");
+    CHECK_EQUAL(table->search_index_type(col), IndexType::Sorted);
+    CHECK_EQUAL(table->where().less(col, 5).count(), 4);
+    {
+        auto wt = db->start_write();
+        auto table = wt->get_table("table");
+        for (int64_t i = 0; i < 10; ++i)
+            table->create_object().set(col, i - 10);
+        table->get_object(0).set(col, 0);
+        wt->commit();
+    }
+    rt->advance_read();
+    CHECK_EQUAL(table->where().less(col, 5).count(), 15);
+    table->get_search_index(col)->verify();
+
+    // Replacing the index in another transaction
+    {
+        auto wt = db->start_write();
+        wt->get_table("table")->add_search_index(col, IndexType::General);
+        wt->commit();
+    }
+    rt->advance_read();
+    CHECK_EQUAL(table->search_index_type(col), IndexType::General);
+    CHECK_EQUAL(table->where().less(col, 5).count(), 15);
+}
+
+TEST(IndexSorted_FileFormat)
+{
+    // Older versions would leave a sorted index stale, so a file holding one
+    // must have a file format which they refuse to open
+    SHARED_GROUP_TEST_PATH(path);
+    _impl::GroupFriend::fake_target_file_format(24);
+    {
+        auto db = DB::create(make_in_realm_history(), path);
+        auto wt = db->start_write();
+        wt->add_table("table")->add_column(type_Int, "value");
+        wt->commit();
+    }
+    _impl::GroupFriend::fake_target_file_format({});
+    {
+        auto db = DB::create(make_in_realm_history(), path);
+        auto wt = db->start_write();
+        auto table = wt->get_table("table");
+        table->add_search_index(table->get_column_key("value"), IndexType::Sorted);
+        wt->commit();
+    }
+    {
+        Group g(path);
+        CHECK_EQUAL(_impl::GroupFriend::get_file_format_version(g), 25);
+        auto table = g.get_table("table");
+        CHECK_EQUAL(table->search_index_type(table->get_column_key("value")), IndexType::Sorted);
+    }
+    util::File::try_remove(BackupHandler::get_prefix_from_path(path) + "v24.backup.realm");
+}
+
+#endif // TEST_INDEX_SORTED
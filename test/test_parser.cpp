@@ -6559,4 +6559,79 @@ TEST(Parser_Wildcard)
     CHECK_EQUAL(q.count(), 1);
 }
 
+TEST(Parser_ParseCache)
+{
+    Group g;
+    auto people = g.add_table("class_people");
+    auto pets = g.add_table("class_pets");
+    auto col_age = people->add_column(type_Int, "age");
+    auto col_name = people->add_column(type_String, "name");
+    auto col_scores = people->add_column_list(type_Int, "scores");
+    auto col_nicknames = people->add_column_list(type_String, "nicknames");
+    auto col_pets = people->add_column_list(*pets, "pets");
+    auto col_pet_age = pets->add_column(type_Int, "age");
+    pets->add_column(type_String, "name");
+
+    std::vector<ObjKey> pet_keys;
+    for (int64_t i = 0; i < 5; ++i)
+        pet_keys.push_back(pets->create_object().set(col_pet_age, i).get_key());
+    for (int64_t i = 0; i < 10; ++i) {
+        auto obj = people->create_object().set(col_age, i).set(col_name, util::format("name %1", i));
+        auto scores = obj.get_list<Int>(col_scores);
+        for (int64_t j = 0; j < i % 3; ++j)
+            scores.add(j);
+        obj.get_list<String>(col_nicknames).add(std::string(size_t(i % 3 + 1), 'x'));
+        auto links = obj.get_linklist(col_pets);
+        for (size_t j = 0; j < size_t(i) % 5; ++j)
+            links.add(pet_keys[j]);
+    }
+
+    // The same string is parsed once and bound to other arguments and tables
+    auto before = query_parser::get_parse_cache_stats();
+    CHECK_EQUAL(people->query("age > $0 && TRUEPREDICATE", std::vector<Mixed>{Mixed(6)}).count(), 3);
+    CHECK_EQUAL(people->query("age > $0 && TRUEPREDICATE", std::vector<Mixed>{Mixed(2)}).count(), 7);
+    CHECK_EQUAL(pets->query("age > $0 && TRUEPREDICATE", std::vector<Mixed>{Mixed(2)}).count(), 2);
+    auto after = query_parser::get_parse_cache_stats();
+    CHECK_GREATER_EQUAL(after.hits - before.hits, 2);
+    CHECK_GREATER_EQUAL(after.misses - before.misses, 1);
+    CHECK_LESS_EQUAL(after.size, after.capacity);
+
+    // Mappings are applied when binding
+    query_parser::KeyPathMapping mapping;
+    mapping.add_mapping(people, "years", "age");
+    CHECK_EQUAL(people->query("years < $0 && TRUEPREDICATE", std::vector<Mixed>{Mixed(4)}, mapping).count(), 4);
+    query_parser::KeyPathMapping other_mapping;
+    other_mapping.add_mapping(people, "years", "name");
+    CHECK_EQUAL(
+        people->query("years < $0 && TRUEPREDICATE", std::vector<Mixed>{Mixed("name 2")}, other_mapping).count(), 2);
+
+    // Parse trees are reused by queries which modify their nodes when bound
+    for (int i = 0; i < 3; ++i) {
+        CHECK_EQUAL(people->query("$K0 == $1", std::vector<Mixed>{Mixed("age"), Mixed(5)}).count(), 1);
+        CHECK_EQUAL(people->query("$K0 == $1", std::vector<Mixed>{Mixed("name"), Mixed("name 7")}).count(), 1);
+        CHECK_EQUAL(pets->query("@links.@count == 0").count(), 1);
+        CHECK_EQUAL(pets->query("@links.people.pets.@count == 4").count(), 1);
+        CHECK_EQUAL(people->query("name.@size == 6").count(), 10);
+        CHECK_EQUAL(people->query("nicknames.length == 2").count(), 3);
+        CHECK_EQUAL(people->query("pets.@max.age > 1").count(), 4);
+        CHECK_EQUAL(people->query("SUBQUERY(pets, $x, $x.age > 2).@count > 0").count(), 2);
+        CHECK_EQUAL(people->query("age BETWEEN {2, 4} SORT(age DESC) LIMIT(2)").find_all().size(), 2);
+        CHECK_THROW_ANY(people->query("height > 2"));
+    }
+
+    // Parse trees with arguments bound by the parser are not kept
+    before = query_parser::get_parse_cache_stats();
+    CHECK_EQUAL(people->query("scores[$0] == 1", std::vector<Mixed>{Mixed(1)}).count(), 3);
+    CHECK_EQUAL(people->query("scores[$0] == 1", std::vector<Mixed>{Mixed(0)}).count(), 0);
+    after = query_parser::get_parse_cache_stats();
+    CHECK_GREATER_EQUAL(after.misses - before.misses, 2);
+
+    // The cache is bounded
+    query_parser::set_parse_cache_capacity(2);
+    for (int i = 0; i < 5; ++i)
+        people->query(util::format("age == %1", i)).count();
+    CHECK_LESS_EQUAL(query_parser::get_parse_cache_stats().size, 2);
+    query_parser::set_parse_cache_capacity(256);
+}
+
 #endif // TEST_PARSER
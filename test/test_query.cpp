@@ -5795,4 +5795,145 @@ TEST(Query_NestedLinkCount)
     CHECK_EQUAL(q.count(), 3);
 }
 
+TEST(Query_ColumnStatistics)
+{
+    Table table;
+    auto col = table.add_column(type_Int, "value", true);
+    auto str_col = table.add_column(type_String, "str");
+    auto list_col = table.add_column_list(type_Int, "list");
+    for (int64_t i = 0; i < 200; ++i) {
+        auto obj = table.create_object();
+        if (i % 4)
+            obj.set(col, i % 10);
+        obj.set(str_col, util::format("s%1", i % 20));
+    }
+
+    // Small tables are sampled completely
+    auto stats = table.get_column_statistics(col);
+    CHECK_EQUAL(stats.num_objects, 200);
+    CHECK_EQUAL(stats.num_sampled, 200);
+    CHECK_EQUAL(stats.null_count, 50);
+    CHECK_EQUAL(stats.distinct_count, 10);
+    CHECK_EQUAL(stats.min, Mixed(0));
+    CHECK_EQUAL(stats.max, Mixed(9));
+    CHECK_APPROXIMATELY_EQUAL(*stats.selectivity(Mixed()), 0.25, 1e-9);
+    CHECK_APPROXIMATELY_EQUAL(*stats.selectivity(Mixed(3)), 0.075, 1e-9);
+    CHECK_EQUAL(*stats.selectivity(Mixed(100)), 0);
+    SortedIndex::Range range;
+    range.begin = Mixed(6);
+    range.begin_inclusive = false;
+    CHECK_APPROXIMATELY_EQUAL(*stats.selectivity(range), 0.75 / 3, 1e-9);
+    range.begin = Mixed(9);
+    CHECK_EQUAL(*stats.selectivity(range), 0);
+    range.include_nulls = true;
+    CHECK_APPROXIMATELY_EQUAL(*stats.selectivity(range), 0.25, 1e-9);
+
+    auto str_stats = table.get_column_statistics(str_col);
+    CHECK_EQUAL(str_stats.distinct_count, 20);
+    CHECK_EQUAL(str_stats.min, Mixed("s0"));
+    CHECK_EQUAL(str_stats.max, Mixed("s9"));
+    CHECK(!table.get_column_statistics(list_col).selectivity(Mixed(1)));
+
+    // Statistics are kept until a tenth of the table has changed
+    for (int64_t i = 0; i < 20; ++i)
+        table.create_object().set(col, 20);
+    stats = table.get_column_statistics(col);
+    CHECK_EQUAL(stats.num_objects, 200);
+    CHECK_EQUAL(stats.max, Mixed(9));
+    table.create_object().set(col, 20);
+    stats = table.get_column_statistics(col);
+    CHECK_EQUAL(stats.num_objects, 221);
+    CHECK_EQUAL(stats.max, Mixed(20));
+
+    // Large tables are sampled
+    for (int64_t i = 0; i < 20000; ++i)
+        table.create_object().set(col, i);
+    stats = table.get_column_statistics(col);
+    CHECK_EQUAL(stats.num_sampled, ColumnStatistics::max_sample_size);
+    CHECK_GREATER(stats.distinct_count, 2000);
+    CHECK_LESS_EQUAL(stats.distinct_count, 20201);
+    CHECK_LESS(*stats.selectivity(Mixed(7)), 0.001);
+}
+
+TEST(Query_ColumnStatisticsAcrossCommits)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    DBRef db = DB::create(make_in_realm_history(), path);
+    auto wt = db->start_write();
+    auto table = wt->add_table("table");
+    auto col = table->add_column(type_Int, "value");
+    for (int64_t i = 0; i < 100; ++i)
+        table->create_object().set(col, i);
+    wt->commit_and_continue_as_read();
+    auto rt = db->start_read();
+    auto rt_table = rt->get_table("table");
+    CHECK_EQUAL(rt_table->get_column_statistics(col).max, Mixed(99));
+
+    // Each commit changes one object, which is not noticed until more than a
+    // tenth of the table may have changed
+    auto update = [&](int64_t value) {
+        wt->promote_to_write();
+        table->get_object(0).set(col, value);
+        wt->commit_and_continue_as_read();
+        rt->advance_read();
+    };
+    for (int64_t i = 0; i < 10; ++i)
+        update(1000 + i);
+    CHECK_EQUAL(rt_table->get_column_statistics(col).max, Mixed(99));
+    CHECK_EQUAL(table->get_column_statistics(col).max, Mixed(1009));
+    update(2000);
+    CHECK_EQUAL(rt_table->get_column_statistics(col).max, Mixed(2000));
+}
+
+TEST(Query_PlannerAndExplain)
+{
+    Group g;
+    auto table = g.add_table("table");
+    auto flag = table->add_column(type_Int, "flag");
+    auto id = table->add_column(type_Int, "id");
+    auto name = table->add_column(type_String, "name");
+    table->add_search_index(flag);
+    for (int64_t i = 0; i < 10000; ++i)
+        table->create_object().set(flag, i % 2).set(id, i).set(name, util::format("n%1", i % 100));
+
+    // An index lookup which matches half of the objects is slower than a
+    // scan for a selective condition
+    Query q = table->where().equal(flag, 1).equal(id, 77);
+    CHECK_EQUAL(q.count(), 1);
+    CHECK_EQUAL(q.find_all().size(), 1);
+    std::string plan = q.explain();
+    CHECK(plan.find("Table 'table': 10000 objects") != std::string::npos);
+    CHECK(plan.find("Search: id == 77 (scan, estimated") != std::string::npos);
+    CHECK(plan.find("Filter: flag == 1 (estimated 5000 matches)") != std::string::npos);
+    CHECK(plan.find("Result: 1 objects") != std::string::npos);
+
+    // A selective index lookup is used
+    table->add_search_index(id);
+    plan = q.explain();
+    CHECK(plan.find("Search: id == 77 (index lookup, 1 matches)") != std::string::npos);
+
+    // The other conditions are tested in order of selectivity
+    q = table->where().greater(id, 100).equal(name, "n5").equal(flag, 1).less(id, 9000);
+    CHECK_EQUAL(q.count(), 89);
+    plan = q.explain();
+    auto flag_pos = plan.find("Filter: flag == 1");
+    auto range_pos = plan.find("Filter: id > 100");
+    CHECK(plan.find("Search: name == \"n5\" (scan") != std::string::npos);
+    CHECK(flag_pos != std::string::npos);
+    CHECK_LESS(flag_pos, range_pos);
+    q = table->where().greater(id, 100).equal(name, "n5").equal(flag, 0).less(id, 9000);
+    CHECK_EQUAL(q.count(), 0);
+
+    // Queries without conditions, on views and with an ordering
+    CHECK(table->where().explain().find("Search: all objects\nResult: 10000 objects") != std::string::npos);
+    auto tv = table->where().less(id, 10).find_all();
+    plan = table->where(&tv).equal(flag, 1).explain();
+    CHECK(plan.find("Restricted to a view of 10 objects") != std::string::npos);
+    CHECK(plan.find("Result: 5 objects") != std::string::npos);
+    auto ordering = util::make_bind<DescriptorOrdering>();
+    ordering->append_limit(3);
+    plan = table->where().equal(flag, 1).set_ordering(ordering).explain();
+    CHECK(plan.find("Ordering: LIMIT(3)\nResult: 3 objects") != std::string::npos);
+}
+
 #endif // TEST_QUERY
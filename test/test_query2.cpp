@@ -24,6 +24,7 @@
 #include <limits>
 #include <vector>
 #include <chrono>
+#include <thread>
 
 #include <realm.hpp>
 #include <realm/column_integer.hpp>
@@ -31,6 +32,7 @@
 #include <realm/query_expression.hpp>
 #include <realm/index_string.hpp>
 #include <realm/query_expression.hpp>
+#include <realm/util/work_stealing_pool.hpp>
 #include "test.hpp"
 #include "test_table_helper.hpp"
 #include "test_types_helper.hpp"
@@ -6375,4 +6377,109 @@ TEST(Query_FullTextPrefix)
     CHECK_EQUAL(q.count(), 1);
 }
 
+TEST(Query_Parallel)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    auto hist = make_in_realm_history();
+    DBRef db = DB::create(*hist, path);
+    ColKey col_int, col_double, col_str;
+    {
+        auto wt = db->start_write();
+        auto table = wt->add_table("table");
+        col_int = table->add_column(type_Int, "int", true);
+        col_double = table->add_column(type_Double, "double");
+        col_str = table->add_column(type_String, "str");
+        for (int64_t i = 0; i < 10000; ++i) {
+            Obj obj = table->create_object();
+            if (i % 13)
+                obj.set(col_int, i % 1000);
+            obj.set(col_double, i * 0.5);
+            obj.set(col_str, (i % 3) ? "foo" : "bar");
+        }
+        wt->commit();
+    }
+
+    auto frozen = db->start_frozen();
+    auto table = frozen->get_table("table");
+    auto check_query = [&](Query q) {
+        Query parallel = Query(q).set_threads(4);
+        CHECK_EQUAL(parallel.get_threads(), 4);
+
+        auto tv = q.find_all();
+        auto tv_parallel = parallel.find_all();
+        CHECK_EQUAL(tv.size(), tv_parallel.size());
+        for (size_t i = 0; i < tv.size(); ++i)
+            CHECK_EQUAL(tv.get_key(i), tv_parallel.get_key(i));
+        CHECK_EQUAL(q.count(), parallel.count());
+        CHECK_EQUAL(*q.sum(col_int), *parallel.sum(col_int));
+        CHECK_EQUAL(*q.avg(col_int), *parallel.avg(col_int));
+        ObjKey min_key, min_key_parallel, max_key, max_key_parallel;
+        CHECK_EQUAL(*q.min(col_int, &min_key), *parallel.min(col_int, &min_key_parallel));
+        CHECK_EQUAL(min_key, min_key_parallel);
+        CHECK_EQUAL(*q.max(col_int, &max_key), *parallel.max(col_int, &max_key_parallel));
+        CHECK_EQUAL(max_key, max_key_parallel);
+        CHECK_EQUAL(*q.max(col_double), *parallel.max(col_double));
+    };
+
+    check_query(table->where());
+    check_query(table->where().greater(col_int, 500));
+    check_query(table->where().equal(col_str, "bar").less(col_double, 3000.0));
+    check_query(table->query("int == nil OR str == 'bar'"));
+    check_query(table->where().equal(col_str, "none"));
+
+    // The process wide pool is used with a thread count of 0
+    Query q = table->where().greater(col_int, 500).set_threads(0);
+    CHECK_EQUAL(q.get_threads(), util::WorkStealingPool::get_default().num_workers());
+    CHECK_EQUAL(q.count(), table->where().greater(col_int, 500).count());
+    CHECK_EQUAL(q.set_threads(1).get_threads(), 1);
+
+    // Queries on live tables are run sequentially
+    auto rt = db->start_read();
+    auto live_table = rt->get_table("table");
+    CHECK_EQUAL(live_table->where().greater(col_int, 500).set_threads(4).count(),
+                table->where().greater(col_int, 500).count());
+}
+
+TEST(Query_WorkStealingPool)
+{
+    util::WorkStealingPool pool(4);
+    CHECK_EQUAL(pool.num_workers(), 4);
+
+    // Tasks of very uneven cost, all in the first worker's initial slice
+    std::vector<std::atomic<int>> visited(1000);
+    pool.parallel_for(visited.size(), [&](size_t task_ndx, size_t worker_ndx) {
+        CHECK_LESS(worker_ndx, 4);
+        if (task_ndx < 50)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        visited[task_ndx]++;
+    });
+    for (auto& v : visited)
+        CHECK_EQUAL(v.load(), 1);
+
+    // Exceptions are propagated to the caller, and the pool remains usable
+    CHECK_THROW(pool.parallel_for(100,
+                                  [&](size_t task_ndx, size_t) {
+                                      if (task_ndx == 42)
+                                          throw std::runtime_error("failed");
+                                  }),
+                std::runtime_error);
+    std::atomic<size_t> count{0};
+    pool.parallel_for(10, [&](size_t, size_t) {
+        ++count;
+    });
+    CHECK_EQUAL(count.load(), 10);
+
+    // Threads started ahead of the first loop are used by it
+    util::WorkStealingPool started(3);
+    started.start_threads();
+    started.start_threads();
+    std::vector<std::atomic<int>> ran(100);
+    started.parallel_for(ran.size(), [&](size_t task_ndx, size_t worker_ndx) {
+        CHECK_LESS(worker_ndx, 3);
+        ran[task_ndx]++;
+    });
+    for (auto& v : ran)
+        CHECK_EQUAL(v.load(), 1);
+}
+
 #endif // TEST_QUERY
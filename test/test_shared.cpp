@@ -2359,6 +2359,610 @@ TEST(Shared_VersionCount)
     CHECK_EQUAL(2, sg->get_number_of_versions());
 }
 
+TEST(Shared_ConcurrentReadLocks)
+{
+    // Read locks are taken without a mutex while versions are added and
+    // cleaned up. Every reader must see a consistent version, and all versions
+    // but the newest ones must be freed once the readers are done.
+    SHARED_GROUP_TEST_PATH(path);
+    DBRef db = get_test_db(path);
+    ColKey col_a, col_b;
+    {
+        WriteTransaction wt(db);
+        auto table = wt.add_table("table");
+        col_a = table->add_column(type_Int, "a");
+        col_b = table->add_column(type_Int, "b");
+        table->create_object();
+        wt.commit();
+    }
+
+    const int num_readers = 8;
+    const int num_commits = 200;
+    std::atomic<bool> done = false;
+    std::vector<std::thread> readers;
+    std::atomic<int> inconsistent = 0;
+    for (int i = 0; i < num_readers; ++i) {
+        readers.emplace_back([&, i] {
+            while (!done) {
+                auto tr = i % 2 ? db->start_read() : db->start_frozen();
+                auto obj = tr->get_table("table")->get_object(0);
+                if (obj.get<Int>(col_a) != obj.get<Int>(col_b))
+                    ++inconsistent;
+                if (auto version = tr->get_version_of_current_transaction(); i % 4 == 1) {
+                    // Lock the same version again through its id
+                    auto again = db->start_read(version);
+                    if (again->get_table("table")->get_object(0).get<Int>(col_a) != obj.get<Int>(col_a))
+                        ++inconsistent;
+                }
+            }
+        });
+    }
+    for (int i = 1; i <= num_commits; ++i) {
+        WriteTransaction wt(db);
+        auto obj = wt.get_table("table")->get_object(0);
+        obj.set(col_a, i);
+        obj.set(col_b, i);
+        wt.commit();
+    }
+    done = true;
+    for (auto& reader : readers)
+        reader.join();
+    CHECK_EQUAL(inconsistent, 0);
+
+    {
+        WriteTransaction wt(db);
+        wt.commit();
+    }
+    CHECK_EQUAL(2, db->get_number_of_versions());
+    auto rt = db->start_read();
+    CHECK_EQUAL(rt->get_table("table")->get_object(0).get<Int>(col_a), num_commits);
+}
+
+TEST(Shared_GroupCommit)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    const int num_threads = 8;
+    const int num_commits = 50;
+    {
+        DBOptions options(crypt_key());
+        options.group_commit = true;
+        DBRef db = DB::create(make_in_realm_history(), path, options);
+        {
+            WriteTransaction wt(db);
+            auto table = wt.add_table("table");
+            table->add_column(type_Int, "thread");
+            table->add_column(type_Int, "value");
+            wt.commit();
+        }
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < num_threads; ++i) {
+            threads.emplace_back([&, i] {
+                for (int j = 0; j < num_commits; ++j) {
+                    auto tr = db->start_write();
+                    auto table = tr->get_table("table");
+                    table->create_object().set_all(i, j);
+                    auto version = tr->commit();
+                    // The version is durable once commit() returns, but
+                    // may have been seen by others before
+                    CHECK_GREATER_EQUAL(db->get_version_of_latest_snapshot(), version);
+                }
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+
+        // Only the newest versions are kept once all commits are on disk
+        {
+            WriteTransaction wt(db);
+            wt.commit();
+        }
+        CHECK_EQUAL(db->get_number_of_versions(), 2);
+    }
+
+    // The file header references the last commit
+    DBRef db = DB::create(make_in_realm_history(), path, DBOptions(crypt_key()));
+    auto rt = db->start_read();
+    auto table = rt->get_table("table");
+    CHECK_EQUAL(table->size(), num_threads * num_commits);
+    for (int i = 0; i < num_threads; ++i) {
+        CHECK_EQUAL(table->where().equal(table->get_column_key("thread"), i).count(), num_commits);
+    }
+}
+
+TEST(Shared_FreeListStats)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    DBRef db = DB::create(make_in_realm_history(), path, DBOptions(crypt_key()));
+    std::vector<ObjKey> keys;
+    {
+        WriteTransaction wt(db);
+        auto table = wt.add_table("table");
+        auto col = table->add_column(type_String, "value");
+        for (int i = 0; i < 10000; ++i)
+            keys.push_back(table->create_object().set(col, std::string(i % 100, 'x')).get_key());
+        wt.commit();
+    }
+
+    // Space freed while a reader holds on to the old version is locked
+    auto rt = db->start_read();
+    {
+        WriteTransaction wt(db);
+        auto table = wt.get_table("table");
+        for (size_t i = 0; i < keys.size(); i += 2)
+            table->remove_object(keys[i]);
+        wt.commit();
+    }
+    DB::FreeListStats stats;
+    db->get_stats(stats);
+    CHECK_GREATER(stats.locked_chunks, 0);
+
+    // And becomes free once the reader is gone
+    rt = nullptr;
+    for (int i = 0; i < 3; ++i) {
+        WriteTransaction wt(db);
+        wt.commit();
+    }
+    size_t free_space, used_space;
+    db->get_stats(free_space, used_space);
+    db->get_stats(stats);
+    CHECK_GREATER(stats.free_chunks, 0);
+    CHECK_GREATER(stats.largest_free_chunk, 0);
+    CHECK_LESS_EQUAL(stats.largest_free_chunk, free_space);
+
+    // The free space is reused for new data, and the file stays consistent
+    {
+        WriteTransaction wt(db);
+        auto table = wt.get_table("table");
+        auto col = table->get_column_key("value");
+        for (int i = 0; i < 5000; ++i)
+            table->create_object().set(col, std::string(i % 100, 'y'));
+        wt.commit();
+    }
+    rt = db->start_read();
+    rt->verify();
+    CHECK_EQUAL(rt->get_table("table")->size(), 10000);
+}
+
+#ifndef _WIN32
+namespace {
+// Replace the contents of the file at `path` by those of the file at `from`,
+// keeping the file itself
+void overwrite_file(const std::string& path, const std::string& from)
+{
+    File source(from);
+    std::vector<char> data(size_t(source.get_size()));
+    source.read(0, data.data(), data.size());
+    File target(path, File::mode_Update);
+    target.resize(0);
+    target.write(0, data.data(), data.size());
+}
+} // anonymous namespace
+
+TEST(Shared_WriteAheadLog)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    SHARED_GROUP_TEST_PATH(crashed_path);
+    SHARED_GROUP_TEST_PATH(copy_path);
+    std::string wal_path = DB::get_core_file(path, DB::CoreFileType::Wal);
+    std::string crashed_wal_path = DB::get_core_file(crashed_path, DB::CoreFileType::Wal);
+    DBOptions options;
+    options.durability = DBOptions::Durability::WriteAheadLog;
+    DBRef db = DB::create(make_in_realm_history(), path, options);
+    {
+        WriteTransaction wt(db);
+        auto table = wt.add_table("table");
+        table->add_column(type_Int, "value");
+        wt.commit();
+    }
+    // The file header still references the version before the first commit,
+    // so a copy of the file is what a crash leaves behind if the commits
+    // after it are lost from the file
+    File::copy(path, crashed_path);
+    for (int i = 0; i < 10; ++i) {
+        WriteTransaction wt(db);
+        auto table = wt.get_table("table");
+        table->create_object().set("value", i);
+        wt.commit();
+    }
+    auto log_size = File::get_size_static(wal_path);
+    CHECK_GREATER(log_size, 0);
+    File::copy(wal_path, crashed_wal_path);
+
+    // A checkpoint writes the commits to the file and clears the log
+    db->checkpoint();
+    CHECK_LESS(File::get_size_static(wal_path), log_size);
+    {
+        WriteTransaction wt(db);
+        wt.get_table("table")->create_object().set("value", 10);
+        wt.commit();
+    }
+    db->close();
+    CHECK_NOT(File::exists(wal_path));
+    db = DB::create(make_in_realm_history(), path, options);
+    auto rt = db->start_read();
+    rt->verify();
+    CHECK_EQUAL(rt->get_table("table")->size(), 11);
+    rt = nullptr;
+    db->close();
+
+    // The log is only replayed on top of the file and version it was started
+    // for. The crashed file is restored in place, as a copy of it is another
+    // file, and the log was written for another file.
+    overwrite_file(path, crashed_path);
+    File::copy(crashed_wal_path, wal_path);
+    File::copy(crashed_path, copy_path);
+    File::copy(crashed_wal_path, DB::get_core_file(copy_path, DB::CoreFileType::Wal));
+    db = DB::create(make_in_realm_history(), copy_path, options);
+    rt = db->start_read();
+    CHECK_NOT(rt->has_table("table"));
+    rt = nullptr;
+    db->close();
+
+    // The commits are restored from the log
+    db = DB::create(make_in_realm_history(), path, options);
+    rt = db->start_read();
+    rt->verify();
+    auto table = rt->get_table("table");
+    CHECK_EQUAL(table->size(), 10);
+    CHECK_EQUAL(table->get_object(ObjKey(9)).get<Int>("value"), 9);
+    rt = nullptr;
+    db->close();
+
+    // A log started on top of another version of the file, here the version
+    // of the crashed file, is discarded
+    File::copy(crashed_wal_path, wal_path);
+    db = DB::create(make_in_realm_history(), path, options);
+    rt = db->start_read();
+    CHECK_EQUAL(rt->get_table("table")->size(), 10);
+    rt = nullptr;
+    db->close();
+}
+
+TEST(Shared_WriteAheadLogFileFormat)
+{
+    // Older versions of the library ignore the log, so a file with commits
+    // which may be only in the log must have a file format they refuse
+    SHARED_GROUP_TEST_PATH(path);
+    _impl::GroupFriend::fake_target_file_format(24);
+    {
+        DBRef db = DB::create(make_in_realm_history(), path);
+        WriteTransaction wt(db);
+        wt.add_table("table")->add_column(type_Int, "value");
+        wt.commit();
+    }
+    _impl::GroupFriend::fake_target_file_format({});
+    DBOptions options;
+    options.durability = DBOptions::Durability::WriteAheadLog;
+    DBRef db = DB::create(make_in_realm_history(), path, options);
+    {
+        WriteTransaction wt(db);
+        wt.get_table("table")->create_object().set("value", 1);
+        wt.commit();
+    }
+    {
+        Group g(path);
+        CHECK_EQUAL(_impl::GroupFriend::get_file_format_version(g), 25);
+    }
+    File::try_remove(BackupHandler::get_prefix_from_path(path) + "v24.backup.realm");
+}
+#endif
+
+#if REALM_ENABLE_ENCRYPTION && !defined(_WIN32)
+TEST(Shared_DecryptedPageCacheSize)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    DBOptions options(crypt_key(true));
+    options.decrypted_page_cache_size = 64 * 1024;
+    DBRef db = DB::create(make_in_realm_history(), path, options);
+    {
+        WriteTransaction wt(db);
+        auto table = wt.add_table("table");
+        auto col = table->add_column(type_String, "value");
+        for (int i = 0; i < 2000; ++i)
+            table->create_object().set(col, std::string(200, char('a' + i % 26)));
+        wt.commit();
+    }
+    // A transaction keeps the pages it accessed in memory, so the limit is
+    // held by reading in short transactions
+    for (int pass = 0; pass < 2; ++pass) {
+        for (size_t begin = 0; begin < 2000; begin += 100) {
+            auto rt = db->start_read();
+            auto table = rt->get_table("table");
+            auto col = table->get_column_key("value");
+            for (size_t i = begin; i < begin + 100; ++i)
+                CHECK_EQUAL(table->get_object(i).get<String>(col), std::string(200, char('a' + i % 26)));
+        }
+    }
+
+    DB::DecryptedPageStats stats;
+    db->get_stats(stats);
+    CHECK_EQUAL(stats.memory_limit, 64 * 1024);
+    CHECK_GREATER(stats.evictions, 0);
+    CHECK_GREATER(stats.hits, 0);
+    CHECK_LESS_EQUAL(stats.memory, 2 * stats.memory_limit);
+}
+#endif
+
+#ifndef _WIN32
+TEST(Shared_MappedMemoryLimit)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    DBOptions options;
+    options.mapped_memory_limit = 2 * 1024 * 1024;
+    DBRef db = DB::create(make_in_realm_history(), path, options);
+    {
+        WriteTransaction wt(db);
+        auto table = wt.add_table("table");
+        auto col = table->add_column(type_String, "value");
+        for (size_t i = 0; i < 40000; ++i)
+            table->create_object().set(col, std::string(200, char('a' + i % 26)));
+        wt.commit();
+    }
+    for (int pass = 0; pass < 2; ++pass) {
+        for (size_t begin = 0; begin < 40000; begin += 1000) {
+            auto rt = db->start_read();
+            auto table = rt->get_table("table");
+            auto col = table->get_column_key("value");
+            for (size_t i = begin; i < begin + 1000; ++i)
+                CHECK_EQUAL(table->get_object(i).get<String>(col), std::string(200, char('a' + i % 26)));
+        }
+    }
+
+    DB::MappingStats stats;
+    db->get_stats(stats);
+    CHECK_EQUAL(stats.limit, 2 * 1024 * 1024);
+    CHECK_GREATER_EQUAL(stats.mapped, 8 * 1024 * 1024);
+    CHECK_GREATER(stats.released_chunks, 0);
+    CHECK_LESS_EQUAL(stats.resident, stats.limit);
+}
+#endif
+
+TEST(Shared_Prefetch)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    DBRef db = DB::create(make_in_realm_history(), path, DBOptions(crypt_key()));
+    {
+        WriteTransaction wt(db);
+        auto foo = wt.add_table("foo");
+        auto int_col = foo->add_column(type_Int, "int");
+        auto str_col = foo->add_column(type_String, "str");
+        foo->add_search_index(str_col);
+        for (int i = 0; i < 10000; ++i)
+            foo->create_object().set(int_col, i).set(str_col, util::to_string(i));
+        auto bar = wt.add_table("bar");
+        auto bar_col = bar->add_column(type_Int, "int");
+        for (int i = 0; i < 10000; ++i)
+            bar->create_object().set(bar_col, i);
+        wt.commit();
+    }
+
+    auto prefetch = [&](DB::PrefetchOptions options) {
+        size_t levels = 0, arrays = 0, bytes = 0;
+        options.progress = [&](size_t a, size_t b) {
+            CHECK_GREATER_EQUAL(a, arrays);
+            CHECK_GREATER_EQUAL(b, bytes);
+            ++levels;
+            arrays = a;
+            bytes = b;
+            return true;
+        };
+        db->prefetch(options);
+        CHECK_GREATER(levels, 0);
+        return std::make_pair(arrays, bytes);
+    };
+    // Only the cluster trees above their leaves by default, more with the data
+    // of a column, and more with its search index
+    auto roots = prefetch({});
+    auto column = prefetch({{{"foo", {"int"}}}, 4});
+    auto column_and_index = prefetch({{{"foo", {"str"}, true}}, 2});
+    auto table = prefetch({{{"foo"}, {"bar"}}});
+    CHECK_GREATER(roots.first, 2);
+    CHECK_GREATER(column.first, roots.first);
+    CHECK_GREATER(column.second, roots.second);
+    CHECK_GREATER(column_and_index.first, column.first);
+    CHECK_GREATER(table.first, column.first);
+    CHECK_GREATER(table.second, column.second);
+
+    // The progress callback can stop it
+    size_t calls = 0;
+    DB::PrefetchOptions options;
+    options.tables = {{"foo"}};
+    options.progress = [&](size_t, size_t) {
+        ++calls;
+        return false;
+    };
+    db->prefetch(options);
+    CHECK_EQUAL(calls, 1);
+
+    CHECK_THROW(db->prefetch({{{"baz"}}}), NoSuchTable);
+    CHECK_THROW(db->prefetch({{{"foo", {"baz"}}}}), InvalidColumnKey);
+    auto rt = db->start_read();
+    CHECK_EQUAL(rt->get_table("foo")->size(), 10000);
+}
+
+TEST(Shared_Metrics)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    DBRef db = DB::create(make_in_realm_history(), path, DBOptions(crypt_key()));
+    ColKey col;
+    {
+        WriteTransaction wt(db);
+        col = wt.add_table("table")->add_column(type_Int, "value");
+        wt.commit();
+    }
+    auto write = [&](int num_objects) {
+        WriteTransaction wt(db);
+        auto table = wt.get_table("table");
+        table->clear();
+        for (int i = 0; i < num_objects; ++i)
+            table->create_object().set(col, i);
+        return wt.commit();
+    };
+    write(10000);
+
+    DB::Metrics metrics;
+    db->get_stats(metrics);
+    CHECK_EQUAL(metrics.commits, 2);
+    CHECK_GREATER(metrics.last_commit_bytes, 10000);
+    CHECK_GREATER(metrics.bytes_written, metrics.last_commit_bytes);
+    CHECK_EQUAL(metrics.begin_write_wait.count, 2);
+    CHECK_EQUAL(metrics.commit.count, 2);
+    CHECK_EQUAL(metrics.write_group.count, 2);
+    CHECK_EQUAL(metrics.free_list.count, 2);
+    CHECK_EQUAL(metrics.sync.count, 2);
+    CHECK_LESS_EQUAL(metrics.write_group.total.count(), metrics.commit.total.count());
+    CHECK_LESS_EQUAL(metrics.commit.percentile(0.5).count(), metrics.commit.max.count());
+    CHECK_GREATER_EQUAL(metrics.read_locks, 2);
+    CHECK_EQUAL(metrics.active_read_locks, 0);
+    CHECK_EQUAL(metrics.newest_version, db->get_version_of_latest_snapshot());
+    CHECK_GREATER(metrics.file_size, 0);
+
+    // A reader pins its version, and the space freed by later versions
+    auto reader = db->start_read();
+    auto pinned = reader->get_version();
+    for (int i = 0; i < 5; ++i)
+        write(10);
+    db->get_stats(metrics);
+    CHECK_EQUAL(metrics.active_read_locks, 1);
+    CHECK_EQUAL(metrics.oldest_live_version, pinned);
+    CHECK_GREATER_EQUAL(metrics.live_versions, 3);
+    CHECK_GREATER(metrics.pinned_space, 10000);
+    reader.reset();
+    write(10);
+    write(10);
+    db->get_stats(metrics);
+    CHECK_GREATER(metrics.oldest_live_version, pinned);
+    CHECK_LESS(metrics.pinned_space, 10000);
+
+    db->reset_metrics();
+    db->get_stats(metrics);
+    CHECK_EQUAL(metrics.commits, 0);
+    CHECK_EQUAL(metrics.commit.count, 0);
+    CHECK_EQUAL(metrics.commit.percentile(0.99).count(), 0);
+    CHECK_EQUAL(metrics.newest_version, db->get_version_of_latest_snapshot());
+
+    DB::LatencyHistogram histogram;
+    for (int i = 0; i < 99; ++i)
+        histogram.record(std::chrono::microseconds(3));
+    histogram.record(std::chrono::microseconds(1000));
+    CHECK_EQUAL(histogram.count, 100);
+    CHECK_EQUAL(histogram.buckets[2], 99);
+    CHECK_EQUAL(histogram.buckets[10], 1);
+    CHECK_EQUAL(histogram.percentile(0.5).count(), 4);
+    CHECK_EQUAL(histogram.percentile(0.99).count(), 4);
+    CHECK_EQUAL(histogram.percentile(1).count(), 1000);
+}
+
+TEST(Shared_PinnedVersionHandler)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::vector<DB::PinnedVersion> reported;
+    DBOptions options(crypt_key());
+    options.pinned_space_limit = 10000;
+    options.pinned_version_handler = [&](const DB::PinnedVersion& pinned) {
+        reported.push_back(pinned);
+    };
+    DBRef db = DB::create(make_in_realm_history(), path, options);
+    ColKey col;
+    auto write = [&](int num_objects) {
+        WriteTransaction wt(db);
+        auto table = wt.get_or_add_table("table");
+        if (!col)
+            col = table->add_column(type_Int, "value");
+        table->clear();
+        for (int i = 0; i < num_objects; ++i)
+            table->create_object().set(col, i);
+        return wt.commit();
+    };
+    write(10000);
+
+    // Small commits after the one before don't pin much
+    write(10);
+    write(10);
+    CHECK(reported.empty());
+
+    // A reader pins the space of its version
+    write(10000);
+    auto reader = db->start_read();
+    auto pinned = reader->get_version();
+    write(10);
+    write(10);
+    write(10);
+    CHECK_EQUAL(reported.size(), 1);
+    if (reported.size() == 1) {
+        CHECK_EQUAL(reported[0].version, pinned);
+        CHECK_GREATER_EQUAL(reported[0].pinned_space, 10000);
+        CHECK_EQUAL(reported[0].live_transactions, 1);
+        CHECK_EQUAL(reported[0].frozen_transactions, 0);
+        CHECK_EQUAL(reported[0].local_transactions, 1);
+        CHECK_EQUAL(reported[0].local_frozen_transactions, 0);
+#ifndef _WIN32
+        CHECK_EQUAL(reported[0].last_reader_pid, uint32_t(getpid()));
+#endif
+    }
+    reader.reset();
+    write(10);
+    write(10);
+    CHECK_EQUAL(reported.size(), 1);
+}
+
+TEST(Shared_PinnedVersionHandlerReleasesFrozenTransactions)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::vector<DB::PinnedVersion> reported;
+    TransactionRef frozen;
+    DBRef db;
+    DBOptions options(crypt_key());
+    options.pinned_version_age_limit = std::chrono::seconds(1);
+    options.pinned_version_handler = [&](const DB::PinnedVersion& pinned) {
+        reported.push_back(pinned);
+        // The write lock is released, so the handler may use the DB
+        auto wt = db->start_write();
+        CHECK(wt);
+        wt->rollback();
+        frozen.reset();
+    };
+    db = DB::create(make_in_realm_history(), path, options);
+    {
+        WriteTransaction wt(db);
+        wt.add_table("table")->add_column(type_Int, "value");
+        wt.commit();
+    }
+    auto write = [&] {
+        WriteTransaction wt(db);
+        wt.get_table("table")->create_object();
+        return wt.commit();
+    };
+
+    frozen = db->start_frozen();
+    auto version = frozen->get_version();
+    auto fresh = write();
+    CHECK(reported.empty());
+
+    millisleep(1100);
+    auto recent = db->start_frozen();
+    write();
+    CHECK_EQUAL(reported.size(), 1);
+    if (reported.size() == 1) {
+        CHECK_EQUAL(reported[0].version, version);
+        CHECK_GREATER_EQUAL(reported[0].age.count(), 1);
+        CHECK_EQUAL(reported[0].frozen_transactions, 1);
+        CHECK_EQUAL(reported[0].local_transactions, 1);
+        CHECK_EQUAL(reported[0].local_frozen_transactions, 1);
+    }
+    // The DB does not close frozen transactions, the handler released the
+    // stale one
+    CHECK_NOT(frozen);
+    CHECK_EQUAL(recent->get_transact_stage(), DB::transact_Frozen);
+    CHECK_EQUAL(recent->get_table("table")->size(), 1);
+    CHECK_EQUAL(recent->get_version(), fresh);
+    write();
+    DB::Metrics metrics;
+    db->get_stats(metrics);
+    CHECK_EQUAL(metrics.oldest_live_version, fresh);
+}
+
 TEST(Shared_MultipleRollbacks)
 {
     SHARED_GROUP_TEST_PATH(path);
@@ -4570,4 +5174,99 @@ TEST(Shared_ClearOnError_CannotClearWhileFileIsOpen)
 }
 #endif
 
+TEST(Shared_CompressedIntegerLeaves)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    DBOptions options(crypt_key());
+    options.compress_integer_leaves = true;
+    auto db = DB::create(make_in_realm_history(), path, options);
+
+    const size_t num_objects = 1000;
+    ColKey col_int, col_null, col_ts, col_link;
+    {
+        WriteTransaction wt(db);
+        auto target = wt.add_table("target");
+        auto table = wt.add_table("table");
+        col_int = table->add_column(type_Int, "int");
+        col_null = table->add_column(type_Int, "nullable", true);
+        col_ts = table->add_column(type_Timestamp, "timestamp");
+        col_link = table->add_column(*target, "link");
+        for (int i = 0; i < 10; ++i)
+            target->create_object();
+        for (size_t i = 0; i < num_objects; ++i) {
+            auto obj = table->create_object();
+            obj.set(col_int, int64_t(1'000'000'000'000 + i % 100));
+            if (i % 3)
+                obj.set(col_null, int64_t(i * 1000));
+            obj.set(col_ts, Timestamp(1'700'000'000 + i, int32_t(i % 10) * 1000));
+            obj.set(col_link, target->get_object(i % 10).get_key());
+        }
+        wt.commit();
+    }
+
+    auto check = [&](ConstTableRef table, int64_t offset) {
+        size_t i = 0;
+        for (auto obj : *table) {
+            CHECK_EQUAL(obj.get<Int>(col_int), int64_t(1'000'000'000'000 + i % 100) + offset);
+            if (i % 3)
+                CHECK_EQUAL(obj.get<util::Optional<Int>>(col_null), int64_t(i * 1000));
+            else
+                CHECK(obj.is_null(col_null));
+            CHECK_EQUAL(obj.get<Timestamp>(col_ts), Timestamp(1'700'000'000 + i, int32_t(i % 10) * 1000));
+            CHECK_EQUAL(obj.get_linked_object(col_link).get_key().value, int64_t(i % 10));
+            ++i;
+        }
+        CHECK_EQUAL(i, num_objects);
+        CHECK_EQUAL(table->where().equal(col_int, 1'000'000'000'042 + offset).count(), 10);
+        CHECK_EQUAL(table->where().not_equal(col_int, 1'000'000'000'042 + offset).count(), 990);
+        CHECK_EQUAL(table->where().greater(col_int, 1'000'000'000'089 + offset).count(), 100);
+        CHECK_EQUAL(table->where().less(col_int, 1'000'000'000'010 + offset).count(), 100);
+        CHECK_EQUAL(table->where().equal(col_null, null()).count(), 334);
+        CHECK_EQUAL(table->where().greater(col_null, 500'000).count(), 332);
+        CHECK_EQUAL(table->where().less(col_ts, Timestamp(1'700'000'100, 0)).count(), 100);
+        CHECK_EQUAL(*table->sum(col_int), 1'000'000'000'000 * int64_t(num_objects) + 49'500 + offset * 1000);
+    };
+
+    auto count_compressed = [&](ConstTableRef table) {
+        size_t compressed = 0;
+        table->traverse_clusters([&](const Cluster* cluster) {
+            for (auto col : {col_int, col_null, col_link}) {
+                // Column leaves follow the key array of the cluster
+                Array leaf(cluster->get_alloc());
+                leaf.init_from_ref(cluster->get_as_ref(col.get_index().val + 1));
+                if (leaf.is_compressed())
+                    ++compressed;
+            }
+            return IteratorControl::AdvanceToNext;
+        });
+        return compressed;
+    };
+
+    size_t num_compressed;
+    {
+        auto rt = db->start_read();
+        auto table = rt->get_table("table");
+        num_compressed = count_compressed(table);
+        CHECK_GREATER(num_compressed, 0);
+        check(table, 0);
+    }
+
+    // Modifying compressed leaves expands them again
+    {
+        WriteTransaction wt(db);
+        auto table = wt.get_table("table");
+        for (auto obj : *table)
+            obj.add_int(col_int, 1);
+        check(table, 1);
+        CHECK_LESS(count_compressed(table), num_compressed);
+        wt.commit();
+    }
+    {
+        auto rt = db->start_read();
+        auto table = rt->get_table("table");
+        check(table, 1);
+        rt->verify();
+    }
+}
+
 #endif // TEST_SHARED
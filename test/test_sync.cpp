@@ -640,6 +640,149 @@ TEST(Sync_Upload)
 }
 
 
+TEST(Sync_CompressionDictionary)
+{
+    // Client 1 has the same compression dictionary as the server, and client
+    // 2 has a different one, so only the messages between client 1 and the
+    // server may be compressed with it
+    class BodyCompressionLogger : public util::Logger {
+    public:
+        std::atomic<int> dictionary_uploads{0};
+        std::atomic<int> dictionary_downloads_1{0};
+        std::atomic<int> dictionary_downloads_2{0};
+
+        BodyCompressionLogger()
+        {
+            set_level_threshold(Level::debug);
+        }
+
+    protected:
+        void do_log(const util::LogCategory&, Level, const std::string& message) override
+        {
+            if (message.find("body_compression=2") == std::string::npos)
+                return;
+            if (message.find("Upload message compression") != std::string::npos)
+                ++dictionary_uploads;
+            if (message.find("Download message compression") == std::string::npos)
+                return;
+            if (message.find("Client[1]:") == 0)
+                ++dictionary_downloads_1;
+            if (message.find("Client[2]:") == 0)
+                ++dictionary_downloads_2;
+        }
+    };
+
+    TEST_DIR(dir);
+    TEST_CLIENT_DB(db_1);
+    TEST_CLIENT_DB(db_2);
+
+    std::string text = "The quick brown fox jumps over the lazy dog, again and again. ";
+    std::vector<char> dictionary(text.begin(), text.end());
+    std::vector<char> other_dictionary(text.rbegin(), text.rend());
+
+    auto logger = std::make_shared<BodyCompressionLogger>();
+    MultiClientServerFixture::Config config;
+    config.logger = logger;
+    config.server_compression_dictionary = dictionary;
+    config.client_compression_dictionaries = {dictionary, other_dictionary};
+    MultiClientServerFixture fixture(2, 1, dir, test_context, std::move(config));
+    fixture.start();
+
+    // Enough objects for the message bodies to be compressed
+    auto add_objects = [&](DBRef db, int64_t first_id) {
+        write_transaction(db, [&](WriteTransaction& wt) {
+            TableRef table = wt.get_group().get_or_add_table_with_primary_key("class_foo", type_Int, "id");
+            ColKey col = table->get_column_key("text");
+            if (!col)
+                col = table->add_column(type_String, "text");
+            for (int64_t id = first_id; id < first_id + 20; ++id)
+                table->create_object_with_primary_key(id).set(col, text + util::to_string(id));
+        });
+    };
+
+    Session session_1 = fixture.make_bound_session(0, db_1, 0, "/test");
+    Session session_2 = fixture.make_bound_session(1, db_2, 0, "/test");
+    for (int64_t round = 0; round < 2; ++round) {
+        add_objects(db_1, round * 100);
+        add_objects(db_2, round * 100 + 50);
+        session_1.wait_for_upload_complete_or_client_stopped();
+        session_2.wait_for_upload_complete_or_client_stopped();
+        session_1.wait_for_download_complete_or_client_stopped();
+        session_2.wait_for_download_complete_or_client_stopped();
+    }
+
+    ReadTransaction rt_1(db_1);
+    ReadTransaction rt_2(db_2);
+    CHECK(compare_groups(rt_1, rt_2, *test_context.logger));
+    CHECK_EQUAL(rt_1.get_table("class_foo")->size(), 80);
+    CHECK_GREATER(logger->dictionary_downloads_1, 0);
+    CHECK_GREATER(logger->dictionary_uploads, 0);
+    CHECK_EQUAL(logger->dictionary_downloads_2, 0);
+}
+
+
+TEST(Sync_PerMessageDeflate)
+{
+    // Only client 1 offers the permessage-deflate extension
+    class ExtensionLogger : public util::Logger {
+    public:
+        std::atomic<int> extension_used_1{0};
+        std::atomic<int> extension_used_2{0};
+
+        ExtensionLogger()
+        {
+            set_level_threshold(Level::debug);
+        }
+
+    protected:
+        void do_log(const util::LogCategory&, Level, const std::string& message) override
+        {
+            if (message.find("Using extension 'permessage-deflate") == std::string::npos)
+                return;
+            if (message.find("Client[1]:") == 0)
+                ++extension_used_1;
+            if (message.find("Client[2]:") == 0)
+                ++extension_used_2;
+        }
+    };
+
+    TEST_DIR(dir);
+    TEST_CLIENT_DB(db_1);
+    TEST_CLIENT_DB(db_2);
+
+    auto logger = std::make_shared<ExtensionLogger>();
+    MultiClientServerFixture::Config config;
+    config.logger = logger;
+    config.client_enable_permessage_deflate = {true, false};
+    MultiClientServerFixture fixture(2, 1, dir, test_context, std::move(config));
+    fixture.start();
+
+    auto add_objects = [&](DBRef db, int64_t first_id) {
+        write_transaction(db, [&](WriteTransaction& wt) {
+            TableRef table = wt.get_group().get_or_add_table_with_primary_key("class_foo", type_Int, "id");
+            for (int64_t id = first_id; id < first_id + 20; ++id)
+                table->create_object_with_primary_key(id);
+        });
+    };
+
+    Session session_1 = fixture.make_bound_session(0, db_1, 0, "/test");
+    Session session_2 = fixture.make_bound_session(1, db_2, 0, "/test");
+    add_objects(db_1, 0);
+    add_objects(db_2, 100);
+    session_1.wait_for_upload_complete_or_client_stopped();
+    session_2.wait_for_upload_complete_or_client_stopped();
+    session_1.wait_for_download_complete_or_client_stopped();
+    session_2.wait_for_download_complete_or_client_stopped();
+
+    ReadTransaction rt_1(db_1);
+    ReadTransaction rt_2(db_2);
+    CHECK(compare_groups(rt_1, rt_2, *test_context.logger));
+    CHECK_EQUAL(rt_1.get_table("class_foo")->size(), 40);
+    CHECK_GREATER(logger->extension_used_1, 0);
+    CHECK_EQUAL(logger->extension_used_2, 0);
+}
+
+
 TEST(Sync_Replication)
 {
     // Replicate changes in file 1 to file 2.
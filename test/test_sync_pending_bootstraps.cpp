@@ -5,6 +5,8 @@
 #include "test.hpp"
 #include "util/test_path.hpp"
 
+#include <future>
+
 namespace realm::sync {
 
 TEST(Sync_PendingBootstrapStoreBatching)
@@ -106,6 +108,60 @@ TEST(Sync_PendingBootstrapStoreBatching)
     }
 }
 
+TEST(Sync_PendingBootstrapStoreReadAhead)
+{
+    SHARED_GROUP_TEST_PATH(db_path);
+    SyncProgress progress;
+    progress.download = {5, 5};
+    progress.latest_server_version = {5, 123456789};
+    progress.upload = {5, 5};
+    auto db = DB::create(make_client_replication(), db_path);
+    sync::PendingBootstrapStore store(db, *test_context.logger);
+
+    std::vector<RemoteChangeset> changesets;
+    std::vector<std::string> changeset_data;
+    changeset_data.reserve(5);
+    for (char val = 'a'; val <= 'e'; ++val) {
+        version_type version = val - 'a' + 1;
+        changeset_data.emplace_back(1024, val);
+        changesets.emplace_back(version, version + 5, BinaryData(changeset_data.back()), version, 1);
+        changesets.back().original_changeset_size = 1024;
+    }
+    store.add_batch(1, progress, changesets, nullptr);
+
+    auto validate_batch = [&](const PendingBootstrapStore::PendingBatch& batch, std::string_view vals,
+                              size_t remaining) {
+        CHECK_EQUAL(batch.changesets.size(), vals.size());
+        CHECK_EQUAL(batch.remaining_changesets, remaining);
+        CHECK_EQUAL(batch.query_version, 1);
+        CHECK(batch.progress);
+        for (size_t i = 0; i < std::min(batch.changesets.size(), vals.size()); ++i) {
+            auto data = batch.changesets[i].data.get_first_chunk();
+            CHECK_EQUAL(batch.changesets[i].remote_version, version_type(vals[i] - 'a' + 1));
+            CHECK(std::all_of(data.data(), data.data() + data.size(), [&](char ch) {
+                return ch == vals[i];
+            }));
+        }
+    };
+
+    // The batch following the one being integrated is read from the version in
+    // which the current batch was not yet removed, on another thread.
+    auto frozen = db->start_frozen();
+    auto current_batch = store.peek_pending((1024 * 2) - 1);
+    validate_batch(current_batch, "ab", 3);
+    auto next_batch = std::async(std::launch::async, [&] {
+        return store.peek_pending(*frozen, current_batch.changesets.size(), (1024 * 2) - 1);
+    });
+    auto tr = db->start_write();
+    store.pop_front_pending(tr, current_batch.changesets.size());
+    tr->commit();
+    validate_batch(next_batch.get(), "cd", 1);
+    validate_batch(store.peek_pending((1024 * 2) - 1), "cd", 1);
+
+    validate_batch(store.peek_pending(*frozen, 4, 1024 * 2), "e", 0);
+    validate_batch(store.peek_pending(*frozen, 5, 1024 * 2), "", 0);
+}
+
 TEST(Sync_PendingBootstrapStoreClear)
 {
     SHARED_GROUP_TEST_PATH(db_path);
@@ -194,6 +194,38 @@ TEST(Protocol_Codec_Upload)
     }
 }
 
+TEST(Protocol_Codec_Upload_CompressionDictionary)
+{
+    auto protocol = _impl::ClientProtocol();
+    auto out = _impl::ClientProtocol::OutputBuffer();
+
+    std::string data = std::string(512, 'A') + std::string(512, 'B') + std::string(512, 'C');
+    std::string body = util::format("4 2 259609999999 123999 %1 ", data.length()) + data;
+    std::vector<char> dictionary(512, 'B');
+    protocol.set_compression_dictionary(dictionary);
+
+    auto make_upload_message = [&](bool use_compression_dictionary) {
+        out.reset();
+        auto upload_message_builder = protocol.make_upload_message_builder(use_compression_dictionary); // Throws
+        upload_message_builder.add_changeset(4, 2, 259609999999, 123999, BinaryData(data.c_str(), data.size()));
+        upload_message_builder.make_upload_message(7, out, 888123, 4, 2, 0);
+        auto message = std::string_view(out.data(), out.size());
+        auto header_size = message.find('\n') + 1;
+        return std::make_pair(message.substr(0, header_size), message.substr(header_size));
+    };
+
+    // The dictionary is only used when asked for
+    auto [header, compressed] = make_upload_message(false);
+    CHECK_EQUAL(header, util::format("upload 888123 1 %1 %2 4 2 0\n", body.length(), compressed.size()));
+
+    std::tie(header, compressed) = make_upload_message(true);
+    CHECK_EQUAL(header, util::format("upload 888123 2 %1 %2 4 2 0\n", body.length(), compressed.size()));
+    Buffer<char> decompressed_buf(body.length());
+    CHECK_NOT(util::compression::decompress(compressed, decompressed_buf, dictionary));
+    compare_out_string(body, decompressed_buf, test_context);
+    CHECK(util::compression::decompress(compressed, decompressed_buf));
+}
+
 TEST(Protocol_Codec_Unbind)
 {
     auto protocol = _impl::ClientProtocol();
@@ -1943,6 +1943,98 @@ TEST(Table_Aggregates2)
     CHECK_EQUAL(s, table.sum(int_col)->get_int());
 }
 
+// Aggregates over many clusters, where whole leaves are aggregated at once
+TEST(Table_AggregatesWholeLeaves)
+{
+    Table table;
+    auto int_col = table.add_column(type_Int, "int");
+    auto int_null_col = table.add_column(type_Int, "int_null", true);
+    auto float_col = table.add_column(type_Float, "float", true);
+    auto double_col = table.add_column(type_Double, "double");
+    auto ts_col = table.add_column(type_Timestamp, "ts", true);
+
+    const size_t size = 3000;
+    int64_t i_sum = 0, in_sum = 0;
+    size_t in_count = 0;
+    double f_sum = 0, d_sum = 0;
+    size_t f_count = 0;
+    std::vector<ObjKey> keys;
+    for (size_t i = 0; i < size; ++i) {
+        Obj obj = table.create_object();
+        keys.push_back(obj.get_key());
+        int64_t v = int64_t(i % 97) - 40;
+        obj.set(int_col, v);
+        i_sum += v;
+        if (i % 7 != 0) {
+            obj.set(int_null_col, v * 1000);
+            in_sum += v * 1000;
+            ++in_count;
+        }
+        if (i % 5 != 0) {
+            float f = float(i % 89) / 4 - 3;
+            obj.set(float_col, f);
+            f_sum += f;
+            ++f_count;
+        }
+        double d = (i % 11 == 3) ? std::numeric_limits<double>::quiet_NaN() : double(i % 83) * 1.5 - 7;
+        obj.set(double_col, d);
+        if (!std::isnan(d))
+            d_sum += d;
+        if (i % 3 != 0)
+            obj.set(ts_col, Timestamp(int64_t(i % 71), 0));
+    }
+
+    // The first occurrences of the extreme values
+    auto first = [&](auto pred) {
+        for (size_t i = 0; i < size; ++i) {
+            if (pred(i))
+                return keys[i];
+        }
+        return ObjKey();
+    };
+
+    ObjKey ret;
+    CHECK_EQUAL(-40, table.min(int_col, &ret)->get_int());
+    CHECK_EQUAL(first([](size_t i) { return i % 97 == 0; }), ret);
+    CHECK_EQUAL(56, table.max(int_col, &ret)->get_int());
+    CHECK_EQUAL(first([](size_t i) { return i % 97 == 96; }), ret);
+    CHECK_EQUAL(-40000, table.min(int_null_col, &ret)->get_int());
+    CHECK_EQUAL(first([](size_t i) { return i % 97 == 0 && i % 7 != 0; }), ret);
+    CHECK_EQUAL(56000, table.max(int_null_col, &ret)->get_int());
+    CHECK_EQUAL(first([](size_t i) { return i % 97 == 96 && i % 7 != 0; }), ret);
+    CHECK_EQUAL(-3.0f, table.min(float_col, &ret)->get_float());
+    CHECK_EQUAL(first([](size_t i) { return i % 89 == 0 && i % 5 != 0; }), ret);
+    CHECK_EQUAL(19.0f, table.max(float_col, &ret)->get_float());
+    CHECK_EQUAL(first([](size_t i) { return i % 89 == 88 && i % 5 != 0; }), ret);
+    CHECK_EQUAL(-7.0, table.min(double_col, &ret)->get_double());
+    CHECK_EQUAL(first([](size_t i) { return i % 83 == 0 && i % 11 != 3; }), ret);
+    CHECK_EQUAL(116.0, table.max(double_col, &ret)->get_double());
+    CHECK_EQUAL(first([](size_t i) { return i % 83 == 82 && i % 11 != 3; }), ret);
+    CHECK_EQUAL(Timestamp(0, 0), table.min(ts_col, &ret)->get_timestamp());
+    CHECK_EQUAL(first([](size_t i) { return i % 71 == 0 && i % 3 != 0; }), ret);
+    CHECK_EQUAL(Timestamp(70, 0), table.max(ts_col, &ret)->get_timestamp());
+    CHECK_EQUAL(first([](size_t i) { return i % 71 == 70 && i % 3 != 0; }), ret);
+
+    CHECK_EQUAL(i_sum, table.sum(int_col)->get_int());
+    CHECK_EQUAL(in_sum, table.sum(int_null_col)->get_int());
+    CHECK_EQUAL(f_sum, table.sum(float_col)->get_double());
+    CHECK_EQUAL(d_sum, table.sum(double_col)->get_double());
+
+    size_t count = realm::npos;
+    CHECK_EQUAL(double(in_sum) / in_count, table.avg(int_null_col, &count)->get_double());
+    CHECK_EQUAL(in_count, count);
+    CHECK_EQUAL(f_sum / f_count, table.avg(float_col, &count)->get_double());
+    CHECK_EQUAL(f_count, count);
+
+    // A condition which every element of a leaf satisfies takes the same path
+    Query q = table.where().not_equal(int_col, int64_t(1) << 40);
+    CHECK_EQUAL(i_sum, q.sum(int_col)->get_int());
+    CHECK_EQUAL(size, q.count());
+    CHECK_EQUAL(-40, q.min(int_col, &ret)->get_int());
+    CHECK_EQUAL(first([](size_t i) { return i % 97 == 0; }), ret);
+    CHECK_EQUAL(10, table.where().not_equal(int_col, int64_t(1) << 40).find_all(10).size());
+}
+
 // Test Table methods max, min, avg, sum, on both nullable and non-nullable columns
 TEST(Table_Aggregates3)
 {
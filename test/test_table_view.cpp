@@ -25,6 +25,7 @@
 #include <ostream>
 #include <cwchar>
 #include <chrono>
+#include <unordered_set>
 
 #include <realm.hpp>
 
@@ -2339,6 +2340,198 @@ TEST(TableView_SortFollowedByLimit)
     }
 }
 
+TEST(TableView_SortFollowedByLimitMatchesFullSort)
+{
+    Table table;
+    auto col_int = table.add_column(type_Int, "int", true);
+    auto col_str = table.add_column(type_String, "str", true);
+    auto col_dbl = table.add_column(type_Double, "dbl");
+    std::mt19937 rnd(unit_test_random_seed);
+    for (int i = 0; i < 3000; ++i) {
+        auto obj = table.create_object();
+        if (rnd() % 10)
+            obj.set(col_int, int64_t(rnd() % 50));
+        if (rnd() % 10)
+            obj.set(col_str, std::string(1, char('a' + rnd() % 5)));
+        obj.set(col_dbl, double(rnd() % 100) / 4);
+    }
+    // Leave some holes in the key sequence
+    for (int i = 0; i < 100; ++i)
+        table.remove_object(table.get_object(size_t(rnd() % table.size())).get_key());
+
+    auto keys = [](const TableView& tv) {
+        std::vector<ObjKey> ret;
+        for (size_t i = 0; i < tv.size(); ++i)
+            ret.push_back(tv.get_key(i));
+        return ret;
+    };
+
+    std::vector<SortDescriptor> sorts = {
+        SortDescriptor({{col_int}}),
+        SortDescriptor({{col_int}}, {false}),
+        SortDescriptor({{col_str}, {col_dbl}}, {true, false}),
+        SortDescriptor({{col_dbl}, {col_int}, {col_str}}, {false, true, false}),
+    };
+    std::vector<Query> queries = {table.where(), table.where().greater(col_dbl, 20.),
+                                  table.where().equal(col_str, "b").Or().equal(col_int, 7)};
+    for (auto& q : queries) {
+        for (auto& sort : sorts) {
+            DescriptorOrdering full;
+            full.append_sort(sort);
+            auto expected = keys(q.find_all(full));
+            for (size_t limit : {size_t(0), size_t(1), size_t(17), size_t(1000), size_t(5000)}) {
+                DescriptorOrdering top;
+                top.append_sort(sort);
+                top.append_limit(limit);
+                auto found = keys(q.find_all(top));
+                CHECK_EQUAL(found.size(), std::min(limit, expected.size()));
+                CHECK(std::equal(found.begin(), found.end(), expected.begin()));
+            }
+        }
+
+        // Descriptors following the limit are still applied
+        DescriptorOrdering top;
+        top.append_sort(SortDescriptor({{col_dbl}}));
+        top.append_limit(200);
+        top.append_distinct(DistinctDescriptor({{col_str}}));
+        DescriptorOrdering full;
+        full.append_sort(SortDescriptor({{col_dbl}}));
+        auto expected = q.find_all(full);
+        std::vector<ObjKey> first;
+        for (size_t i = 0; i < std::min(expected.size(), size_t(200)); ++i)
+            first.push_back(expected.get_key(i));
+        auto distinct = keys(q.find_all(top));
+        CHECK_LESS_EQUAL(distinct.size(), 6);
+        for (auto key : distinct)
+            CHECK(std::find(first.begin(), first.end(), key) != first.end());
+    }
+}
+
+TEST(TableView_IncrementalUpdate)
+{
+    Group g;
+    auto table = g.add_table("table");
+    auto target = g.add_table("target");
+    auto col_int = table->add_column(type_Int, "int", true);
+    auto col_str = table->add_column(type_String, "str", true);
+    auto col_link = table->add_column(*target, "link");
+    auto col_self = table->add_column(*table, "self");
+    target->create_object();
+    std::mt19937 rnd(unit_test_random_seed);
+    auto randomize = [&](Obj obj) {
+        if (rnd() % 10)
+            obj.set(col_int, int64_t(rnd() % 20));
+        else
+            obj.set_null(col_int);
+        obj.set(col_str, std::string(1, char('a' + rnd() % 5)));
+    };
+    for (int i = 0; i < 500; ++i)
+        randomize(table->create_object());
+
+    auto keys = [](const TableView& tv) {
+        std::vector<ObjKey> ret;
+        for (size_t i = 0; i < tv.size(); ++i)
+            ret.push_back(tv.get_key(i));
+        return ret;
+    };
+
+    std::vector<DescriptorOrdering> orderings(5);
+    orderings[1].append_sort(SortDescriptor({{col_int}}));
+    orderings[2].append_sort(SortDescriptor({{col_int}}, {false}));
+    orderings[3].append_sort(SortDescriptor({{col_str}, {col_int}}, {true, false}));
+    orderings[4].append_sort(SortDescriptor({{col_int}}));
+    orderings[4].append_sort(SortDescriptor({{col_str}}));
+    std::vector<Query> queries = {table->where(), table->where().greater(col_int, 7),
+                                  table->where().equal(col_str, "b").Or().equal(col_int, 3)};
+    for (auto& q : queries) {
+        for (auto& ordering : orderings) {
+            TableView tv(q, size_t(-1));
+            tv.apply_descriptor_ordering(ordering);
+            auto previous = keys(tv);
+
+            std::unordered_set<ObjKey> changed;
+            for (int i = 0; i < 50; ++i) {
+                auto obj = table->get_object(size_t(rnd() % table->size()));
+                changed.insert(obj.get_key());
+                switch (rnd() % 3) {
+                    case 0:
+                        randomize(obj);
+                        break;
+                    case 1:
+                        obj.remove();
+                        break;
+                    case 2: {
+                        auto new_obj = table->create_object();
+                        changed.insert(new_obj.get_key());
+                        randomize(new_obj);
+                        break;
+                    }
+                }
+            }
+
+            TableView updated(q, size_t(-1));
+            CHECK(updated.apply_descriptor_ordering(ordering, previous, changed));
+            TableView expected(q, size_t(-1));
+            expected.apply_descriptor_ordering(ordering);
+            CHECK(keys(updated) == keys(expected));
+        }
+    }
+
+    // Results which depend on more than the changed objects themselves
+    std::vector<ObjKey> previous = keys(table->where().find_all());
+    std::unordered_set<ObjKey> changed = {previous.front()};
+    auto check_refused = [&](const Query& q, const DescriptorOrdering& ordering) {
+        TableView tv(q, size_t(-1));
+        CHECK_NOT(tv.apply_descriptor_ordering(ordering, previous, changed));
+    };
+    DescriptorOrdering none;
+    check_refused(table->where().and_query(table->column<Link>(col_link).is_not_null()), none);
+    check_refused(table->link(col_self).column<Int>(col_int) == 3, none);
+    TableView view = table->where().find_all();
+    check_refused(table->where(&view), none);
+    DescriptorOrdering limit;
+    limit.append_limit(LimitDescriptor(10));
+    check_refused(table->where(), limit);
+    DescriptorOrdering distinct;
+    distinct.append_distinct(DistinctDescriptor({{col_str}}));
+    check_refused(table->where(), distinct);
+    DescriptorOrdering linked_sort;
+    linked_sort.append_sort(SortDescriptor({{col_self, col_int}}));
+    check_refused(table->where(), linked_sort);
+    // Expressions on the columns of a table which links to itself can't be
+    // told apart from expressions following the links
+    check_refused(table->query("int * 2 > 7"), none);
+    check_refused(table->query("self.int * 2 > 7"), none);
+
+    // Expressions on the columns of a table without links to itself
+    auto col_target_int = target->add_column(type_Int, "int");
+    for (int i = 0; i < 100; ++i)
+        target->create_object().set(col_target_int, int64_t(i % 10));
+    Query q = target->query("int * 2 > 8");
+    TableView tv(q, size_t(-1));
+    tv.apply_descriptor_ordering(orderings[0]);
+    previous = keys(tv);
+    changed.clear();
+    for (int i = 0; i < 10; ++i) {
+        auto obj = target->get_object(size_t(rnd() % target->size()));
+        changed.insert(obj.get_key());
+        obj.set(col_target_int, int64_t(rnd() % 10));
+    }
+    TableView updated(q, size_t(-1));
+    CHECK(updated.apply_descriptor_ordering(orderings[0], previous, changed));
+    TableView expected(q, size_t(-1));
+    expected.apply_descriptor_ordering(orderings[0]);
+    CHECK(keys(updated) == keys(expected));
+
+    // Arithmetic on the columns of another table depends on that table
+    Query linked_query = table->query("link.int * 2 > 7");
+    check_refused(linked_query, none);
+    TableView linked = linked_query.find_all();
+    CHECK(linked.is_in_sync());
+    target->get_object(0).set(col_target_int, 7);
+    CHECK_NOT(linked.is_in_sync());
+}
+
 TEST(TableView_Filter)
 {
     Table table;
@@ -3120,4 +3120,86 @@ TEST(Transform_SetNullDefaultVsSetDefault)
     CHECK_EQUAL(obj.get_any(col_int), Mixed(6));
 }
 
+TEST(Transform_Parallel)
+{
+    // Transforming the conflict groups in parallel must produce the same
+    // result as transforming them on a single thread. The peers of the
+    // parallel run share one pool, like the sessions of a sync client.
+    unsigned int seed = unit_test_random_seed;
+    CHECK_NOT(Transformer::make_pool(1));
+    auto run = [&](unsigned int threadcount, const std::string& path_add_on) {
+        auto server = Peer::create_server(test_context, nullptr, path_add_on);
+        auto client_1 = Peer::create_client(test_context, 2, nullptr, path_add_on);
+        auto client_2 = Peer::create_client(test_context, 3, nullptr, path_add_on);
+        auto pool = Transformer::make_pool(threadcount);
+        for (Peer* peer : {server.get(), client_1.get(), client_2.get()})
+            peer->history.set_transform_pool(pool);
+
+        auto schema = [](WriteTransaction& tr) {
+            TableRef t = tr.get_group().add_table_with_primary_key("class_t", type_Int, "id");
+            t->add_column(type_Int, "i");
+            t->add_column_list(type_Int, "l");
+            t->add_column(*t, "link");
+        };
+        client_1->create_schema(schema);
+        client_2->create_schema(schema);
+        synchronize(server.get(), {client_1.get(), client_2.get()});
+
+        Random random(seed);
+        for (int round = 0; round < 3; ++round) {
+            for (Peer* client : {client_1.get(), client_2.get()}) {
+                for (int i = 0; i < 50; ++i) {
+                    client->history.advance_time(1);
+                    client->transaction([&](Peer& p) {
+                        TableRef t = p.table("class_t");
+                        Obj obj = t->create_object_with_primary_key(random.draw_int_mod(50));
+                        switch (random.draw_int_mod(5)) {
+                            case 0:
+                                obj.set("i", random.draw_int_mod(1000));
+                                break;
+                            case 1:
+                                obj.get_list<Int>("l").add(random.draw_int_mod(1000));
+                                break;
+                            case 2: {
+                                auto list = obj.get_list<Int>("l");
+                                if (list.size() > 0)
+                                    list.remove(random.draw_int_mod(list.size()));
+                                break;
+                            }
+                            case 3: {
+                                Obj target = t->create_object_with_primary_key(random.draw_int_mod(50));
+                                obj.set("link", target.get_key());
+                                break;
+                            }
+                            case 4:
+                                obj.remove();
+                                break;
+                        }
+                    });
+                }
+            }
+            if (round == 1) {
+                // A schema change in the middle of the local changesets
+                client_1->create_schema([](WriteTransaction& tr) {
+                    tr.get_table("class_t")->add_column(type_String, "s");
+                });
+            }
+            synchronize(server.get(), {client_1.get(), client_2.get()});
+        }
+
+        ReadTransaction read_server(server->shared_group);
+        ReadTransaction read_client_1(client_1->shared_group);
+        ReadTransaction read_client_2(client_2->shared_group);
+        CHECK(compare_groups(read_server, read_client_1, *test_context.logger));
+        CHECK(compare_groups(read_server, read_client_2, *test_context.logger));
+        return server;
+    };
+
+    auto serial = run(1, ".serial");
+    auto parallel = run(4, ".parallel");
+    ReadTransaction read_serial(serial->shared_group);
+    ReadTransaction read_parallel(parallel->shared_group);
+    CHECK(compare_groups(read_serial, read_parallel, *test_context.logger));
+}
+
 } // unnamed namespace
@@ -555,6 +555,64 @@ NONCONCURRENT_TEST(Upgrade_BackupAtoBbypassAtoC)
     _impl::GroupFriend::fake_target_file_format({});
 }
 
+NONCONCURRENT_TEST(Upgrade_Database_24_25)
+{
+    SHARED_GROUP_TEST_PATH(path);
+    std::string prefix = realm::BackupHandler::get_prefix_from_path(path);
+    File::try_remove(prefix + "v24.backup.realm");
+
+    _impl::GroupFriend::fake_target_file_format(24);
+    {
+        auto db = DB::create(make_in_realm_history(), path);
+        auto tr = db->start_write();
+        auto table = tr->add_table("MyTable");
+        auto col = table->add_column(type_Int, "ints");
+        for (int i = 0; i < 100; ++i)
+            table->create_object().set(col, i);
+        tr->commit();
+    }
+    _impl::GroupFriend::fake_target_file_format({});
+
+    // Version 24 files can be read without an upgrade
+    {
+        Group g(path);
+        CHECK_EQUAL(_impl::GroupFriend::get_file_format_version(g), 24);
+        CHECK_EQUAL(g.get_table("MyTable")->size(), 100);
+    }
+
+    // Version 25 files may hold compressed leaves, which older versions
+    // cannot read, so a writable session must upgrade
+    {
+        DBOptions options;
+        options.allow_file_format_upgrade = false;
+        CHECK_THROW_ANY(DB::create(make_in_realm_history(), path, options));
+    }
+    {
+        DBOptions options;
+        options.compress_integer_leaves = true;
+        bool did_upgrade = false;
+        options.upgrade_callback = [&](int old_version, int new_version) {
+            did_upgrade = true;
+            CHECK_EQUAL(old_version, 24);
+            CHECK_EQUAL(new_version, 25);
+        };
+        auto db = DB::create(make_in_realm_history(), path, options);
+        CHECK(did_upgrade);
+        auto tr = db->start_write();
+        auto table = tr->get_table("MyTable");
+        auto col = table->get_column_key("ints");
+        table->begin()->set(col, 1000);
+        tr->commit_and_continue_as_read();
+        CHECK_EQUAL(tr->get_table("MyTable")->sum(col), 4950 + 1000);
+    }
+    {
+        Group g(path);
+        CHECK_EQUAL(_impl::GroupFriend::get_file_format_version(g), 25);
+    }
+
+    File::try_remove(prefix + "v24.backup.realm");
+}
+
 TEST(Upgrade_RecoverAsymmetricTables)
 {
     // This file has a table that is marked as asymmetric, but has 3 objects in it
@@ -246,6 +246,49 @@ TEST_IF(Compression_Allocate_And_Compress_Large, false)
     allocate_and_compress_decompress_compare(test_context, generate_compressible_data(to_size_t(uncompressed_size)));
 }
 
+TEST(Compression_Dictionary)
+{
+    // Messages which share most of their strings with each other, but are each
+    // too short to compress well on their own
+    std::vector<std::string> messages;
+    for (int i = 0; i < 20; ++i) {
+        messages.push_back(util::format("{\"table\": \"class_Person\", \"field\": \"firstName\", \"value\": %1, "
+                                        "\"object\": {\"_id\": %2, \"partition\": \"user=%3\"}}",
+                                        i * 7, i, i % 3));
+    }
+    std::vector<Span<const char>> samples(messages.begin(), messages.begin() + 10);
+    std::vector<char> dictionary = compression::train_dictionary(samples, 1024);
+    CHECK_GREATER(dictionary.size(), 0);
+    CHECK_LESS_EQUAL(dictionary.size(), 1024);
+
+    size_t total_plain = 0, total_with_dictionary = 0;
+    for (auto& message : messages) {
+        std::vector<char> compressed(compression::compress_bound(message.size()));
+        size_t compressed_size;
+        CHECK_NOT(compression::compress(message, compressed, compressed_size, 6));
+        total_plain += compressed_size;
+        CHECK_NOT(compression::compress(message, compressed, compressed_size, 6, nullptr, dictionary));
+        total_with_dictionary += compressed_size;
+        compressed.resize(compressed_size);
+
+        std::vector<char> decompressed(message.size());
+        CHECK_NOT(compression::decompress(compressed, decompressed, dictionary));
+        compare(test_context, message, decompressed);
+
+        // The data can only be decompressed with the same dictionary
+        CHECK_EQUAL(compression::decompress(compressed, decompressed), compression::error::decompress_unsupported);
+        std::vector<char> other_dictionary = dictionary;
+        other_dictionary.back() ^= 1;
+        CHECK_EQUAL(compression::decompress(compressed, decompressed, other_dictionary),
+                    compression::error::decompress_unsupported);
+    }
+    CHECK_LESS(total_with_dictionary, total_plain);
+
+    CHECK_EQUAL(compression::dictionary_id(dictionary), compression::dictionary_id(dictionary));
+    CHECK_NOT_EQUAL(compression::dictionary_id(dictionary), compression::dictionary_id(samples[0]));
+    CHECK(compression::train_dictionary({}).empty());
+}
+
 namespace {
 struct ChunkingStream : InputStream {
     Span<const char> input;
@@ -14,6 +14,8 @@ namespace {
 // A class for connecting two socket endpoints through a memory buffer.
 class Pipe {
 public:
+    size_t num_bytes_written = 0;
+
     Pipe(const std::shared_ptr<util::Logger>& logger_ptr)
         : m_logger_ptr(logger_ptr)
     {
@@ -24,6 +26,7 @@ public:
     void async_write(const char* data, size_t size, WriteCompletionHandler handler)
     {
         m_logger_ptr->trace(util::LogCategory::network, "async_write, size = %1", size);
+        num_bytes_written += size;
         m_buffer.insert(m_buffer.end(), data, data + size);
         do_read();
         handler(std::error_code{}, size);
@@ -169,6 +172,7 @@ public:
     int n_protocol_errors = 0;
     int n_read_errors = 0;
     int n_write_errors = 0;
+    size_t max_decompressed_message_size = 256 * 1024 * 1024;
 
     std::vector<std::string> text_messages;
     std::vector<std::string> binary_messages;
@@ -264,6 +268,11 @@ public:
         return true;
     }
 
+    size_t websocket_get_max_decompressed_message_size() noexcept override
+    {
+        return max_decompressed_message_size;
+    }
+
 
 private:
     Pipe &m_pipe_in, &m_pipe_out;
@@ -476,3 +485,197 @@ TEST(WebSocket_Interleaved_Fragmented_Messages)
     CHECK_EQUAL(config_2.binary_messages.size(), 1);
     CHECK_EQUAL(config_2.binary_messages[0], "abcd");
 }
+
+TEST(WebSocket_PerMessageDeflate)
+{
+    Fixture fixt{test_context.logger};
+    WSConfig& config_1 = fixt.config_1;
+    WSConfig& config_2 = fixt.config_2;
+
+    websocket::Socket& socket_1 = fixt.socket_1;
+    websocket::Socket& socket_2 = fixt.socket_2;
+
+    socket_1.initiate_client_handshake("/uri", "host", "protocol", {}, true);
+    socket_2.initiate_server_handshake(true);
+
+    CHECK_EQUAL(config_1.n_handshake_completed, 1);
+    CHECK_EQUAL(config_2.n_handshake_completed, 1);
+
+    auto handler_no_op = [=](std::error_code, size_t) {};
+
+    // Later messages refer back to earlier ones, so a repeated message takes
+    // only a few bytes
+    std::string message = "{\"type\":\"MARK\",\"session_ident\":1,\"request_ident\":1}";
+    size_t num_bytes_before = fixt.pipe_2.num_bytes_written;
+    socket_1.async_write_binary(message.data(), message.size(), handler_no_op);
+    size_t first_size = fixt.pipe_2.num_bytes_written - num_bytes_before;
+    num_bytes_before = fixt.pipe_2.num_bytes_written;
+    socket_1.async_write_binary(message.data(), message.size(), handler_no_op);
+    size_t second_size = fixt.pipe_2.num_bytes_written - num_bytes_before;
+    CHECK_LESS(second_size, 16);
+    CHECK_LESS(second_size, first_size);
+    CHECK_EQUAL(config_2.binary_messages.size(), 2);
+    CHECK_EQUAL(config_2.binary_messages[0], message);
+    CHECK_EQUAL(config_2.binary_messages[1], message);
+
+    socket_1.async_write_text("", 0, handler_no_op);
+    socket_1.async_write_text("short text example", 18, handler_no_op);
+    CHECK_EQUAL(config_2.text_messages.size(), 2);
+    CHECK_EQUAL(config_2.text_messages[0], "");
+    CHECK_EQUAL(config_2.text_messages[1], "short text example");
+
+    // Control frames and fragmented messages are not compressed
+    socket_1.async_write_ping("ping example", 12, handler_no_op);
+    CHECK_EQUAL(config_2.ping_messages.size(), 1);
+    CHECK_EQUAL(config_2.ping_messages[0], "ping example");
+    socket_1.async_write_frame(false, websocket::Opcode::binary, "abc", 3, handler_no_op);
+    socket_1.async_write_frame(true, websocket::Opcode::continuation, "defg", 4, handler_no_op);
+    CHECK_EQUAL(config_2.binary_messages.size(), 3);
+    CHECK_EQUAL(config_2.binary_messages[2], "abcdefg");
+
+    std::mt19937_64 random;
+    std::vector<size_t> message_sizes{1, 2, 100, 125, 126, 127, 128, 200, 1000, 65000, 65535, 65536, 100000, 1000000};
+    for (size_t i = 0; i < message_sizes.size(); ++i) {
+        size_t size = message_sizes[i];
+        std::string compressible(size, 'c');
+        socket_2.async_write_binary(compressible.data(), size, handler_no_op);
+        CHECK_EQUAL(config_1.binary_messages.size(), 2 * i + 1);
+        CHECK_EQUAL(config_1.binary_messages[2 * i], compressible);
+
+        std::string incompressible(size, 0);
+        for (char& c : incompressible)
+            c = char(random());
+        socket_2.async_write_binary(incompressible.data(), size, handler_no_op);
+        CHECK_EQUAL(config_1.binary_messages.size(), 2 * i + 2);
+        CHECK_EQUAL(config_1.binary_messages[2 * i + 1], incompressible);
+    }
+    CHECK_EQUAL(config_1.n_protocol_errors, 0);
+    CHECK_EQUAL(config_2.n_protocol_errors, 0);
+}
+
+TEST(WebSocket_PerMessageDeflate_MaxDecompressedSize)
+{
+    Fixture fixt{test_context.logger};
+    WSConfig& config_1 = fixt.config_1;
+
+    websocket::Socket& socket_1 = fixt.socket_1;
+    websocket::Socket& socket_2 = fixt.socket_2;
+
+    config_1.max_decompressed_message_size = 100000;
+    socket_1.initiate_client_handshake("/uri", "host", "protocol", {}, true);
+    socket_2.initiate_server_handshake(true);
+
+    auto handler_no_op = [=](std::error_code, size_t) {};
+
+    // A message which decompresses to much more than its compressed size is
+    // rejected once it exceeds the limit
+    std::string message(100000, 'c');
+    socket_2.async_write_binary(message.data(), message.size(), handler_no_op);
+    CHECK_EQUAL(config_1.binary_messages.size(), 1);
+    CHECK_EQUAL(config_1.n_protocol_errors, 0);
+    message.push_back('c');
+    socket_2.async_write_binary(message.data(), message.size(), handler_no_op);
+    CHECK_EQUAL(config_1.binary_messages.size(), 1);
+    CHECK_EQUAL(config_1.n_protocol_errors, 1);
+}
+
+TEST(WebSocket_PerMessageDeflate_NoContextTakeover)
+{
+    Fixture fixt{test_context.logger};
+    WSConfig& config_1 = fixt.config_1;
+    WSConfig& config_2 = fixt.config_2;
+
+    websocket::Socket& socket_1 = fixt.socket_1;
+    websocket::Socket& socket_2 = fixt.socket_2;
+
+    HTTPHeaders headers;
+    headers["Sec-WebSocket-Extensions"] =
+        "permessage-deflate; server_no_context_takeover; client_no_context_takeover; server_max_window_bits=10";
+    socket_1.initiate_client_handshake("/uri", "host", "protocol", headers, true);
+    socket_2.initiate_server_handshake(true);
+
+    auto handler_no_op = [=](std::error_code, size_t) {};
+
+    // Every message is compressed on its own
+    std::string message = "{\"type\":\"MARK\",\"session_ident\":1,\"request_ident\":1}";
+    for (int i = 0; i < 3; ++i) {
+        size_t num_bytes_before_1 = fixt.pipe_2.num_bytes_written;
+        size_t num_bytes_before_2 = fixt.pipe_1.num_bytes_written;
+        socket_1.async_write_binary(message.data(), message.size(), handler_no_op);
+        socket_2.async_write_binary(message.data(), message.size(), handler_no_op);
+        CHECK_GREATER(fixt.pipe_2.num_bytes_written - num_bytes_before_1, 32);
+        CHECK_GREATER(fixt.pipe_1.num_bytes_written - num_bytes_before_2, 32);
+    }
+    CHECK_EQUAL(config_1.binary_messages.size(), 3);
+    CHECK_EQUAL(config_2.binary_messages.size(), 3);
+    CHECK_EQUAL(config_1.binary_messages[2], message);
+    CHECK_EQUAL(config_2.binary_messages[2], message);
+}
+
+TEST(WebSocket_PerMessageDeflate_NotAccepted)
+{
+    Fixture fixt{test_context.logger};
+    WSConfig& config_1 = fixt.config_1;
+    WSConfig& config_2 = fixt.config_2;
+
+    websocket::Socket& socket_1 = fixt.socket_1;
+    websocket::Socket& socket_2 = fixt.socket_2;
+
+    socket_1.initiate_client_handshake("/uri", "host", "protocol", {}, true);
+    socket_2.initiate_server_handshake(false);
+
+    CHECK_EQUAL(config_1.n_handshake_completed, 1);
+    CHECK_EQUAL(config_2.n_handshake_completed, 1);
+
+    auto handler_no_op = [=](std::error_code, size_t) {};
+    std::string message(100, 'c');
+    size_t num_bytes_before = fixt.pipe_2.num_bytes_written;
+    socket_1.async_write_binary(message.data(), message.size(), handler_no_op);
+    CHECK_EQUAL(fixt.pipe_2.num_bytes_written - num_bytes_before, message.size() + 6);
+    CHECK_EQUAL(config_2.binary_messages.size(), 1);
+    CHECK_EQUAL(config_2.binary_messages[0], message);
+
+    // A compressed frame is a protocol error when the extension is not in use
+    const char frame[] = "\xc2\x81\x00\x00\x00\x00\x4a";
+    fixt.pipe_2.async_write(frame, sizeof frame - 1, handler_no_op);
+    CHECK_EQUAL(config_2.binary_messages.size(), 1);
+    CHECK_EQUAL(config_2.n_protocol_errors, 1);
+}
+
+TEST(WebSocket_PerMessageDeflate_Negotiation)
+{
+    auto negotiate = [](const char* offer, bool accept_permessage_deflate = true) {
+        HTTPRequest request;
+        request.headers["Upgrade"] = "websocket";
+        request.headers["Connection"] = "Upgrade";
+        request.headers["Sec-WebSocket-Key"] = "dGhlIHNhbXBsZSBub25jZQ==";
+        request.headers["Sec-WebSocket-Version"] = "13";
+        if (offer)
+            request.headers["Sec-WebSocket-Extensions"] = offer;
+        std::error_code ec;
+        auto response = websocket::make_http_response(request, "protocol", ec, accept_permessage_deflate);
+        REALM_ASSERT(!ec && response);
+        auto i = response->headers.find("Sec-WebSocket-Extensions");
+        return i == response->headers.end() ? std::string("none") : i->second;
+    };
+
+    CHECK_EQUAL(negotiate(nullptr), "none");
+    CHECK_EQUAL(negotiate("permessage-deflate", false), "none");
+    CHECK_EQUAL(negotiate("permessage-deflate"), "permessage-deflate");
+    CHECK_EQUAL(negotiate("permessage-deflate; client_max_window_bits"), "permessage-deflate");
+    CHECK_EQUAL(negotiate("PerMessage-Deflate ; Server_No_Context_Takeover ; client_max_window_bits=\"9\""),
+                "permessage-deflate; server_no_context_takeover");
+    CHECK_EQUAL(negotiate("permessage-deflate; client_no_context_takeover; server_max_window_bits=12"),
+                "permessage-deflate; client_no_context_takeover; server_max_window_bits=12");
+
+    // Offers with unsupported or invalid parameters are declined
+    CHECK_EQUAL(negotiate("x-webkit-deflate-frame"), "none");
+    CHECK_EQUAL(negotiate("permessage-deflate; server_max_window_bits=8"), "none");
+    CHECK_EQUAL(negotiate("permessage-deflate; server_max_window_bits=16"), "none");
+    CHECK_EQUAL(negotiate("permessage-deflate; server_max_window_bits"), "none");
+    CHECK_EQUAL(negotiate("permessage-deflate; server_no_context_takeover; server_no_context_takeover"), "none");
+    CHECK_EQUAL(negotiate("permessage-deflate; mux"), "none");
+    CHECK_EQUAL(negotiate("x-webkit-deflate-frame, permessage-deflate; server_max_window_bits=8, "
+                          "permessage-deflate; server_max_window_bits=15"),
+                "permessage-deflate; server_max_window_bits=15");
+}
@@ -57,6 +57,8 @@
 #define TEST_GEO
 #define TEST_GROUP
 #define TEST_UPGRADE
+#define TEST_INDEX_COMPOSITE
+#define TEST_INDEX_SORTED
 #define TEST_INDEX_STRING
 #define TEST_LANG_BIND_HELPER
 #define TEST_PARSER